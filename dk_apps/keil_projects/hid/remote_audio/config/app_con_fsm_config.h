@@ -124,6 +124,9 @@ typedef struct {
     bool has_security_request_send;
     bool has_send_ll_terminate_ind; 
     bool has_usage_counters;
+    bool has_reconnect_policy;
+    bool has_conn_params_manager;
+    bool has_rpa_cache;
     bool has_nv_rom;
     uint32_t unbonded_discoverable_timeout;
     uint32_t bonded_discoverable_timeout;  
@@ -198,6 +201,31 @@ static const con_fsm_params_t con_fsm_params={
 // * of the new host                                                                      *
 // ****************************************************************************************/
     .has_usage_counters          = false,
+        
+///****************************************************************************************
+// * Rank the bonded hosts by recency and reconnection success (app_reconnect.h) and do   *
+// * Directed advertising to the best ones in turn before falling back to Undirected      *
+// * advertising. If not set, only the last host gets Directed advertising.               *
+// ****************************************************************************************/
+    .has_reconnect_policy        = true,
+        
+///****************************************************************************************
+// * Request the connection parameters by the activity of the device (app_conn_params.h): *
+// * high slave latency when idle, lower while typing, low or none while motion or voice  *
+// * reports are sent. Fallback sets are requested when the host rejects a set. If not    *
+// * set, the preferred connection parameters below are requested once.                   *
+// * Note: use_pref_conn_params must be set.                                              *
+// ****************************************************************************************/
+    .has_conn_params_manager     = true,
+        
+///****************************************************************************************
+// * Keep the resolvable private addresses of the bonded hosts resolved recently          *
+// * (app_rpa_cache.h): a host that reconnects with the same address is found without     *
+// * address resolution and the IRKs of the most recently connected hosts are tried       *
+// * first. If not set, all the IRKs are tried in the order they were stored.             *
+// * Note: has_nv_rom must be set.                                                        *
+// ****************************************************************************************/
+    .has_rpa_cache               = true,
     
 /****************************************************************************************
  * Timeouts                                                                             *
@@ -87,6 +87,9 @@
 #define SPI_FLASH_PAGE      SPI_FLASH_PAGE_SIZE   // SPI Flash memory page size in bytes
 #define SPI_FLASH_SECTOR    0x1000
 
+// Lines (32 bytes each) of the read cache of the SPI flash driver, 0 to disable it
+#define SPI_FLASH_CACHE_LINES   (4)
+
 #else   // HAS_SPI_FLASH_STORAGE
         
 // dummy settings so that the compiler does not complain
@@ -50,6 +50,22 @@
 
 
 
+/****************************************************************************************
+ * Measure the worst-case processing time of a row scan step (kbd_row_proc_ticks_max)  *
+ * against the ROW_SCAN_TIME budget. Debug only.                                        *
+ ****************************************************************************************/
+#undef KBD_ROW_TIME_MEASURE_ON
+
+
+/****************************************************************************************
+ * Record timestamps of each stage of a key press (wakeup, scan, report, HOGPD, L2CM,   *
+ * air) in a trace ring and print them over the UART (CFG_PRINTF). The log is           *
+ * analyzed with dk_apps/misc/kbd_latency/kbd_latency.py. Debug only.                   *
+ ****************************************************************************************/
+#undef KBD_LATENCY_TRACE_ON
+
+
+
 /****************************************************************************************
  * Use a key combination to put the device permanently in extended sleep                *
  * (i.e. 'Fn'+'Space') for consumption measurement purposes.                            *
@@ -52,6 +52,63 @@
     //#undef CFG_APP_MOTION
 #endif
 
+/*************************************************************************************
+ * Define CFG_APP_MOTION_FIFO to collect the samples of the BMI055 in its FIFOs at a *
+ * fixed ODR and send them in bursts of MOTION_BURST_SAMPLES per motion report.      *
+ * Otherwise one sample is read and sent per connection event.                       *
+ *************************************************************************************/
+#if defined(CFG_APP_MOTION)
+    #define CFG_APP_MOTION_FIFO
+#endif
+
+/*************************************************************************************
+ * Define CFG_APP_MOTION_POINTER to estimate the orientation of the remote on the    *
+ * device and send the pointer movement in the HID Mouse report. The raw motion      *
+ * reports are still sent. Needs CFG_APP_MOTION_FIFO (fixed sampling rate).          *
+ *************************************************************************************/
+#if defined(CFG_APP_MOTION_FIFO)
+    #define CFG_APP_MOTION_POINTER
+#endif
+
+/*************************************************************************************
+ * Define CFG_APP_MOTION_DELTA to send the motion samples as deltas from the        *
+ * previous sample, with periodic keyframes (app_motion_codec.h).                    *
+ * Needs CFG_APP_MOTION_FIFO.                                                        *
+ *************************************************************************************/
+#if defined(CFG_APP_MOTION_FIFO)
+    #define CFG_APP_MOTION_DELTA
+#endif
+
+/*************************************************************************************
+ * Define CFG_APP_MOTION_I2C_ASYNC to read the FIFOs of the BMI055 with the          *
+ * interrupt driven I2C driver (i2c_async.h) instead of busy waiting.                *
+ * Needs CFG_APP_MOTION_FIFO.                                                        *
+ *************************************************************************************/
+#if defined(CFG_APP_MOTION_FIFO)
+    #define CFG_APP_MOTION_I2C_ASYNC
+#endif
+
+/*************************************************************************************
+ * Define CFG_APP_MOTION_POWER to power the gyro down while the remote is still and  *
+ * wake it on the any-motion interrupt of the accelerometer, and to narrow the gyro  *
+ * bandwidth during slow movements. Needs CFG_APP_MOTION_FIFO.                       *
+ *************************************************************************************/
+#if defined(CFG_APP_MOTION_FIFO)
+    #define CFG_APP_MOTION_POWER
+#endif
+
+/*************************************************************************************
+ * Define CFG_APP_MOTION_INT_PIN if INT1 of the accelerometer of the BMI055 is wired *
+ * to MOTION_INT_PORT/MOTION_INT_PIN. While the gyro is powered down, the latched    *
+ * any-motion interrupt is read from the pin at each connection event, instead of    *
+ * over I2C. Needs CFG_APP_MOTION_POWER.                                             *
+ *************************************************************************************/
+#if defined(CFG_APP_MOTION_POWER)
+    #define CFG_APP_MOTION_INT_PIN
+    #define MOTION_INT_PORT       GPIO_PORT_3
+    #define MOTION_INT_PIN        GPIO_PIN_0
+#endif
+
 
 /*************************************************************************************
  * Define CFG_APP_AUDIO to use the audio features                                    *
@@ -70,6 +127,31 @@
 #define CFG_APP_STREAM
 #endif
 
+/*************************************************************************************
+ * Define CFG_APP_WHEEL to use a scroll wheel / jog dial                             *
+ * The wheel is connected to the X channel of the Quadrature Decoder. WHEEL_A and    *
+ * WHEEL_B must be the pins of the selected WHEEL_QUADEC_CHX pair.                   *
+ *************************************************************************************/
+// Defined below per design #define CFG_APP_WHEEL
+
+
+// P2_7 and P2_8 are free on the DA14582 RCU (MATRIX_SETUP 16) only. They are columns of
+// the DA14580 RCU matrix (MATRIX_SETUP 12). app_kbd_matrix.h stops the build if a wheel
+// pin is a pin of the matrix.
+#if (DA14582_RCU)
+    //#define CFG_APP_WHEEL
+#else
+    //#undef CFG_APP_WHEEL
+#endif
+
+#if defined(CFG_APP_WHEEL)
+    #define WHEEL_QUADEC_CHX    QUAD_DEC_CHXA_P27_AND_CHXB_P28
+    #define WHEEL_A_PORT        (2)
+    #define WHEEL_A_PIN         (7)
+    #define WHEEL_B_PORT        (2)
+    #define WHEEL_B_PIN         (8)
+#endif
+
 /*************************************************************************************
  * Define HAS_SPI_FLASH_STORAGE if SPI flash is used for storing parameters          *
  * Define SPI_FLASH_IS_2M to set SPI Flash size. 1=2Mbit, 0=1Mbit                    *
@@ -139,6 +221,50 @@
 
 #endif  
 
+/*************************************************************************************
+ * Define CFG_SPI_FLASH_BOND_LOG to append the changes of the bonding data to a log  *
+ * in BOND_LOG_SECTORS sectors of the SPI flash, starting at BOND_LOG_BASE_ADDR,     *
+ * instead of erasing the NV_STORAGE_BASE_ADDR sector on every write. The log is     *
+ * placed below the debug sector (APP_FLASH_BASE). Needs HAS_SPI_FLASH_STORAGE.      *
+ *************************************************************************************/
+#if defined(HAS_SPI_FLASH_STORAGE)
+    #define CFG_SPI_FLASH_BOND_LOG
+    #define BOND_LOG_SECTORS      (3)
+    #define BOND_LOG_BASE_ADDR    (NV_STORAGE_BASE_ADDR - (BOND_LOG_SECTORS + 1) * SPI_FLASH_SECTOR)
+#endif
+
+/*************************************************************************************
+ * Define CFG_SPI_FLASH_ASYNC to run SPI flash erases and programs in the background *
+ * (app_flash_async.c). The status of the flash is polled from a kernel timer during *
+ * an erase, so the system can sleep, and from the main loop during a program. The   *
+ * bond log erases its next sector this way. Needs HAS_SPI_FLASH_STORAGE.            *
+ *************************************************************************************/
+#if defined(HAS_SPI_FLASH_STORAGE)
+    #define CFG_SPI_FLASH_ASYNC
+#endif
+
+/*************************************************************************************
+ * Define CFG_ENERGY_LEDGER to keep the time and the charge per power state and per  *
+ * wake reason (app_energy.c). The currents are set in app_energy_current[]. The     *
+ * ledger is read over the vendor HID reports. Needs CFG_APP_STREAM.                 *
+ *************************************************************************************/
+#if defined(CFG_APP_STREAM)
+    #define CFG_ENERGY_LEDGER
+#endif
+
+/*************************************************************************************
+ * Define CFG_BLE_SLEEP to let the main loop put the system in the sleep mode set by *
+ * the application (app_set_extended_sleep()) while the BLE core sleeps, through     *
+ * rwip_sleep(). Otherwise the system stays active. The sleep hooks of app_sleep.h   *
+ * keep the key scanning, the wheel and the I2C transfers powered, and limit a       *
+ * background SPI flash operation to the extended sleep. The voice keeps the system  *
+ * active (app_force_active_mode()).                                                 *
+ * Opt-in: it is not defined here, as it changes the power mode of the whole product *
+ * and has not been checked on hardware. See misc/ble_sleep_model for the current    *
+ * it saves with each slave latency.                                                 *
+ *************************************************************************************/
+// #define CFG_BLE_SLEEP
+
 #ifdef HAS_I2C_EEPROM_STORAGE
 
 /****************************************************************************************/ 
@@ -201,6 +327,86 @@
 #else // defined(CFG_APP_MOTION)
 #define HAS_BMI055   0
 #endif // defined(CFG_APP_MOTION)
+
+/// Burst sampling of the motion sensor
+#if defined(CFG_APP_MOTION_FIFO)
+#define HAS_BMI055_FIFO   1
+#else // defined(CFG_APP_MOTION_FIFO)
+#define HAS_BMI055_FIFO   0
+#endif // defined(CFG_APP_MOTION_FIFO)
+
+/// Pointer movement from the motion sensor
+#if defined(CFG_APP_MOTION_POINTER)
+#define HAS_MOTION_POINTER   1
+#else // defined(CFG_APP_MOTION_POINTER)
+#define HAS_MOTION_POINTER   0
+#endif // defined(CFG_APP_MOTION_POINTER)
+
+/// Delta encoding of the motion reports
+#if defined(CFG_APP_MOTION_DELTA)
+#define HAS_MOTION_DELTA   1
+#else // defined(CFG_APP_MOTION_DELTA)
+#define HAS_MOTION_DELTA   0
+#endif // defined(CFG_APP_MOTION_DELTA)
+
+/// Interrupt driven I2C transactions
+#if defined(CFG_APP_MOTION_I2C_ASYNC)
+#define HAS_I2C_ASYNC   1
+#else // defined(CFG_APP_MOTION_I2C_ASYNC)
+#define HAS_I2C_ASYNC   0
+#endif // defined(CFG_APP_MOTION_I2C_ASYNC)
+
+/// Activity driven power levels of the motion sensor
+#if defined(CFG_APP_MOTION_POWER)
+#define HAS_MOTION_POWER   1
+#else // defined(CFG_APP_MOTION_POWER)
+#define HAS_MOTION_POWER   0
+#endif // defined(CFG_APP_MOTION_POWER)
+
+/// Any-motion interrupt of the motion sensor on a GPIO
+#if defined(CFG_APP_MOTION_INT_PIN)
+#define HAS_MOTION_INT_PIN   1
+#else // defined(CFG_APP_MOTION_INT_PIN)
+#define HAS_MOTION_INT_PIN   0
+#endif // defined(CFG_APP_MOTION_INT_PIN)
+
+/// Log-structured bond storage in the SPI flash
+#if defined(CFG_SPI_FLASH_BOND_LOG)
+#define HAS_SPI_FLASH_BOND_LOG   1
+#else // defined(CFG_SPI_FLASH_BOND_LOG)
+#define HAS_SPI_FLASH_BOND_LOG   0
+#endif // defined(CFG_SPI_FLASH_BOND_LOG)
+
+/// Background erases and programs of the SPI flash
+#if defined(CFG_SPI_FLASH_ASYNC)
+#define HAS_SPI_FLASH_ASYNC   1
+#else // defined(CFG_SPI_FLASH_ASYNC)
+#define HAS_SPI_FLASH_ASYNC   0
+#endif // defined(CFG_SPI_FLASH_ASYNC)
+
+/// Time and charge per power state and wake reason
+#if defined(CFG_ENERGY_LEDGER)
+#define HAS_ENERGY_LEDGER   1
+#else // defined(CFG_ENERGY_LEDGER)
+#define HAS_ENERGY_LEDGER   0
+#endif // defined(CFG_ENERGY_LEDGER)
+
+/// Sleep while the BLE core sleeps
+#if defined(CFG_BLE_SLEEP)
+#define HAS_BLE_SLEEP   1
+#else // defined(CFG_BLE_SLEEP)
+#define HAS_BLE_SLEEP   0
+#endif // defined(CFG_BLE_SLEEP)
+
+/// Scroll wheel on the Quadrature Decoder
+#if defined(CFG_APP_WHEEL)
+#define HAS_QUADEC_WHEEL    1
+#else // defined(CFG_APP_WHEEL)
+#define HAS_QUADEC_WHEEL    0
+#endif // defined(CFG_APP_WHEEL)
+
+/// HID Mouse report, used by the scroll wheel and the motion pointer
+#define HAS_MOUSE_REPORT    (HAS_QUADEC_WHEEL || HAS_MOTION_POINTER)
     
     
 #endif	// _HW_CONFIG
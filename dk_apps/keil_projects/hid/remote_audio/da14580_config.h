@@ -85,6 +85,9 @@
     /* Log HEAP usage */
     #define LOG_MEM_USAGE       0   //0: no logging, 1: logging is active
 
+    /* Count main loop passes and app event handler calls (app_event_stats) */
+    #define LOG_APP_EVENT_STATS 0   //0: no counting, 1: counting is active
+
     /* Application boot from OTP memory - Bootloader copies OTP Header to sysRAM */
     //#define APP_BOOT_FROM_OTP
 
@@ -0,0 +1,558 @@
+/**
+ ****************************************************************************************
+ *
+ * @file aes_queue_test.c
+ *
+ * @brief Host test of the AES job queue (modules/crypto/aes_queue.c): ordering, fairness
+ *        and throughput while the stack contends for the AES block.
+ *
+ * The AES block of the BLE core is simulated with the software AES (sw_aes.c): a write
+ * of 1 to BLE_AESCNTL_REG encrypts the 16 bytes of the exchange memory at
+ * jump_table_struct[offset_em_enc_plain] with the key of the BLE_AESKEY registers (the
+ * words of AES_set_key(), as aes_api.c loads them) into
+ * jump_table_struct[offset_em_enc_cipher]. The kernel is a FIFO of messages and a list
+ * of timers in 10ms units. Time advances by BLOCK_US for each block, KEY_US for each key
+ * load and MSG_US for each message; these are estimates, not measurements, and -block,
+ * -key and -msg override them (us).
+ *
+ * The test checks that
+ * - every job gives the ECB encryption of the software AES, in place too,
+ * - the jobs of up to AES_QUEUE_BURST blocks complete in their order, before a long job
+ *   queued ahead of them, and a job of a bad length fails with AES_JOB_ERR_PARAM,
+ * - with three users that submit again at each completion (a 1 KB job through its
+ *   callback, a block through its callback and a block through AES_JOB_CMP_IND), a block
+ *   waits for at most one burst of each user,
+ * - the queue never touches the AES block while the Security Manager holds it
+ *   (GAPM_USE_ENC_BLOCK), an asynchronous aes_operation() is in progress or the link
+ *   layer encrypts, and goes on afterwards.
+ * It prints the throughput and the latency of each user, without and with that
+ * contention, and the longest AES_QUEUE_RUN handler.
+ *
+ * aes_queue_test.sh builds and runs the test for AES_QUEUE_BURST 1, 4 and 8. A single
+ * variant is built and run from this directory with e.g. (AES_QUEUE_BURST is 4 by default):
+ *   cc -DUSE_AES=1 -Istub -I../../src/modules/crypto aes_queue_test.c \
+ *      ../../src/modules/crypto/sw_aes.c -o aes_queue_test
+ *   ./aes_queue_test [-block <us>] [-key <us>] [-msg <us>]
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "aes_queue.c"
+
+#define BLOCK_US                (12)        // copy in, start, poll, copy out at 16 MHz
+#define KEY_US                  (2)
+#define MSG_US                  (30)        // kernel scheduling of a message
+#define PHASE_US                (1000000L)
+
+#define TASK_USER               (10)        // receives AES_JOB_CMP_IND
+#define MAX_TIMERS              (4)
+#define MAX_JOB                 (1024)
+
+// contention, in the second phase
+#define SM_PERIOD_US            (100000)    // the Security Manager holds the block 20 ms of 100
+#define SM_HOLD_US              (20000)
+#define API_PERIOD_US           (70000)     // an asynchronous aes_operation() 5 ms of 70
+#define API_HOLD_US             (5000)
+#define LL_PERIOD_US            (7500)      // the link layer encrypts at each connection event
+#define LL_HOLD_US              (300)
+
+static int failures;
+static long now;                            // us
+static long block_us = BLOCK_US, key_us = KEY_US, msg_us = MSG_US;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAIL %s\n", what);
+        failures++;
+    }
+}
+
+/*
+ * STACK STAND-INS
+ ****************************************************************************************
+ */
+
+struct aes_env_tag aes_env;
+struct smpm_env_tag smpm_env;
+static struct smp_cmd sm_cmd = {GAPM_USE_ENC_BLOCK};
+static int api_cmd;                         // stands for the message of aes_operation()
+static bool ll_busy;
+static bool contention;
+
+static void update_contention(void)
+{
+    smpm_env.operation = (contention && (now % SM_PERIOD_US < SM_HOLD_US)) ? &sm_cmd : NULL;
+    aes_env.operation = (contention && (now % API_PERIOD_US >= API_PERIOD_US - API_HOLD_US)) ? &api_cmd : NULL;
+    ll_busy = contention && (now % LL_PERIOD_US < LL_HOLD_US);
+}
+
+/*
+ * AES BLOCK MODEL
+ ****************************************************************************************
+ */
+
+static uint8_t em_plain[AES_BLOCKSIZE], em_cipher[AES_BLOCKSIZE];
+uintptr_t jump_table_struct[offset_em_enc_cipher + 1];
+static uint32_t hw_key[4];                  // BLE_AESKEY127_96_REG first
+static long hw_blocks, hw_keys;
+
+static void hw_check_free(void)
+{
+    check(!smpm_env.operation && !aes_env.operation && !ll_busy, "AES block used while the stack has it");
+}
+
+uint32_t GetWord32(uint32_t addr)
+{
+    return ((addr == BLE_AESCNTL_REG) && ll_busy) ? 1 : 0;
+}
+
+void SetWord32(uint32_t addr, uint32_t value)
+{
+    AES_CTX ctx;
+    uint32_t data[4];
+    int i;
+
+    switch (addr) {
+    case BLE_AESKEY127_96_REG:
+    case BLE_AESKEY95_64_REG:
+    case BLE_AESKEY63_32_REG:
+    case BLE_AESKEY31_0_REG:
+        hw_check_free();
+        hw_key[(BLE_AESKEY127_96_REG - addr) / 4] = value;
+        if (addr == BLE_AESKEY127_96_REG) {
+            hw_keys++;
+            now += key_us;
+        }
+        break;
+    case BLE_AESCNTL_REG:
+        hw_check_free();
+        // the key schedule of the words in the key registers
+        for (i = 0; i < 4; i++) {
+            data[i] = hw_key[i];
+        }
+        {
+            uint8_t key[16];
+
+            for (i = 0; i < 16; i++) {
+                key[i] = (uint8_t)(data[i / 4] >> (24 - 8 * (i % 4)));
+            }
+            AES_set_key(&ctx, key, key, AES_MODE_128);
+        }
+        for (i = 0; i < 4; i++) {
+            data[i] = ((uint32_t)em_plain[4 * i] << 24) | ((uint32_t)em_plain[4 * i + 1] << 16) |
+                      ((uint32_t)em_plain[4 * i + 2] << 8) | em_plain[4 * i + 3];
+        }
+        AES_encrypt(&ctx, data);
+        for (i = 0; i < 16; i++) {
+            em_cipher[i] = (uint8_t)(data[i / 4] >> (24 - 8 * (i % 4)));
+        }
+        hw_blocks++;
+        now += block_us;
+        break;
+    }
+}
+
+static void reference_ecb(const uint8_t *key, const uint8_t *in, uint8_t *out, int len)
+{
+    AES_CTX ctx;
+    uint32_t data[4];
+    int b, i;
+
+    AES_set_key(&ctx, key, key, AES_MODE_128);
+    for (b = 0; b < len; b += AES_BLOCKSIZE) {
+        for (i = 0; i < 4; i++) {
+            data[i] = ((uint32_t)in[b + 4 * i] << 24) | ((uint32_t)in[b + 4 * i + 1] << 16) |
+                      ((uint32_t)in[b + 4 * i + 2] << 8) | in[b + 4 * i + 3];
+        }
+        AES_encrypt(&ctx, data);
+        for (i = 0; i < 16; i++) {
+            out[b + i] = (uint8_t)(data[i / 4] >> (24 - 8 * (i % 4)));
+        }
+    }
+}
+
+/*
+ * KERNEL MODEL
+ ****************************************************************************************
+ */
+
+struct kmsg
+{
+    struct kmsg *next;
+    ke_msg_id_t id;
+    ke_task_id_t dest_id;
+    long param[4];
+};
+
+static struct kmsg *fifo_head, *fifo_tail;
+
+static struct
+{
+    bool set;
+    ke_msg_id_t id;
+    ke_task_id_t task;
+    long expiry;
+} timers[MAX_TIMERS];
+
+static long runs, busy_runs, retries, max_handler_us;
+
+void *ke_msg_alloc(ke_msg_id_t id, ke_task_id_t dest_id, ke_task_id_t src_id, uint16_t param_len)
+{
+    struct kmsg *m = calloc(1, sizeof(*m));
+
+    check(param_len <= sizeof(m->param), "message parameters");
+    m->id = id;
+    m->dest_id = dest_id;
+    return m->param;
+}
+
+void ke_msg_send(void const *param_ptr)
+{
+    struct kmsg *m = (struct kmsg *)((char *)param_ptr - offsetof(struct kmsg, param));
+
+    m->next = NULL;
+    if (fifo_head == NULL) {
+        fifo_head = m;
+    } else {
+        fifo_tail->next = m;
+    }
+    fifo_tail = m;
+}
+
+void ke_msg_send_basic(ke_msg_id_t id, ke_task_id_t dest_id, ke_task_id_t src_id)
+{
+    ke_msg_send(ke_msg_alloc(id, dest_id, src_id, 0));
+}
+
+void ke_timer_set(ke_msg_id_t const timer_id, ke_task_id_t const task, uint16_t const delay)
+{
+    int i, free_slot = -1;
+
+    for (i = 0; i < MAX_TIMERS; i++) {
+        if (timers[i].set && (timers[i].id == timer_id) && (timers[i].task == task)) {
+            break;
+        }
+        if (!timers[i].set && (free_slot < 0)) {
+            free_slot = i;
+        }
+    }
+    if (i == MAX_TIMERS) {
+        i = free_slot;
+    }
+    timers[i].set = true;
+    timers[i].id = timer_id;
+    timers[i].task = task;
+    timers[i].expiry = now + (delay ? delay : 1) * 10000L;
+}
+
+/*
+ * USERS
+ ****************************************************************************************
+ */
+
+struct user
+{
+    const char *name;
+    uint16_t len;
+    bool by_message;                        // AES_JOB_CMP_IND instead of the callback
+    bool in_place;
+    struct aes_job job;
+    uint8_t key[16];
+    uint8_t plain[MAX_JOB];
+    uint8_t buf[MAX_JOB];
+    bool active;
+
+    // of the current phase
+    long jobs, blocks;
+    long submitted_us, submitted_run;
+    double latency_sum;
+    long latency_max_us, latency_max_runs;
+};
+
+static struct user users[] = {
+    {"1 KB, callback", MAX_JOB, false, true},
+    {"16 B, callback", 16, false, false},
+    {"16 B, message", 16, true, false},
+};
+
+#define NR_USERS                ((int)(sizeof(users) / sizeof(users[0])))
+
+static void user_done(struct aes_job *job);
+
+static void user_submit(struct user *u)
+{
+    int i;
+
+    for (i = 0; i < u->len; i++) {
+        u->plain[i] = (uint8_t)rand();
+    }
+    memcpy(u->buf, u->plain, u->len);
+    u->job.key = u->key;
+    u->job.in = u->in_place ? u->buf : u->plain;
+    u->job.out = u->buf;
+    u->job.len = u->len;
+    u->job.callback = u->by_message ? NULL : user_done;
+    u->job.dest_id = u->by_message ? TASK_USER : TASK_NONE;
+    u->submitted_us = now;
+    u->submitted_run = busy_runs;
+    aes_queue_submit(&u->job);
+}
+
+static void user_done(struct aes_job *job)
+{
+    struct user *u = NULL;
+    uint8_t ref[MAX_JOB];
+    long latency_us;
+    int i;
+
+    for (i = 0; i < NR_USERS; i++) {
+        if (job == &users[i].job) {
+            u = &users[i];
+        }
+    }
+    latency_us = now - u->submitted_us;
+
+    reference_ecb(u->key, u->plain, ref, u->len);
+    check((job->status == AES_JOB_OK) && !memcmp(u->buf, ref, u->len), "result of a job");
+
+    u->jobs++;
+    u->blocks += u->len / AES_BLOCKSIZE;
+    u->latency_sum += latency_us;
+    if (latency_us > u->latency_max_us) {
+        u->latency_max_us = latency_us;
+    }
+    if (busy_runs - u->submitted_run > u->latency_max_runs) {
+        u->latency_max_runs = busy_runs - u->submitted_run;
+    }
+    if (u->active) {
+        user_submit(u);
+    }
+}
+
+/*
+ * SCHEDULER
+ ****************************************************************************************
+ */
+
+static void dispatch(struct kmsg *m)
+{
+    const long start = now;
+    const long blocks = hw_blocks;
+
+    now += msg_us;
+    if ((m->dest_id == TASK_AES) && (m->id == AES_QUEUE_RUN)) {
+        aes_queue_run_handler(m->id, m->param, m->dest_id, TASK_AES);
+        runs++;
+        if (hw_blocks != blocks) {
+            busy_runs++;
+        } else if (aes_queue_head && (aes_queue_head->len % AES_BLOCKSIZE == 0) && aes_queue_head->len) {
+            retries++;
+        }
+        if (now - start > max_handler_us) {
+            max_handler_us = now - start;
+        }
+    } else if ((m->dest_id == TASK_USER) && (m->id == AES_JOB_CMP_IND)) {
+        const struct aes_job_cmp_ind *ind = (const struct aes_job_cmp_ind *)m->param;
+
+        check(ind->status == ind->job->status, "status of AES_JOB_CMP_IND");
+        user_done(ind->job);
+    } else {
+        check(false, "unexpected message");
+    }
+    free(m);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Runs the kernel until end_us, or until nothing is left to do.
+ ****************************************************************************************
+ */
+static void run_until(long end_us)
+{
+    struct kmsg *m;
+    long next;
+    int i;
+
+    while (now < end_us) {
+        update_contention();
+        for (i = 0; i < MAX_TIMERS; i++) {
+            if (timers[i].set && (timers[i].expiry <= now)) {
+                timers[i].set = false;
+                ke_msg_send_basic(timers[i].id, timers[i].task, timers[i].task);
+            }
+        }
+        if ((m = fifo_head) != NULL) {
+            fifo_head = m->next;
+            dispatch(m);
+            continue;
+        }
+
+        next = end_us;
+        for (i = 0; i < MAX_TIMERS; i++) {
+            if (timers[i].set && (timers[i].expiry < next)) {
+                next = timers[i].expiry;
+            }
+        }
+        if (next == end_us) {
+            return;                         // idle
+        }
+        now = next;
+    }
+}
+
+/*
+ * TESTS
+ ****************************************************************************************
+ */
+
+static struct aes_job order_jobs[6];
+static char order[8];
+static int nb_order;
+
+static void order_done(struct aes_job *job)
+{
+    order[nb_order++] = (char)('a' + (job - order_jobs));
+}
+
+static void test_order(void)
+{
+    static const uint16_t lens[6] = {256, 32, 48, 16, 0, 20};
+    static uint8_t key[16] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                              0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+    static uint8_t in[6][256], out[6][256], ref[256];
+    const long keys = hw_keys;
+    int j, i;
+
+    for (j = 0; j < 6; j++) {
+        for (i = 0; i < 256; i++) {
+            in[j][i] = (uint8_t)(i * 7 + j);
+        }
+        order_jobs[j].key = key;
+        order_jobs[j].in = in[j];
+        order_jobs[j].out = (j == 3) ? in[j] : out[j];      // d in place
+        order_jobs[j].len = lens[j];
+        order_jobs[j].callback = order_done;
+        order_jobs[j].dest_id = TASK_NONE;
+    }
+    reference_ecb(key, in[3], ref, 16);
+
+    for (j = 0; j < 6; j++) {
+        aes_queue_submit(&order_jobs[j]);
+    }
+    check(aes_queue_is_busy(), "aes_queue_is_busy() with queued jobs");
+    busy_runs = 0;
+    run_until(now + PHASE_US);
+    order[nb_order] = '\0';
+
+    check(!aes_queue_is_busy() && (nb_order == 6), "the jobs did not all complete");
+    for (j = 0; j < 4; j++) {
+        reference_ecb(key, in[j], out[5], lens[j]);
+        if (j != 3) {
+            check((order_jobs[j].status == AES_JOB_OK) && !memcmp(out[j], out[5], lens[j]), "result of a job");
+        }
+    }
+    check((order_jobs[3].status == AES_JOB_OK) && !memcmp(in[3], ref, 16), "result of the job in place");
+    check((order_jobs[4].status == AES_JOB_ERR_PARAM) && (order_jobs[5].status == AES_JOB_ERR_PARAM),
+          "jobs of a bad length");
+    // b, c and d fit in a burst (AES_QUEUE_BURST of 4 or more): in order, before a
+    if (AES_QUEUE_BURST >= 4) {
+        check(strchr(order, 'b') < strchr(order, 'c') && strchr(order, 'c') < strchr(order, 'd') &&
+              strchr(order, 'd') < strchr(order, 'a'), "completion order");
+    }
+    check(hw_keys - keys == busy_runs, "one key load per burst");
+    printf("order of completion %s (a 256 B, b 32 B, c 48 B, d 16 B, e 0 B, f 20 B), %ld bursts\n",
+           order, busy_runs);
+
+    aes_queue_submit(&order_jobs[0]);
+    aes_queue_reset();
+    check(!aes_queue_is_busy(), "aes_queue_reset()");
+    fifo_head = NULL;                       // the kernel flushes the messages of the task
+}
+
+static void phase(const char *name, bool contended)
+{
+    const long start = now, blocks = hw_blocks;
+    int i;
+
+    contention = contended;
+    runs = busy_runs = retries = max_handler_us = 0;
+    for (i = 0; i < NR_USERS; i++) {
+        users[i].jobs = users[i].blocks = 0;
+        users[i].latency_sum = 0;
+        users[i].latency_max_us = users[i].latency_max_runs = 0;
+    }
+
+    run_until(start + PHASE_US);
+
+    printf("%s: %.0f blocks/s (%.0f%% of the AES block), %ld runs, %ld retries, longest run %ld us\n",
+           name, (hw_blocks - blocks) * 1e6 / (now - start), 100.0 * (hw_blocks - blocks) * block_us / (now - start),
+           runs, retries, max_handler_us);
+    printf("  %-16s %-8s %-10s %-10s %-10s %s\n", "user", "jobs", "blocks/s", "mean us", "max us", "max bursts");
+    for (i = 0; i < NR_USERS; i++) {
+        const struct user *u = &users[i];
+
+        printf("  %-16s %-8ld %-10.0f %-10.0f %-10ld %ld\n", u->name, u->jobs, u->blocks * 1e6 / (now - start),
+               u->jobs ? u->latency_sum / u->jobs : 0.0, u->latency_max_us, u->latency_max_runs);
+        check(u->jobs > 0, "a user was not served");
+        // a block waits for a burst of each other user, then its own
+        if ((u->len == AES_BLOCKSIZE) && (u->latency_max_runs > NR_USERS)) {
+            printf("FAIL %s waited %ld bursts\n", u->name, u->latency_max_runs);
+            failures++;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int i, k;
+
+    for (k = 1; k + 1 < argc; k += 2) {
+        if (!strcmp(argv[k], "-block")) {
+            block_us = atol(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-key")) {
+            key_us = atol(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-msg")) {
+            msg_us = atol(argv[k + 1]);
+        }
+    }
+    jump_table_struct[offset_em_enc_plain] = (uintptr_t)em_plain - 0x80000;
+    jump_table_struct[offset_em_enc_cipher] = (uintptr_t)em_cipher - 0x80000;
+    srand(1);
+
+    test_order();
+
+    printf("AES_QUEUE_BURST %d, %ld us/block, %ld us/key, %ld us/message\n", AES_QUEUE_BURST, block_us,
+           key_us, msg_us);
+    for (i = 0; i < NR_USERS; i++) {
+        for (k = 0; k < 16; k++) {
+            users[i].key[k] = (uint8_t)rand();
+        }
+        users[i].active = true;
+        user_submit(&users[i]);
+    }
+    phase("block free", false);
+    phase("contention", true);
+
+    // the last jobs complete once the users stop
+    for (i = 0; i < NR_USERS; i++) {
+        users[i].active = false;
+    }
+    contention = false;
+    run_until(now + PHASE_US);
+    check(!aes_queue_is_busy(), "jobs left in the queue");
+
+    printf("%s\n", failures ? "" : "ok");
+    return failures != 0;
+}
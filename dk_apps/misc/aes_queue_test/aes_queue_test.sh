@@ -0,0 +1,18 @@
+#!/bin/sh
+#
+# Builds aes_queue_test.c with modules/crypto/aes_queue.c (USE_AES) and sw_aes.c for
+# AES_QUEUE_BURST 1, 4 and 8, and runs it. Usage: aes_queue_test.sh [C compiler, cc by default]
+#
+cd "$(dirname "$0")" || exit 1
+CC=${1:-cc}
+OUT=$(mktemp -d) || exit 1
+status=0
+
+for burst in 1 4 8; do
+    $CC -O2 -Wall -Istub -I../../src/modules/crypto -DUSE_AES=1 -DAES_QUEUE_BURST=$burst \
+        aes_queue_test.c ../../src/modules/crypto/sw_aes.c -o "$OUT/test" || status=1
+    "$OUT/test" || status=1
+done
+
+rm -rf "$OUT"
+exit $status
@@ -0,0 +1,25 @@
+/**
+ ****************************************************************************************
+ *
+ * @file arch.h
+ *
+ * @brief Host stand-in of the platform header included by sw_aes.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _ARCH_H_
+#define _ARCH_H_
+
+#include <stdint.h>
+
+#define __INLINE static inline
+
+#endif // _ARCH_H_
@@ -0,0 +1,26 @@
+/**
+ ****************************************************************************************
+ *
+ * @file co_bt.h
+ *
+ * @brief Host stand-in of co_bt.h, for aes_queue.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef CO_BT_H_
+#define CO_BT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define KEY_LEN                         0x10
+
+#endif // CO_BT_H_
@@ -0,0 +1,33 @@
+/**
+ ****************************************************************************************
+ *
+ * @file gap.h
+ *
+ * @brief Host stand-in of gap.h, for aes_queue.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef GAP_H_
+#define GAP_H_
+
+#include "co_bt.h"
+
+struct bd_addr
+{
+    uint8_t addr[6];
+};
+
+struct gap_sec_key
+{
+    uint8_t key[KEY_LEN];
+};
+
+#endif // GAP_H_
@@ -0,0 +1,29 @@
+/**
+ ****************************************************************************************
+ *
+ * @file gapm_task.h
+ *
+ * @brief Host stand-in of gapm_task.h, for aes_queue.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _GAPM_TASK_H_
+#define _GAPM_TASK_H_
+
+enum gapm_operation
+{
+    GAPM_RESOLV_ADDR = 0x17,
+    GAPM_GEN_RAND_ADDR,
+    GAPM_USE_ENC_BLOCK,
+    GAPM_GEN_RAND_NB,
+};
+
+#endif // _GAPM_TASK_H_
@@ -0,0 +1,55 @@
+/**
+ ****************************************************************************************
+ *
+ * @file ke_msg.h
+ *
+ * @brief Host stand-in of ke_msg.h, for aes_queue.c.
+ *        The messages go to the kernel model of aes_queue_test.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _KE_MSG_H_
+#define _KE_MSG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef uint16_t ke_msg_id_t;
+typedef uint16_t ke_task_id_t;
+typedef uint8_t ke_state_t;
+
+// from rwip_config.h
+#define TASK_AES                        62
+#define TASK_NONE                       ((ke_task_id_t)0xFF)
+
+#define KE_FIRST_MSG(task)              ((ke_msg_id_t)((task) << 10))
+
+enum ke_msg_status_tag
+{
+    KE_MSG_CONSUMED = 0,
+    KE_MSG_NO_FREE,
+    KE_MSG_SAVED,
+};
+
+struct ke_state_handler
+{
+    const void *msg_table;
+    uint16_t msg_cnt;
+};
+
+#define KE_MSG_ALLOC(id, dest, src, param_str) \
+    (struct param_str *)ke_msg_alloc(id, dest, src, sizeof(struct param_str))
+
+void *ke_msg_alloc(ke_msg_id_t id, ke_task_id_t dest_id, ke_task_id_t src_id, uint16_t param_len);
+void ke_msg_send(void const *param_ptr);
+void ke_msg_send_basic(ke_msg_id_t id, ke_task_id_t dest_id, ke_task_id_t src_id);
+
+#endif // _KE_MSG_H_
@@ -0,0 +1,26 @@
+/**
+ ****************************************************************************************
+ *
+ * @file ke_timer.h
+ *
+ * @brief Host stand-in of ke_timer.h, for aes_queue.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _KE_TIMER_H_
+#define _KE_TIMER_H_
+
+#include "ke_msg.h"
+
+// delay in 10ms units
+void ke_timer_set(ke_msg_id_t const timer_id, ke_task_id_t const task, uint16_t const delay);
+
+#endif // _KE_TIMER_H_
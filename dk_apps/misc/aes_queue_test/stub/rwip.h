@@ -0,0 +1,42 @@
+/**
+ ****************************************************************************************
+ *
+ * @file rwip.h
+ *
+ * @brief Host stand-in of rwip.h, for aes_queue.c.
+ *        The AES block and the exchange memory are simulated by aes_queue_test.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _RWIP_H_
+#define _RWIP_H_
+
+#include <stdint.h>
+
+// from datasheet.h
+#define BLE_AESCNTL_REG                 (0x400000C0)
+#define BLE_AESKEY31_0_REG              (0x400000C4)
+#define BLE_AESKEY63_32_REG             (0x400000C8)
+#define BLE_AESKEY95_64_REG             (0x400000CC)
+#define BLE_AESKEY127_96_REG            (0x400000D0)
+#define BLE_AESPTR_REG                  (0x400000D4)
+
+// from rwip_config.h
+#define offset_em_enc_plain             30
+#define offset_em_enc_cipher            31
+
+// exchange memory offsets, from 0x80000: wide enough for the addresses of the host
+extern uintptr_t jump_table_struct[];
+
+uint32_t GetWord32(uint32_t addr);
+void SetWord32(uint32_t addr, uint32_t value);
+
+#endif // _RWIP_H_
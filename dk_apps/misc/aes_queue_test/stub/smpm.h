@@ -0,0 +1,36 @@
+/**
+ ****************************************************************************************
+ *
+ * @file smpm.h
+ *
+ * @brief Host stand-in of smpm.h, for aes_queue.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef SMPM_H_
+#define SMPM_H_
+
+#include <stdint.h>
+
+// from smp_common.h
+struct smp_cmd
+{
+    uint8_t operation;
+};
+
+struct smpm_env_tag
+{
+    void *operation;
+};
+
+extern struct smpm_env_tag smpm_env;
+
+#endif // SMPM_H_
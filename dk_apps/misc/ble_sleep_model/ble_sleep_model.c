@@ -0,0 +1,194 @@
+/**
+ ****************************************************************************************
+ *
+ * @file ble_sleep_model.c
+ *
+ * @brief Current and key delay model of the sleep between the connection events skipped
+ *        by the slave latency (CFG_BLE_SLEEP, app_tx_pending() in app_sleep.h), on the
+ *        host.
+ *
+ * The connection interval is INTERVAL_US. The remote listens to one connection event out
+ * of latency + 1 and sleeps in between. Each event it attends costs EVENT_UC and the window
+ * widening (RX_MA for the drift since the last attended event, WIDENING_PPM), each report
+ * PACKET_UC, and the sleep SLEEP_UA all the time. The count of skipped events restarts
+ * at each attended event. These are estimates for the DA14580, not measurements, and can be
+ * changed on the command line.
+ *
+ * The user types 3 keys/s, a press and a release report each. Two ways to send a report:
+ *   - forced wake: app_tx_pending() wakes the BLE up, which takes WAKEUP_US, and the report
+ *     goes out at the next connection event after that;
+ *   - wait for anchor: the report waits for the next event the remote listens to.
+ * The test prints, for each slave latency, the idle current and, for both ways, the
+ * current and the mean and 99th percentile delay of a key report.
+ *
+ * Build and run from this directory:
+ *   cc ble_sleep_model.c -o ble_sleep_model
+ *   ./ble_sleep_model [-sleep <uA>] [-event <uC>] [-packet <uC>] [-ppm <ppm>] [-rx <mA>]
+ *                     [-wakeup <us>]
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#define INTERVAL_US         (7500)
+#define RUN_S               (3600)
+#define KEYS_PER_S          (3)
+#define MAX_REPORTS         (2 * KEYS_PER_S * RUN_S * 2)
+
+static const int latencies[] = {0, 4, 9, 19, 31, 49, 99};
+
+static double sleep_ua = 1.8;
+static double event_uc = 3.0;
+static double packet_uc = 1.5;
+static double widening_ppm = 550;
+static double rx_ma = 4.9;
+static double wakeup_us = 2500;
+
+static double reports_us[MAX_REPORTS];      // the time of each report, in order
+static int nb_reports;
+static double delay_us[MAX_REPORTS];
+
+static int failures;
+
+static double uniform(double lo, double hi)
+{
+    return lo + (hi - lo) * (rand() / (RAND_MAX + 1.0));
+}
+
+static int compare(const void *a, const void *b)
+{
+    const double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+// 3 keys/s on average, each released 80-120ms after the press
+static void make_reports(void)
+{
+    double t = 0;
+
+    srand(1);
+    nb_reports = 0;
+    while (1) {
+        t += uniform(0.1, 2.0 / KEYS_PER_S - 0.3) * 1e6;     // after the last release
+        if (t >= RUN_S * 1e6 - 200000) {
+            break;
+        }
+        reports_us[nb_reports++] = t;
+        reports_us[nb_reports++] = t + uniform(80000, 120000);
+        t = reports_us[nb_reports - 1];
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Runs RUN_S at a slave latency.
+ *
+ * @param[in]  latency  The slave latency
+ * @param[in]  reports  Sends the reports of make_reports(), else none
+ * @param[in]  forced   Wakes the BLE up for a report, else waits for a listened event
+ * @param[out] mean_ms  The mean delay of a report
+ * @param[out] p99_ms   The 99th percentile delay of a report
+ *
+ * @return The mean current in uA
+ ****************************************************************************************
+ */
+static double run(int latency, bool reports, bool forced, double *mean_ms, double *p99_ms)
+{
+    const int events = (int)(RUN_S * 1e6 / INTERVAL_US);
+    double charge_uc = sleep_ua * RUN_S, last_us = 0, sum = 0, t;
+    int k, next = 0, first, skipped = 0, count = reports ? nb_reports : 0;
+    bool attend;
+
+    for (k = 1; k <= events; k++) {
+        t = (double)k * INTERVAL_US;
+
+        // the reports that made it in time for this event
+        first = next;
+        while ((next < count) && (reports_us[next] + (forced ? wakeup_us : 0) <= t)) {
+            next++;
+        }
+        attend = (skipped >= latency) || (forced && (next > first));
+
+        if (!attend) {
+            skipped++;
+            next = first;       // the reports wait
+            continue;
+        }
+        for (; first < next; first++) {
+            delay_us[first] = t - reports_us[first];
+            sum += delay_us[first];
+            charge_uc += packet_uc;
+        }
+        charge_uc += event_uc + rx_ma * widening_ppm * 1e-9 * (t - last_us);
+        last_us = t;
+        skipped = 0;
+    }
+
+    *mean_ms = *p99_ms = 0;
+    if (count) {
+        if (next < count) {
+            printf("FAIL %d reports left at latency %d\n", count - next, latency);
+            failures++;
+        }
+        *mean_ms = sum / next / 1000;
+        qsort(delay_us, next, sizeof(delay_us[0]), compare);
+        *p99_ms = delay_us[next * 99 / 100] / 1000;
+        if (delay_us[next - 1] > (forced ? INTERVAL_US + wakeup_us : INTERVAL_US * (latency + 1))) {
+            printf("FAIL a report waited %.1fms at latency %d\n", delay_us[next - 1] / 1000, latency);
+            failures++;
+        }
+    }
+    return charge_uc / RUN_S;
+}
+
+int main(int argc, char **argv)
+{
+    double idle, forced, wait, forced_mean, forced_p99, wait_mean, wait_p99;
+    unsigned i;
+    int k;
+
+    for (k = 1; k + 1 < argc; k += 2) {
+        if (!strcmp(argv[k], "-sleep")) {
+            sleep_ua = atof(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-event")) {
+            event_uc = atof(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-packet")) {
+            packet_uc = atof(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-ppm")) {
+            widening_ppm = atof(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-rx")) {
+            rx_ma = atof(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-wakeup")) {
+            wakeup_us = atof(argv[k + 1]);
+        }
+    }
+
+    make_reports();
+
+    printf("latency  idle   typing, forced wake     typing, wait for anchor\n");
+    printf("         uA     uA    avg ms  p99 ms    uA    avg ms  p99 ms\n");
+    for (i = 0; i < sizeof(latencies) / sizeof(latencies[0]); i++) {
+        idle = run(latencies[i], false, false, &wait_mean, &wait_p99);
+        forced = run(latencies[i], true, true, &forced_mean, &forced_p99);
+        wait = run(latencies[i], true, false, &wait_mean, &wait_p99);
+        printf("%4d   %6.1f %6.1f %6.1f  %6.1f   %6.1f %6.1f  %6.1f\n", latencies[i], idle,
+               forced, forced_mean, forced_p99, wait, wait_mean, wait_p99);
+    }
+
+    if (!failures) {
+        printf("ok\n");
+    }
+    return failures != 0;
+}
@@ -0,0 +1,313 @@
+/**
+ ****************************************************************************************
+ *
+ * @file bond_log_sim.c
+ *
+ * @brief Power loss simulation of the bond log (app_multi_bond/app_bond_log.c), on the host.
+ *
+ * app_bond_log.c runs on a simulated NOR flash: a program can only clear bits and an
+ * erase sets a whole sector to 0xFF. The test starts from a sector at
+ * NV_STORAGE_BASE_ADDR in the old format, applies random writes to the NV layout and
+ * reads the whole layout back after each of them. The retained state of the log is
+ * lost from time to time, as at a power-up.
+ *
+ * Some writes are cut by a power loss after a random number of programmed bytes. An
+ * erase that is cut leaves the sector partly erased. After a cut each byte of the
+ * layout must hold its old or its new value, and the log must keep working.
+ *
+ * The test also checks that the old sector is imported once, then invalidated, and that
+ * a format clears the layout. It prints the programs and the erases of each log sector.
+ *
+ * It also prints the latency of the writes that are not cut: the SPI transfers of the
+ * reads and the programs, at SPI_BYTE_NS a byte, plus PAGE_PROGRAM_US for each page
+ * programmed and SECTOR_ERASE_US for each erase, as the write waits for the flash. The
+ * first write after a power up includes the mount of the log. The times are typical
+ * values of the W25X10/W25X20 datasheets at an 8 MHz SPI clock, not measurements;
+ * -pp and -se override them.
+ *
+ * Build and run from this directory:
+ *   cc -Istub -I../../src/modules/app/src/app_utils/app_multi_bond bond_log_sim.c -o bond_log_sim
+ *   ./bond_log_sim [iterations, 20000 by default] [seed, 1 by default] [-pp <us>] [-se <us>]
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the stand-in of app_multi_bond.h goes first: its guard hides the real one, next to app_bond_log.c
+#include "rwble_config.h"
+#include "stub/app_multi_bond.h"
+#include "app_bond_log.c"
+
+#define LAYOUT_SIZE     (NV_STORAGE_BOND_DATA_ADDR - NV_STORAGE_BASE_ADDR + MAX_BOND_PEER * sizeof(struct bonding_info_))
+#define GAP_START       (0x0C)      // NV_STORAGE_BASE_ADDR + 0x0C..0x0F is not part of the layout
+#define GAP_END         (0x10)
+#define WRITE_MAX       (70)
+#define PAGE_SIZE       (0x100)
+#define SPI_BYTE_NS     (1000)      // 8 bits at 8 MHz
+#define PAGE_PROGRAM_US (800)
+#define SECTOR_ERASE_US (30000)
+#define MAX_ITERATIONS  (1000000)
+
+static uint8_t flash[SPI_FLASH_SIZE];
+static long cut_budget = -1;        // bytes programmed before the power loss, -1 for none
+static int programs;
+static int erases[BOND_LOG_SECTORS];
+
+static long page_program_us = PAGE_PROGRAM_US;
+static long sector_erase_us = SECTOR_ERASE_US;
+static long busy_ns;                // of the current write
+static int write_erases;            // of the current write
+static long latency_us[MAX_ITERATIONS];
+
+/*
+ * SIMULATED FLASH
+ ****************************************************************************************
+ */
+
+void app_spi_flash_wait_power_up(void)
+{
+}
+
+int32_t spi_flash_read_data(uint8_t *rd_data_ptr, uint32_t address, uint32_t size)
+{
+    busy_ns += (4 + size) * SPI_BYTE_NS;        // command, address and data
+    memcpy(rd_data_ptr, &flash[address], size);
+    return size;
+}
+
+int32_t spi_flash_write_data(uint8_t *wr_data_ptr, uint32_t address, uint32_t size)
+{
+    uint32_t i;
+
+    programs++;
+    // the driver programs a page at a time: write enable, command and address, data
+    busy_ns += ((address + size - 1) / PAGE_SIZE - address / PAGE_SIZE + 1) *
+               (page_program_us * 1000 + 5 * SPI_BYTE_NS) + size * SPI_BYTE_NS;
+    for (i = 0; i < size; i++) {
+        if (cut_budget == 0) {
+            return i;
+        }
+        if (cut_budget > 0) {
+            cut_budget--;
+        }
+        flash[address + i] &= wr_data_ptr[i];
+    }
+    return size;
+}
+
+int8_t spi_flash_block_erase(uint32_t address, SPI_erase_module_t spiEraseModule)
+{
+    uint32_t i;
+
+    busy_ns += sector_erase_us * 1000 + 5 * SPI_BYTE_NS;
+    write_erases++;
+    if (cut_budget == 0) {
+        // partly erased
+        for (i = 0; i < SPI_FLASH_SECTOR; i++) {
+            if (rand() & 1) {
+                flash[address + i] = 0xFF;
+            }
+        }
+        return -1;
+    }
+    memset(&flash[address], 0xFF, SPI_FLASH_SECTOR);
+    if ((address >= BOND_LOG_BASE_ADDR) && (address < BOND_LOG_SECTOR_ADDR(BOND_LOG_SECTORS))) {
+        erases[(address - BOND_LOG_BASE_ADDR) / SPI_FLASH_SECTOR]++;
+    }
+    return ERR_OK;
+}
+
+/*
+ * TEST
+ ****************************************************************************************
+ */
+
+static void power_up(void)
+{
+    memset(&bond_log_env, 0, sizeof(bond_log_env));
+}
+
+static bool legacy_valid(void)
+{
+    uint32_t magic;
+
+    memcpy(&magic, &flash[NV_STORAGE_MAGIC_ADDR], sizeof(magic));
+    return magic == NV_STORAGE_MAGIC_NUMBER;
+}
+
+static int compare_long(const void *a, const void *b)
+{
+    const long x = *(const long *)a, y = *(const long *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Prints the latency of the writes that were not cut, those with an erase apart.
+ ****************************************************************************************
+ */
+static void print_latency(int nb, const long *erase_latency, int nb_erase)
+{
+    double sum = 0, erase_sum = 0;
+    int i;
+
+    if (nb == 0) {
+        return;
+    }
+    for (i = 0; i < nb; i++) {
+        sum += latency_us[i];
+    }
+    for (i = 0; i < nb_erase; i++) {
+        erase_sum += erase_latency[i];
+    }
+    qsort(latency_us, nb, sizeof(latency_us[0]), compare_long);
+
+    printf("write latency (us, %ld per page program, %ld per erase): mean %.0f, median %ld, "
+           "99%% %ld, max %ld\n", page_program_us, sector_erase_us, sum / nb, latency_us[nb / 2],
+           latency_us[nb * 99 / 100], latency_us[nb - 1]);
+    printf("%d of %d writes erase a sector, mean %.0f us\n", nb_erase, nb,
+           nb_erase ? erase_sum / nb_erase : 0.0);
+}
+
+static int check_layout(const uint8_t *ref, const uint8_t *data, uint32_t offset, uint32_t len,
+                        int it)
+{
+    uint8_t buf[LAYOUT_SIZE];
+    uint32_t i;
+
+    app_bond_log_read(buf, NV_STORAGE_BASE_ADDR, LAYOUT_SIZE);
+    for (i = 0; i < LAYOUT_SIZE; i++) {
+        if (buf[i] == ref[i]) {
+            continue;
+        }
+        if (data && (i >= offset) && (i < offset + len) && (buf[i] == data[i - offset])) {
+            continue;
+        }
+        printf("iteration %d: byte 0x%02X is 0x%02X instead of 0x%02X\n", it, i, buf[i], ref[i]);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = (argc > 1) ? atoi(argv[1]) : 20000;
+    static long erase_latency[MAX_ITERATIONS];
+    int nb_latency = 0, nb_erase = 0, k;
+    uint8_t ref[LAYOUT_SIZE], buf[LAYOUT_SIZE], data[WRITE_MAX];
+    uint32_t magic = NV_STORAGE_MAGIC_NUMBER;
+    uint32_t offset, len, i;
+    int it, cuts = 0;
+
+    srand((argc > 2) ? atoi(argv[2]) : 1);
+    for (k = 3; k + 1 < argc; k += 2) {
+        if (!strcmp(argv[k], "-pp")) {
+            page_program_us = atol(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-se")) {
+            sector_erase_us = atol(argv[k + 1]);
+        }
+    }
+    if (iterations > MAX_ITERATIONS) {
+        iterations = MAX_ITERATIONS;
+    }
+
+    // the old NV sector, with a status and a byte of a bonding info entry
+    memset(flash, 0xFF, sizeof(flash));
+    memset(&flash[NV_STORAGE_BASE_ADDR], 0, LAYOUT_SIZE);
+    memcpy(&flash[NV_STORAGE_MAGIC_ADDR], &magic, sizeof(magic));
+    flash[NV_STORAGE_STATUS_ADDR] = 5;
+    flash[NV_STORAGE_BOND_DATA_ADDR + 3] = 7;
+    memcpy(ref, &flash[NV_STORAGE_BASE_ADDR], LAYOUT_SIZE);
+    memset(&ref[GAP_START], 0, GAP_END - GAP_START);
+
+    if (check_layout(ref, NULL, 0, 0, -1)) {
+        return 1;
+    }
+    if (legacy_valid()) {
+        printf("the old sector is still valid after the import\n");
+        return 1;
+    }
+
+    for (it = 0; it < iterations; it++) {
+        offset = rand() % LAYOUT_SIZE;
+        len = 1 + rand() % (((LAYOUT_SIZE - offset) < WRITE_MAX) ? (LAYOUT_SIZE - offset) : WRITE_MAX);
+        if ((offset < GAP_END) && (offset + len > GAP_START)) {
+            continue;
+        }
+        for (i = 0; i < len; i++) {
+            data[i] = rand() % 4;
+        }
+
+        if (rand() % 50 == 0) {
+            cuts++;
+            cut_budget = rand() % 80;
+            app_bond_log_write(data, NV_STORAGE_BASE_ADDR + offset, len);
+            cut_budget = -1;
+            power_up();
+
+            // each byte is old or new
+            if (check_layout(ref, data, offset, len, it)) {
+                return 1;
+            }
+            app_bond_log_read(ref, NV_STORAGE_BASE_ADDR, LAYOUT_SIZE);
+            continue;
+        }
+
+        busy_ns = 0;
+        write_erases = 0;
+        app_bond_log_write(data, NV_STORAGE_BASE_ADDR + offset, len);
+        latency_us[nb_latency++] = busy_ns / 1000;
+        if (write_erases) {
+            erase_latency[nb_erase++] = busy_ns / 1000;
+        }
+        memcpy(&ref[offset], data, len);
+        if (rand() % 100 == 0) {
+            power_up();
+        }
+        if (check_layout(ref, NULL, 0, 0, it)) {
+            return 1;
+        }
+        if (legacy_valid()) {
+            printf("iteration %d: the old sector was imported again\n", it);
+            return 1;
+        }
+    }
+
+    printf("%d writes, %d power losses: %d programs, erases", iterations, cuts, programs);
+    for (i = 0; i < BOND_LOG_SECTORS; i++) {
+        printf(" %d", erases[i]);
+    }
+    printf("\n");
+    print_latency(nb_latency, erase_latency, nb_erase);
+
+    // a format clears the layout and the old sector stays invalid
+    memcpy(&flash[NV_STORAGE_MAGIC_ADDR], &magic, sizeof(magic));
+    if (!app_bond_log_format() || legacy_valid()) {
+        printf("format failed\n");
+        return 1;
+    }
+    for (i = 0; i < 2; i++) {
+        app_bond_log_read(buf, NV_STORAGE_BASE_ADDR, LAYOUT_SIZE);
+        for (offset = 0; offset < LAYOUT_SIZE; offset++) {
+            if (buf[offset]) {
+                printf("byte 0x%02X is not cleared by the format\n", offset);
+                return 1;
+            }
+        }
+        power_up();
+    }
+
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,23 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_flash.h
+ *
+ * @brief Host stand-in of app_flash.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_FLASH_H_
+#define APP_FLASH_H_
+
+void app_spi_flash_wait_power_up(void);
+
+#endif // APP_FLASH_H_
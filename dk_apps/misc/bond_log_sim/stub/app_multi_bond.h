@@ -0,0 +1,42 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_multi_bond.h
+ *
+ * @brief Host stand-in of app_multi_bond.h: the NV layout used by the bond log. The bonding info entry has the size of the real one, not its fields.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_MULTI_BOND_H_
+#define APP_MULTI_BOND_H_
+
+#define NV_STORAGE_MAGIC_ADDR           (NV_STORAGE_BASE_ADDR + 0x04)
+#define NV_STORAGE_STATUS_ADDR          (NV_STORAGE_BASE_ADDR + 0x08)
+#define NV_STORAGE_USAGE_ADDR           (NV_STORAGE_BASE_ADDR + 0x09)
+#define NV_STORAGE_BOND_DATA_ADDR       (NV_STORAGE_BASE_ADDR + 0x10)
+
+#define NV_STORAGE_GUARD_NUMBER         (0xA55A5AA5)
+#define NV_STORAGE_MAGIC_NUMBER         (0xDEADBEEF)
+
+struct usage_array_
+{
+    uint8_t pos[MAX_BOND_PEER];
+};
+
+struct bonding_info_
+{
+    int info;
+    int ext_info;
+    uint8_t irk[16];
+    uint8_t env[36];
+};
+
+#endif // APP_MULTI_BOND_H_
@@ -0,0 +1,38 @@
+/**
+ ****************************************************************************************
+ *
+ * @file rwble_config.h
+ *
+ * @brief Host stand-in of the configuration seen by app_bond_log.c: the remote_audio SPI flash layout (hw_config.h, app_flash_config.h).
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef RWBLE_CONFIG_H_
+#define RWBLE_CONFIG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define zero_init
+
+#define HAS_SPI_FLASH_BOND_LOG  1
+#define HAS_SPI_FLASH_ASYNC     0
+
+#define MAX_BOND_PEER           (3)
+
+#define SPI_FLASH_SIZE          0x20000
+#define SPI_FLASH_SECTOR        0x1000
+#define NV_STORAGE_BASE_ADDR    (SPI_FLASH_SIZE-SPI_FLASH_SECTOR)
+#define BOND_LOG_SECTORS        (3)
+#define BOND_LOG_BASE_ADDR      (NV_STORAGE_BASE_ADDR - (BOND_LOG_SECTORS + 1) * SPI_FLASH_SECTOR)
+
+#endif // RWBLE_CONFIG_H_
@@ -0,0 +1,33 @@
+/**
+ ****************************************************************************************
+ *
+ * @file spi_flash.h
+ *
+ * @brief Host stand-in of spi_flash.h: the NOR flash of bond_log_sim.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _SPI_FLASH_H_
+#define _SPI_FLASH_H_
+
+#include <stdint.h>
+
+#define ERR_OK          0
+
+typedef enum {
+    SECTOR_ERASE = 0x20,
+} SPI_erase_module_t;
+
+int32_t spi_flash_read_data(uint8_t *rd_data_ptr, uint32_t address, uint32_t size);
+int32_t spi_flash_write_data(uint8_t *wr_data_ptr, uint32_t address, uint32_t size);
+int8_t spi_flash_block_erase(uint32_t address, SPI_erase_module_t spiEraseModule);
+
+#endif // _SPI_FLASH_H_
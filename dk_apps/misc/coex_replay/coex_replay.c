@@ -0,0 +1,298 @@
+/**
+ ****************************************************************************************
+ *
+ * @file coex_replay.c
+ *
+ * @brief Replay of the WLAN coexistence priority (modules/wlan_coex/wlan_coex.c) of a voice
+ *        stream and key presses, on the host.
+ *
+ * A connection with a 7.5ms interval and 2.5ms events sends up to PKT_PER_EVT packets
+ * of the stream FIFO per event. The voice adds VOICE_PKT_PER_S packets per second to the
+ * FIFO, which drops the packets above FIFO_LEN. Keys are pressed KEYS_PER_S times per
+ * second, at random, and are sent at the next event that takes place.
+ *
+ * The WLAN is busy periodically or for random periods. An event that overlaps a busy
+ * period takes place only when wlan_coex_evt_prio_set() raises the BLE priority, else it
+ * is missed. The criteria of the connection are:
+ *   - none;
+ *   - BLEMPRIO_DATA, every data event;
+ *   - BLEMPRIO_URGENT and BLEMPRIO_MISSED, as set by app_connection_func(). The urgency is
+ *     reported as app_stream_coex_update() and app_asynch_proc() do.
+ *
+ * The replay prints the voice loss, the mean and the 99th percentile of the key latency
+ * and the share of the WLAN busy time taken by the BLE events.
+ *
+ * Build and run from this directory:
+ *   cc -DWLAN_COEX_ENABLED -DWLAN_COEX_BLE_EVENT=6 -DWLAN_COEX_PORT=0 -DWLAN_COEX_PIN=0 \
+ *      -DWLAN_COEX_IRQ=0 -DWLAN_COEX_PRIO_PORT=0 -DWLAN_COEX_PRIO_PIN=1 \
+ *      -Istub -I../../src/modules/wlan_coex -I../../src/modules/app/src/app_project/remote_audio/stream \
+ *      coex_replay.c -lm -o coex_replay
+ *   ./coex_replay
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "lld.h"
+#include "lld_evt.h"
+#include "ke_event.h"
+#include "em_map_ble.h"
+#include "reg_ble_em_et.h"
+#include "reg_ble_em_tx.h"
+#include "reg_ble_em_cs.h"
+#include "gpio.h"
+#include "gapm.h"
+#include "app_stream.h"
+
+// wlan_coex.c declares its GPIO handlers extern, then defines them static: armcc accepts it,
+// gcc does not. The stand-ins above are already included.
+#define static
+#include "wlan_coex.c"
+#undef static
+
+#define DURATION_S      (60.0)
+#define INTERVAL_S      (7.5e-3)
+#define EVENT_S         (2.5e-3)
+#define PKT_PER_EVT     (6)
+#define VOICE_PKT_PER_S (400)
+#define FIFO_LEN        (350)
+#define KEYS_PER_S      (3.0)
+#define MAX_KEYS        (1000)
+#define MAX_BUSY        (20000)
+#define CONHDL          (0)
+
+enum policy
+{
+    POLICY_NONE,
+    POLICY_DATA,
+    POLICY_URGENT,
+};
+
+struct busy
+{
+    double start;
+    double end;
+};
+
+struct lld_evt_env_tag lld_evt_env;
+struct gapm_env_tag gapm_env = {GAP_PERIPHERAL_SLV};
+
+static bool prio_pin;
+static struct busy busy[MAX_BUSY];
+static int nb_busy;
+static double keys[MAX_KEYS], latency[MAX_KEYS];
+
+/*
+ * GPIO
+ ****************************************************************************************
+ */
+
+void GPIO_ConfigurePin(GPIO_PORT port, GPIO_PIN pin, GPIO_PUPD mode, int function, const bool high)
+{
+}
+
+void GPIO_SetActive(GPIO_PORT port, GPIO_PIN pin)
+{
+    if ((port == WLAN_COEX_PRIO_PORT) && (pin == WLAN_COEX_PRIO_PIN)) {
+        prio_pin = true;
+    }
+}
+
+void GPIO_SetInactive(GPIO_PORT port, GPIO_PIN pin)
+{
+    if ((port == WLAN_COEX_PRIO_PORT) && (pin == WLAN_COEX_PRIO_PIN)) {
+        prio_pin = false;
+    }
+}
+
+bool GPIO_GetPinStatus(GPIO_PORT port, GPIO_PIN pin)
+{
+    return (port == WLAN_COEX_PRIO_PORT) && (pin == WLAN_COEX_PRIO_PIN) && prio_pin;
+}
+
+void GPIO_RegisterCallback(IRQn_Type irq, GPIO_handler_function_t callback)
+{
+}
+
+void GPIO_EnableIRQ(GPIO_PORT port, GPIO_PIN pin, IRQn_Type irq, bool low_input, bool release_wait,
+                    uint8_t debounce_ms)
+{
+}
+
+GPIO_IRQ_INPUT_LEVEL GPIO_GetIRQInputLevel(IRQn_Type irq)
+{
+    return GPIO_IRQ_INPUT_LEVEL_HIGH;
+}
+
+void GPIO_SetIRQInputLevel(IRQn_Type irq, GPIO_IRQ_INPUT_LEVEL level)
+{
+}
+
+/*
+ * REPLAY
+ ****************************************************************************************
+ */
+
+static double uniform(void)
+{
+    return rand() / (RAND_MAX + 1.0);
+}
+
+static double exponential(double mean)
+{
+    return -mean * log(1.0 - uniform());
+}
+
+// on/off periods of the WLAN, random if random_periods
+static void wlan_pattern(double on, double off, bool random_periods)
+{
+    double t = 0, d;
+
+    nb_busy = 0;
+    while ((t < DURATION_S) && (nb_busy < MAX_BUSY)) {
+        d = random_periods ? exponential(on) : on;
+        busy[nb_busy].start = t;
+        busy[nb_busy].end = t + d;
+        nb_busy++;
+        t += d + (random_periods ? exponential(off) : off);
+    }
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    const double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void replay(const char *name, enum policy policy)
+{
+    struct lld_evt_tag evt;
+    struct co_buf_tx_node key_buf;
+    double t, busy_time = 0, taken = 0, lat_sum = 0;
+    int fifo = 0, made = 0, lost = 0, missed = 0;
+    int nb_keys = 0, next_key = 0, sent = 0, first = 0, b = 0, n, i;
+    bool wlan;
+
+    for (i = 0; i < nb_busy; i++) {
+        busy_time += ((busy[i].end < DURATION_S) ? busy[i].end : DURATION_S) - busy[i].start;
+    }
+    for (t = exponential(1.0 / KEYS_PER_S); (t < DURATION_S) && (nb_keys < MAX_KEYS); t += exponential(1.0 / KEYS_PER_S)) {
+        keys[nb_keys++] = t;
+    }
+
+    memset(wlan_coex_criteria, 0, sizeof(wlan_coex_criteria));
+    wlan_coex_urgency_reset();
+    if (policy == POLICY_DATA) {
+        wlan_coex_prio_criteria_add(BLEMPRIO_DATA, CONHDL, 0);
+    } else if (policy == POLICY_URGENT) {
+        wlan_coex_prio_criteria_add(BLEMPRIO_URGENT, CONHDL, 0);
+        wlan_coex_prio_criteria_add(BLEMPRIO_MISSED, CONHDL, WLAN_COEX_MISSED_EVENTS);
+    }
+
+    memset(&evt, 0, sizeof(evt));
+    evt.conhdl = CONHDL;
+    memset(&key_buf, 0, sizeof(key_buf));
+
+    for (n = 0; n * INTERVAL_S < DURATION_S; n++) {
+        t = n * INTERVAL_S;
+
+        // the voice, then the keys pressed since the last event
+        fifo += (int)(t * VOICE_PKT_PER_S) - made;
+        made = (int)(t * VOICE_PKT_PER_S);
+        if (fifo > FIFO_LEN) {
+            lost += fifo - FIFO_LEN;
+            fifo = FIFO_LEN;
+        }
+        while ((next_key < nb_keys) && (keys[next_key] <= t)) {
+            next_key++;
+        }
+        // as app_stream_coex_update() and app_asynch_proc()
+        if (fifo >= APP_STREAM_COEX_HIGH_WATER) {
+            wlan_coex_urgency_set(WLAN_COEX_URG_STREAM, true);
+        } else if (fifo <= APP_STREAM_COEX_LOW_WATER) {
+            wlan_coex_urgency_set(WLAN_COEX_URG_STREAM, false);
+        }
+        wlan_coex_urgency_set(WLAN_COEX_URG_KEY, first < next_key);
+
+        // the event starts
+        evt.missed_cnt = missed;
+        evt.tx_rdy.first = (first < next_key) ? &key_buf.hdr : NULL;
+        lld_evt_env.evt_prog.first = &evt.hdr;
+        wlan_coex_lld_evt_start = 1;
+        wlan_coex_lld_evt_schedule();
+
+        while ((b < nb_busy) && (busy[b].end <= t)) {
+            b++;
+        }
+        wlan = false;
+        for (i = b; (i < nb_busy) && (busy[i].start < t + EVENT_S); i++) {
+            wlan = true;
+        }
+
+        if (wlan && !prio_pin) {
+            missed++;
+        } else {
+            if (wlan) {
+                taken += EVENT_S;
+            }
+            missed = 0;
+            for (; first < next_key; first++) {
+                latency[sent++] = t - keys[first];
+                lat_sum += t - keys[first];
+            }
+            fifo = (fifo > PKT_PER_EVT) ? (fifo - PKT_PER_EVT) : 0;
+            evt.tx_rdy.first = NULL;
+            wlan_coex_urgency_set(WLAN_COEX_URG_KEY, false);
+        }
+
+        // the event ends
+        wlan_coex_lld_evt_end();
+    }
+
+    printf("%-16s %-8s %6.1f%%", name, (policy == POLICY_NONE) ? "none" : (policy == POLICY_DATA) ? "DATA" : "urgency",
+           100.0 * lost / made);
+    if (sent) {
+        qsort(latency, sent, sizeof(latency[0]), cmp_double);
+        printf("   %5.1f / %5.1f", 1000 * lat_sum / sent, 1000 * latency[sent * 99 / 100]);
+    } else {
+        printf("    never sent  ");
+    }
+    printf("   %5.1f%%\n", 100 * taken / busy_time);
+}
+
+int main(void)
+{
+    static const struct {
+        const char *name;
+        double on, off;
+        bool random_periods;
+    } patterns[] = {
+        {"10/10ms", 10e-3, 10e-3, false},
+        {"25/5ms", 25e-3, 5e-3, false},
+        {"60/20ms", 60e-3, 20e-3, false},
+        {"random 40/20ms", 40e-3, 20e-3, true},
+    };
+    enum policy policy;
+    unsigned i;
+
+    printf("WLAN busy        policy   voice loss  key avg / p99 ms  WLAN hit\n");
+    for (i = 0; i < sizeof(patterns) / sizeof(patterns[0]); i++) {
+        for (policy = POLICY_NONE; policy <= POLICY_URGENT; policy++) {
+            srand(3);
+            wlan_pattern(patterns[i].on, patterns[i].off, patterns[i].random_periods);
+            replay(patterns[i].name, policy);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,38 @@
+/**
+ ****************************************************************************************
+ *
+ * @file arch.h
+ *
+ * @brief Host stand-in of arch.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef ARCH_H_
+#define ARCH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define zero_init
+
+typedef uint8_t uint8;
+typedef int16_t int16;
+typedef uint32_t uint32;
+
+#define GLOBAL_INT_STOP()
+#define GLOBAL_INT_START()
+
+#define SetBits16(a, f, v)
+#define SetBits32(a, f, v)
+#define SetWord16(a, v)
+
+#endif // ARCH_H_
@@ -0,0 +1,22 @@
+/**
+ ****************************************************************************************
+ *
+ * @file em_map_ble.h
+ *
+ * @brief Host stand-in of em_map_ble.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef EM_MAP_BLE_H_
+#define EM_MAP_BLE_H_
+
+
+#endif // EM_MAP_BLE_H_
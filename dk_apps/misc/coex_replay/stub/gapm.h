@@ -0,0 +1,30 @@
+/**
+ ****************************************************************************************
+ *
+ * @file gapm.h
+ *
+ * @brief Host stand-in of gapm.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef GAPM_H_
+#define GAPM_H_
+
+#define GAP_PERIPHERAL_SLV          (8)
+
+struct gapm_env_tag
+{
+    uint8_t role;
+};
+
+extern struct gapm_env_tag gapm_env;
+
+#endif // GAPM_H_
@@ -0,0 +1,57 @@
+/**
+ ****************************************************************************************
+ *
+ * @file gpio.h
+ *
+ * @brief Host stand-in of gpio.h. The test defines the functions and keeps the level of the BLE priority pin.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef GPIO_H_
+#define GPIO_H_
+
+typedef enum {
+    GPIO_PORT_0 = 0,
+    GPIO_PORT_1 = 1,
+    GPIO_PORT_2 = 2,
+    GPIO_PORT_3 = 3,
+} GPIO_PORT;
+
+typedef int GPIO_PIN;
+
+typedef enum {
+    INPUT = 0,
+    OUTPUT = 0x300,
+} GPIO_PUPD;
+
+typedef enum {
+    GPIO0_IRQn = 5,
+} IRQn_Type;
+
+typedef enum {
+    GPIO_IRQ_INPUT_LEVEL_HIGH = 0,
+    GPIO_IRQ_INPUT_LEVEL_LOW = 1,
+} GPIO_IRQ_INPUT_LEVEL;
+
+typedef void (*GPIO_handler_function_t)(void);
+
+#define PID_GPIO                    (0)
+
+void GPIO_ConfigurePin(GPIO_PORT port, GPIO_PIN pin, GPIO_PUPD mode, int function, const bool high);
+void GPIO_SetActive(GPIO_PORT port, GPIO_PIN pin);
+void GPIO_SetInactive(GPIO_PORT port, GPIO_PIN pin);
+bool GPIO_GetPinStatus(GPIO_PORT port, GPIO_PIN pin);
+void GPIO_RegisterCallback(IRQn_Type irq, GPIO_handler_function_t callback);
+void GPIO_EnableIRQ(GPIO_PORT port, GPIO_PIN pin, IRQn_Type irq, bool low_input, bool release_wait, uint8_t debounce_ms);
+GPIO_IRQ_INPUT_LEVEL GPIO_GetIRQInputLevel(IRQn_Type irq);
+void GPIO_SetIRQInputLevel(IRQn_Type irq, GPIO_IRQ_INPUT_LEVEL level);
+
+#endif // GPIO_H_
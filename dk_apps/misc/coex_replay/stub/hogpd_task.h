@@ -0,0 +1,23 @@
+/**
+ ****************************************************************************************
+ *
+ * @file hogpd_task.h
+ *
+ * @brief Host stand-in of hogpd_task.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef HOGPD_TASK_H_
+#define HOGPD_TASK_H_
+
+struct hogpd_report_info;
+
+#endif // HOGPD_TASK_H_
@@ -0,0 +1,32 @@
+/**
+ ****************************************************************************************
+ *
+ * @file ke_event.h
+ *
+ * @brief Host stand-in of ke_event.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef KE_EVENT_H_
+#define KE_EVENT_H_
+
+enum
+{
+    KE_EVENT_BLE_EVT_START,
+    KE_EVENT_BLE_EVT_END,
+};
+
+static inline uint8_t ke_event_callback_set(uint8_t event_type, void (*p_callback)(void))
+{
+    return 0;
+}
+
+#endif // KE_EVENT_H_
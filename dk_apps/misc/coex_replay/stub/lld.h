@@ -0,0 +1,53 @@
+/**
+ ****************************************************************************************
+ *
+ * @file lld.h
+ *
+ * @brief Host stand-in of lld.h: the lists and the link layer state used by wlan_coex.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef LLD_H_
+#define LLD_H_
+
+#include "arch.h"
+
+#define BLE_CONNECTION_MAX_USER     (1)
+#define LLD_ADV_HDL                 BLE_CONNECTION_MAX_USER
+#define LLD_INITIATING              (2)
+
+struct co_list_hdr
+{
+    struct co_list_hdr *next;
+};
+
+struct co_list
+{
+    struct co_list_hdr *first;
+    struct co_list_hdr *last;
+};
+
+static inline bool co_list_is_empty(const struct co_list *list)
+{
+    return list->first == NULL;
+}
+
+static inline struct co_list_hdr *co_list_pick(const struct co_list *list)
+{
+    return list->first;
+}
+
+static inline uint8_t ble_cntl_get(int elt_idx)
+{
+    return 0;
+}
+
+#endif // LLD_H_
@@ -0,0 +1,63 @@
+/**
+ ****************************************************************************************
+ *
+ * @file lld_evt.h
+ *
+ * @brief Host stand-in of lld_evt.h: the event fields used by wlan_coex.c. The ROM functions of the events do nothing.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef LLD_EVT_H_
+#define LLD_EVT_H_
+
+#include "lld.h"
+
+#define LLD_ADV_RESTART             (1)
+#define LLD_SCN_RESTART             (2)
+#define LLD_EVT_PROG_LATENCY        (4)
+#define BLE_BASETIMECNT_MASK        (0x07FFFFFF)
+
+struct lld_evt_tag
+{
+    struct co_list_hdr hdr;
+    uint32_t time;
+    struct co_list tx_rdy;
+    struct co_list tx_prog;
+    uint16_t conhdl;
+    uint16_t missed_cnt;
+    uint8_t restart_pol;
+};
+
+struct lld_evt_env_tag
+{
+    struct co_list evt_prog;
+};
+
+extern struct lld_evt_env_tag lld_evt_env;
+
+static inline uint32_t lld_evt_time_get(void)
+{
+    return 0;
+}
+
+static inline void lld_evt_schedule(void)
+{
+}
+
+static inline void lld_evt_end(void)
+{
+}
+
+static inline void lld_evt_init_func(bool reset)
+{
+}
+
+#endif // LLD_EVT_H_
@@ -0,0 +1,22 @@
+/**
+ ****************************************************************************************
+ *
+ * @file reg_ble_em_cs.h
+ *
+ * @brief Host stand-in of reg_ble_em_cs.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef REG_BLE_EM_CS_H_
+#define REG_BLE_EM_CS_H_
+
+
+#endif // REG_BLE_EM_CS_H_
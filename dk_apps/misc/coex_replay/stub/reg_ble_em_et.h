@@ -0,0 +1,28 @@
+/**
+ ****************************************************************************************
+ *
+ * @file reg_ble_em_et.h
+ *
+ * @brief Host stand-in of reg_ble_em_et.h: no event of the exchange table is processed.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef REG_BLE_EM_ET_H_
+#define REG_BLE_EM_ET_H_
+
+#define EM_BLE_ET_PROCESSED         (3)
+
+static inline uint8_t ble_etstatus_getf(int elt_idx)
+{
+    return 0;
+}
+
+#endif // REG_BLE_EM_ET_H_
@@ -0,0 +1,35 @@
+/**
+ ****************************************************************************************
+ *
+ * @file reg_ble_em_tx.h
+ *
+ * @brief Host stand-in of reg_ble_em_tx.h: the queued buffers are data, not LLCP.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef REG_BLE_EM_TX_H_
+#define REG_BLE_EM_TX_H_
+
+#define BLE_TXLLID_MASK             ((uint16_t)0x00000003)
+#define BLE_TXLLID_DATA             (2)
+
+struct co_buf_tx_node
+{
+    struct co_list_hdr hdr;
+    uint8_t idx;
+};
+
+static inline uint8_t ble_txllid_getf(int elt_idx)
+{
+    return BLE_TXLLID_DATA;
+}
+
+#endif // REG_BLE_EM_TX_H_
@@ -0,0 +1,525 @@
+/**
+ ****************************************************************************************
+ *
+ * @file conn_params_model.c
+ *
+ * @brief Current and latency model of the connection parameters manager
+ *        (app_multi_bond/app_conn_params.c), on the host.
+ *
+ * The link is stepped in 1.25ms ticks. The remote attends a connection event when it has
+ * reports queued, when a parameter update is in flight, or after the slave latency has run
+ * out. It pays EVENT_UC for each attended event, PACKET_UC for each report, the window
+ * widening (RX_MA for the drift since the last attended event, WIDENING_PPM) and SLEEP_UA
+ * all the time. The host picks the middle of the requested interval range and answers a
+ * request in UPDATE_TICKS. These are estimates for the DA14580, not measurements, and can be
+ * changed on the command line.
+ *
+ * Two outputs:
+ *   - each load on its own, with the preferred_conn_* set for all of them (fixed) and with
+ *     the first set of the load (managed), and the battery life when idle;
+ *   - a day trace of TRACE_S connected (zapping, pointer and voice sessions every 0.5-3min)
+ *     with three policies: fixed, no batching (the set of the load is requested as soon as
+ *     the load changes) and the manager. The trace is run with a host that accepts all the
+ *     sets and with one that applies the iOS rules.
+ * The model fails if a request is sent while another is in flight, within the gap after an
+ * answer, or before time_to_request_param_upd.
+ *
+ * Build and run from this directory:
+ *   cc -Istub -I../../src/modules/app/src/app_utils/app_multi_bond conn_params_model.c -o conn_params_model
+ *   ./conn_params_model [-sleep <uA>] [-event <uC>] [-packet <uC>] [-ppm <ppm>] [-rx <mA>]
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the stand-ins go first: their guards hide the real headers, next to app_conn_params.c
+#include "rwble_config.h"
+#include "stub/app_api.h"
+#include "stub/app_con_fsm.h"
+#include "stub/reg_blecore.h"
+#include "app_conn_params.c"
+
+#define TICK_S              (0.00125)   // the unit of the connection interval
+#define TICKS_PER_KE        (8)         // ke_time() counts 10ms
+#define TICKS_PER_S         (800)
+#define HOST_INTV           (24)        // the host's parameters after the connection: 30ms/0
+#define HOST_LATENCY        (0)
+#define FIRST_REQUEST       (5000)      // con_fsm_params.time_to_request_param_upd, 10ms units
+#define UPDATE_TICKS        (48)        // the host answers a request in 60ms
+#define NB_HOLD             (20)        // no batching: a load lasts 200ms after its activity
+#define BATTERY_UAH         (1000000.0) // 2xAAA
+#define LOAD_S              (600)
+#define TRACE_S             (4 * 3600)
+
+enum policy
+{
+    FIXED,
+    NO_BATCHING,
+    MANAGER,
+};
+
+enum session
+{
+    S_NONE,
+    S_ZAPPING,
+    S_POINTER,
+    S_VOICE,
+};
+
+static double sleep_ua = 1.8;
+static double event_uc = 3.0;
+static double packet_uc = 1.5;
+static double widening_ppm = 550;
+static double rx_ma = 5.0;
+
+static int failures;
+
+// the globals of app_con_fsm.c seen by app_conn_params.c
+bool conn_upd_pending;
+
+static struct
+{
+    enum policy policy;
+    bool ios;                           // the host applies the iOS rules
+    uint32_t tick;
+    int state;                          // of TASK_APP
+    bool timer_on;
+    uint32_t timer_tick;
+    uint32_t answer_tick;
+    struct conn_params_set req;
+    uint16_t not_before;                // ke_time() of the end of the gap, if gap
+    bool gap;
+    uint16_t intv;                      // in use
+    uint16_t latency;
+    uint32_t anchor;                    // the next connection event
+    uint32_t last_attended;
+    int skipped;
+    int queued;                         // reports
+    int nb_load;                        // no batching: the load requested
+    uint32_t nb_last[CONN_LOAD_NB];     // no batching: the tick of the last activity
+    uint8_t nb_held;
+    double charge_uc;
+    int requests;
+    int rejects;
+} sim;
+
+static struct
+{
+    enum session type;
+    uint32_t next;                      // the next key, report or session
+    uint32_t until;                     // the end of the session
+    int keys;                           // key presses and releases left
+    double idle_uc;                     // charge between the sessions
+    uint32_t idle_ticks;
+} trace;
+
+uint32_t ke_time(void)
+{
+    return sim.tick / TICKS_PER_KE;
+}
+
+int ke_state_get(int task)
+{
+    return sim.state;
+}
+
+int app_con_fsm_get_state(void)
+{
+    return CONNECTED_ST;
+}
+
+void app_timer_set(int timer, int task, uint16_t delay)
+{
+    sim.timer_on = true;
+    sim.timer_tick = sim.tick + (delay ? delay * TICKS_PER_KE : 1);
+}
+
+static double uniform(double lo, double hi)
+{
+    return lo + (hi - lo) * (rand() / (RAND_MAX + 1.0));
+}
+
+/**
+ ****************************************************************************************
+ * @brief Checks a set against the rules of the Apple Bluetooth Design Guidelines: a range
+ *        of 15ms at least from 11.25ms up, a latency of 30 at most and no more than 2s
+ *        between the events the device listens to.
+ ****************************************************************************************
+ */
+static bool ios_accepts(const struct conn_params_set *set)
+{
+    return (set->intv_min >= 9) && (set->intv_max >= set->intv_min + 12) && (set->latency <= 30)
+        && (set->intv_max * (set->latency + 1) * 5 <= 2000 * 4);
+}
+
+static void request(const struct conn_params_set *set)
+{
+    const uint16_t now = (uint16_t)ke_time();
+
+    if (sim.state == APP_PARAM_UPD) {
+        printf("FAIL request at %.2fs while another is in flight\n", sim.tick * TICK_S);
+        failures++;
+    }
+    if (sim.gap && ((int16_t)(sim.not_before - now) > 0)) {
+        printf("FAIL request at %.2fs within the gap\n", sim.tick * TICK_S);
+        failures++;
+    }
+    if (sim.tick < FIRST_REQUEST * TICKS_PER_KE) {
+        printf("FAIL request at %.2fs before time_to_request_param_upd\n", sim.tick * TICK_S);
+        failures++;
+    }
+    sim.state = APP_PARAM_UPD;
+    sim.req = *set;
+    sim.answer_tick = sim.tick + UPDATE_TICKS;
+    sim.requests++;
+}
+
+static void answer(void)
+{
+    const uint16_t now = (uint16_t)ke_time();
+
+    sim.state = APP_CONNECTED;
+    if (!sim.ios || ios_accepts(&sim.req)) {
+        sim.intv = (sim.req.intv_min + sim.req.intv_max) / 2;
+        sim.latency = sim.req.latency;
+        if (sim.policy == MANAGER) {
+            sim.not_before = now + CONN_PARAMS_MIN_GAP;
+            sim.gap = true;
+            app_conn_params_accepted();
+        }
+    } else {
+        sim.rejects++;
+        if (sim.policy == MANAGER) {
+            sim.not_before = now + CONN_PARAMS_REJECT_BACKOFF;
+            sim.gap = true;
+            app_conn_params_rejected();
+        }
+    }
+}
+
+// TIMER_EXPIRED_EVT of app_con_fsm.c in CONNECTED_ST
+static void timer_expired(void)
+{
+    struct conn_params_set set;
+
+    if (sim.policy != MANAGER) {
+        app_conn_params_preferred(&set);
+        request(&set);
+    } else if (app_conn_params_next(&set)) {
+        request(&set);
+    }
+    conn_upd_pending = false;
+}
+
+// no batching: requests the set of the most demanding load as soon as it changes
+static void no_batching_step(void)
+{
+    struct conn_params_set set;
+    int load;
+
+    if (conn_upd_pending || (sim.state == APP_PARAM_UPD)) {
+        return;
+    }
+    for (load = CONN_LOAD_NB - 1; load > CONN_LOAD_IDLE; load--) {
+        if ((sim.nb_held & (1 << load)) || (sim.tick - sim.nb_last[load] < NB_HOLD * TICKS_PER_KE)) {
+            break;
+        }
+    }
+    if (load != sim.nb_load) {
+        sim.nb_load = load;
+        conn_params_get(load, 0, &set);
+        request(&set);
+    }
+}
+
+static void activity(enum conn_params_load load)
+{
+    sim.nb_last[load] = sim.tick;
+    app_conn_params_activity(load);
+}
+
+static void hold(enum conn_params_load load, bool on)
+{
+    if (on) {
+        sim.nb_held |= 1 << load;
+    } else {
+        sim.nb_held &= ~(1 << load);
+        sim.nb_last[load] = sim.tick;
+    }
+    app_conn_params_hold(load, on);
+}
+
+// a key press or release, as in app_con_fsm.c
+static void key_event(void)
+{
+    sim.queued++;
+    activity(CONN_LOAD_TYPING);
+}
+
+// a motion report, as in app_motion_sensor.c
+static void motion_report(void)
+{
+    if (!conn_upd_pending) {
+        sim.queued++;
+        activity(CONN_LOAD_MOTION);
+    }
+}
+
+static void voice_packet(void)
+{
+    sim.queued++;
+}
+
+static void step(void)
+{
+    if ((sim.state == APP_PARAM_UPD) && (sim.tick == sim.answer_tick)) {
+        answer();
+    }
+    if (sim.timer_on && (sim.tick >= sim.timer_tick)) {
+        sim.timer_on = false;
+        timer_expired();
+    }
+    if (sim.policy == NO_BATCHING) {
+        no_batching_step();
+    }
+
+    if (sim.tick == sim.anchor) {
+        if (sim.queued || (sim.state == APP_PARAM_UPD) || (sim.skipped >= sim.latency)) {
+            sim.charge_uc += event_uc + sim.queued * packet_uc
+                + rx_ma * widening_ppm * 1e-3 * (sim.tick - sim.last_attended) * TICK_S;
+            sim.last_attended = sim.tick;
+            sim.skipped = 0;
+            sim.queued = 0;
+        } else {
+            sim.skipped++;
+        }
+        sim.anchor += sim.intv;
+    }
+    sim.charge_uc += sleep_ua * TICK_S;
+    sim.tick++;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Starts a connection with the host's parameters.
+ *
+ * @param[in] policy    The policy
+ * @param[in] ios       The host applies the iOS rules
+ * @param[in] first     The first request is sent after time_to_request_param_upd
+ ****************************************************************************************
+ */
+static void connect(enum policy policy, bool ios, bool first)
+{
+    memset(&sim, 0, sizeof(sim));
+    memset(&conn_params_env, 0, sizeof(conn_params_env));
+    con_fsm_params.has_conn_params_manager = (policy == MANAGER);
+    sim.policy = policy;
+    sim.ios = ios;
+    sim.state = APP_CONNECTED;
+    sim.intv = HOST_INTV;
+    sim.latency = HOST_LATENCY;
+
+    app_conn_params_reset();
+    conn_upd_pending = first;
+    if (first) {
+        app_timer_set(APP_CON_FSM_TIMER, TASK_APP, FIRST_REQUEST);
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Runs a load on its own for LOAD_S with a set.
+ *
+ * @param[in] load      The load
+ * @param[in] set       The set in use
+ *
+ * @return The mean current in uA
+ ****************************************************************************************
+ */
+static double load_current(int load, const struct conn_params_set *set)
+{
+    static const uint32_t period[CONN_LOAD_NB] =
+    {
+        0,
+        TICKS_PER_S / 6,        // 3 keys/s, pressed and released
+        TICKS_PER_S / 100,      // 100 reports/s
+        2,                      // 64kbit/s in 20 byte packets
+    };
+    uint32_t end;
+
+    connect(FIXED, false, false);
+    sim.intv = (set->intv_min + set->intv_max) / 2;
+    sim.latency = set->latency;
+
+    for (end = LOAD_S * TICKS_PER_S; sim.tick < end; ) {
+        if (period[load] && ((sim.tick % period[load]) == 0)) {
+            sim.queued++;
+        }
+        step();
+    }
+    return sim.charge_uc / (LOAD_S);
+}
+
+static void print_loads(void)
+{
+    static const char *const names[CONN_LOAD_NB] =
+    {
+        "idle", "typing, 3 keys/s", "motion, 100 reports/s", "voice, 64kbit/s",
+    };
+    struct conn_params_set fixed, managed;
+    double ua_fixed, ua_managed, idle_fixed = 0, idle_managed = 0;
+    int load;
+
+    app_conn_params_preferred(&fixed);
+    printf("load, all day           fixed %d/%d/%d    managed          max key / host->dev\n",
+           fixed.intv_min, fixed.intv_max, fixed.latency);
+    for (load = CONN_LOAD_IDLE; load < CONN_LOAD_NB; load++) {
+        conn_params_get(load, 0, &managed);
+        ua_fixed = load_current(load, &fixed);
+        ua_managed = load_current(load, &managed);
+        if (load == CONN_LOAD_IDLE) {
+            idle_fixed = ua_fixed;
+            idle_managed = ua_managed;
+        }
+        printf("%-22s %7.1fuA   %7.1fuA %d/%d/%-2d   %.1fms / %.1fms\n", names[load],
+               ua_fixed, ua_managed, managed.intv_min, managed.intv_max, managed.latency,
+               managed.intv_max * 1.25, managed.intv_max * 1.25 * (managed.latency + 1));
+    }
+    printf("idle on 2xAAA: %.0f days managed, %.0f days fixed\n\n",
+           BATTERY_UAH / idle_managed / 24, BATTERY_UAH / idle_fixed / 24);
+}
+
+static void trace_step(void)
+{
+    if (trace.type == S_NONE) {
+        if (sim.tick < trace.next) {
+            trace.idle_ticks++;
+            trace.idle_uc -= sim.charge_uc;
+            step();
+            trace.idle_uc += sim.charge_uc;
+            return;
+        }
+        trace.next = sim.tick;
+        switch (rand() % 4) {
+        case 0:
+        case 1:
+            trace.type = S_ZAPPING;
+            trace.keys = 2 * (int)uniform(4, 21);
+            break;
+        case 2:
+            trace.type = S_POINTER;
+            trace.until = sim.tick + (uint32_t)(uniform(5, 30) * TICKS_PER_S);
+            break;
+        default:
+            trace.type = S_VOICE;
+            trace.until = sim.tick + (uint32_t)(uniform(2, 8) * TICKS_PER_S);
+            key_event();
+            hold(CONN_LOAD_VOICE, true);
+            break;
+        }
+    }
+
+    switch (trace.type) {
+    case S_ZAPPING:
+        if (sim.tick == trace.next) {
+            key_event();
+            if (--trace.keys == 0) {
+                trace.type = S_NONE;
+            } else if (trace.keys & 1) {
+                trace.next += TICKS_PER_S / 10;                           // released
+            } else {
+                trace.next += (uint32_t)(uniform(0.3, 1.0) * TICKS_PER_S);  // the next key
+            }
+        }
+        break;
+    case S_POINTER:
+        if (sim.tick >= trace.until) {
+            trace.type = S_NONE;
+        } else if (sim.tick == trace.next) {
+            motion_report();
+            trace.next += TICKS_PER_S / 100;
+        }
+        break;
+    case S_VOICE:
+        if (sim.tick >= trace.until) {
+            hold(CONN_LOAD_VOICE, false);
+            key_event();
+            trace.type = S_NONE;
+        } else if (sim.tick == trace.next) {
+            voice_packet();
+            trace.next += 2;
+        }
+        break;
+    default:
+        break;
+    }
+    if (trace.type == S_NONE) {
+        trace.next = sim.tick + (uint32_t)(uniform(30, 180) * TICKS_PER_S);
+    }
+    step();
+}
+
+static void run_trace(const char *name, enum policy policy, bool ios)
+{
+    uint32_t end;
+
+    srand(1);
+    memset(&trace, 0, sizeof(trace));
+    trace.next = 60 * TICKS_PER_S;
+    connect(policy, ios, true);
+
+    for (end = TRACE_S * TICKS_PER_S; sim.tick < end; ) {
+        trace_step();
+    }
+    printf("  %-18s %5d   %6.1f  %6.1f", name, sim.requests, sim.charge_uc / TRACE_S,
+           trace.idle_uc / (trace.idle_ticks * TICK_S));
+    if (sim.rejects) {
+        printf("   %d rejected, ends at %.2fms/%d", sim.rejects, sim.intv * 1.25, sim.latency);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    int k;
+
+    for (k = 1; k + 1 < argc; k += 2) {
+        if (!strcmp(argv[k], "-sleep")) {
+            sleep_ua = atof(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-event")) {
+            event_uc = atof(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-packet")) {
+            packet_uc = atof(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-ppm")) {
+            widening_ppm = atof(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-rx")) {
+            rx_ma = atof(argv[k + 1]);
+        }
+    }
+
+    print_loads();
+
+    printf("day trace, %dh connected  requests  avg uA  idle uA\n", TRACE_S / 3600);
+    printf("accepting host\n");
+    run_trace("fixed", FIXED, false);
+    run_trace("no batching", NO_BATCHING, false);
+    run_trace("manager", MANAGER, false);
+    printf("host with iOS rules\n");
+    run_trace("fixed", FIXED, true);
+    run_trace("manager", MANAGER, true);
+
+    if (!failures) {
+        printf("ok\n");
+    }
+    return failures != 0;
+}
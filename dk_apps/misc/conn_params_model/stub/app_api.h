@@ -0,0 +1,35 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_api.h
+ *
+ * @brief Host stand-in of app_api.h: the timer and the states of TASK_APP used by
+ *        app_conn_params.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_API_H_
+#define APP_API_H_
+
+#define TASK_APP                (0)
+#define APP_CON_FSM_TIMER       (1)
+
+enum
+{
+    APP_PARAM_UPD,
+    APP_CONNECTED,
+};
+
+int ke_state_get(int task);
+
+void app_timer_set(int timer, int task, uint16_t delay);
+
+#endif // APP_API_H_
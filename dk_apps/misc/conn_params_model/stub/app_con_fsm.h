@@ -0,0 +1,48 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_con_fsm.h
+ *
+ * @brief Host stand-in of app_con_fsm.h: the parameters and the state of the
+ *        connection FSM used by app_conn_params.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_CON_FSM_H_
+#define APP_CON_FSM_H_
+
+typedef struct {
+    bool has_conn_params_manager;
+    uint16_t preferred_conn_interval_min;
+    uint16_t preferred_conn_interval_max;
+    uint16_t preferred_conn_latency;
+    uint16_t preferred_conn_timeout;
+} con_fsm_params_t;
+
+// as in keil_projects/hid/remote_audio/config/app_con_fsm_config.h, not const: the model
+// turns the manager on and off
+static con_fsm_params_t con_fsm_params = {
+    .has_conn_params_manager        = true,
+    .preferred_conn_interval_min    = 6,
+    .preferred_conn_interval_max    = 6,
+    .preferred_conn_latency         = 31,
+    .preferred_conn_timeout         = 200,
+};
+
+enum
+{
+    IDLE_ST,
+    CONNECTED_ST,
+};
+
+int app_con_fsm_get_state(void);
+
+#endif // APP_CON_FSM_H_
@@ -0,0 +1,23 @@
+/**
+ ****************************************************************************************
+ *
+ * @file reg_blecore.h
+ *
+ * @brief Host stand-in of reg_blecore.h, for app_conn_params.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _REG_BLECORE_H_
+#define _REG_BLECORE_H_
+
+#define BLE_GROSSTARGET_MASK    ((uint32_t)0x0000FFFF)
+
+#endif // _REG_BLECORE_H_
@@ -0,0 +1,288 @@
+/**
+ ****************************************************************************************
+ *
+ * @file energy_ledger_test.c
+ *
+ * @brief Unit test of the energy ledger (remote_audio/system/app_energy.c), on the host.
+ *
+ * The test drives the hooks of the main loop (sample, sleep, wakeup, ble_slept, awake)
+ * with a simulated BLE timer and NVIC pending bits, then checks the time, the count and
+ * the charge of each bucket.
+ *
+ * Build and run from this directory:
+ *   cc -DHAS_ENERGY_LEDGER=1 -Istub -I../../src/modules/app/src/app_project/remote_audio/system \
+ *      energy_ledger_test.c ../../src/modules/app/src/app_project/remote_audio/system/app_energy.c \
+ *      -o energy_ledger_test
+ *   ./energy_ledger_test
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "app_energy.h"
+#include "reg_blecore.h"
+
+#define CHECK(c)                                                                \
+    do {                                                                        \
+        if (!(c)) {                                                             \
+            printf("FAIL line %d: %s\n", __LINE__, #c);                         \
+            failures++;                                                         \
+        }                                                                       \
+    } while (0)
+
+NVIC_Type stub_nvic;
+SCB_Type stub_scb;
+int stub_ble_running = 1;
+uint32_t stub_twirq;
+
+static uint64_t now_us;                 // the true time
+static int failures;
+
+/*
+ * SIMULATED BLE TIMER
+ ****************************************************************************************
+ */
+
+uint32_t lld_sleep_lpcycles_2_us_sel_func(uint32_t lpcycles)
+{
+    return (uint32_t)((uint64_t)lpcycles * 1000000 / 32768);
+}
+
+uint32_t lld_evt_time_get(void)
+{
+    return (uint32_t)(now_us / 625) & BLE_BASETIMECNT_MASK;
+}
+
+uint32_t ble_finetimecnt_get(void)
+{
+    return 624 - (uint32_t)(now_us % 625);
+}
+
+/*
+ * TEST
+ ****************************************************************************************
+ */
+
+static struct app_energy_entry entry(int bucket)
+{
+    struct app_energy_entry e;
+
+    app_energy_get(bucket, &e);
+    return e;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Runs awake_us with the BLE awake, then a BLE sleep of sleep_us. The CPU wakes
+ *        up twirq_us before the BLE core, with the interrupts of ispr pending.
+ ****************************************************************************************
+ */
+static void cycle(uint32_t awake_us, uint32_t sleep_us, sleep_mode_t mode, uint32_t ispr,
+                  uint32_t twirq_us)
+{
+    stub_ble_running = 1;
+    now_us += awake_us;
+    app_energy_sample();
+    app_energy_sleep(mode);
+    stub_ble_running = 0;
+    now_us += sleep_us - twirq_us;
+    stub_nvic.ISPR[0] = ispr;
+    app_energy_wakeup();
+    stub_nvic.ISPR[0] = 0;
+    now_us += twirq_us;
+    app_energy_ble_slept(sleep_us);
+    stub_ble_running = 1;
+}
+
+// 2ms awake for the BLE and 98ms of extended sleep, 1000 times: the split is exact
+static void test_split(void)
+{
+    int i;
+
+    app_energy_reset();
+    now_us = 1000;
+    for (i = 0; i < 1000; i++) {
+        cycle(2000, 98000, mode_ext_sleep, 1 << 4, 0);
+    }
+    now_us += 2000;
+    app_energy_sample();
+
+    CHECK(entry(ENERGY_EXT_SLEEP).time_ms == 98000);
+    CHECK(entry(ENERGY_BLE).time_ms == 2000);
+    CHECK(entry(ENERGY_EXT_SLEEP).count == 1000);
+    CHECK(entry(ENERGY_BLE).count == 1000);
+}
+
+// the TWIRQ wake-ahead of a deep sleep is awake time, charged to the wake reason
+static void test_twirq(void)
+{
+    uint32_t ahead, awake;
+    int i;
+
+    stub_twirq = 33;
+    ahead = lld_sleep_lpcycles_2_us_sel_func(stub_twirq);
+    app_energy_reset();
+    app_energy_sample();
+    for (i = 0; i < 100; i++) {
+        cycle(3000, 50000, mode_deep_sleep, 1 << KEYBRD_IRQn, ahead);
+    }
+    now_us += 3000;
+    app_energy_sample();
+    stub_twirq = 0;
+
+    // the first interval has no wake reason: it goes to the BLE
+    awake = (100 * (3000 + ahead) + 3000) / 1000;
+    CHECK(entry(ENERGY_DEEP_SLEEP).time_ms == 100 * (50000 - ahead) / 1000);
+    CHECK(entry(ENERGY_BLE).time_ms == 3);
+    CHECK(entry(ENERGY_KBD).time_ms + entry(ENERGY_BLE).time_ms + 1 >= awake);
+    CHECK(entry(ENERGY_KBD).time_ms + entry(ENERGY_BLE).time_ms <= awake);
+}
+
+// audio ranks above the keyboard and the UART, and the busy flags count as reasons
+static void test_priority(void)
+{
+    app_energy_reset();
+    app_energy_sample();
+    cycle(1000, 10000, mode_ext_sleep, (1 << KEYBRD_IRQn) | (1 << UART_IRQn) | (1 << SWTIM_IRQn), 0);
+    now_us += 1000;
+    app_energy_sample();
+
+    CHECK(entry(ENERGY_AUDIO).time_ms == 1);
+    CHECK(entry(ENERGY_KBD).time_ms == 0);
+    CHECK(entry(ENERGY_KBD).count == 1);
+    CHECK(entry(ENERGY_UART).count == 1);
+    CHECK(entry(ENERGY_AUDIO).count == 1);
+
+    now_us += 5000;
+    app_energy_busy(ENERGY_I2C);
+    app_energy_sample();
+    CHECK(entry(ENERGY_I2C).time_ms == 5);
+}
+
+// the SysTick periods of key scanning while the BLE sleeps come out of the sleep
+static void test_scan_during_sleep(void)
+{
+    int i;
+
+    app_energy_reset();
+    app_energy_sample();
+    now_us += 1000;
+    app_energy_sample();
+    app_energy_sleep(mode_ext_sleep);
+    stub_ble_running = 0;
+    now_us += 20000;
+    stub_nvic.ISPR[0] = 1 << KEYBRD_IRQn;
+    app_energy_wakeup();
+    stub_nvic.ISPR[0] = 0;
+    for (i = 0; i < 30; i++) {
+        now_us += 1000;
+        app_energy_awake(1000);
+    }
+    app_energy_sleep(mode_ext_sleep);
+    now_us += 50000;
+    app_energy_wakeup();
+    app_energy_ble_slept(100000);
+    stub_ble_running = 1;
+    now_us += 2000;
+    app_energy_sample();
+
+    // 100ms of BLE sleep less 30ms of scanning; the scanning and the time awake after it go to the keyboard
+    CHECK(entry(ENERGY_EXT_SLEEP).time_ms == 70);
+    CHECK(entry(ENERGY_KBD).time_ms == 32);
+    CHECK(entry(ENERGY_EXT_SLEEP).count == 2);
+}
+
+// a CPU that only idles while the BLE sleeps is awake
+static void test_idle(void)
+{
+    app_energy_reset();
+    app_energy_sample();
+    app_energy_sleep(mode_idle);
+    stub_ble_running = 0;
+    now_us += 10000;
+    app_energy_ble_slept(10000);
+    stub_ble_running = 1;
+    app_energy_sample();
+
+    CHECK(entry(ENERGY_EXT_SLEEP).time_ms == 0);
+    CHECK(entry(ENERGY_BLE).time_ms == 10);
+}
+
+// the slot counter wraps, a gap of more than 1h is dropped
+static void test_wrap(void)
+{
+    app_energy_reset();
+    now_us = (uint64_t)(BLE_BASETIMECNT_MASK - 10) * 625 + 300;
+    app_energy_sample();
+    now_us += 20 * 625 + 100;
+    app_energy_sample();
+    CHECK(entry(ENERGY_BLE).time_ms == 12);
+
+    now_us += 2ULL * 3600 * 1000000;
+    app_energy_sample();
+    CHECK(entry(ENERGY_BLE).time_ms == 12);
+}
+
+// a sleep longer than the sample interval does not make the awake time negative
+static void test_clamp(void)
+{
+    app_energy_reset();
+    app_energy_sample();
+    app_energy_sleep(mode_ext_sleep);
+    stub_ble_running = 0;
+    now_us += 10000;
+    app_energy_ble_slept(10500);
+    stub_ble_running = 1;
+    app_energy_sample();
+
+    CHECK(entry(ENERGY_BLE).time_ms == 0);
+}
+
+// 1h of extended sleep at 1400nA, 10s of BLE at 3.5mA, 30 days of audio at 4.5mA
+static void test_charge(void)
+{
+    int i;
+
+    app_energy_reset();
+    app_energy_sample();
+    for (i = 0; i < 36; i++) {
+        cycle(0, 100000000, mode_ext_sleep, 0, 0);
+    }
+    now_us += 10000000;
+    app_energy_sample();
+    CHECK(entry(ENERGY_EXT_SLEEP).charge_nah == 1400);
+    CHECK(entry(ENERGY_BLE).charge_nah == 9722);
+
+    app_energy_reset();
+    app_energy_sample();
+    for (i = 0; i < 30 * 48; i++) {
+        now_us += 1800000000ULL;
+        app_energy_busy(ENERGY_AUDIO);
+        app_energy_sample();
+    }
+    CHECK(entry(ENERGY_AUDIO).charge_nah >= 3239999000u);
+    CHECK(entry(ENERGY_AUDIO).charge_nah <= 3240000000u);
+}
+
+int main(void)
+{
+    test_split();
+    test_twirq();
+    test_priority();
+    test_scan_during_sleep();
+    test_idle();
+    test_wrap();
+    test_clamp();
+    test_charge();
+
+    printf(failures ? "%d failed\n" : "ok\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,78 @@
+/**
+ ****************************************************************************************
+ *
+ * @file arch.h
+ *
+ * @brief Host stand-in of arch.h for app_energy.c: the sleep modes, the NVIC pending bits and the registers read by the ledger, driven by energy_ledger_test.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _ARCH_H_
+#define _ARCH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define zero_init
+
+typedef enum {
+    mode_active = 0,
+    mode_idle,
+    mode_ext_sleep,
+    mode_deep_sleep,
+    mode_sleeping,
+} sleep_mode_t;
+
+enum {
+    SWTIM_IRQn          = 8,
+    WKUP_QUADEC_IRQn    = 9,
+    UART_IRQn           = 12,
+    UART2_IRQn          = 13,
+    I2C_IRQn            = 14,
+    SPI_IRQn            = 15,
+    KEYBRD_IRQn         = 17,
+    GPIO3_IRQn          = 22,
+};
+
+typedef struct {
+    uint32_t ISPR[1];
+} NVIC_Type;
+
+typedef struct {
+    uint32_t ICSR;
+} SCB_Type;
+
+extern NVIC_Type stub_nvic;
+extern SCB_Type stub_scb;
+extern int stub_ble_running;            // the BLE core is clocked and awake
+extern uint32_t stub_twirq;             // TWIRQ_SET, in low power cycles
+
+#define NVIC                    (&stub_nvic)
+#define SCB                     (&stub_scb)
+#define SCB_ICSR_PENDSTSET_Msk  (1UL << 26)
+
+// GetBits16(CLK_RADIO_REG, BLE_ENABLE), GetBits32(BLE_DEEPSLCNTL_REG, DEEP_SLEEP_STAT)
+// and GetBits32(BLE_ENBPRESET_REG, TWIRQ_SET) are the only registers read
+#define CLK_RADIO_REG           0
+#define BLE_ENABLE              0
+#define BLE_DEEPSLCNTL_REG      1
+#define DEEP_SLEEP_STAT         1
+#define BLE_ENBPRESET_REG       2
+#define TWIRQ_SET               2
+#define GetBits16(r, f)         (stub_ble_running ? 1 : 0)
+#define GetBits32(r, f)         (((r) == BLE_ENBPRESET_REG) ? stub_twirq : (stub_ble_running ? 0 : 1))
+
+#define GLOBAL_INT_STOP()
+#define GLOBAL_INT_START()
+
+uint32_t lld_sleep_lpcycles_2_us_sel_func(uint32_t lpcycles);
+
+#endif // _ARCH_H_
@@ -0,0 +1,25 @@
+/**
+ ****************************************************************************************
+ *
+ * @file lld_evt.h
+ *
+ * @brief Host stand-in of lld_evt.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef LLD_EVT_H_
+#define LLD_EVT_H_
+
+#include <stdint.h>
+
+uint32_t lld_evt_time_get(void);
+
+#endif // LLD_EVT_H_
@@ -0,0 +1,61 @@
+/**
+ ****************************************************************************************
+ *
+ * @file i2c_busy_blocking.c
+ *
+ * @brief The blocking I2C drivers (i2c_eeprom.c without HAS_I2C_ASYNC, i2c_bmi055.c) for
+ *        i2c_busy_model.c. The EEPROM functions are renamed blk_*, to link with the
+ *        interrupt driven ones.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#define HAS_I2C_ASYNC                   0
+
+#define i2c_eeprom_init                 blk_eeprom_init
+#define i2c_eeprom_release              blk_eeprom_release
+#define i2c_wait_until_eeprom_ready     blk_wait_until_eeprom_ready
+#define i2c_send_address                blk_send_address
+#define i2c_eeprom_read_byte            blk_eeprom_read_byte
+#define i2c_eeprom_read_data            blk_eeprom_read_data
+#define i2c_eeprom_write_byte           blk_eeprom_write_byte
+#define i2c_eeprom_write_page           blk_eeprom_write_page
+#define i2c_eeprom_write_data           blk_eeprom_write_data
+
+#include "i2c_eeprom.c"
+
+// both drivers define them
+#undef SEND_I2C_COMMAND
+#undef WAIT_WHILE_I2C_FIFO_IS_FULL
+#undef WAIT_UNTIL_I2C_FIFO_IS_EMPTY
+#undef WAIT_UNTIL_NO_MASTER_ACTIVITY
+#undef WAIT_FOR_RECEIVED_BYTE
+
+#include "i2c_bmi055.c"
+
+/**
+ ****************************************************************************************
+ * @brief The burst read of app_motion_sensor.c without HAS_I2C_ASYNC.
+ *
+ * @param[in] temp      Reads the temperature too
+ ****************************************************************************************
+ */
+void blk_motion_burst(bool temp)
+{
+    uint8_t data[BMI055_FIFO_MAX_BURST * BMI055_FIFO_FRAME_SIZE];
+
+    i2c_bmi055_init(0x69, I2C_FAST, I2C_7BIT_ADDR);
+    i2c_bmi055_read_fifo(data, BMI055_FIFO_MAX_BURST);
+    i2c_bmi055_init(0x19, I2C_FAST, I2C_7BIT_ADDR);
+    i2c_bmi055_read_fifo(data, BMI055_FIFO_MAX_BURST);
+    if (temp) {
+        i2c_bmi055_read_byte(BMI055_ACCD_TEMP);
+    }
+}
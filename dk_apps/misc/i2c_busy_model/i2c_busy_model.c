@@ -0,0 +1,744 @@
+/**
+ ****************************************************************************************
+ *
+ * @file i2c_busy_model.c
+ *
+ * @brief Compares the CPU time taken by the blocking I2C drivers (i2c_eeprom.c and
+ *        i2c_bmi055.c without HAS_I2C_ASYNC) with the interrupt driven ones (i2c_async.c
+ *        and the jobs of i2c_eeprom.c), on the host.
+ *
+ * The real drivers run against a model of the I2C controller of the DA14580: Tx and Rx
+ * FIFOs of 32 entries, a STOP when the Tx FIFO empties, a RESTART when the direction
+ * changes, TX_ABRT on a NACK of the address (the Tx FIFO is flushed while it is set) and
+ * STOP_DET, at 400kHz (10 bit times for a START and the address, 9 per byte). On the bus
+ * are:
+ *   - a 24LC64 EEPROM at 0x50, which does not acknowledge its address during the write
+ *     cycle of EEPROM_WRITE_US after a page write;
+ *   - the gyro (0x69) and the accelerometer (0x19) of a BMI055, with MOTION_FRAMES frames
+ *     in their FIFOs.
+ * No device answers at 0x57, the missing EEPROM.
+ *
+ * Each register access takes 4 cycles of the 16MHz CPU and every entry in I2C_Handler 120
+ * more (entry, exit and the code of the handler and of the callbacks). Both are estimates,
+ * not measurements; -reg and -isr change them. The blocking drivers spin for
+ * the whole transfer, so their CPU time is the elapsed time. The CPU time of the
+ * interrupt driven ones is the time spent outside WFI.
+ *
+ * The transfers:
+ *   - a motion burst of app_motion_sensor.c: FIFO status and frames of the gyro, then of
+ *     the accelerometer, then the temperature, with the chain of app_motion_i2c_cb();
+ *   - a write of EEPROM_BYTES (2 pages) followed by a read of them, as a bond is stored
+ *     and read back by app_multi_bond.c. The read waits for the write cycle of the last
+ *     page;
+ *   - the ready poll of the missing EEPROM, which must end with I2C_EEPROM_ERR_NOT_READY.
+ *
+ * Build and run from this directory:
+ *   cc -Istub -I../../src/plf/refip/src/driver/i2c_async -I../../src/plf/refip/src/driver/i2c_eeprom \
+ *      -I../../src/plf/refip/src/driver/i2c_BMI055 i2c_busy_model.c i2c_busy_blocking.c -o i2c_busy_model
+ *   ./i2c_busy_model [-reg <cycles>] [-isr <cycles>]
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HAS_I2C_ASYNC           1
+
+#include "i2c_async.c"
+#include "i2c_eeprom.c"
+#include "i2c_bmi055.h"
+
+#define CPU_MHZ                 (16)
+#define FIFO_DEPTH              (32)
+#define EEPROM_WRITE_US         (5000)
+#define EEPROM_ADDRESS          (0x50)
+#define EEPROM_MISSING          (0x57)
+#define EEPROM_BYTES            (64)
+#define EEPROM_START            (0x100)
+#define MOTION_FRAMES           (BMI055_FIFO_MAX_BURST)
+#define MOTION_BURSTS           (100)
+#define MOTION_TEMP_INTERVAL    (4)         // one burst in 4 reads the temperature
+#define CONN_INTERVAL_US        (7500)
+
+#define I2C_CMD_READ            (0x0100)
+
+static int reg_cycles = 4;
+static int isr_cycles = 120;
+
+// the blocking drivers, in i2c_busy_blocking.c
+void blk_eeprom_init(uint16_t dev_address, uint8_t speed, uint8_t address_mode, uint8_t address_size);
+void blk_eeprom_release(void);
+int8_t blk_wait_until_eeprom_ready(void);
+uint32_t blk_eeprom_read_data(uint8_t *rd_data_ptr, uint32_t address, uint32_t size);
+uint32_t blk_eeprom_write_data(uint8_t *wr_data_ptr, uint32_t address, uint32_t size);
+void blk_motion_burst(bool temp);
+
+/*
+ * CPU
+ ****************************************************************************************
+ */
+
+int sim_int_off;
+bool sim_primask;
+
+static uint64_t now;                        // cycles
+static uint64_t cpu;                        // cycles with the CPU running
+static unsigned isrs;
+static bool in_isr;
+static bool nvic_on;
+
+/*
+ * DEVICES
+ ****************************************************************************************
+ */
+
+struct device
+{
+    bool (*address)(bool read);             // returns the ACK
+    void (*write)(uint8_t byte);
+    uint8_t (*read)(void);
+    void (*stop)(void);
+};
+
+static struct
+{
+    uint8_t mem[I2C_EEPROM_SIZE];
+    uint8_t page[I2C_EEPROM_PAGE];
+    uint16_t pointer;
+    int addr_bytes;                         // of the memory address received
+    int wr_bytes;                           // of data received
+    uint64_t busy_until;
+} ee;
+
+static bool ee_address(bool read)
+{
+    if (now < ee.busy_until) {
+        return false;
+    }
+    if (!read) {
+        ee.addr_bytes = 0;
+        ee.wr_bytes = 0;
+    }
+    return true;
+}
+
+static void ee_write(uint8_t byte)
+{
+    if (ee.addr_bytes < 2) {
+        ee.pointer = ((ee.pointer << 8) | byte) & (I2C_EEPROM_SIZE - 1);
+        ee.addr_bytes++;
+        return;
+    }
+    if (ee.wr_bytes == 0) {
+        memcpy(ee.page, &ee.mem[ee.pointer & ~(I2C_EEPROM_PAGE - 1)], I2C_EEPROM_PAGE);
+    }
+    // the address rolls over within the page
+    ee.page[(ee.pointer + ee.wr_bytes++) % I2C_EEPROM_PAGE] = byte;
+}
+
+static uint8_t ee_read(void)
+{
+    uint8_t byte = ee.mem[ee.pointer];
+
+    ee.pointer = (ee.pointer + 1) & (I2C_EEPROM_SIZE - 1);
+    return byte;
+}
+
+static void ee_stop(void)
+{
+    if (ee.wr_bytes) {
+        memcpy(&ee.mem[ee.pointer & ~(I2C_EEPROM_PAGE - 1)], ee.page, I2C_EEPROM_PAGE);
+        ee.wr_bytes = 0;
+        ee.busy_until = now + EEPROM_WRITE_US * CPU_MHZ;
+    }
+}
+
+static const struct device eeprom = {ee_address, ee_write, ee_read, ee_stop};
+
+static struct
+{
+    uint8_t pointer;
+    bool pointer_set;
+} bmi[2];                                   // gyro, accelerometer
+
+static int bmi_sel;
+
+static bool bmi_address(bool read)
+{
+    if (!read) {
+        bmi[bmi_sel].pointer_set = false;
+    }
+    return true;
+}
+
+static void bmi_write(uint8_t byte)
+{
+    if (!bmi[bmi_sel].pointer_set) {
+        bmi[bmi_sel].pointer = byte;
+        bmi[bmi_sel].pointer_set = true;
+    } else {
+        bmi[bmi_sel].pointer++;             // the register is written
+    }
+}
+
+static uint8_t bmi_read(void)
+{
+    const uint8_t reg = bmi[bmi_sel].pointer;
+
+    if (reg == BMI055_FIFO_DATA) {
+        return (uint8_t)rand();             // FIFO_DATA does not auto-increment
+    }
+    bmi[bmi_sel].pointer++;
+    return (reg == BMI055_FIFO_STATUS) ? MOTION_FRAMES : reg;
+}
+
+static void bmi_stop(void)
+{
+}
+
+static const struct device bmi055 = {bmi_address, bmi_write, bmi_read, bmi_stop};
+
+static const struct device *device_at(uint16_t tar)
+{
+    switch (tar & 0x7F) {
+    case EEPROM_ADDRESS:
+        return &eeprom;
+    case 0x69:
+        bmi_sel = 0;
+        return &bmi055;
+    case 0x19:
+        bmi_sel = 1;
+        return &bmi055;
+    }
+    return NULL;
+}
+
+/*
+ * I2C CONTROLLER
+ ****************************************************************************************
+ */
+
+enum bus_action
+{
+    BUS_IDLE,
+    BUS_ADDRESS,                            // START or RESTART, and the address
+    BUS_WRITE,
+    BUS_READ,
+    BUS_STOP,
+};
+
+static struct
+{
+    uint16_t con, tar, mask, rx_tl, tx_tl, enable, clk;
+    uint16_t tx[FIFO_DEPTH];
+    int tx_rd, tx_n;
+    uint8_t rx[FIFO_DEPTH];
+    int rx_rd, rx_n;
+    bool abrt, stop_det;
+    uint16_t abrt_source;
+    bool started, reading, aborting;
+    enum bus_action action;
+    uint16_t cmd;                           // of BUS_WRITE, or the direction of BUS_ADDRESS
+    uint64_t end;                           // of the action
+    uint64_t free;                          // end of the last action
+} i2c;
+
+static int bit_cycles(void)
+{
+    // 100kHz or 400kHz
+    return CPU_MHZ * ((((i2c.con & I2C_SPEED) >> 1) == I2C_STANDARD) ? 10 : 25) / 10;
+}
+
+static void tx_flush(void)
+{
+    i2c.tx_n = 0;
+}
+
+static uint16_t tx_pop(void)
+{
+    uint16_t cmd = i2c.tx[i2c.tx_rd];
+
+    i2c.tx_rd = (i2c.tx_rd + 1) % FIFO_DEPTH;
+    i2c.tx_n--;
+    return cmd;
+}
+
+static void bus_next(uint64_t start)
+{
+    int bits;
+
+    i2c.action = BUS_IDLE;
+    if (!(i2c.enable & 1) || !(i2c.clk & I2C_ENABLE)) {
+        return;
+    }
+    if (i2c.aborting || (i2c.started && (i2c.tx_n == 0))) {
+        i2c.action = BUS_STOP;
+        bits = 2;
+    } else if (i2c.tx_n == 0) {
+        return;
+    } else if (!i2c.started || (((i2c.tx[i2c.tx_rd] & I2C_CMD_READ) != 0) != i2c.reading)) {
+        i2c.action = BUS_ADDRESS;
+        i2c.cmd = i2c.tx[i2c.tx_rd] & I2C_CMD_READ;
+        bits = 10;
+    } else if (i2c.reading && (i2c.rx_n == FIFO_DEPTH)) {
+        return;                             // SCL is held until the Rx FIFO is read
+    } else {
+        // the command leaves the Tx FIFO when the byte starts
+        i2c.cmd = tx_pop();
+        i2c.action = i2c.reading ? BUS_READ : BUS_WRITE;
+        bits = 9;
+    }
+    i2c.end = start + bits * bit_cycles();
+}
+
+static void bus_done(void)
+{
+    const struct device *dev = device_at(i2c.tar);
+
+    switch (i2c.action) {
+    case BUS_ADDRESS:
+        i2c.started = true;
+        if (!dev || !dev->address(i2c.cmd != 0)) {
+            i2c.abrt = true;
+            i2c.abrt_source = ABRT_7B_ADDR_NOACK;
+            i2c.aborting = true;
+            tx_flush();
+        } else {
+            i2c.reading = (i2c.cmd != 0);
+        }
+        break;
+    case BUS_WRITE:
+        dev->write(i2c.cmd & 0xFF);
+        break;
+    case BUS_READ:
+        i2c.rx[(i2c.rx_rd + i2c.rx_n++) % FIFO_DEPTH] = dev->read();
+        break;
+    case BUS_STOP:
+        if (dev && !i2c.aborting) {
+            dev->stop();
+        }
+        i2c.started = false;
+        i2c.aborting = false;
+        i2c.stop_det = true;
+        break;
+    default:
+        break;
+    }
+}
+
+static void bus_run(void)
+{
+    for (;;) {
+        if (i2c.action == BUS_IDLE) {
+            bus_next((i2c.free > now) ? i2c.free : now);
+            if (i2c.action == BUS_IDLE) {
+                return;
+            }
+        }
+        if (now < i2c.end) {
+            return;
+        }
+        bus_done();
+        i2c.free = i2c.end;
+        bus_next(i2c.end);
+        if (i2c.action == BUS_IDLE) {
+            return;
+        }
+    }
+}
+
+static uint16_t intr_raw(void)
+{
+    return ((i2c.rx_n > i2c.rx_tl) ? R_RX_FULL : 0) |
+           ((i2c.tx_n <= i2c.tx_tl) ? R_TX_EMPTY : 0) |
+           (i2c.abrt ? R_TX_ABRT : 0) |
+           (i2c.stop_det ? R_STOP_DET : 0);
+}
+
+static bool irq_pending(void)
+{
+    return nvic_on && (i2c.enable & 1) && (intr_raw() & i2c.mask);
+}
+
+static uint16_t *reg_ptr(uint32_t addr)
+{
+    switch (addr) {
+    case I2C_CON_REG:       return &i2c.con;
+    case I2C_TAR_REG:       return &i2c.tar;
+    case I2C_INTR_MASK_REG: return &i2c.mask;
+    case I2C_RX_TL_REG:     return &i2c.rx_tl;
+    case I2C_TX_TL_REG:     return &i2c.tx_tl;
+    case I2C_ENABLE_REG:    return &i2c.enable;
+    case CLK_PER_REG:       return &i2c.clk;
+    }
+    return NULL;
+}
+
+static void run_isr(void)
+{
+    while (irq_pending()) {
+        in_isr = true;
+        isrs++;
+        now += isr_cycles;
+        cpu += isr_cycles;
+        bus_run();
+        I2C_Handler();
+        in_isr = false;
+    }
+}
+
+// a register access: the time goes on and the interrupt is taken if it is pending
+static void tick(void)
+{
+    now += reg_cycles;
+    cpu += reg_cycles;
+    bus_run();
+    sim_irq_check();
+}
+
+void sim_irq_check(void)
+{
+    if (!in_isr && !sim_primask && !sim_int_off) {
+        run_isr();
+    }
+}
+
+void sim_wfi(void)
+{
+    while (!irq_pending()) {
+        if (i2c.action == BUS_IDLE) {
+            printf("FAIL WFI with nothing to wake it up\n");
+            exit(1);
+        }
+        now = i2c.end;
+        bus_run();
+    }
+    sim_irq_check();
+}
+
+uint16_t GetWord16(uint32_t addr)
+{
+    uint16_t *reg = reg_ptr(addr);
+    uint16_t val = 0;
+
+    tick();
+    switch (addr) {
+    case I2C_DATA_CMD_REG:
+        if (i2c.rx_n) {
+            val = i2c.rx[i2c.rx_rd];
+            i2c.rx_rd = (i2c.rx_rd + 1) % FIFO_DEPTH;
+            i2c.rx_n--;
+            bus_run();
+        }
+        return val;
+    case I2C_INTR_STAT_REG:
+        return intr_raw() & i2c.mask;
+    case I2C_STATUS_REG:
+        return ((i2c.tx_n < FIFO_DEPTH) ? TFNF : 0) | ((i2c.tx_n == 0) ? TFE : 0) |
+               ((i2c.started || (i2c.action != BUS_IDLE)) ? MST_ACTIVITY : 0);
+    case I2C_RXFLR_REG:
+        return i2c.rx_n;
+    case I2C_TX_ABRT_SOURCE_REG:
+        return i2c.abrt_source;
+    case I2C_CLR_INTR_REG:
+        i2c.stop_det = false;
+        // no break
+    case I2C_CLR_TX_ABRT_REG:
+        i2c.abrt = false;
+        i2c.abrt_source = 0;
+        return 0;
+    case I2C_CLR_STOP_DET_REG:
+        i2c.stop_det = false;
+        return 0;
+    }
+    return reg ? *reg : 0;
+}
+
+void SetWord16(uint32_t addr, uint16_t value)
+{
+    uint16_t *reg = reg_ptr(addr);
+
+    if (addr == I2C_DATA_CMD_REG) {
+        // the Tx FIFO stays flushed while TX_ABRT is set
+        if (!i2c.abrt && (i2c.tx_n < FIFO_DEPTH)) {
+            i2c.tx[(i2c.tx_rd + i2c.tx_n++) % FIFO_DEPTH] = value;
+        }
+    } else if (reg) {
+        *reg = value;
+        if ((addr == I2C_ENABLE_REG) && !(value & 1)) {
+            tx_flush();
+            i2c.rx_n = 0;
+            i2c.started = false;
+            i2c.aborting = false;
+            i2c.action = BUS_IDLE;
+        }
+    }
+    tick();
+}
+
+void SetBits16(uint32_t addr, uint16_t mask, uint16_t value)
+{
+    uint16_t *reg = reg_ptr(addr);
+    int shift = 0;
+
+    while (!((mask >> shift) & 1)) {
+        shift++;
+    }
+    if (reg) {
+        *reg = (*reg & ~mask) | ((value << shift) & mask);
+    }
+    tick();
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq)
+{
+    nvic_on = true;
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq)
+{
+    nvic_on = false;
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+}
+
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority)
+{
+}
+
+/*
+ * MOTION BURST, INTERRUPT DRIVEN
+ ****************************************************************************************
+ */
+
+enum motion_step
+{
+    RD_IDLE,
+    RD_ROT_STATUS,
+    RD_ROT,
+    RD_ACC_STATUS,
+    RD_ACC,
+    RD_TEMP,
+};
+
+static struct i2c_async_trans motion_trans;
+static enum motion_step motion_step;
+static bool motion_temp;
+static uint8_t motion_status;
+static uint8_t motion_data[MOTION_FRAMES * BMI055_FIFO_FRAME_SIZE];
+static uint8_t motion_temperature;
+static int failures;
+
+static void motion_read(uint8_t dev, uint8_t reg, uint8_t *data, uint16_t len, enum motion_step step)
+{
+    motion_step = step;
+    motion_trans.dev_address = dev;
+    motion_trans.reg = reg;
+    motion_trans.rd_data = data;
+    motion_trans.rd_len = len;
+    i2c_async_submit(&motion_trans);
+}
+
+// the chain of app_motion_i2c_cb(), without the FIFO overruns
+static void motion_cb(struct i2c_async_trans *trans)
+{
+    if (trans->status != I2C_ASYNC_OK) {
+        printf("FAIL motion burst status %d\n", trans->status);
+        failures++;
+        motion_step = RD_IDLE;
+        return;
+    }
+    switch (motion_step) {
+    case RD_ROT_STATUS:
+        motion_read(0x69, BMI055_FIFO_DATA, motion_data, (motion_status & BMI055_FIFO_FRAME_COUNTER) * BMI055_FIFO_FRAME_SIZE, RD_ROT);
+        break;
+    case RD_ROT:
+        motion_read(0x19, BMI055_FIFO_STATUS, &motion_status, 1, RD_ACC_STATUS);
+        break;
+    case RD_ACC_STATUS:
+        motion_read(0x19, BMI055_FIFO_DATA, motion_data, (motion_status & BMI055_FIFO_FRAME_COUNTER) * BMI055_FIFO_FRAME_SIZE, RD_ACC);
+        break;
+    case RD_ACC:
+        if (motion_temp) {
+            motion_read(0x19, BMI055_ACCD_TEMP, &motion_temperature, 1, RD_TEMP);
+            break;
+        }
+        // no break
+    default:
+        motion_step = RD_IDLE;
+        break;
+    }
+}
+
+static void motion_burst(bool temp)
+{
+    motion_temp = temp;
+    motion_trans.callback = motion_cb;
+    motion_trans.speed = I2C_FAST;
+    motion_trans.reg_len = 1;
+    motion_trans.wr_len = 0;
+    motion_read(0x69, BMI055_FIFO_STATUS, &motion_status, 1, RD_ROT_STATUS);
+}
+
+/*
+ * MEASUREMENTS
+ ****************************************************************************************
+ */
+
+struct cost
+{
+    uint64_t wall, cpu;
+    unsigned isrs;
+};
+
+static struct cost mark;
+
+static void cost_start(void)
+{
+    mark.wall = now;
+    mark.cpu = cpu;
+    mark.isrs = isrs;
+}
+
+static struct cost cost_end(void)
+{
+    struct cost c = {now - mark.wall, cpu - mark.cpu, isrs - mark.isrs};
+
+    return c;
+}
+
+static void print_cost(const char *what, const char *driver, struct cost c, int n)
+{
+    printf("%-22s %-9s %9.1f %9.1f %6.1f\n", what, driver, (double)c.wall / n / CPU_MHZ,
+           (double)c.cpu / n / CPU_MHZ, (double)c.isrs / n);
+}
+
+// waits with the CPU halted until the motion chain has ended
+static void wait_motion(void)
+{
+    while (motion_step != RD_IDLE) {
+        sim_wfi();
+    }
+}
+
+static void eeprom_idle(void)
+{
+    // lets the last write cycle end, without counting it
+    now += EEPROM_WRITE_US * CPU_MHZ;
+}
+
+static void check(const uint8_t *a, const uint8_t *b, uint32_t len, uint32_t done, const char *what)
+{
+    if ((done != len) || memcmp(a, b, len)) {
+        printf("FAIL %s: %u bytes, data %s\n", what, done, memcmp(a, b, len) ? "differ" : "ok");
+        failures++;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint8_t wr[EEPROM_BYTES], rd[EEPROM_BYTES];
+    struct i2c_eeprom_job job;
+    struct cost c;
+    uint32_t done;
+    int k;
+
+    for (k = 1; k + 1 < argc; k += 2) {
+        if (!strcmp(argv[k], "-reg")) {
+            reg_cycles = atoi(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-isr")) {
+            isr_cycles = atoi(argv[k + 1]);
+        }
+    }
+    for (k = 0; k < EEPROM_BYTES; k++) {
+        wr[k] = (uint8_t)(k * 7 + 1);
+    }
+
+    printf("model, not a measurement: %d cycles per register access, %d per interrupt, 16MHz, I2C at 400kHz\n",
+           reg_cycles, isr_cycles);
+    printf("%-22s %-9s %9s %9s %6s\n", "transfer", "driver", "wall us", "CPU us", "IRQs");
+
+    // motion bursts
+    cost_start();
+    for (k = 0; k < MOTION_BURSTS; k++) {
+        blk_motion_burst((k % MOTION_TEMP_INTERVAL) == 0);
+    }
+    blk_eeprom_release();
+    c = cost_end();
+    print_cost("motion burst", "blocking", c, MOTION_BURSTS);
+    printf("%-22s %-9s %28.1f%% of a %dus connection interval\n", "", "", 100.0 * c.cpu / MOTION_BURSTS / CPU_MHZ / CONN_INTERVAL_US, CONN_INTERVAL_US);
+    cost_start();
+    for (k = 0; k < MOTION_BURSTS; k++) {
+        motion_burst((k % MOTION_TEMP_INTERVAL) == 0);
+        wait_motion();
+    }
+    c = cost_end();
+    print_cost("motion burst", "async", c, MOTION_BURSTS);
+    printf("%-22s %-9s %28.1f%% of a %dus connection interval\n", "", "", 100.0 * c.cpu / MOTION_BURSTS / CPU_MHZ / CONN_INTERVAL_US, CONN_INTERVAL_US);
+
+    // EEPROM write then read back
+    blk_eeprom_init(EEPROM_ADDRESS, I2C_FAST, I2C_7BIT_ADDR, I2C_2BYTES_ADDR);
+    cost_start();
+    done = blk_eeprom_write_data(wr, EEPROM_START, EEPROM_BYTES);
+    print_cost("EEPROM write 64B", "blocking", cost_end(), 1);
+    check(wr, wr, EEPROM_BYTES, done, "blocking write");
+    memset(rd, 0, sizeof(rd));
+    cost_start();
+    done = blk_eeprom_read_data(rd, EEPROM_START, EEPROM_BYTES);
+    print_cost("EEPROM read 64B", "blocking", cost_end(), 1);
+    check(wr, rd, EEPROM_BYTES, done, "blocking read");
+    blk_eeprom_release();
+    eeprom_idle();
+
+    for (k = 0; k < EEPROM_BYTES; k++) {
+        wr[k] ^= 0x5A;
+    }
+    i2c_eeprom_init(EEPROM_ADDRESS, I2C_FAST, I2C_7BIT_ADDR, I2C_2BYTES_ADDR);
+    cost_start();
+    memset(&job, 0, sizeof(job));
+    job.data = wr;
+    job.address = EEPROM_START;
+    job.size = EEPROM_BYTES;
+    job.write = true;
+    i2c_eeprom_submit(&job);
+    i2c_eeprom_wait(&job);
+    print_cost("EEPROM write 64B", "async", cost_end(), 1);
+    check(wr, wr, EEPROM_BYTES, job.done, "async write");
+    memset(rd, 0, sizeof(rd));
+    cost_start();
+    done = i2c_eeprom_read_data(rd, EEPROM_START, EEPROM_BYTES);
+    print_cost("EEPROM read 64B", "async", cost_end(), 1);
+    check(wr, rd, EEPROM_BYTES, done, "async read");
+    eeprom_idle();
+
+    // missing EEPROM
+    blk_eeprom_init(EEPROM_MISSING, I2C_FAST, I2C_7BIT_ADDR, I2C_2BYTES_ADDR);
+    cost_start();
+    if (blk_wait_until_eeprom_ready() != I2C_EEPROM_ERR_NOT_READY) {
+        printf("FAIL blocking: the missing EEPROM is ready\n");
+        failures++;
+    }
+    print_cost("missing EEPROM poll", "blocking", cost_end(), 1);
+    blk_eeprom_release();
+    i2c_eeprom_init(EEPROM_MISSING, I2C_FAST, I2C_7BIT_ADDR, I2C_2BYTES_ADDR);
+    cost_start();
+    if (i2c_wait_until_eeprom_ready() != I2C_EEPROM_ERR_NOT_READY) {
+        printf("FAIL async: the missing EEPROM is ready\n");
+        failures++;
+    }
+    print_cost("missing EEPROM poll", "async", cost_end(), 1);
+
+    printf("%s\n", failures ? "" : "ok");
+    return failures != 0;
+}
@@ -0,0 +1,86 @@
+/**
+ ****************************************************************************************
+ *
+ * @file arch.h
+ *
+ * @brief Host stand-in of the platform header included by the I2C drivers. The
+ *        registers are those of datasheet.h; the accesses go to the simulated controller
+ *        of i2c_busy_model.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _ARCH_H_
+#define _ARCH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define I2C_CON_REG                 (0x50001300)
+#define I2C_TAR_REG                 (0x50001304)
+#define I2C_DATA_CMD_REG            (0x50001310)
+#define I2C_INTR_STAT_REG           (0x5000132C)
+#define I2C_INTR_MASK_REG           (0x50001330)
+#define I2C_RX_TL_REG               (0x50001338)
+#define I2C_TX_TL_REG               (0x5000133C)
+#define I2C_CLR_INTR_REG            (0x50001340)
+#define I2C_CLR_TX_ABRT_REG         (0x50001354)
+#define I2C_CLR_STOP_DET_REG        (0x50001360)
+#define I2C_ENABLE_REG              (0x5000136C)
+#define I2C_STATUS_REG              (0x50001370)
+#define I2C_RXFLR_REG               (0x50001378)
+#define I2C_TX_ABRT_SOURCE_REG      (0x50001380)
+#define CLK_PER_REG                 (0x50000004)
+
+#define TFNF                        (0x0002)
+#define TFE                         (0x0004)
+#define MST_ACTIVITY                (0x0020)
+#define R_RX_FULL                   (0x0004)
+#define R_TX_EMPTY                  (0x0010)
+#define R_TX_ABRT                   (0x0040)
+#define R_STOP_DET                  (0x0200)
+#define M_RX_FULL                   (0x0004)
+#define M_TX_EMPTY                  (0x0010)
+#define M_TX_ABRT                   (0x0040)
+#define M_STOP_DET                  (0x0200)
+#define ABRT_7B_ADDR_NOACK          (0x0001)
+#define I2C_MASTER_MODE             (0x0001)
+#define I2C_SPEED                   (0x0006)
+#define I2C_10BITADDR_MASTER        (0x0010)
+#define I2C_RESTART_EN              (0x0020)
+#define I2C_SLAVE_DISABLE           (0x0040)
+#define I2C_ENABLE                  (0x0020)
+
+typedef enum {
+    I2C_IRQn = 14,
+} IRQn_Type;
+
+uint16_t GetWord16(uint32_t addr);
+void SetWord16(uint32_t addr, uint16_t value);
+void SetBits16(uint32_t addr, uint16_t mask, uint16_t value);
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority);
+
+// the simulation, in i2c_busy_model.c
+extern int sim_int_off;                 // nesting of GLOBAL_INT_DISABLE()
+extern bool sim_primask;                // GLOBAL_INT_STOP()
+void sim_irq_check(void);               // takes the I2C interrupt, if it is pending and allowed
+void sim_wfi(void);                     // halts until the I2C interrupt is pending
+
+#define GLOBAL_INT_DISABLE()        do { sim_int_off++;
+#define GLOBAL_INT_RESTORE()        sim_int_off--; sim_irq_check(); } while (0)
+#define GLOBAL_INT_STOP()           (sim_primask = true)
+#define GLOBAL_INT_START()          do { sim_primask = false; sim_irq_check(); } while (0)
+#define WFI()                       sim_wfi()
+
+#endif // _ARCH_H_
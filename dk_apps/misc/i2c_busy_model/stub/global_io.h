@@ -0,0 +1,23 @@
+/**
+ ****************************************************************************************
+ *
+ * @file global_io.h
+ *
+ * @brief Host stand-in of global_io.h, for i2c_eeprom.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef IO_H_INCLUDED
+#define IO_H_INCLUDED
+
+#include "arch.h"
+
+#endif // IO_H_INCLUDED
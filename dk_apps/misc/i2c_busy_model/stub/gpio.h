@@ -0,0 +1,21 @@
+/**
+ ****************************************************************************************
+ *
+ * @file gpio.h
+ *
+ * @brief Host stand-in of gpio.h, for i2c_eeprom.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _GPIO_H_
+#define _GPIO_H_
+
+#endif // _GPIO_H_
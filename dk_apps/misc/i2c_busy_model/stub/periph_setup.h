@@ -0,0 +1,28 @@
+/**
+ ****************************************************************************************
+ *
+ * @file periph_setup.h
+ *
+ * @brief Host stand-in of periph_setup.h, for i2c_eeprom.c: a 24LC64 (EEPROM_IS_8K).
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef PERIPH_SETUP_H_
+#define PERIPH_SETUP_H_
+
+#define I2C_SLAVE_ADDRESS       0x50            // Set slave device address
+#define I2C_ADDRESS_MODE        I2C_7BIT_ADDR   // 7-bit addressing
+#define I2C_EEPROM_SIZE         8192            // EEPROM size in bytes
+#define I2C_EEPROM_PAGE         32              // EEPROM's page size in bytes
+#define I2C_SPEED_MODE          I2C_FAST        // fast mode (400 kbits/s)
+#define I2C_ADRESS_BYTES_CNT    I2C_2BYTES_ADDR
+
+#endif // PERIPH_SETUP_H_
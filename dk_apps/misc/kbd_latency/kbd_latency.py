@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""
+Key-to-air latency analyzer.
+
+Reads the UART log of a remote_audio build with KBD_LATENCY_TRACE_ON (and
+CFG_PRINTF) and prints, per start type (active, extended sleep, deep sleep),
+a latency histogram of each stage of a key press:
+
+    WAKEUP / KBD_IRQ -> SCAN_START -> KEY_DETECTED -> REPORT_PREPARED
+                     -> HOGPD_REQ -> L2CM -> AIR
+
+and of the whole path from the start to AIR. A stage that was not recorded
+(e.g. SCAN_START of a key press during scanning) is skipped and its time is
+added to the next stage.
+
+Trace lines have the format (see app_kbd_trace.h):
+
+    KT,<seq>,<stage>,<arg>,<clk>,<time in usec, 8 hex digits>
+    KT,LOST,<n>
+
+Other lines of the log are ignored. Times that include an entry recorded while
+no clock was running (clk 2, e.g. WAKEUP of a sleep start) are lower bounds;
+their number is reported per stage.
+
+Usage:
+    kbd_latency.py [--bin <usec>] [--width <chars>] <uart log> [...]
+"""
+
+import argparse
+import re
+import sys
+
+STAGES = ('WAKEUP', 'KBD_IRQ', 'SCAN_START', 'KEY_DETECTED', 'REPORT_PREPARED',
+          'HOGPD_REQ', 'L2CM', 'AIR')
+WAKEUP, KBD_IRQ, AIR = 0, 1, 7
+
+START_TYPES = ('active', 'extended sleep', 'deep sleep')
+
+CLK_NONE = 2
+
+TRACE_RE = re.compile(r'KT,(\d+),(\d+),(\d+),(\d+),([0-9a-fA-F]{8})')
+LOST_RE = re.compile(r'KT,LOST,(\d+)')
+
+
+def parse(lines):
+    """Returns the list of (seq, stage, arg, clk, time) entries and the number of lost entries."""
+    entries = []
+    lost = 0
+    for line in lines:
+        m = LOST_RE.search(line)
+        if m:
+            lost += int(m.group(1))
+            continue
+        m = TRACE_RE.search(line)
+        if m:
+            seq, stage, arg, clk = (int(m.group(i)) for i in range(1, 5))
+            if stage < len(STAGES):
+                entries.append((seq, stage, arg, clk, int(m.group(5), 16)))
+    return entries, lost
+
+
+def sessions(entries):
+    """Splits the entries in key presses. Yields (start type, {stage: (time, clk)})."""
+    current = None
+    start_type = None
+    for seq, stage, arg, clk, time in entries:
+        if stage in (WAKEUP, KBD_IRQ):
+            if current:
+                yield start_type, current
+            current = {stage: (time, clk)}
+            start_type = arg if stage == WAKEUP else 0
+            current_seq = seq
+        elif current is not None and seq == current_seq:
+            # only the first report of a key press is followed
+            current.setdefault(stage, (time, clk))
+    if current:
+        yield start_type, current
+
+
+def stage_latencies(stages):
+    """Returns [(name, usec, lower bound)] for each recorded stage after the start."""
+    result = []
+    order = sorted(stages)      # the stages are numbered in path order
+    prev_time, prev_clk = stages[order[0]]
+    start_time, start_clk = prev_time, prev_clk
+    for stage in order[1:]:
+        time, clk = stages[stage]
+        delta = (time - prev_time) & 0xFFFFFFFF
+        if delta >= 0x80000000:
+            return []   # out of order, the trace is broken
+        result.append((STAGES[stage], delta, CLK_NONE in (clk, prev_clk)))
+        prev_time, prev_clk = time, clk
+    if AIR in stages:
+        time, clk = stages[AIR]
+        result.append(('TOTAL', (time - start_time) & 0xFFFFFFFF,
+                       start_clk == CLK_NONE or clk == CLK_NONE))
+    return result
+
+
+def percentile(values, p):
+    values = sorted(values)
+    return values[min(len(values) - 1, (len(values) * p) // 100)]
+
+
+def print_histogram(name, values, lower_bounds, bin_us, width):
+    print('  %-16s n=%-5d min=%-6d p50=%-6d p95=%-6d max=%-6d%s' % (
+        name, len(values), min(values), percentile(values, 50), percentile(values, 95),
+        max(values), ('  (%d lower bounds)' % lower_bounds) if lower_bounds else ''))
+    bins = {}
+    for v in values:
+        bins[v // bin_us] = bins.get(v // bin_us, 0) + 1
+    top = max(bins.values())
+    for b in range(min(bins), max(bins) + 1):
+        count = bins.get(b, 0)
+        bar = '#' * ((count * width + top - 1) // top)
+        print('    %7d-%-7d %5d %s' % (b * bin_us, (b + 1) * bin_us - 1, count, bar))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Key-to-air latency analyzer')
+    parser.add_argument('--bin', type=int, default=250, help='histogram bin width in usec')
+    parser.add_argument('--width', type=int, default=50, help='width of the largest bar')
+    parser.add_argument('logs', nargs='+', help='UART log files')
+    args = parser.parse_args()
+
+    lines = []
+    for path in args.logs:
+        with open(path, errors='replace') as f:
+            lines.extend(f.readlines())
+
+    entries, lost = parse(lines)
+    if not entries:
+        print('no trace entries found')
+        return 1
+
+    # start type -> stage name -> ([usec], lower bounds)
+    stats = {}
+    presses = [0] * len(START_TYPES)
+    for start_type, stages in sessions(entries):
+        if start_type >= len(START_TYPES):
+            continue
+        presses[start_type] += 1
+        for name, usec, lower_bound in stage_latencies(stages):
+            values, lb = stats.setdefault(start_type, {}).setdefault(name, ([], [0]))
+            values.append(usec)
+            lb[0] += lower_bound
+
+    print('%d entries, %d lost' % (len(entries), lost))
+    for start_type, name in enumerate(START_TYPES):
+        if start_type not in stats:
+            continue
+        print('\n%s start (%d key presses)' % (name, presses[start_type]))
+        for stage in STAGES[2:] + ('TOTAL',):
+            if stage in stats[start_type]:
+                values, lb = stats[start_type][stage]
+                print_histogram(stage, values, lb[0], args.bin, args.width)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,325 @@
+/**
+ ****************************************************************************************
+ *
+ * @file kbd_trace_replay.c
+ *
+ * @brief Captures a UART log of the key-to-air trace (remote_audio/app_kbd_trace.c) on the
+ *        host, with the true latency of each stage, to validate kbd_latency.py.
+ *
+ * The real app_kbd_trace.c runs against a model of the clocks it reads:
+ *   - the BLE timer (base time in slots and the fine counter), which keeps the time while
+ *     the BLE core sleeps but can only be read after the core has woken up. Its count
+ *     starts near the 32-bit wrap of the usec time;
+ *   - the SysTick of the key scanning at 1MHz, started when the scanning starts and
+ *     stopped when the keyboard goes idle, with the KBD_TRACE_SYSTICK_STOP() and
+ *     KBD_TRACE_SYSTICK_WRAP() calls of app_kbd.c;
+ *   - the connection events, every INTERVAL_US, ending EVT_LEN_US after the anchor.
+ *
+ * Key presses come in three kinds, as the start types of the analyzer:
+ *   - active: the keyboard is scanning and the BLE core is awake (KBD_IRQ);
+ *   - extended and deep sleep: WAKEUP, the scanning starts after the wakeup delay of the
+ *     sleep mode, the BLE core wakes up for the next connection event (RW_WAKE_UP_ONGOING
+ *     for 300us before it) and the entries taken before are moved to the BLE time base.
+ * Then the key is detected after the debouncing, the report is prepared, HOGPD_REQ sent
+ * and the notification handed to L2CM; AIR is recorded at the end of the next event.
+ * After each press the trace is exported as the main loop does while the keyboard is idle.
+ *
+ * The log goes to stdout. The true latencies go to stderr, in the summary format of
+ * kbd_latency.py:
+ *   ./kbd_trace_replay > replay.log 2> truth.txt
+ *   ../kbd_latency.py replay.log | grep n= | diff - truth.txt
+ * Only SCAN_START and TOTAL of the sleep starts may differ: the SysTick does not run
+ * between the wakeup and the scanning, so the analyzer reports them as lower bounds.
+ *
+ * Build and run from this directory:
+ *   cc -Istub -I../../src/modules/app/src/app_project/remote_audio kbd_trace_replay.c \
+ *      -o kbd_trace_replay
+ *   ./kbd_trace_replay [-n <key presses>] [-s <seed>]
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define KBD_LATENCY_TRACE_ON
+#define zero_init
+
+// app_kbd.h sits next to app_kbd_trace.c, so the stub directory cannot hide it
+#define APP_KBD_H_
+#define SYSTICK_TICKS_PER_US    (1)
+
+#include "app_kbd_trace.c"
+
+#define INTERVAL_US             (7500)
+#define EVT_LEN_US              (700)
+#define BLE_WAKEUP_US           (600)       // the BLE core wakes up this long before the anchor
+#define BLE_ONGOING_US          (300)       // RW_WAKE_UP_ONGOING before the BLE core is up
+#define SYSTICK_PERIOD          (2000)      // usec, the scan period
+#define BLE_START_US            (0xFFF00000ULL)
+
+struct range
+{
+    int min, max;
+};
+
+// the wakeup delay until the scanning starts, per start type
+static const struct range wakeup_delay[] = {
+    {0, 0},
+    {1200, 2500},       // extended sleep: XTAL16 settling
+    {2500, 5000},       // deep sleep: boot from the OTP
+};
+static const struct range debounce = {1000, 8000};
+static const struct range prepare = {100, 600};
+static const struct range request = {50, 300};
+static const struct range to_l2cm = {200, 1500};
+
+static uint64_t now;                        // usec
+static bool ble_on;                         // BLE core awake
+static uint64_t ble_wakeup;                 // when the BLE core wakes up, if !ble_on
+static bool st_on;
+static uint32_t st_val;
+
+// true latencies: [start type][stage] and TOTAL
+#define MAX_PRESSES             (20000)
+static int truth[3][KBD_TRACE_NR_STAGES + 1][MAX_PRESSES];
+static int truth_n[3][KBD_TRACE_NR_STAGES + 1];
+
+/*
+ * STAND-INS
+ ****************************************************************************************
+ */
+
+static bool ble_readable(void)
+{
+    return ble_on;
+}
+
+uint16_t GetBits16(uint32_t addr, uint16_t field)
+{
+    return (addr == CLK_RADIO_REG) && (field == BLE_ENABLE) && ble_readable();
+}
+
+uint32_t GetBits32(uint32_t addr, uint32_t field)
+{
+    return (addr == BLE_DEEPSLCNTL_REG) && (field == DEEP_SLEEP_STAT) && !ble_readable();
+}
+
+uint32_t GetWord32(uint32_t addr)
+{
+    switch (addr) {
+    case 0xE000E010: return st_on;
+    case 0xE000E014: return SYSTICK_PERIOD - 1;
+    case 0xE000E018: return st_val;
+    }
+    return 0;
+}
+
+uint16_t rwip_prevent_sleep_get(void)
+{
+    return (!ble_on && (now + BLE_ONGOING_US >= ble_wakeup)) ? RW_WAKE_UP_ONGOING : 0;
+}
+
+uint32_t lld_evt_time_get(void)
+{
+    return ((BLE_START_US + now) / 625) & 0x7FFFFFF;    // BLE_BASETIMECNT_MASK
+}
+
+uint32_t ble_finetimecnt_get(void)
+{
+    return 624 - (BLE_START_US + now) % 625;
+}
+
+int arch_printf(const char *fmt, ...)
+{
+    va_list args;
+    int n;
+
+    va_start(args, fmt);
+    n = vprintf(fmt, args);
+    va_end(args);
+    return n;
+}
+
+/*
+ * SIMULATION
+ ****************************************************************************************
+ */
+
+static int pick(struct range r)
+{
+    return r.min + rand() % (r.max - r.min + 1);
+}
+
+static uint64_t next_evt_end(void)
+{
+    return ((now + INTERVAL_US - EVT_LEN_US) / INTERVAL_US) * INTERVAL_US + EVT_LEN_US;
+}
+
+// systick_start() and systick_stop() of app_kbd.c
+static void systick_start(void)
+{
+    KBD_TRACE_SYSTICK_STOP();
+    st_val = SYSTICK_PERIOD - 1;
+    st_on = true;
+}
+
+static void systick_stop(void)
+{
+    KBD_TRACE_SYSTICK_STOP();
+    st_on = false;
+}
+
+// runs the clocks until t; returns the end of the last BLE event that was passed, or 0
+static uint64_t run_until(uint64_t t)
+{
+    uint64_t evt_end = 0;
+
+    while (now < t) {
+        now++;
+        if (st_on) {
+            if (st_val == 0) {
+                st_val = SYSTICK_PERIOD - 1;
+                KBD_TRACE_SYSTICK_WRAP();
+            } else {
+                st_val--;
+            }
+        }
+        if (!ble_on && (now >= ble_wakeup)) {
+            ble_on = true;
+        }
+        if (ble_on && (now % INTERVAL_US == EVT_LEN_US)) {
+            app_kbd_trace_ble_evt_end();
+            evt_end = now;
+        }
+    }
+    return evt_end;
+}
+
+static void add_truth(int type, int stage, uint64_t from, uint64_t to)
+{
+    if (truth_n[type][stage] < MAX_PRESSES) {
+        truth[type][stage][truth_n[type][stage]++] = (int)(to - from);
+    }
+}
+
+static void key_press(int type)
+{
+    uint64_t t[KBD_TRACE_NR_STAGES], start;
+    int s, prev;
+
+    memset(t, 0, sizeof(t));
+    now += 50000 + rand() % 450000;         // idle gap: no clock needs to run
+    if (type == KBD_TRACE_START_ACTIVE) {
+        // scanning, with the BLE core up
+        ble_on = true;
+        systick_start();
+        run_until(now + pick((struct range){0, 3 * SYSTICK_PERIOD}));
+        start = t[KBD_TRACE_KBD_IRQ] = now;
+        KBD_TRACE(KBD_TRACE_KBD_IRQ, KBD_TRACE_START_ACTIVE);
+        prev = KBD_TRACE_KBD_IRQ;
+    } else {
+        ble_on = false;
+        ble_wakeup = next_evt_end() - EVT_LEN_US - BLE_WAKEUP_US;
+        if (ble_wakeup <= now) {
+            ble_wakeup += INTERVAL_US;
+        }
+        start = t[KBD_TRACE_WAKEUP] = now;
+        KBD_TRACE(KBD_TRACE_WAKEUP, type);
+        run_until(now + pick(wakeup_delay[type]));
+        systick_start();                    // update_scan_times()
+        t[KBD_TRACE_SCAN_START] = now;
+        KBD_TRACE(KBD_TRACE_SCAN_START, 0);
+        prev = KBD_TRACE_WAKEUP;
+    }
+
+    run_until(now + pick(debounce));
+    t[KBD_TRACE_KEY_DETECTED] = now;
+    KBD_TRACE(KBD_TRACE_KEY_DETECTED, rand() % 8);
+    run_until(now + pick(prepare));
+    t[KBD_TRACE_REPORT_PREPARED] = now;
+    KBD_TRACE(KBD_TRACE_REPORT_PREPARED, 1);
+    run_until(now + pick(request));
+    t[KBD_TRACE_HOGPD_REQ] = now;
+    KBD_TRACE(KBD_TRACE_HOGPD_REQ, 0);
+    run_until(now + pick(to_l2cm));
+    t[KBD_TRACE_L2CM] = now;
+    KBD_TRACE(KBD_TRACE_L2CM, 0);
+    t[KBD_TRACE_AIR] = run_until(next_evt_end());
+
+    // the key is released and the keyboard goes idle
+    run_until(now + pick(debounce));
+    systick_stop();
+    while (kbd_trace_tail != kbd_trace_head) {
+        app_kbd_trace_export();
+    }
+
+    for (s = prev + 1; s < KBD_TRACE_NR_STAGES; s++) {
+        if (t[s]) {
+            add_truth(type, s, t[prev], t[s]);
+            prev = s;
+        }
+    }
+    add_truth(type, KBD_TRACE_NR_STAGES, start, t[KBD_TRACE_AIR]);
+}
+
+static int compare(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+static int percentile(int *v, int n, int p)
+{
+    int i = (n * p) / 100;
+
+    return v[(i < n - 1) ? i : n - 1];
+}
+
+int main(int argc, char **argv)
+{
+    static const char *stage_names[] = {"WAKEUP", "KBD_IRQ", "SCAN_START", "KEY_DETECTED",
+                                        "REPORT_PREPARED", "HOGPD_REQ", "L2CM", "AIR", "TOTAL"};
+    int presses = 3000, i, type, s;
+    unsigned seed = 1;
+
+    for (i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "-n")) {
+            presses = atoi(argv[i + 1]);
+        } else if (!strcmp(argv[i], "-s")) {
+            seed = atoi(argv[i + 1]);
+        }
+    }
+    if (presses > MAX_PRESSES) {
+        presses = MAX_PRESSES;
+    }
+    srand(seed);
+
+    for (i = 0; i < presses; i++) {
+        key_press(rand() % 3);
+    }
+
+    for (type = 0; type < 3; type++) {
+        for (s = KBD_TRACE_SCAN_START; s <= KBD_TRACE_NR_STAGES; s++) {
+            int *v = truth[type][s], n = truth_n[type][s];
+
+            if (n == 0) {
+                continue;
+            }
+            qsort(v, n, sizeof(v[0]), compare);
+            fprintf(stderr, "  %-16s n=%-5d min=%-6d p50=%-6d p95=%-6d max=%-6d\n",
+                    stage_names[s], n, v[0], percentile(v, n, 50), percentile(v, n, 95), v[n - 1]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,23 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_console.h
+ *
+ * @brief Host stand-in of app_console.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_CONSOLE_H_
+#define APP_CONSOLE_H_
+
+int arch_printf(const char *fmt, ...);
+
+#endif // APP_CONSOLE_H_
@@ -0,0 +1,34 @@
+/**
+ ****************************************************************************************
+ *
+ * @file arch.h
+ *
+ * @brief Host stand-in of arch.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef ARCH_H_
+#define ARCH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CLK_RADIO_REG           (0x50000008)
+#define BLE_ENABLE              (0x0080)
+
+#define GLOBAL_INT_DISABLE()
+#define GLOBAL_INT_RESTORE()
+
+uint16_t GetBits16(uint32_t addr, uint16_t field);
+uint32_t GetBits32(uint32_t addr, uint32_t field);
+uint32_t GetWord32(uint32_t addr);
+
+#endif // ARCH_H_
@@ -0,0 +1,29 @@
+/**
+ ****************************************************************************************
+ *
+ * @file reg_blecore.h
+ *
+ * @brief Host stand-in of reg_blecore.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef REG_BLECORE_H_
+#define REG_BLECORE_H_
+
+#include <stdint.h>
+
+#define BLE_DEEPSLCNTL_REG      (0x40000030)
+#define DEEP_SLEEP_STAT         (0x8000)
+#define BLE_FINECNT_MASK        ((uint32_t)0x000003FF)
+
+uint32_t ble_finetimecnt_get(void);
+
+#endif // REG_BLECORE_H_
@@ -0,0 +1,30 @@
+/**
+ ****************************************************************************************
+ *
+ * @file rwip.h
+ *
+ * @brief Host stand-in of rwip.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef RWIP_H_
+#define RWIP_H_
+
+#include <stdint.h>
+
+enum prevent_sleep
+{
+    RW_WAKE_UP_ONGOING = 0x0001,
+};
+
+uint16_t rwip_prevent_sleep_get(void);
+
+#endif // RWIP_H_
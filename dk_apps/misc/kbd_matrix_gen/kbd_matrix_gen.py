@@ -0,0 +1,509 @@
+#!/usr/bin/env python3
+"""
+Keyboard matrix generator.
+
+Builds the app_kbd_matrix_setup_<N>.h and app_kbd_key_matrix_setup_<N>.h headers
+of the remote_audio project from a single declarative layout description
+(see layouts/*.kbd).
+
+Layout syntax (one directive per line, '#' starts a comment):
+
+    setup           <N>                     MATRIX_SETUP number
+    title           <text>                  free text, used in the doxygen brief
+    input           P<port>_<pin>           one per column, in scanword bit order
+    output          P<port>_<pin>           one per row
+    delayed_wakeup  <row> <column>          key used for DELAYED_WAKEUP_ON
+    layer           <set>                   starts a keymap layer; followed by
+                                            one line of keycodes per output and
+                                            closed by 'end'
+    legend <text>                           in a layer, before the keycodes: one
+                                            line of the key legend comment of the
+                                            layer: the text after 'legend' is copied
+                                            as is ('#' included)
+    combo           <ACTION> <o>,<i> ...    multi-key combination; a comment on
+                                            the line (# Stop+1) is kept
+    combo_guard     <macro>                 the #ifdef of the combinations
+                                            (MULTI_KEY_COMBINATIONS_ON by default)
+
+Keycodes may be numeric (0x0051) or one of the symbols PAIR, CLRP, K_CODE.
+Layer 0 is the default keymap and must contain every key of the matrix. Fn
+layers (set > 0) are emitted sparsely: only the entries that differ from layer 0
+are stored.
+
+Usage:
+    kbd_matrix_gen.py <layout.kbd> [<output dir>]
+"""
+
+import os
+import re
+import sys
+
+SYMBOLS = ('PAIR', 'CLRP', 'K_CODE')
+
+COPYRIGHT = """\
+/**
+ ****************************************************************************************
+ *
+ * Copyright (C) 2014. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * GENERATED FILE - DO NOT EDIT.
+ * Generated by misc/kbd_matrix_gen/kbd_matrix_gen.py from %s.
+ */
+"""
+
+
+class LayoutError(Exception):
+    pass
+
+
+class Layout(object):
+    def __init__(self):
+        self.setup = None
+        self.title = ''
+        self.inputs = []
+        self.outputs = []
+        self.delayed_wakeup = None
+        self.layers = {}
+        self.legends = {}
+        self.combos = []
+        self.combo_guard = 'MULTI_KEY_COMBINATIONS_ON'
+
+
+def parse_pin(tok, lineno):
+    m = re.match(r'^P([0-3])_([0-9])$', tok)
+    if not m:
+        raise LayoutError('line %d: bad pin "%s" (expected P<port>_<pin>)' % (lineno, tok))
+    return int(m.group(1)), int(m.group(2))
+
+
+def parse_keycode(tok, lineno):
+    if tok in SYMBOLS:
+        return tok
+    try:
+        val = int(tok, 0)
+    except ValueError:
+        raise LayoutError('line %d: bad keycode "%s"' % (lineno, tok))
+    if val < 0 or val > 0xFFFF:
+        raise LayoutError('line %d: keycode "%s" out of range' % (lineno, tok))
+    return val
+
+
+def parse(path):
+    lay = Layout()
+    layer = None
+    rows = None
+
+    with open(path) as f:
+        for lineno, raw in enumerate(f, 1):
+            if (layer is not None) and (raw.split(None, 1)[:1] == ['legend']):
+                text = raw.rstrip('\r\n').split('legend', 1)[1]
+                lay.legends[layer].append(text.rstrip())
+                continue
+            line = raw.split('#', 1)[0].strip()
+            if not line:
+                continue
+            toks = line.split()
+            key = toks[0]
+
+            if layer is not None:
+                if key == 'end':
+                    lay.layers[layer] = rows
+                    layer = None
+                else:
+                    rows.append([parse_keycode(t, lineno) for t in toks])
+                continue
+
+            if key == 'setup':
+                lay.setup = int(toks[1])
+            elif key == 'title':
+                lay.title = line[len('title'):].strip()
+            elif key == 'input':
+                lay.inputs.append(parse_pin(toks[1], lineno))
+            elif key == 'output':
+                lay.outputs.append(parse_pin(toks[1], lineno))
+            elif key == 'delayed_wakeup':
+                lay.delayed_wakeup = (int(toks[1]), int(toks[2]))
+            elif key == 'layer':
+                layer = int(toks[1])
+                if layer in lay.layers:
+                    raise LayoutError('line %d: layer %d defined twice' % (lineno, layer))
+                rows = []
+                lay.legends[layer] = []
+            elif key == 'combo':
+                keys = []
+                for t in toks[2:]:
+                    o, i = t.split(',')
+                    keys.append((int(o), int(i)))
+                comment = raw.split('#', 1)[1].strip() if '#' in raw else ''
+                lay.combos.append((toks[1], keys, comment))
+            elif key == 'combo_guard':
+                lay.combo_guard = toks[1]
+            else:
+                raise LayoutError('line %d: unknown directive "%s"' % (lineno, key))
+
+    if layer is not None:
+        raise LayoutError('layer %d is not closed with "end"' % layer)
+
+    validate(lay)
+    return lay
+
+
+def validate(lay):
+    if lay.setup is None:
+        raise LayoutError('"setup" is missing')
+    if not lay.inputs or not lay.outputs:
+        raise LayoutError('at least one input and one output are required')
+    if len(lay.inputs) > 32:
+        raise LayoutError('more than 32 inputs are not supported')
+    pins = lay.inputs + lay.outputs
+    if len(set(pins)) != len(pins):
+        raise LayoutError('a GPIO is used more than once')
+    if 0 not in lay.layers:
+        raise LayoutError('layer 0 (default keymap) is missing')
+    nr_sets = max(lay.layers) + 1
+    for s in range(nr_sets):
+        rows = lay.layers.get(s)
+        if rows is None:
+            raise LayoutError('layer %d is missing' % s)
+        if len(rows) != len(lay.outputs):
+            raise LayoutError('layer %d: %d rows, expected %d' % (s, len(rows), len(lay.outputs)))
+        for r, row in enumerate(rows):
+            if len(row) != len(lay.inputs):
+                raise LayoutError('layer %d, row %d: %d keys, expected %d' % (s, r, len(row), len(lay.inputs)))
+    if lay.delayed_wakeup is not None:
+        r, c = lay.delayed_wakeup
+        if r >= len(lay.outputs) or c >= len(lay.inputs):
+            raise LayoutError('delayed_wakeup key is outside the matrix')
+    lens = set(len(k) for _, k, _ in lay.combos)
+    if len(lens) > 1:
+        raise LayoutError('all combos must have the same number of keys')
+    for action, keys, _ in lay.combos:
+        for o, i in keys:
+            if o >= len(lay.outputs) or i >= len(lay.inputs):
+                sys.stderr.write('warning: combo %s uses key (%d,%d) outside the matrix\n' % (action, o, i))
+
+
+def fmt_keycode(k):
+    if isinstance(k, str):
+        return '%-6s' % k
+    return '0x%04X' % k
+
+
+def legend(lines):
+    """The key legend comment of a layer, in the style of the hand-maintained setups."""
+    if not lines:
+        return []
+    o = ['/*' + lines[0]]
+    o.extend(lines[1:])
+    o[-1] += '*/'
+    return o
+
+
+def or_list(fmt, count, per_line, indent):
+    items = [fmt % i for i in range(count)]
+    lines = []
+    for n in range(0, count, per_line):
+        lines.append(' | '.join(items[n:n + per_line]))
+    return (' \\\n' + indent + '| ').join(lines)
+
+
+def gather_plan(lay):
+    """
+    Groups the inputs by (port, pin - scanword bit). All the inputs of a group
+    move by the same distance when the port data word is compressed into the
+    scanword, so each group costs one masked shift.
+    """
+    groups = {}
+    for j, (port, pin) in enumerate(lay.inputs):
+        groups.setdefault((port, pin - j), []).append(j)
+    return sorted(groups.items())
+
+
+def gen_gather(lay):
+    plan = gather_plan(lay)
+    nin = len(lay.inputs)
+    o = []
+    o.append('// Per-port input gather plan (%d masked shifts for %d inputs).' % (len(plan), nin))
+    o.append('// Each term keeps the bits of one port that move by the same distance and')
+    o.append('// compresses them into their scanword positions. Inputs that have been')
+    o.append('// remapped (CFG_PRINTF on a UART pin) are not connected and read as \'1\'.')
+    o.append('#define KBD_INPUT_GATHER_ONES (%s)' % or_list('SET_GATHER_ONE(%d)', nin, 4, '                               '))
+    o.append('')
+    terms = []
+    for (port, shift), cols in plan:
+        mask = ' | '.join('SET_GATHER_BIT(%d)' % j for j in cols)
+        if shift > 0:
+            op = ' >> %d' % shift
+        elif shift < 0:
+            op = ' << %d' % -shift
+        else:
+            op = ''
+        terms.append('(((in)[%d] & (%s))%s)' % (port, mask, op))
+    o.append('#define KBD_INPUT_GATHER(in)  ( KBD_INPUT_GATHER_ONES \\')
+    for n_, t in enumerate(terms):
+        tail = ' \\' if n_ < len(terms) - 1 else ' )'
+        o.append('                              | %s%s' % (t, tail))
+    o.append('')
+    return o
+
+
+def gen_matrix(lay, src):
+    n = lay.setup
+    guard = '_APP_KBD_MATRIX_SETUP_%d_H_' % n
+    nin = len(lay.inputs)
+    nout = len(lay.outputs)
+    nr_sets = max(lay.layers) + 1
+    ports_with_input = sorted(set(p for p, _ in lay.inputs))
+    o = []
+
+    o.append(COPYRIGHT % src)
+    o.append('')
+    o.append('#ifndef %s' % guard)
+    o.append('#define %s' % guard)
+    o.append('')
+    o.append('#include <stdint.h>')
+    o.append('#include <stddef.h>')
+    o.append('#include "app_kbd_macros.h"')
+    o.append('#include "da14580_config.h"')
+    o.append('')
+    o.append('/**')
+    o.append(' ****************************************************************************************')
+    o.append(' * @addtogroup APP')
+    o.append(' * @ingroup HID')
+    o.append(' *')
+    o.append(' * @brief HID (Keyboard) Application matrix of setup #%d (%s).' % (n, lay.title))
+    o.append(' *')
+    o.append(' * @{')
+    o.append(' ****************************************************************************************')
+    o.append(' */')
+    o.append('')
+    o.append('// the tables below are const and use the packed/sparse formats of the generator')
+    o.append('#define KBD_LAYOUT_GENERATED')
+    o.append('')
+    o.append('#if defined(HAS_I2C_EEPROM_STORAGE) || defined(HAS_SPI_FLASH_STORAGE)')
+    o.append('#define PAIR                (0xF4F1)')
+    o.append('#define CLRP                (0xF4F2)')
+    o.append('#else')
+    o.append('#define PAIR                (0x0000)')
+    o.append('#define CLRP                (0x0000)')
+    o.append('#endif')
+    o.append('')
+    o.append('#define KBD_NR_INPUTS       (%d)' % nin)
+    o.append('#define KBD_NR_OUTPUTS      (%d)' % nout)
+    o.append('')
+    for i, (port, pin) in enumerate(lay.inputs):
+        o.append('#define COLUMN_%d_PORT       (%d)' % (i, port))
+        o.append('#define COLUMN_%d_PIN        (%d)' % (i, pin))
+    o.append('')
+    o.append('// used for cycle optimization (only the ports that have inputs are read)')
+    for p in ports_with_input:
+        o.append('#define P%d_HAS_INPUT        (1)' % p)
+    o.append('')
+    for i, (port, pin) in enumerate(lay.outputs):
+        o.append('#define ROW_%d_PORT          (%d)' % (i, port))
+        o.append('#define ROW_%d_PIN           (%d)' % (i, pin))
+    o.append('')
+
+    ind = '                             '
+    o.append('// Masks for the initialization of the KBD controller')
+    o.append('#define MASK_P0             (0x4000 | %s)' % or_list('SET_MASK0_FROM_COLUMN(%d)', nin, 4, ind))
+    o.append('#define MASK_P12            (0x0000 | %s)' % or_list('SET_MASK12_FROM_COLUMN(%d)', nin, 4, ind))
+    o.append('#define MASK_P3             (0x0000 | %s)' % or_list('SET_MASK3_FROM_COLUMN(%d)', nin, 4, ind))
+    o.append('')
+    o.append('const uint16_t mask_p0 = MASK_P0;')
+    o.append('const uint16_t mask_p12 = MASK_P12;')
+    o.append('const uint16_t mask_p3 = MASK_P3;')
+    o.append('')
+    o.append('// Masks for the initialization of the WKUP controller')
+    for p in range(4):
+        o.append('#define WKUP_MASK_P%d        (%s)' % (p, or_list('SET_WKUP_MASK_FROM_COLUMN(%d, %%d)' % p, nin, 4, ind)))
+    o.append('')
+    for p in range(4):
+        o.append('const uint16_t wkup_mask_p%d = WKUP_MASK_P%d;' % (p, p))
+    o.append('')
+
+    def table(ctype, name, macro, count, comment=None):
+        o.append('const %s %s[] =' % (ctype, name))
+        o.append('{')
+        for i in range(count):
+            sep = ',' if i < count - 1 else ''
+            o.append('    %s(%d)%s' % (macro, i, sep))
+        o.append('};')
+        o.append('')
+
+    table('uint8_t', 'kbd_input_ports', 'COL', nin)
+    table('uint8_t', 'kbd_output_mode_regs', 'SET_OUTPUT_MODE_REG', nout)
+    table('uint8_t', 'kbd_output_reset_data_regs', 'SET_RESET_REG', nout)
+    table('uint16_t', 'kbd_out_bitmasks', 'SET_BITMAP', nout)
+    table('uint8_t', 'kbd_input_mode_regs', 'SET_INPUT_MODE_REG', nin)
+
+    o.extend(gen_gather(lay))
+
+    o.append('typedef int kbd_input_ports_check[ (sizeof(kbd_input_ports) / sizeof(uint8_t)) == KBD_NR_INPUTS];                   // on error: the kbd_input_ports[] is not defined properly!')
+    o.append('typedef int kbd_output_mode_regs_check[ (sizeof(kbd_output_mode_regs) / sizeof(uint8_t)) == KBD_NR_OUTPUTS];        // on error: the kbd_output_mode_regs[] is not defined properly!')
+    o.append('typedef int kbd_output_reset_regs_check[ (sizeof(kbd_output_reset_data_regs) / sizeof(uint8_t)) == KBD_NR_OUTPUTS]; // on error: the kbd_output_reset_data_regs[] is not defined properly!')
+    o.append('typedef int kbd_output_bitmasks_check[ (sizeof(kbd_out_bitmasks) / sizeof(uint16_t)) == KBD_NR_OUTPUTS];            // on error: the kbd_out_bitmasks[] is not defined properly!')
+    o.append('typedef int kbd_output_input_mode_regs_check[ (sizeof(kbd_input_mode_regs) / sizeof(uint8_t)) == KBD_NR_INPUTS];    // on error: the kbd_input_mode_regs[] is not defined properly!')
+    o.append('')
+
+    if lay.delayed_wakeup is not None:
+        o.append('#ifdef DELAYED_WAKEUP_ON')
+        o.append('#define DELAYED_WAKEUP_GPIO_ROW         (%d)' % lay.delayed_wakeup[0])
+        o.append('#define DELAYED_WAKEUP_GPIO_COLUMN      (%d)' % lay.delayed_wakeup[1])
+        o.append('#endif')
+        o.append('')
+
+    o.append("// extra sets for 'hidden modifiers', e.g. the 'Fn' key")
+    o.append('#define KBD_NR_SETS (%d)' % nr_sets)
+    o.append('')
+    o.append('// unknown key code - nothing is sent to the other side but the key is examined for ghosting')
+    o.append('#define K_CODE              (0xF4FF)')
+    o.append('')
+    o.append('')
+    o.append('// The key map.')
+    o.append('// 00xx means regular key')
+    o.append('// FCxx means modifier key.')
+    o.append('// F8xx means FN Modifier.')
+    o.append('// F4xy means special function (x = no of byte in the report, y no of bit set).')
+    o.append('')
+    o.append('// Default keymap (set #0), dense: every key of the matrix')
+    o.append('const uint16_t kbd_keymap_base[KBD_NR_OUTPUTS][KBD_NR_INPUTS] =')
+    o.append('{')
+    base = lay.layers[0]
+    o.extend(legend(lay.legends[0]))
+    for r, row in enumerate(base):
+        sep = ',' if r < nout - 1 else ' '
+        o.append('    { %s }%s // ROW%d' % (', '.join(fmt_keycode(k) for k in row), sep, r))
+    o.append('};')
+    o.append('')
+
+    if nr_sets > 1:
+        entries = []
+        starts = [0]
+        for s in range(1, nr_sets):
+            for r in range(nout):
+                for c in range(nin):
+                    k = lay.layers[s][r][c]
+                    if k != base[r][c]:
+                        entries.append((r, c, k))
+            starts.append(len(entries))
+        if len(entries) > 255:
+            raise LayoutError('too many Fn layer entries (%d)' % len(entries))
+        o.append('// Fn keymaps (sets #1..#%d), sparse: only the keys that differ from set #0,' % (nr_sets - 1))
+        o.append('// sorted by intersection within each set')
+        o.append('const struct kbd_keymap_entry_t kbd_keymap_layers[] =')
+        o.append('{')
+        for n_, (r, c, k) in enumerate(entries):
+            sep = ',' if n_ < len(entries) - 1 else ''
+            o.append('    { 0x%02X%02X, %s }%s' % (r, c, fmt_keycode(k).strip(), sep))
+        if not entries:
+            o.append('    { 0xFFFF, 0x0000 }')
+        o.append('};')
+        o.append('')
+        o.append('// set #N occupies kbd_keymap_layers[kbd_keymap_layer_start[N-1] .. kbd_keymap_layer_start[N]-1]')
+        o.append('const uint8_t kbd_keymap_layer_start[KBD_NR_SETS] =')
+        o.append('{')
+        o.append('    ' + ', '.join('%d' % v for v in starts))
+        o.append('};')
+        o.append('')
+
+    if lay.combos:
+        nkeys = len(lay.combos[0][1])
+        o.append('#ifdef %s' % lay.combo_guard)
+        o.append('')
+        o.append('typedef int multi_key_num_of_keys_check[MULTI_KEY_NUM_OF_KEYS == %d];   // on error: the layout combos do not match MULTI_KEY_NUM_OF_KEYS!' % nkeys)
+        o.append('')
+        o.append('enum {')
+        for i, (action, _, _) in enumerate(lay.combos):
+            sep = ',' if i < len(lay.combos) - 1 else ''
+            o.append('    MULTI_KEY_ACTION_%s%s' % (action, sep))
+        o.append('};')
+        o.append('')
+        o.append('const struct multi_key_combinations_t multi_key_combinations[] = {')
+        for i, (action, keys, comment) in enumerate(lay.combos):
+            sep = ',' if i < len(lay.combos) - 1 else ''
+            ks = ','.join('{%d,%d}' % k for k in keys)
+            entry = '    {{%s},  MULTI_KEY_ACTION_%s}%s' % (ks, action, sep)
+            o.append(('%-56s // %s' % (entry, comment)) if comment else entry)
+        o.append('};')
+        o.append('#endif')
+        o.append('')
+
+    o.append('/// @} APP')
+    o.append('')
+    o.append('#endif //%s' % guard)
+    return '\n'.join(o) + '\n'
+
+
+def gen_key_matrix(lay, src):
+    n = lay.setup
+    guard = '_APP_KBD_KEY_MATRIX_SETUP_%d_H_' % n
+    o = []
+    o.append(COPYRIGHT % src)
+    o.append('')
+    o.append('#ifndef %s' % guard)
+    o.append('    #define %s' % guard)
+    o.append('')
+    o.append('/**')
+    o.append(' ****************************************************************************************')
+    o.append(' * @addtogroup APP')
+    o.append(' * @ingroup HID')
+    o.append(' *')
+    o.append(' * @brief HID (Keyboard) Application GPIO reservations for the matrix of setup #%d.' % n)
+    o.append(' *')
+    o.append(' * @{')
+    o.append(' ****************************************************************************************')
+    o.append(' */')
+    o.append('')
+    o.append('/**')
+    o.append(' * \\brief Reserve GPIO pins for keyboard usage')
+    o.append(' */')
+    o.append('__INLINE void declare_keyboard_gpios()')
+    o.append('{')
+    for i, (port, pin) in enumerate(lay.inputs):
+        o.append('    RESERVE_GPIO(%-17s GPIO_PORT_%d, GPIO_PIN_%d, PID_GPIO);' % ('INPUT_COL_%d,' % i, port, pin))
+    for i, (port, pin) in enumerate(lay.outputs):
+        o.append('    RESERVE_GPIO(%-17s GPIO_PORT_%d, GPIO_PIN_%d, PID_GPIO);' % ('OUTPUT_ROW_%d,' % i, port, pin))
+    o.append('}')
+    o.append('')
+    o.append('/// @} APP')
+    o.append('')
+    o.append('#endif //%s' % guard)
+    return '\n'.join(o) + '\n'
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.stderr.write(__doc__)
+        return 2
+    path = argv[1]
+    outdir = argv[2] if len(argv) > 2 else '.'
+    try:
+        lay = parse(path)
+    except LayoutError as e:
+        sys.stderr.write('%s: %s\n' % (path, e))
+        return 1
+
+    src = 'misc/kbd_matrix_gen/layouts/' + os.path.basename(path)
+    files = {
+        'app_kbd_matrix_setup_%d.h' % lay.setup: gen_matrix(lay, src),
+        'app_kbd_key_matrix_setup_%d.h' % lay.setup: gen_key_matrix(lay, src),
+    }
+    for name, text in sorted(files.items()):
+        with open(os.path.join(outdir, name), 'w', newline='\n') as f:
+            f.write(text)
+        print('generated %s' % os.path.join(outdir, name))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
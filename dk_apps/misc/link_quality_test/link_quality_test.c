@@ -0,0 +1,196 @@
+/**
+ ****************************************************************************************
+ *
+ * @file link_quality_test.c
+ *
+ * @brief Test of the link quality monitor (ip/ble/ll/src/rwble/rwble_link_quality.c) with
+ *        synthetic traces, on the host.
+ *
+ * The test feeds rwble_lq_rx() and rwble_lq_evt_end() as the BLE interrupt handlers do:
+ * a 7.5ms interval (12 slots), 1 to 3 packets per event and a supervision timeout of 2s.
+ * Before the onset of a fault the link has 2% of CRC errors. After it, the packets have
+ * CRC errors, the anchors are missed, the packets are retransmissions (NESN error), or
+ * nothing is received at all. Each trace runs with PHASES onsets, one event apart, so that
+ * the onset falls at each point of a window.
+ *
+ * For each trace the test prints the events from the onset to the first FAIR or POOR
+ * state, the traces detected POOR at once and the false alarms before the onsets. It
+ * checks that:
+ *   - the clean link is GOOD at most onsets (a false alarm may still be in progress);
+ *   - the faults above the FAIR thresholds are always detected;
+ *   - a blackout is POOR before a quarter of the supervision timeout;
+ *   - each change of state sets APP_EVENT_LINK_QUALITY.
+ *
+ * Build and run from this directory:
+ *   cc -Istub -I../../src/ip/ble/ll/src/rwble -I../../src/modules/app/src/app_project/remote_audio/system \
+ *      link_quality_test.c ../../src/ip/ble/ll/src/rwble/rwble_link_quality.c -o link_quality_test
+ *   ./link_quality_test
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include "rwip_config.h"
+#include "reg_ble_em_rx.h"
+#include "rwble_link_quality.h"
+#include "app_event.h"
+
+#define CONHDL          (0)
+#define SLOTS_PER_EVT   (12)
+#define SUP_TO          (200)               // 10ms units
+#define ONSET           (2000)              // clean events before the first onset
+#define PHASES          (64)
+#define FAULT_EVENTS    (2000)
+#define BACKGROUND_PER  (0.02)
+
+struct trace
+{
+    const char *name;
+    double per;
+    double missed;
+    double retx;
+    bool blackout;
+    bool must_detect;
+};
+
+volatile uint32_t app_event_field;
+
+static int failures;
+
+static unsigned rnd(void)
+{
+    static unsigned seed = 12345;
+
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) & 0x7FFF;
+}
+
+static bool chance(double p)
+{
+    return rnd() < p * 32768;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Runs a trace with its onset after the given number of events.
+ *
+ * @param[out] state    The first state other than GOOD after the onset
+ * @param[out] alarms   The states other than GOOD entered before the onset
+ * @param[in,out] not_good  Incremented if the state is not GOOD at the onset
+ *
+ * @return The events from the onset to the detection, -1 if not detected
+ ****************************************************************************************
+ */
+static int run(const struct trace *t, int onset, uint8_t *state, int *alarms, int *not_good)
+{
+    struct rwble_lq_info info;
+    uint8_t prev = RWBLE_LQ_GOOD;
+    uint32_t now = 0;
+    int e, n, i, detect = -1;
+    uint16_t status;
+    bool fault;
+
+    *alarms = 0;
+    rwble_lq_reset(CONHDL);
+    app_event_field = 0;
+
+    for (e = 0; e < onset + FAULT_EVENTS; e++, now += SLOTS_PER_EVT) {
+        fault = (e >= onset);
+        n = 1 + rnd() % 3;
+        if (fault && (t->blackout || chance(t->missed))) {
+            n = 0;
+        }
+        for (i = 0; i < n; i++) {
+            status = 0;
+            if (fault && chance(t->per)) {
+                status = BLE_CRC_ERR_BIT;
+            } else if (fault && chance(t->retx)) {
+                status = BLE_NESN_ERR_BIT;
+            } else if (!fault && chance(BACKGROUND_PER)) {
+                status = BLE_CRC_ERR_BIT;
+            }
+            rwble_lq_rx(CONHDL, status);
+        }
+        rwble_lq_evt_end(CONHDL, now, SUP_TO);
+
+        rwble_lq_get(CONHDL, &info);
+        if ((info.state != prev) && !app_event_take(APP_EVENT_LINK_QUALITY)) {
+            printf("FAIL %s: change of state without APP_EVENT_LINK_QUALITY\n", t->name);
+            failures++;
+        }
+        if (!fault && (info.state != RWBLE_LQ_GOOD) && (prev == RWBLE_LQ_GOOD)) {
+            (*alarms)++;
+        }
+        prev = info.state;
+
+        if ((e == onset - 1) && (info.state != RWBLE_LQ_GOOD)) {
+            (*not_good)++;
+        }
+        if (fault && (detect < 0) && (info.state != RWBLE_LQ_GOOD)) {
+            detect = e - onset;
+            *state = info.state;
+        }
+    }
+    return detect;
+}
+
+int main(void)
+{
+    static const struct trace traces[] = {
+        {"CRC 15%",                 0.15, 0,    0,   false, true},
+        {"CRC 40%",                 0.40, 0,    0,   false, true},
+        {"missed 15%",              0,    0.15, 0,   false, true},
+        {"missed 50%",              0,    0.50, 0,   false, true},
+        {"retx 30%",                0,    0,    0.3, false, true},
+        {"retx 60%",                0,    0,    0.6, false, true},
+        {"blackout",                0,    0,    0,   true,  true},
+        {"CRC 5% (below FAIR)",     0.05, 0,    0,   false, false},
+    };
+    unsigned i;
+    int ph, d, sum, max, undetected, poor, alarms, a, not_good;
+    uint8_t state;
+
+    printf("%-22s %-24s %-12s %s\n", "trace", "detected after (events)", "POOR first", "false alarms");
+    for (i = 0; i < sizeof(traces) / sizeof(traces[0]); i++) {
+        sum = max = undetected = poor = alarms = not_good = 0;
+        for (ph = 0; ph < PHASES; ph++) {
+            d = run(&traces[i], ONSET + ph, &state, &a, &not_good);
+            alarms += a;
+            if (d < 0) {
+                undetected++;
+                continue;
+            }
+            sum += d;
+            max = (d > max) ? d : max;
+            poor += (state == RWBLE_LQ_POOR);
+        }
+
+        printf("%-22s avg %5.1f / max %4d     %2d/%d        %d", traces[i].name,
+               (undetected < PHASES) ? (double)sum / (PHASES - undetected) : 0.0, max, poor, PHASES, alarms);
+        printf(undetected ? ", %d/%d undetected\n" : "\n", undetected, PHASES);
+
+        if (not_good > PHASES / 8) {
+            printf("FAIL %s: the clean link is not GOOD at %d onsets\n", traces[i].name, not_good);
+            failures++;
+        }
+        if (traces[i].must_detect && undetected) {
+            printf("FAIL %s: not detected\n", traces[i].name);
+            failures++;
+        }
+        // a quarter of the supervision timeout, in events
+        if (traces[i].blackout && ((max + 1) * SLOTS_PER_EVT > SUP_TO * 4)) {
+            printf("FAIL %s: not POOR within a quarter of the supervision timeout\n", traces[i].name);
+            failures++;
+        }
+    }
+
+    printf(failures ? "%d failed\n" : "ok\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,32 @@
+/**
+ ****************************************************************************************
+ *
+ * @file arch.h
+ *
+ * @brief Host stand-in of arch.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef ARCH_H_
+#define ARCH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define zero_init
+#define __INLINE                static inline
+
+#define GLOBAL_INT_DISABLE()
+#define GLOBAL_INT_RESTORE()
+#define GLOBAL_INT_STOP()
+#define GLOBAL_INT_START()
+
+#endif // ARCH_H_
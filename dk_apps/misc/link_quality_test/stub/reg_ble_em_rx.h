@@ -0,0 +1,29 @@
+/**
+ ****************************************************************************************
+ *
+ * @file reg_ble_em_rx.h
+ *
+ * @brief Host stand-in of reg_ble_em_rx.h: the bits of the RX status.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef REG_BLE_EM_RX_H_
+#define REG_BLE_EM_RX_H_
+
+#define BLE_NESN_ERR_BIT        ((uint16_t)0x00000040)
+#define BLE_SN_ERR_BIT          ((uint16_t)0x00000020)
+#define BLE_MIC_ERR_BIT         ((uint16_t)0x00000010)
+#define BLE_CRC_ERR_BIT         ((uint16_t)0x00000008)
+#define BLE_LEN_ERR_BIT         ((uint16_t)0x00000004)
+#define BLE_TYPE_ERR_BIT        ((uint16_t)0x00000002)
+#define BLE_SYNC_ERR_BIT        ((uint16_t)0x00000001)
+
+#endif // REG_BLE_EM_RX_H_
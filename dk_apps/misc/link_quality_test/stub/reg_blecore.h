@@ -0,0 +1,23 @@
+/**
+ ****************************************************************************************
+ *
+ * @file reg_blecore.h
+ *
+ * @brief Host stand-in of reg_blecore.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef REG_BLECORE_H_
+#define REG_BLECORE_H_
+
+#define BLE_BASETIMECNT_MASK    ((uint32_t)0x07FFFFFF)
+
+#endif // REG_BLECORE_H_
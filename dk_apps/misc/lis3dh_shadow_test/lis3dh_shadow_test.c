@@ -0,0 +1,492 @@
+/**
+ ****************************************************************************************
+ *
+ * @file lis3dh_shadow_test.c
+ *
+ * @brief Host test of the register shadow, the burst configuration and the FIFO stream of
+ *        the LIS3DH driver (driver/accel/lis3dh_driver.c), against a model of the SPI
+ *        block and of the sensor.
+ *
+ * The SPI model follows the 8 and 16 bit modes of SPI_CTRL_REG and counts a transaction
+ * for every frame with the chip select (P0_6) low, and the bytes clocked in it. The
+ * LIS3DH model decodes the command byte (read, address auto-increment, address), ignores
+ * the writes to its read-only registers, clears BOOT by itself and keeps a 32 sample FIFO
+ * in stream mode: OUT_X_L to OUT_Z_H give the oldest sample, which is popped by the read
+ * of OUT_Z_H, and the auto-increment wraps from OUT_Z_H back to OUT_X_L while the FIFO is
+ * enabled.
+ *
+ * The test checks that
+ * - LIS3DH_ShadowInit() reads the shadowed registers in one burst per run,
+ * - the same configuration gives the same registers without the shadow, with the shadow
+ *   and between LIS3DH_ConfigBegin() and LIS3DH_ConfigCommit(), and costs nothing the
+ *   second time,
+ * - BOOT is written at once, even inside a configuration change,
+ * - LIS3DH_FifoStreamStart() / LIS3DH_FifoStreamStop() set and clear the FIFO bits and
+ *   LIS3DH_FifoDrain() returns the samples in order, on overrun too.
+ * It prints the SPI transactions and bytes of each way.
+ *
+ * No project of this tree builds the driver (BLE_ACCEL is not set by any application),
+ * so this test is where it is compiled.
+ *
+ * Build and run from this directory:
+ *   cc -Istub -I../../src/plf/refip/src/driver/accel lis3dh_shadow_test.c -o lis3dh_shadow_test
+ *   ./lis3dh_shadow_test
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define zero_init                       // Keil only
+#include "lis3dh_driver.c"
+
+#define WHO_AM_I_VALUE                  (0x33)
+#define FIFO_SIZE                       (32)
+#define CS_PIN                          (1 << 6)
+
+enum config_way
+{
+    NO_SHADOW,
+    SHADOW,
+    BURST,
+    NR_WAYS,
+};
+
+static const char *way_names[NR_WAYS] = {"no shadow", "shadow", "begin/commit"};
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAIL %s\n", what);
+        failures++;
+    }
+}
+
+/*
+ * LIS3DH MODEL
+ ****************************************************************************************
+ */
+
+static struct
+{
+    uint8_t reg[0x40];
+    AxesRaw_t fifo[FIFO_SIZE];
+    int count;
+    AxesRaw_t last;                     // output registers while the FIFO is off
+    int boots;
+
+    // current SPI frame
+    int pos;
+    uint8_t addr;
+    bool read, inc;
+} dev;
+
+static bool dev_fifo_on(void)
+{
+    return (dev.reg[LIS3DH_CTRL_REG5] & (1 << LIS3DH_FIFO_EN)) &&
+           (dev.reg[LIS3DH_FIFO_CTRL_REG] >> LIS3DH_FM);
+}
+
+static void dev_reset(void)
+{
+    memset(&dev, 0, sizeof(dev));
+    dev.reg[LIS3DH_WHO_AM_I] = WHO_AM_I_VALUE;
+    dev.reg[LIS3DH_CTRL_REG1] = 0x07;   // power-on value: all axes, power down
+}
+
+static void dev_push(const AxesRaw_t *s)
+{
+    dev.last = *s;
+    if (!dev_fifo_on()) {
+        return;
+    }
+    if (dev.count == FIFO_SIZE) {
+        memmove(&dev.fifo[0], &dev.fifo[1], (FIFO_SIZE - 1) * sizeof(AxesRaw_t));  // stream: drop the oldest
+        dev.count--;
+    }
+    dev.fifo[dev.count++] = *s;
+}
+
+static uint8_t dev_read(uint8_t addr)
+{
+    if ((addr >= LIS3DH_OUT_X_L) && (addr <= LIS3DH_OUT_Z_H)) {
+        const AxesRaw_t *s = (dev_fifo_on() && dev.count) ? &dev.fifo[0] : &dev.last;
+        const uint8_t val = ((const uint8_t *)s)[addr - LIS3DH_OUT_X_L];
+
+        if ((addr == LIS3DH_OUT_Z_H) && dev_fifo_on() && dev.count) {
+            memmove(&dev.fifo[0], &dev.fifo[1], (FIFO_SIZE - 1) * sizeof(AxesRaw_t));
+            dev.count--;
+        }
+        return val;
+    }
+    if (addr == LIS3DH_FIFO_SRC_REG) {
+        return ((dev.count > (dev.reg[LIS3DH_FIFO_CTRL_REG] & 0x1F)) ? LIS3DH_FIFO_SRC_WTM : 0) |
+               ((dev.count == FIFO_SIZE) ? LIS3DH_FIFO_SRC_OVRUN : 0) |
+               ((dev.count == 0) ? LIS3DH_FIFO_SRC_EMPTY : 0) |
+               (dev.count & 0x1F);
+    }
+    return dev.reg[addr];
+}
+
+static void dev_write(uint8_t addr, uint8_t val)
+{
+    if (((addr >= 0x07) && (addr <= LIS3DH_WHO_AM_I)) ||
+        ((addr >= LIS3DH_STATUS_REG) && (addr <= LIS3DH_OUT_Z_H)) ||
+        (addr == LIS3DH_FIFO_SRC_REG) || (addr == LIS3DH_INT1_SRC) || (addr == LIS3DH_CLICK_SRC)) {
+        return;                         // read-only
+    }
+    if ((addr == LIS3DH_CTRL_REG5) && (val & (1 << LIS3DH_BOOT))) {
+        dev.boots++;
+        val &= ~(1 << LIS3DH_BOOT);
+    }
+    dev.reg[addr] = val;
+    if (!dev_fifo_on()) {
+        dev.count = 0;                  // bypass mode empties the FIFO
+    }
+}
+
+static uint8_t dev_byte(uint8_t in)
+{
+    uint8_t out = 0xFF;
+
+    if (dev.pos++ == 0) {
+        dev.read = (in & LIS3DH_SPI_READ) != 0;
+        dev.inc = (in & LIS3DH_SPI_INC) != 0;
+        dev.addr = in & 0x3F;
+        return out;
+    }
+
+    if (dev.read) {
+        out = dev_read(dev.addr);
+    } else {
+        dev_write(dev.addr, in);
+    }
+    if (dev.inc) {
+        if ((dev.addr == LIS3DH_OUT_Z_H) && dev_fifo_on()) {
+            dev.addr = LIS3DH_OUT_X_L;
+        } else {
+            dev.addr = (dev.addr + 1) & 0x3F;
+        }
+    }
+    return out;
+}
+
+/*
+ * SPI AND GPIO MODEL
+ ****************************************************************************************
+ */
+
+static uint16_t spi_ctrl, spi_rx;
+static bool cs_low;
+static long transactions, spi_bytes;
+
+static int mask_shift(uint16_t mask)
+{
+    int shift = 0;
+
+    while (!(mask & (1 << shift))) {
+        shift++;
+    }
+    return shift;
+}
+
+uint16_t GetWord16(uint32_t addr)
+{
+    if (addr == SPI_CTRL_REG) {
+        return spi_ctrl;
+    }
+    if (addr == SPI_RX_TX_REG0) {
+        return spi_rx;
+    }
+    return 0;
+}
+
+void SetWord16(uint32_t addr, uint16_t value)
+{
+    switch (addr) {
+    case SPI_RX_TX_REG0:
+        check(cs_low && (spi_ctrl & SPI_ON), "SPI word without chip select or SPI_ON");
+        if (GetBits16(SPI_CTRL_REG, SPI_WORD) == 1) {
+            const uint8_t hi = dev_byte(value >> 8);
+
+            spi_rx = (hi << 8) | dev_byte(value & 0xFF);
+            spi_bytes += 2;
+        } else {
+            spi_rx = dev_byte(value & 0xFF);
+            spi_bytes++;
+        }
+        spi_ctrl |= SPI_INT_BIT;
+        break;
+    case SPI_CLEAR_INT_REG:
+        spi_ctrl &= ~SPI_INT_BIT;
+        break;
+    case P0_RESET_DATA_REG:
+        if ((value & CS_PIN) && !cs_low) {
+            cs_low = true;
+            dev.pos = 0;
+            transactions++;
+        }
+        break;
+    case P0_SET_DATA_REG:
+        if (value & CS_PIN) {
+            cs_low = false;
+        }
+        break;
+    case SPI_CTRL_REG:
+        spi_ctrl = value;
+        break;
+    }
+}
+
+uint16_t GetBits16(uint32_t addr, uint16_t mask)
+{
+    return (GetWord16(addr) & mask) >> mask_shift(mask);
+}
+
+void SetBits16(uint32_t addr, uint16_t mask, uint16_t value)
+{
+    if (addr == SPI_CTRL_REG) {
+        spi_ctrl = (spi_ctrl & ~mask) | ((value << mask_shift(mask)) & mask);
+    }
+}
+
+/*
+ * TESTS
+ ****************************************************************************************
+ */
+
+static void counters_reset(void)
+{
+    transactions = 0;
+    spi_bytes = 0;
+}
+
+static bool shadow_matches_device(void)
+{
+    int reg;
+
+    for (reg = LIS3DH_SHADOW_FIRST; reg <= LIS3DH_SHADOW_LAST; reg++) {
+        if (LIS3DH_IS_SHADOWED(reg) && (LIS3DH_Shadow[reg - LIS3DH_SHADOW_FIRST] != dev.reg[reg])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ ****************************************************************************************
+ * @brief The configuration of a motion remote: 100 Hz normal mode, +-4g, any-motion and
+ *        click interrupts on INT1.
+ ****************************************************************************************
+ */
+static void config_sequence(void)
+{
+    LIS3DH_SetODR(LIS3DH_ODR_100Hz);
+    LIS3DH_SetMode(LIS3DH_NORMAL);
+    LIS3DH_SetFullScale(LIS3DH_FULLSCALE_4);
+    LIS3DH_SetAxis(LIS3DH_X_ENABLE | LIS3DH_Y_ENABLE | LIS3DH_Z_ENABLE);
+    LIS3DH_SetBDU(MEMS_ENABLE);
+    LIS3DH_SetInt1Threshold(20);
+    LIS3DH_SetInt1Duration(2);
+    LIS3DH_SetIntConfiguration(LIS3DH_INT1_ZHIE_ENABLE | LIS3DH_INT1_XHIE_ENABLE);
+    LIS3DH_SetIntMode(LIS3DH_INT_MODE_OR);
+    LIS3DH_SetInt1Pin(LIS3DH_CLICK_ON_PIN_INT1_ENABLE | LIS3DH_I1_INT1_ON_PIN_INT1_ENABLE);
+    LIS3DH_SetClickCFG(LIS3DH_ZS_ENABLE);
+    LIS3DH_SetClickTHS(40);
+    LIS3DH_SetClickLIMIT(10);
+    LIS3DH_SetClickLATENCY(20);
+    LIS3DH_SetClickWINDOW(60);
+}
+
+static void run_config(enum config_way way)
+{
+    if (way == BURST) {
+        check(LIS3DH_ConfigBegin() == MEMS_SUCCESS, "ConfigBegin");
+    }
+    config_sequence();
+    if (way == BURST) {
+        check(LIS3DH_ConfigCommit() == MEMS_SUCCESS, "ConfigCommit");
+    }
+}
+
+static AxesRaw_t sample(int i)
+{
+    AxesRaw_t s;
+
+    s.AXIS_X = (i16_t)(100 * i + 1);
+    s.AXIS_Y = (i16_t)(-100 * i - 2);
+    s.AXIS_Z = (i16_t)(0x1000 + 7 * i);
+    return s;
+}
+
+static bool samples_equal(const AxesRaw_t *buf, int first, int nb)
+{
+    int i;
+
+    for (i = 0; i < nb; i++) {
+        const AxesRaw_t s = sample(first + i);
+
+        if (memcmp(&buf[i], &s, sizeof(s))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void push_samples(int first, int nb)
+{
+    int i;
+
+    for (i = 0; i < nb; i++) {
+        const AxesRaw_t s = sample(first + i);
+
+        dev_push(&s);
+    }
+}
+
+static void test_config(void)
+{
+    uint8_t regs[NR_WAYS][LIS3DH_SHADOW_SIZE];
+    long way_transactions[NR_WAYS], way_bytes[NR_WAYS];
+    enum config_way way;
+    u8_t who = 0;
+
+    dev_reset();
+    counters_reset();
+    check(LIS3DH_ShadowInit() == MEMS_SUCCESS, "ShadowInit");
+    check(transactions == 6, "ShadowInit is not one burst per run of shadowed registers");
+    check(shadow_matches_device(), "shadow after ShadowInit");
+    LIS3DH_GetWHO_AM_I(&who);
+    check(who == WHO_AM_I_VALUE, "WHO_AM_I");
+
+    for (way = NO_SHADOW; way < NR_WAYS; way++) {
+        dev_reset();
+        if (way == NO_SHADOW) {
+            LIS3DH_ShadowValid = 0;
+            check(LIS3DH_ConfigBegin() == MEMS_ERROR, "ConfigBegin without the shadow");
+        } else {
+            LIS3DH_ShadowInit();
+        }
+        counters_reset();
+        run_config(way);
+        way_transactions[way] = transactions;
+        way_bytes[way] = spi_bytes;
+        memcpy(regs[way], &dev.reg[LIS3DH_SHADOW_FIRST], LIS3DH_SHADOW_SIZE);
+
+        if (way != NO_SHADOW) {
+            check(shadow_matches_device(), "shadow after the configuration");
+            counters_reset();
+            run_config(way);
+            check(transactions == 0, "the same configuration again is not free");
+        }
+        if (memcmp(regs[way], regs[NO_SHADOW], LIS3DH_SHADOW_SIZE)) {
+            printf("FAIL registers of '%s' differ from '%s'\n", way_names[way], way_names[NO_SHADOW]);
+            failures++;
+        }
+    }
+    check(dev.reg[LIS3DH_CTRL_REG1] == 0x57, "CTRL_REG1");
+    check(dev.reg[LIS3DH_CTRL_REG4] == 0x98, "CTRL_REG4");
+    check(dev.reg[LIS3DH_TIME_WINDOW] == 60, "TIME_WINDOW");
+
+    printf("%-14s %-13s %s\n", "configuration", "transactions", "bytes");
+    for (way = NO_SHADOW; way < NR_WAYS; way++) {
+        printf("%-14s %-13ld %ld\n", way_names[way], way_transactions[way], way_bytes[way]);
+    }
+}
+
+static void test_boot(void)
+{
+    u8_t value;
+
+    LIS3DH_ConfigBegin();
+    counters_reset();
+    LIS3DH_ReadReg(LIS3DH_CTRL_REG5, &value);
+    LIS3DH_WriteReg(LIS3DH_CTRL_REG5, value | (MEMS_SET << LIS3DH_BOOT));
+    check((transactions == 1) && (dev.boots == 1), "BOOT is not written at once");
+    LIS3DH_ConfigCommit();
+    check(transactions == 1, "BOOT written again by ConfigCommit");
+    LIS3DH_ReadReg(LIS3DH_CTRL_REG5, &value);
+    check(!(value & (MEMS_SET << LIS3DH_BOOT)), "BOOT kept in the shadow");
+}
+
+static void test_fifo(void)
+{
+    AxesRaw_t buf[FIFO_SIZE];
+    u8_t src;
+    long start_transactions, drain_transactions, drain_bytes;
+    int i;
+
+    counters_reset();
+    check(LIS3DH_FifoStreamStart(16) == MEMS_SUCCESS, "FifoStreamStart");
+    start_transactions = transactions;
+    check(LIS3DH_FifoStreamStart(0) == MEMS_ERROR, "FifoStreamStart(0)");
+    check((dev.reg[LIS3DH_CTRL_REG5] & (1 << LIS3DH_FIFO_EN)) &&
+          (dev.reg[LIS3DH_CTRL_REG3] & LIS3DH_WTM_ON_INT1_ENABLE) &&
+          (dev.reg[LIS3DH_FIFO_CTRL_REG] == ((LIS3DH_FIFO_STREAM_MODE << LIS3DH_FM) | 16)),
+          "registers after FifoStreamStart");
+    check(shadow_matches_device(), "shadow after FifoStreamStart");
+
+    // above the watermark
+    push_samples(0, 20);
+    counters_reset();
+    check(LIS3DH_FifoDrain(buf, FIFO_SIZE, &src) == 20, "drain of 20 samples");
+    drain_transactions = transactions;
+    drain_bytes = spi_bytes;
+    check(src & LIS3DH_FIFO_SRC_WTM, "FIFO_SRC without WTM");
+    check(samples_equal(buf, 0, 20), "samples of the drain");
+    check(transactions == 2, "drain is not 2 transactions");
+
+    // the same samples one by one
+    push_samples(0, 20);
+    counters_reset();
+    for (i = 0; i < 20; i++) {
+        LIS3DH_GetAccAxesRaw(&buf[i]);
+    }
+    check(samples_equal(buf, 0, 20), "samples of GetAccAxesRaw");
+    printf("%-14s %-13s %s\n", "20 samples", "transactions", "bytes");
+    printf("%-14s %-13ld %ld\n", "FifoDrain", drain_transactions, drain_bytes);
+    printf("%-14s %-13ld %ld\n", "GetAccAxesRaw", transactions, spi_bytes);
+    printf("FifoStreamStart: %ld transactions\n", start_transactions);
+
+    // overrun: the oldest samples are lost
+    push_samples(0, 40);
+    check(LIS3DH_FifoDrain(buf, FIFO_SIZE, &src) == FIFO_SIZE, "drain after overrun");
+    check(src & LIS3DH_FIFO_SRC_OVRUN, "FIFO_SRC without OVRUN");
+    check(samples_equal(buf, 40 - FIFO_SIZE, FIFO_SIZE), "samples after overrun");
+
+    // empty, then a buffer smaller than the FIFO content
+    counters_reset();
+    check(LIS3DH_FifoDrain(buf, FIFO_SIZE, &src) == 0, "drain of the empty FIFO");
+    check((transactions == 1) && (src & LIS3DH_FIFO_SRC_EMPTY), "empty FIFO");
+    push_samples(0, 10);
+    check((LIS3DH_FifoDrain(buf, 4, &src) == 4) && samples_equal(buf, 0, 4), "drain of 4 out of 10");
+    check((LIS3DH_FifoDrain(buf, FIFO_SIZE, &src) == 6) && samples_equal(buf, 4, 6), "drain of the 6 left");
+
+    check(LIS3DH_FifoStreamStop() == MEMS_SUCCESS, "FifoStreamStop");
+    check(!(dev.reg[LIS3DH_CTRL_REG5] & (1 << LIS3DH_FIFO_EN)) &&
+          !(dev.reg[LIS3DH_CTRL_REG3] & LIS3DH_WTM_ON_INT1_ENABLE) &&
+          !(dev.reg[LIS3DH_FIFO_CTRL_REG] >> LIS3DH_FM),
+          "registers after FifoStreamStop");
+    check(shadow_matches_device(), "shadow after FifoStreamStop");
+}
+
+int main(void)
+{
+    test_config();
+    test_boot();
+    test_fifo();
+
+    printf("%s\n", failures ? "" : "ok");
+    return failures != 0;
+}
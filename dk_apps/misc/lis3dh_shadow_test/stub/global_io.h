@@ -0,0 +1,43 @@
+/**
+ ****************************************************************************************
+ *
+ * @file global_io.h
+ *
+ * @brief Host stand-in of global_io.h, for lis3dh_driver.c. The registers are
+ *        accessed through the SPI and GPIO model of lis3dh_shadow_test.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef IO_H_INCLUDED
+#define IO_H_INCLUDED
+
+#include <stdint.h>
+
+#define SPI_CTRL_REG                    (0x50001200)
+#define SPI_RX_TX_REG0                  (0x50001202)
+#define SPI_CLEAR_INT_REG               (0x50001206)
+#define P0_SET_DATA_REG                 (0x50003002)
+#define P0_RESET_DATA_REG               (0x50003004)
+
+// fields of SPI_CTRL_REG
+#define SPI_ON                          (0x0001)
+#define SPI_PHA                         (0x0002)
+#define SPI_POL                         (0x0004)
+#define SPI_CLK                         (0x0018)
+#define SPI_WORD                        (0x0180)
+#define SPI_INT_BIT                     (0x2000)
+
+uint16_t GetWord16(uint32_t addr);
+void SetWord16(uint32_t addr, uint16_t value);
+uint16_t GetBits16(uint32_t addr, uint16_t mask);
+void SetBits16(uint32_t addr, uint16_t mask, uint16_t value);
+
+#endif // IO_H_INCLUDED
@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""
+Main loop model of remote_audio: passes per second and time to WFI.
+
+Compares three versions of the main loop of arch_main.c:
+
+    polled      the hooks run every pass: app_asynch_trm(), app_asynch_proc()
+                (fsm_scan_update(), the BLE wakeup checks, delayed_start_proc()),
+                app_audio439_encode(8), stream_queue_more_data() and
+                app_asynch_sleep_proc(). sleep_mode is mode_active: no WFI.
+    dispatch    the handlers run only when their event is set in app_event_field
+                (system/app_event.h). Still mode_active: no WFI.
+    dispatch+wfi  as dispatch; when no kernel and no app event is pending the
+                CPU halts until the next interrupt (app_asynch_idle_check(),
+                mode_idle) while the BLE core stays up.
+
+The interrupts of a scenario (end of BLE event, SysTick of the key scanning,
+audio blocks) each set the events they would set on target. A pass costs the
+fixed part of the loop plus the handlers it runs; with WFI the CPU runs one
+pass per interrupt (plus the passes its handlers ask for) and halts.
+
+The model is not a measurement: the cycle counts are estimates for the
+Cortex-M0 at 16MHz and can be changed with --cost <name>=<cycles>. On target,
+build with LOG_APP_EVENT_STATS and read app_event_stats (loops, idle_loops,
+dispatched[], idle_wfi) with the debugger.
+
+Usage:
+    main_loop_model.py [--conn <ms>] [--scan <ms>] [--audio <blocks/s>]
+                       [--cost <name>=<cycles>] [...]
+"""
+
+import argparse
+import sys
+
+CLOCK_HZ = 16e6
+
+# Estimated cycles, at 16MHz from SysRAM
+COSTS = {
+    'loop':         40,     # BLE running check, ke_event_get(), the pass itself
+    'decision':     30,     # GLOBAL_INT_STOP(), the sleep mode decision
+    'event_take':   14,     # app_event_take(): disable, test, clear, restore
+    'idle_check':   25,     # ke_sleep_check() and the app_event_field test
+    # the hooks when they find nothing to do
+    'trm_idle':     180,    # state checks, prepare_keyreports, con_fsm async tasks, motion
+    'proc_idle':    115,    # fsm_scan_update, BLE wakeup checks, delayed_start_proc
+    'encode_idle':  40,     # app_audio439_encode(8) without a block
+    'stream_idle':  60,     # stream_queue_more_data() with an empty queue
+    'sleep_idle':   20,     # app_asynch_sleep_proc()
+    # the handlers when they have work
+    'schedule':     900,    # rwip_schedule() after a BLE event
+    'trm':          400,    # prepare and send the reports
+    'scan':         600,    # fsm_scan_update() with a matrix scan
+    'encode':       9000,   # one audio block
+    'stream':       700,    # queue stream packets
+}
+
+# The events each interrupt sets (the handlers the next pass runs)
+SCENARIOS = (
+    ('connected, idle', {'ble': ('schedule', 'trm')}),
+    ('key scanning', {'ble': ('schedule', 'trm'), 'systick': ('scan',)}),
+    ('voice', {'ble': ('schedule', 'trm', 'stream'), 'audio': ('encode',)}),
+)
+
+POLLED_HOOKS = ('trm_idle', 'proc_idle', 'encode_idle', 'stream_idle', 'sleep_idle')
+DISPATCH_TAKES = 8      # TRM, KBD_SCAN, LINK_QUALITY, BLE_WAKEUP, AUDIO, STREAM, KBD_SCAN, DELAYED_START
+
+
+def polled_pass(c, handlers=()):
+    # the handlers replace the idle cost of their hook
+    idle = {'schedule': None, 'trm': 'trm_idle', 'scan': 'proc_idle',
+            'encode': 'encode_idle', 'stream': 'stream_idle'}
+    cycles = c['loop'] + c['decision'] + sum(c[h] for h in POLLED_HOOKS)
+    for h in handlers:
+        cycles += c[h] - (c[idle[h]] if idle[h] else 0)
+    return cycles
+
+
+def dispatch_pass(c, handlers=(), wfi=False):
+    cycles = c['loop'] + c['decision'] + DISPATCH_TAKES * c['event_take']
+    cycles += sum(c[h] for h in handlers)
+    if wfi:
+        cycles += c['idle_check']
+    return cycles
+
+
+def model(c, rates, scenario):
+    """Returns {version: (passes/s, CPU running %, time to WFI in usec or None)}."""
+    irqs = sum(rates[src] for src in scenario)
+    work = {}
+    for version in ('polled', 'dispatch', 'dispatch+wfi'):
+        busy = 0.0          # cycles/s spent in passes that run handlers
+        worst = 0
+        for src, handlers in scenario.items():
+            if version == 'polled':
+                cycles = polled_pass(c, handlers)
+            else:
+                cycles = dispatch_pass(c, handlers, version == 'dispatch+wfi')
+            busy += rates[src] * cycles
+            worst = max(worst, cycles)
+        if version == 'dispatch+wfi':
+            # one pass per interrupt, then WFI
+            work[version] = (irqs, 100 * busy / CLOCK_HZ, worst * 1e6 / CLOCK_HZ)
+        else:
+            idle = polled_pass(c) if version == 'polled' else dispatch_pass(c)
+            passes = irqs + (CLOCK_HZ - busy) / idle
+            work[version] = (passes, 100.0, None)
+        work[version + ' pass'] = ((polled_pass(c) if version == 'polled' else
+                                    dispatch_pass(c, (), version == 'dispatch+wfi')) * 1e6 / CLOCK_HZ,
+                                   worst * 1e6 / CLOCK_HZ)
+    return work
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Main loop model')
+    parser.add_argument('--conn', type=float, default=15, help='connection interval, ms')
+    parser.add_argument('--scan', type=float, default=1, help='SysTick period while scanning, ms')
+    parser.add_argument('--audio', type=float, default=200, help='audio blocks per second')
+    parser.add_argument('--cost', action='append', default=[], help='<name>=<cycles>')
+    args = parser.parse_args()
+
+    c = dict(COSTS)
+    for item in args.cost:
+        name, value = item.split('=')
+        if name not in c:
+            parser.error('unknown cost %s' % name)
+        c[name] = int(value)
+    rates = {'ble': 1000 / args.conn, 'systick': 1000 / args.scan, 'audio': args.audio}
+
+    print('connection %.1fms, scan %.1fms, %d audio blocks/s, CPU %dMHz (model, not a measurement)'
+          % (args.conn, args.scan, args.audio, CLOCK_HZ / 1e6))
+    print('%-16s %-13s %12s %10s %14s %14s %12s' % ('scenario', 'loop', 'passes/s', 'CPU on %',
+                                                     'empty pass us', 'longest pass us', 'to WFI us'))
+    for name, scenario in SCENARIOS:
+        work = model(c, rates, scenario)
+        for version in ('polled', 'dispatch', 'dispatch+wfi'):
+            passes, cpu, to_wfi = work[version]
+            empty, worst = work[version + ' pass']
+            print('%-16s %-13s %12.0f %10.1f %14.1f %14.1f %12s' % (
+                name if version == 'polled' else '', version, passes, cpu, empty, worst,
+                'never' if to_wfi is None else '%.1f' % to_wfi))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,276 @@
+/**
+ ****************************************************************************************
+ *
+ * @file motion_codec_test.c
+ *
+ * @brief Round trip test of the delta encoding of the motion reports
+ *        (remote_audio/motion_sensor/app_motion_codec.c), with a reference decoder, on
+ *        the host.
+ *
+ * The encoder gets the bursts of the FIFO path of app_motion_sensor.c: 1 to
+ * BMI055_FIFO_MAX_BURST samples of 6 axes in 12-bit units every connection event, with a
+ * temperature that changes now and then. The movement alternates between still (sensor
+ * noise only), slow and fast (deltas up to FAST_DELTA LSB per sample); a few bursts are
+ * marked with a gap and a share of the notifications is refused, as when the L2CM buffers
+ * are full.
+ *
+ * The decoder follows app_motion_codec.h. It checks that every decoded sample and
+ * temperature equals the one encoded for its sample counter, that every sample of a sent
+ * report is decoded once the stream is in sync, and that the stream is back in sync at
+ * the first report after a refused one. It prints the bytes per sample of each kind of
+ * movement, against the 10 bytes per sample of the fixed burst format.
+ *
+ * Build and run from this directory:
+ *   cc -DHAS_MOTION_DELTA=1 -Istub -I../../src/modules/app/src/app_project/remote_audio/motion_sensor \
+ *      motion_codec_test.c -o motion_codec_test
+ *   ./motion_codec_test [-n <samples>] [-s <seed>] [-drop <% refused>]
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "app_motion_codec.c"
+
+#define FIFO_MAX_BURST          (5)         // BMI055_FIFO_MAX_BURST
+#define MAX_SAMPLES             (200000)
+#define FAST_DELTA              (100)
+#define FIXED_BYTES_PER_SAMPLE  (10.0)      // t_app_motion_burst: 2 samples in 20 bytes
+
+enum movement
+{
+    STILL,
+    SLOW,
+    FAST,
+    NR_MOVEMENTS,
+};
+
+static const char *movement_names[NR_MOVEMENTS] = {"still", "slow", "fast"};
+
+static int16_t sent[MAX_SAMPLES][MOTION_CODEC_AXES];
+static int8_t sent_temperature[MAX_SAMPLES];
+static bool decoded[MAX_SAMPLES];
+static int nb_sent;                         // samples given to the encoder
+
+static int refuse_pct = 5;
+static int failures;
+
+static enum movement movement;
+static long bytes[NR_MOVEMENTS];            // of the reports sent
+static long samples[NR_MOVEMENTS];          // in the reports sent
+static long reports, refused, refused_samples, keyframes;
+
+/*
+ * REFERENCE DECODER
+ ****************************************************************************************
+ */
+
+static struct
+{
+    bool sync;
+    int next;                               // index of the next sample, if in sync
+    int16_t prev[MOTION_CODEC_AXES];
+    int8_t temperature;
+    bool temperature_valid;
+} dec;
+
+/**
+ ****************************************************************************************
+ * @brief Decodes a report. The sample counter of the report (8 bits) is extended to
+ *        an index with the index of the last sample given to the encoder.
+ *
+ * @return false, if the report is malformed
+ ****************************************************************************************
+ */
+static bool decode_report(const uint8_t *buf, uint8_t len)
+{
+    const uint8_t info = buf[1];
+    const int nb = info & MOTION_CODEC_INFO_SAMPLES;
+    int first = nb_sent - (uint8_t)(nb_sent - buf[0]);
+    int pos = 2, nibble = 0, s, i;
+
+    // the report holds samples that were just given to the encoder
+    while (first + nb > nb_sent) {
+        first -= 256;
+    }
+    if (info & MOTION_CODEC_INFO_TEMP) {
+        dec.temperature = (int8_t)buf[pos++];
+        dec.temperature_valid = true;
+    }
+    if (info & MOTION_CODEC_INFO_KEY) {
+        memset(dec.prev, 0, sizeof(dec.prev));
+        dec.sync = true;
+    } else if (!dec.sync || (first != dec.next)) {
+        dec.sync = false;               // a lost report: wait for the next keyframe
+        return true;
+    }
+
+    for (s = 0; s < nb; s++) {
+        for (i = 0; i < MOTION_CODEC_AXES; i++) {
+            uint16_t z = 0;
+            int shift = 0;
+            uint8_t n;
+
+            do {
+                if (pos >= len) {
+                    return false;
+                }
+                n = (buf[pos] >> (4 * nibble)) & 0xF;
+                if (nibble) {
+                    pos++;
+                }
+                nibble ^= 1;
+                z |= (n & 0x7) << shift;
+                shift += 3;
+            } while (n & 0x8);
+            dec.prev[i] += (int16_t)((z >> 1) ^ -(z & 1));
+        }
+
+        if (memcmp(dec.prev, sent[first + s], sizeof(dec.prev)) ||
+            !dec.temperature_valid || (dec.temperature != sent_temperature[first + s])) {
+            printf("FAIL sample %d decoded wrong\n", first + s);
+            failures++;
+        }
+        decoded[first + s] = true;
+    }
+    dec.next = first + nb;
+    // the padding of the last byte must be all that is left
+    return (pos + nibble == len);
+}
+
+/*
+ * STAND-IN
+ ****************************************************************************************
+ */
+
+bool app_stream_send_motionreport(void * motiondata, uint8_t len)
+{
+    const uint8_t *buf = motiondata;
+    const int nb = buf[1] & MOTION_CODEC_INFO_SAMPLES;
+
+    if ((len > APP_STREAM_PACKET_SIZE) || (nb == 0)) {
+        printf("FAIL report of %d bytes with %d samples\n", len, nb);
+        failures++;
+    }
+    if (rand() % 100 < refuse_pct) {
+        refused++;
+        refused_samples += nb;
+        return false;
+    }
+
+    reports++;
+    bytes[movement] += len;
+    samples[movement] += nb;
+    if (buf[1] & MOTION_CODEC_INFO_KEY) {
+        keyframes++;
+    } else if (!dec.sync) {
+        // the codec must send a keyframe after a refused report
+        printf("FAIL report after a refused one is not a keyframe\n");
+        failures++;
+    }
+    if (!decode_report(buf, len)) {
+        printf("FAIL malformed report\n");
+        failures++;
+    }
+    return true;
+}
+
+/*
+ * SAMPLES
+ ****************************************************************************************
+ */
+
+static int16_t clamp12(int v)
+{
+    return (int16_t)((v > 2047) ? 2047 : (v < -2048) ? -2048 : v);
+}
+
+static int delta(int max)
+{
+    return (rand() % (2 * max + 1)) - max;
+}
+
+int main(int argc, char **argv)
+{
+    int total = 6000, k;
+    unsigned seed = 1;
+    int16_t level[MOTION_CODEC_AXES] = {0, 0, 256, 3, -2, 1};
+    int16_t burst[FIFO_MAX_BURST][MOTION_CODEC_AXES];
+    int8_t temperature = 6;
+    int phase_left = 0, not_decoded = 0, i;
+
+    for (k = 1; k + 1 < argc; k += 2) {
+        if (!strcmp(argv[k], "-n")) {
+            total = atoi(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-s")) {
+            seed = atoi(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-drop")) {
+            refuse_pct = atoi(argv[k + 1]);
+        }
+    }
+    if (total > MAX_SAMPLES - FIFO_MAX_BURST) {
+        total = MAX_SAMPLES - FIFO_MAX_BURST;
+    }
+    srand(seed);
+
+    app_motion_codec_reset();
+    while (nb_sent < total) {
+        const int nb = 1 + rand() % FIFO_MAX_BURST;
+        uint8_t info = (rand() % 2) ? MOTION_CODEC_INFO_CLICK : 0;
+        const int first = nb_sent;
+
+        if (phase_left <= 0) {
+            movement = (enum movement)(rand() % NR_MOVEMENTS);
+            phase_left = 100 + rand() % 400;
+        }
+        if (rand() % 200 == 0) {
+            temperature += (rand() % 2) ? 1 : -1;
+        }
+        if (rand() % 100 == 0) {
+            info |= MOTION_CODEC_INFO_GAP;
+        }
+
+        for (k = 0; k < nb; k++) {
+            for (i = 0; i < MOTION_CODEC_AXES; i++) {
+                const int step = (movement == FAST) ? FAST_DELTA : (movement == SLOW) ? 10 : 0;
+
+                level[i] = clamp12(level[i] + delta(step));
+                burst[k][i] = clamp12(level[i] + delta(2));     // sensor noise
+            }
+            memcpy(sent[nb_sent + k], burst[k], sizeof(burst[k]));
+            sent_temperature[nb_sent + k] = temperature;
+        }
+        nb_sent += nb;
+        phase_left -= nb;
+
+        app_motion_codec_send((const int16_t (*)[MOTION_CODEC_AXES])burst, nb, (uint8_t)first, info,
+                              temperature);
+    }
+
+    // only the samples of the refused reports may be missing
+    for (k = 0; k < nb_sent; k++) {
+        if (!decoded[k]) {
+            not_decoded++;
+        }
+    }
+    if (not_decoded != refused_samples) {
+        printf("FAIL %d samples not decoded, %ld in refused reports\n", not_decoded, refused_samples);
+        failures++;
+    }
+
+    printf("%d samples, %ld reports sent (%ld keyframes), %ld refused\n", nb_sent, reports, keyframes, refused);
+    printf("%-8s %-10s bytes/sample (fixed format: %.0f)\n", "movement", "bytes", FIXED_BYTES_PER_SAMPLE);
+    for (k = 0; k < NR_MOVEMENTS; k++) {
+        printf("%-8s %-10ld %.2f\n", movement_names[k], bytes[k], samples[k] ? (double)bytes[k] / samples[k] : 0.0);
+    }
+    printf("%s\n", failures ? "" : "ok");
+    return failures != 0;
+}
@@ -0,0 +1,28 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_stream.h
+ *
+ * @brief Host stand-in of app_stream.h, for app_motion_codec.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_STREAM_H_
+#define APP_STREAM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define APP_STREAM_PACKET_SIZE 20
+
+bool app_stream_send_motionreport(void * motiondata, uint8_t len);
+
+#endif // APP_STREAM_H_
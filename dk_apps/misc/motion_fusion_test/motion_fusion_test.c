@@ -0,0 +1,398 @@
+/**
+ ****************************************************************************************
+ *
+ * @file motion_fusion_test.c
+ *
+ * @brief Test of the motion pointer filter (remote_audio/motion_sensor/app_motion_fusion.c),
+ *        on the host.
+ *
+ * The test feeds the filter with the samples of a remote turning at a constant rate,
+ * at MOTION_ODR_HZ (100 Hz), with the scales of the BMI055 (500 deg/s / 2048 LSB for
+ * the gyro, 256 LSB per g for the accelerometer). The remote is held flat or rolled by
+ * 1.2 rad (69 deg) in the hand, and the gyro has an offset of GYRO_OFFSET LSB. The filter
+ * first sees 1.5 s of the remote at rest, to learn the offset, then 1 rad of yaw or of
+ * pitch. The pointer must move by FUSION_POINTER_GAIN pixels (+/- 1) on the turned axis
+ * only.
+ *
+ * Then the filter is compared with a floating-point reference of the same algorithm
+ * (same gains, same still detection, exact products, divisions and normalization) on
+ * random hand movements: rates up to MAX_RATE on all axes, gyro and accelerometer noise,
+ * hand accelerations and the gyro offset. The orientation may differ by MAX_ANGLE_ERR and
+ * the total pointer movement on each axis by MAX_PTR_ERR pixels plus MAX_PTR_REL of the
+ * distance travelled.
+ *
+ * Build and run from this directory:
+ *   cc -DHAS_MOTION_POINTER=1 -Istub -I../../src/modules/app/src/app_project/remote_audio/motion_sensor \
+ *      motion_fusion_test.c -lm -o motion_fusion_test
+ *   ./motion_fusion_test [-n <random runs>]
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "app_motion_fusion.c"
+
+#define ODR_HZ              (100)
+#define GYRO_DPS_PER_LSB    (500.0 / 2048)
+#define GYRO_RAD_PER_LSB    (GYRO_DPS_PER_LSB * M_PI / 180)
+#define GYRO_OFFSET         (3)
+#define REST_SAMPLES        (150)
+
+#define RUN_SAMPLES         (20 * ODR_HZ)
+#define MAX_RATE            (4.0)       // rad/s
+#define MAX_ANGLE_ERR       (0.1)       // deg
+#define MAX_PTR_ERR         (2.0)       // pixels
+#define MAX_PTR_REL         (0.0005)
+
+static int failures;
+
+/**
+ ****************************************************************************************
+ * @brief Turns the remote for the given number of samples and returns the pointer movement.
+ *
+ * @param[in] roll      roll of the remote around its pointing axis (X), in rad
+ * @param[in] yaw       rate around the vertical, in rad/s
+ * @param[in] pitch     rate around the horizontal axis on the right of the remote, in rad/s
+ ****************************************************************************************
+ */
+static void turn(double roll, double yaw, double pitch, int samples, int *dx, int *dy)
+{
+    // the vertical and the right axis, in the frame of the remote
+    const double up[3] = {0, sin(roll), cos(roll)};
+    const double right[3] = {0, -cos(roll), sin(roll)};
+    int16_t acc[3], rot[3];
+    int8_t x, y;
+    int k, i;
+
+    app_motion_fusion_reset();
+    *dx = 0;
+    *dy = 0;
+
+    for (k = -REST_SAMPLES; k < samples; k++) {
+        const double moving = (k < 0) ? 0 : 1;
+
+        for (i = 0; i < 3; i++) {
+            const double rate = moving * (yaw * up[i] + pitch * right[i]);
+
+            acc[i] = (int16_t)lround(up[i] * FUSION_ACC_1G);
+            rot[i] = (int16_t)lround(rate * 180 / M_PI / GYRO_DPS_PER_LSB) + GYRO_OFFSET;
+        }
+        app_motion_fusion_update(acc, rot);
+        app_motion_fusion_get_pointer(&x, &y);
+        if (k >= 0) {
+            *dx += x;
+            *dy += y;
+        }
+    }
+}
+
+static void check(const char *name, double roll, double yaw, double pitch, int samples,
+                  int exp_dx, int exp_dy)
+{
+    int dx, dy;
+
+    turn(roll, yaw, pitch, samples, &dx, &dy);
+    printf("%-24s dx %5d dy %5d\n", name, dx, dy);
+    if ((abs(dx - exp_dx) > 1) || (abs(dy - exp_dy) > 1)) {
+        printf("FAIL %s: expected dx %d dy %d\n", name, exp_dx, exp_dy);
+        failures++;
+    }
+}
+
+/*
+ * FLOATING-POINT REFERENCE
+ ****************************************************************************************
+ */
+
+struct ref
+{
+    double q[4];
+    double bias[3];
+    int16_t prev_rot[3];
+    bool bias_valid;
+    int still_cnt;
+    int fast_cnt;
+    double dx, dy;
+};
+
+static void ref_reset(struct ref *r)
+{
+    memset(r, 0, sizeof(*r));
+    r->q[0] = 1;
+    r->fast_cnt = FUSION_FAST_SAMPLES;
+}
+
+static bool ref_update_bias(struct ref *r, const int16_t rot[3])
+{
+    bool still = true;
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        const double ref = r->bias_valid ? r->bias[i] : r->prev_rot[i];
+
+        if ((fabs(rot[i] - ref) > FUSION_STILL_THRESHOLD) || (abs(rot[i]) > FUSION_BIAS_MAX)) {
+            still = false;
+        }
+        r->prev_rot[i] = rot[i];
+    }
+    if (!still) {
+        r->still_cnt = 0;
+        return false;
+    }
+    if (r->still_cnt < FUSION_STILL_SAMPLES) {
+        r->still_cnt++;
+        return false;
+    }
+    for (i = 0; i < 3; i++) {
+        r->bias[i] = r->bias_valid ? r->bias[i] + (rot[i] - r->bias[i]) / (1 << FUSION_BIAS_SHIFT) : rot[i];
+    }
+    r->bias_valid = true;
+    return true;
+}
+
+static double clamp(double v, double max)
+{
+    return (v > max) ? max : (v < -max) ? -max : v;
+}
+
+static void ref_update(struct ref *r, const int16_t acc[3], const int16_t rot[3])
+{
+    const double lsb = FUSION_GYRO_LSB_Q30 / (double)Q30_ONE;
+    const bool still = ref_update_bias(r, rot);
+    double *q = r->q, g[3], w[3], u[3], p[4], mag, n;
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        w[i] = g[i] = (rot[i] - r->bias[i]) * lsb;
+    }
+    u[0] = 2 * (q[1] * q[3] - q[0] * q[2]);
+    u[1] = 2 * (q[0] * q[1] + q[2] * q[3]);
+    u[2] = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+
+    mag = sqrt((double)acc[0] * acc[0] + (double)acc[1] * acc[1] + (double)acc[2] * acc[2]);
+    if ((floor(mag) > FUSION_ACC_1G * 3 / 4) && (floor(mag) < FUSION_ACC_1G * 5 / 4)) {
+        const double k = 1.0 / (1 << (r->fast_cnt ? FUSION_KP_SHIFT_FAST : FUSION_KP_SHIFT));
+        const double a[3] = {acc[0] / mag, acc[1] / mag, acc[2] / mag};
+
+        w[0] += (a[1] * u[2] - a[2] * u[1]) * k;
+        w[1] += (a[2] * u[0] - a[0] * u[2]) * k;
+        w[2] += (a[0] * u[1] - a[1] * u[0]) * k;
+        if (r->fast_cnt) {
+            r->fast_cnt--;
+        }
+    }
+
+    p[0] = q[0] - (q[1] * w[0] + q[2] * w[1] + q[3] * w[2]) / 2;
+    p[1] = q[1] + (q[0] * w[0] + q[2] * w[2] - q[3] * w[1]) / 2;
+    p[2] = q[2] + (q[0] * w[1] - q[1] * w[2] + q[3] * w[0]) / 2;
+    p[3] = q[3] + (q[0] * w[2] + q[1] * w[1] - q[2] * w[0]) / 2;
+    n = sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2] + p[3] * p[3]);
+    for (i = 0; i < 4; i++) {
+        q[i] = p[i] / n;
+    }
+
+    if (still) {
+        r->dx = 0;
+        r->dy = 0;
+        return;
+    }
+
+    mag = sqrt(u[1] * u[1] + u[2] * u[2]);
+    r->dx = clamp(r->dx - (g[0] * u[0] + g[1] * u[1] + g[2] * u[2]) * FUSION_POINTER_GAIN, FUSION_POINTER_MAX);
+    if (mag > 1.0 / 8) {
+        r->dy = clamp(r->dy - (g[2] * u[1] - g[1] * u[2]) / mag * FUSION_POINTER_GAIN, FUSION_POINTER_MAX);
+    }
+}
+
+static double ref_get(double *d)
+{
+    const double v = clamp(trunc(*d), 127);
+
+    *d -= v;
+    return v;
+}
+
+/*
+ * RANDOM MOVEMENTS
+ ****************************************************************************************
+ */
+
+static double uniform(void)
+{
+    return rand() / (RAND_MAX + 1.0);
+}
+
+static double noise(double amplitude)
+{
+    return amplitude * (uniform() + uniform() + uniform() - 1.5);
+}
+
+static int16_t sensor(double v, int max)
+{
+    const long x = lround(v);
+
+    return (int16_t)((x > max) ? max : (x < -max - 1) ? -max - 1 : x);
+}
+
+// rotates v by the quaternion q (body to world) inverted: world to body
+static void to_body(const double q[4], const double v[3], double b[3])
+{
+    const double r[3][3] = {
+        {1 - 2 * (q[2] * q[2] + q[3] * q[3]), 2 * (q[1] * q[2] - q[0] * q[3]), 2 * (q[1] * q[3] + q[0] * q[2])},
+        {2 * (q[1] * q[2] + q[0] * q[3]), 1 - 2 * (q[1] * q[1] + q[3] * q[3]), 2 * (q[2] * q[3] - q[0] * q[1])},
+        {2 * (q[1] * q[3] - q[0] * q[2]), 2 * (q[2] * q[3] + q[0] * q[1]), 1 - 2 * (q[1] * q[1] + q[2] * q[2])},
+    };
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        b[i] = r[0][i] * v[0] + r[1][i] * v[1] + r[2][i] * v[2];
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Feeds the filter and the reference with the same random movement and checks
+ *        the differences. Returns the largest ones.
+ ****************************************************************************************
+ */
+static void compare(unsigned seed, double *angle_err, double *ptr_err, double *travel)
+{
+    const double up_world[3] = {0, 0, 1};
+    double truth[4] = {1, 0, 0, 0};
+    double freq[3][2], amp[3][2], phase[3][2];
+    double fx = 0, fy = 0, rx = 0, ry = 0;
+    struct ref r;
+    int16_t acc[3], rot[3];
+    int8_t x, y;
+    int k, i, j;
+
+    srand(seed);
+    for (i = 0; i < 3; i++) {
+        for (j = 0; j < 2; j++) {
+            freq[i][j] = 0.2 + 2 * uniform();
+            amp[i][j] = MAX_RATE / 2 * uniform();
+            phase[i][j] = 2 * M_PI * uniform();
+        }
+    }
+    // start rolled and tilted
+    {
+        const double roll = 2 * (uniform() - 0.5), tilt = uniform() - 0.5;
+
+        truth[0] = cos(roll / 2) * cos(tilt / 2);
+        truth[1] = sin(roll / 2) * cos(tilt / 2);
+        truth[2] = cos(roll / 2) * sin(tilt / 2);
+        truth[3] = -sin(roll / 2) * sin(tilt / 2);
+    }
+
+    app_motion_fusion_reset();
+    ref_reset(&r);
+    *angle_err = *ptr_err = *travel = 0;
+
+    for (k = -REST_SAMPLES; k < RUN_SAMPLES; k++) {
+        const double t = (double)k / ODR_HZ;
+        double rate[3], up[3], n, dot;
+        double p[4];
+
+        for (i = 0; i < 3; i++) {
+            rate[i] = 0;
+            for (j = 0; (k >= 0) && (j < 2); j++) {
+                rate[i] += amp[i][j] * sin(2 * M_PI * freq[i][j] * t + phase[i][j]);
+            }
+        }
+
+        // the sensors, then the true orientation moves on by one sample
+        to_body(truth, up_world, up);
+        for (i = 0; i < 3; i++) {
+            acc[i] = sensor(up[i] * FUSION_ACC_1G + noise(3) + ((k >= 0) ? noise(40) : 0), 2047);
+            rot[i] = sensor(rate[i] / GYRO_RAD_PER_LSB + GYRO_OFFSET + noise(2), 2047);
+        }
+        p[0] = truth[0] - (truth[1] * rate[0] + truth[2] * rate[1] + truth[3] * rate[2]) / (2 * ODR_HZ);
+        p[1] = truth[1] + (truth[0] * rate[0] + truth[2] * rate[2] - truth[3] * rate[1]) / (2 * ODR_HZ);
+        p[2] = truth[2] + (truth[0] * rate[1] - truth[1] * rate[2] + truth[3] * rate[0]) / (2 * ODR_HZ);
+        p[3] = truth[3] + (truth[0] * rate[2] + truth[1] * rate[1] - truth[2] * rate[0]) / (2 * ODR_HZ);
+        n = sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2] + p[3] * p[3]);
+        for (i = 0; i < 4; i++) {
+            truth[i] = p[i] / n;
+        }
+
+        app_motion_fusion_update(acc, rot);
+        ref_update(&r, acc, rot);
+
+        // both are read once per sample, as at a 10ms connection interval
+        app_motion_fusion_get_pointer(&x, &y);
+        fx += x;
+        fy += y;
+        rx += ref_get(&r.dx);
+        ry += ref_get(&r.dy);
+        *travel += fabs(x) + fabs(y);
+
+        // the angle between the orientations; |fusion_q| is only close to 1
+        dot = n = 0;
+        for (i = 0; i < 4; i++) {
+            dot += (double)fusion_q[i] * r.q[i];
+            n += (double)fusion_q[i] * fusion_q[i];
+        }
+        dot = fabs(dot) / sqrt(n);
+        dot = (dot > 1) ? 1 : dot;
+        if (2 * acos(dot) * 180 / M_PI > *angle_err) {
+            *angle_err = 2 * acos(dot) * 180 / M_PI;
+        }
+        if (fabs(fx - rx) > *ptr_err) {
+            *ptr_err = fabs(fx - rx);
+        }
+        if (fabs(fy - ry) > *ptr_err) {
+            *ptr_err = fabs(fy - ry);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int runs = 20, n;
+    double worst_angle = 0, worst_ptr = 0, worst_rel = 0;
+
+    // a turn to the left (positive yaw) moves the pointer left, nose up moves it up
+    check("still", 0, 0, 0, 3 * ODR_HZ, 0, 0);
+    check("yaw, flat", 0, 1, 0, ODR_HZ, -FUSION_POINTER_GAIN, 0);
+    check("yaw, rolled", 1.2, 1, 0, ODR_HZ, -FUSION_POINTER_GAIN, 0);
+    check("pitch up, rolled", 1.2, 0, 1, ODR_HZ, 0, -FUSION_POINTER_GAIN);
+    check("pitch down, flat", 0, 0, -1, ODR_HZ, 0, FUSION_POINTER_GAIN);
+    check("yaw right, rolled back", -1.2, -1, 0, ODR_HZ, FUSION_POINTER_GAIN, 0);
+
+    if ((argc == 3) && !strcmp(argv[1], "-n")) {
+        runs = atoi(argv[2]);
+    }
+    for (n = 1; n <= runs; n++) {
+        double angle, ptr, travel;
+
+        compare(n, &angle, &ptr, &travel);
+        if (angle > worst_angle) {
+            worst_angle = angle;
+        }
+        if (ptr > worst_ptr) {
+            worst_ptr = ptr;
+            worst_rel = ptr / travel;
+        }
+        if ((angle > MAX_ANGLE_ERR) || (ptr > MAX_PTR_ERR + MAX_PTR_REL * travel)) {
+            printf("FAIL random run %d: orientation %.4f deg, pointer %.1f px over %.0f px\n",
+                   n, angle, ptr, travel);
+            failures++;
+        }
+    }
+    printf("%d random runs of %d s against the floating-point reference: orientation within %.4f deg, "
+           "pointer within %.1f px (%.3f%% of the travel)\n",
+           runs, RUN_SAMPLES / ODR_HZ, worst_angle, worst_ptr, 100 * worst_rel);
+
+    printf(failures ? "%d failed\n" : "ok\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""
+Motion sensor current model.
+
+Estimates the average current of the BMI055 (gyro + accelerometer) while the
+motion key is held, with and without the power levels of CFG_APP_MOTION_POWER
+(app_motion_sensor.c):
+
+    ACTIVE   both sensors in normal mode, MOTION_ODR_HZ
+    DOZE     after MOTION_DOZE_SAMPLES still samples: gyro in fast power-up,
+             accelerometer in low power mode (25ms sleep) with any-motion
+    STANDBY  after MOTION_STANDBY_DELAY in DOZE: gyro suspended,
+             accelerometer in low power mode (100ms sleep)
+
+The thresholds are read from app_motion_sensor.h. The model is not a
+measurement: the currents are datasheet typical values (BMI055) and can be
+changed on the command line. The motion is a sequence of moving and still
+periods. Any motion wakes the sensors after two accelerometer samples plus one
+connection event, as the interrupt status is polled.
+
+Two outputs:
+  - the fixed mix of the time in each level (--mix, in %), e.g. 40/30/30;
+  - a random session: moving periods and pauses with exponential lengths
+    (--move, --pause, --rest in s; a pause is a rest with --rest-share).
+
+Usage:
+    motion_power.py [--mix A/D/S] [--session <s>] [--seed <n>] [--conn <ms>]
+                    [--gyro-active <mA>] [...]
+"""
+
+import argparse
+import os
+import random
+import re
+
+HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'src', 'modules',
+                      'app', 'src', 'app_project', 'remote_audio', 'motion_sensor',
+                      'app_motion_sensor.h')
+
+ACTIVE, DOZE, STANDBY = 0, 1, 2
+LEVELS = ('ACTIVE', 'DOZE', 'STANDBY')
+
+
+def read_defines(path):
+    """Returns the integer #defines of the header."""
+    defines = {}
+    with open(path) as f:
+        for line in f:
+            m = re.match(r'\s*#define\s+(\w+)\s+\((-?\d+)\)', line)
+            if m:
+                defines[m.group(1)] = int(m.group(2))
+    return defines
+
+
+def level_currents(args):
+    """Returns the current of the two sensors in each level, in mA."""
+    return (args.gyro_active + args.acc_normal,
+            args.gyro_fast_powerup + args.acc_lp25,
+            args.gyro_suspend + args.acc_lp100)
+
+
+def simulate(args, cfg):
+    """Runs the power levels on a random session. Returns the time in each level, in s."""
+    rng = random.Random(args.seed)
+    doze_after = cfg['MOTION_DOZE_SAMPLES'] / cfg['MOTION_ODR_HZ']
+    standby_after = cfg['MOTION_STANDBY_DELAY'] / 100.0
+    conn = args.conn / 1000.0
+    time = [0.0, 0.0, 0.0]
+    t = 0.0
+
+    while t < args.session:
+        moving = rng.expovariate(1.0 / args.move)
+        if rng.random() < args.rest_share:
+            still = rng.expovariate(1.0 / args.rest)
+        else:
+            still = rng.expovariate(1.0 / args.pause)
+
+        time[ACTIVE] += moving
+        t += moving
+
+        # still: ACTIVE until the doze, DOZE until the standby, then STANDBY
+        left = still
+        part = min(left, doze_after)
+        time[ACTIVE] += part
+        left -= part
+        if left > 0:
+            part = min(left, standby_after)
+            time[DOZE] += part
+            left -= part
+            level = DOZE if left <= 0 else STANDBY
+            time[STANDBY] += max(left, 0)
+            # the wake up: two accelerometer samples, then the poll at a connection event
+            wake = 2 * (0.025 if level == DOZE else 0.1) + rng.uniform(0, conn)
+            time[level] += wake
+            t += wake
+        t += still
+
+    return time
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[1])
+    parser.add_argument('--mix', default='40/30/30', help='%% of time in ACTIVE/DOZE/STANDBY')
+    parser.add_argument('--session', type=float, default=3600, help='random session length, s')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--move', type=float, default=3.0, help='mean moving period, s')
+    parser.add_argument('--pause', type=float, default=2.0, help='mean short pause, s')
+    parser.add_argument('--rest', type=float, default=20.0, help='mean rest, s')
+    parser.add_argument('--rest-share', type=float, default=0.3, help='share of the pauses that are rests')
+    parser.add_argument('--conn', type=float, default=10.0, help='connection interval, ms')
+    parser.add_argument('--gyro-active', type=float, default=5.0, help='mA')
+    parser.add_argument('--gyro-fast-powerup', type=float, default=2.5, help='mA')
+    parser.add_argument('--gyro-suspend', type=float, default=0.025, help='mA')
+    parser.add_argument('--acc-normal', type=float, default=0.130, help='mA')
+    parser.add_argument('--acc-lp25', type=float, default=0.016, help='mA, 25ms sleep')
+    parser.add_argument('--acc-lp100', type=float, default=0.005, help='mA, 100ms sleep')
+    parser.add_argument('--header', default=HEADER, help='app_motion_sensor.h')
+    args = parser.parse_args()
+
+    cfg = read_defines(args.header)
+    currents = level_currents(args)
+
+    print('level currents: ' + ', '.join('%s %.3f mA' % (LEVELS[i], currents[i]) for i in range(3)))
+
+    mix = [float(x) / 100 for x in args.mix.split('/')]
+    print('mix %s: always active %.2f mA, power levels %.2f mA' %
+          (args.mix, currents[ACTIVE], sum(m * c for m, c in zip(mix, currents))))
+
+    time = simulate(args, cfg)
+    total = sum(time)
+    print('random session of %.0f s: %s' %
+          (total, ', '.join('%s %.0f%%' % (LEVELS[i], 100 * time[i] / total) for i in range(3))))
+    print('  always active %.2f mA, power levels %.2f mA' %
+          (currents[ACTIVE], sum(time[i] * currents[i] for i in range(3)) / total))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,247 @@
+#!/usr/bin/env python3
+"""
+RCX20 drift model.
+
+Compares a measurement of the RCX20 at every BLE event (the former
+calibrate_rcx20() / read_rcx_freq() per event) with the tracker of
+arch_system.c (rcx_track_start/poll/sleep/kick):
+
+    per event   a 20-cycle measurement per event; the main loop waits for its
+                end after the event, then does the float math
+    tracker     a measurement when RCX_TRACK_INTERVAL_MIN..MAX slots have
+                elapsed, or when the temperature (RC16M count of
+                conditionally_run_radio_cals(), every 2 s) or the battery
+                level (app_batt_lvl(), every 60 s) has changed; the average
+                is updated as rcx_track_update() does, in fixed point (x256)
+
+The thresholds are read from arch.h and can be changed on the command line.
+The model is not a measurement of the silicon: the RCX runs at 10.87 kHz with
+a linear drift in temperature and voltage, a jitter and the 1-count
+quantization of the 16 MHz reference. The profile of 1 h is: 22 C, warmed by
+a hand (+8 C), cooled, then in the sun (+6 C), and a -50 mV battery step.
+
+For each scenario the model prints the measurements and the CPU time per hour
+and the 99th percentile and the maximum of the frequency error over the
+following sleep, with the widening of the window at the sleep length.
+
+Usage:
+    rcx_drift.py [--tc <ppm/C>] [--kv <ppm/V>] [--seed <n>] [--interval-max <slots>] [...]
+"""
+
+import argparse
+import math
+import os
+import random
+import re
+
+HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'src', 'plf',
+                      'refip', 'src', 'arch', 'arch.h')
+
+F0 = 10870.0                # Hz at 25 C, 3.0 V
+CAL = 20                    # RCX cycles of a measurement (RCX_CAL_TIME)
+REF = 16e6                  # reference clock of the measurement
+SLOTS_PER_S = 1600
+DEV_MAX = 0x40000           # the deviation limit of rcx_track_update()
+
+
+def read_defines(path):
+    """Returns the integer #defines of the header."""
+    defines = {}
+    with open(path) as f:
+        for line in f:
+            m = re.match(r'\s*#define\s+(\w+)\s+\((-?\d+)\)', line)
+            if m:
+                defines[m.group(1)] = int(m.group(2))
+    return defines
+
+
+class Rcx:
+    """The simulated oscillator."""
+
+    def __init__(self, args, rnd):
+        self.tc = args.tc * 1e-6
+        self.kv = args.kv * 1e-6
+        self.jitter = args.jitter * 1e-6
+        self.rnd = rnd
+
+    @staticmethod
+    def temp(t):
+        if t < 600:
+            return 22.0
+        if t < 1800:
+            return 22.0 + 8.0 * (1 - math.exp(-(t - 600) / 120))
+        if t < 3000:
+            return 22.0 + 8.0 * math.exp(-(t - 1800) / 300)
+        return 22.0 + 6.0 * (1 - math.exp(-(t - 3000) / 200))
+
+    @staticmethod
+    def volt(t):
+        return 3.0 if t < 2400 else 2.95
+
+    def freq(self, t):
+        return F0 * (1 + self.tc * (self.temp(t) - 25) + self.kv * (self.volt(t) - 3.0))
+
+    def measure(self, t):
+        """Returns the 16 MHz cycles in CAL cycles of the RCX."""
+        f = self.freq(t) * (1 + self.rnd.gauss(0, self.jitter))
+        return int(REF * CAL / f + self.rnd.random())
+
+
+class Tracker:
+    """rcx_track_update() and the interval of rcx_track_start()."""
+
+    def __init__(self, cfg):
+        self.cfg = cfg
+        self.value = 0
+        self.interval = 0
+
+    def kick(self):
+        self.interval = self.cfg['RCX_TRACK_INTERVAL_MIN']
+
+    def update(self, cycles):
+        cfg = self.cfg
+        value = cycles << 8
+        if self.value == 0:
+            self.value = value
+            self.interval = cfg['RCX_TRACK_INTERVAL_MIN']
+            return
+        dev = abs(value - self.value)
+        ppm = (min(dev, DEV_MAX) * 15625) // (self.value >> 6)
+        if ppm >= cfg['RCX_TRACK_STEP_PPM']:
+            self.value = value
+            self.interval = cfg['RCX_TRACK_INTERVAL_MIN']
+            return
+        if value > self.value:
+            self.value += (value - self.value) >> cfg['RCX_TRACK_SHIFT']
+        else:
+            self.value -= (self.value - value) >> cfg['RCX_TRACK_SHIFT']
+        if ppm < cfg['RCX_TRACK_STABLE_PPM']:
+            self.interval = min(max(2 * self.interval, cfg['RCX_TRACK_INTERVAL_MIN']),
+                                cfg['RCX_TRACK_INTERVAL_MAX'])
+        else:
+            self.interval = max(self.interval // 2, cfg['RCX_TRACK_INTERVAL_MIN'])
+
+
+def per_event(events, rcx):
+    """Returns the measurements, the CPU time in us and the errors in ppm."""
+    meas, cpu, err = 0, 0.0, []
+    for (t, sleep, evt_len) in events:
+        cycles = rcx.measure(t)
+        meas += 1
+        cpu += max(0.0, CAL / F0 * 1e6 - evt_len) + 40      # wait for the end, float math
+        if sleep > 0.004:
+            f = REF * CAL / cycles
+            f_true = rcx.freq(t + sleep / 2)
+            err.append((f - f_true) / f_true * 1e6)
+    return meas, cpu, err
+
+
+def tracked(events, rcx, cfg):
+    """Returns the measurements, the CPU time in us and the errors in ppm."""
+    tracker = Tracker(cfg)
+    meas, cpu, err = 0, 0.0, []
+    last, kick = -1e9, False
+    temp_check, temp_count = -10, None
+    batt = round((rcx.volt(0) - 2.8) * 200)
+    batt_poll = 0
+    for (t, sleep, evt_len) in events:
+        cpu += 2                                            # rcx_track_poll()
+        slots = t * SLOTS_PER_S
+        if kick or (slots - last) >= tracker.interval:
+            tracker.update(rcx.measure(t))
+            meas += 1
+            cpu += 30
+            if sleep > 0:
+                cpu += max(0.0, CAL / F0 * 1e6 - evt_len)   # rcx_track_sleep() waits
+            last = slots
+            kick = False
+        if sleep > 0.004:
+            # conditionally_run_radio_cals(), every 2 s while sleeping
+            if t - temp_check >= 2:
+                temp_check = t
+                count = round(4.8 * rcx.temp(t))
+                if temp_count is None:
+                    temp_count = count
+                if abs(count - temp_count) >= cfg['RCX_TRACK_TEMP_COUNT']:
+                    temp_count = count
+                    kick = True
+                    tracker.kick()
+            f = REF * CAL * 256 / tracker.value
+            f_true = rcx.freq(t + sleep / 2)
+            err.append((f - f_true) / f_true * 1e6)
+        if t - batt_poll >= 60:
+            batt_poll = t
+            level = round((rcx.volt(t) - 2.8) * 200)
+            if level != batt:
+                batt = level
+                kick = True
+                tracker.kick()
+    return meas, cpu, err
+
+
+def idle(period, hours=1.0, evt_len=500):
+    return [(i * period, period, evt_len) for i in range(int(3600 * hours / period))]
+
+
+def stream(hours=1.0):
+    return [(i * 0.0075, 0.0, 2500) for i in range(int(3600 * hours / 0.0075))]
+
+
+def mixed():
+    events = [e for e in idle(0.75) if e[0] < 3000]
+    return events + [(3000 + i * 0.0075, 0.0, 2500) for i in range(int(600 / 0.0075))]
+
+
+def pct(values, q):
+    values = sorted(abs(x) for x in values)
+    return values[min(len(values) - 1, int(q * len(values)))] if values else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[1])
+    parser.add_argument('--tc', type=float, default=250, help='drift, ppm/C')
+    parser.add_argument('--kv', type=float, default=2000, help='drift, ppm/V')
+    parser.add_argument('--jitter', type=float, default=30, help='sigma of a measurement, ppm')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--shift', type=int, help='RCX_TRACK_SHIFT')
+    parser.add_argument('--interval-min', type=int, help='RCX_TRACK_INTERVAL_MIN, slots')
+    parser.add_argument('--interval-max', type=int, help='RCX_TRACK_INTERVAL_MAX, slots')
+    parser.add_argument('--stable', type=int, help='RCX_TRACK_STABLE_PPM')
+    parser.add_argument('--step', type=int, help='RCX_TRACK_STEP_PPM')
+    parser.add_argument('--temp-count', type=int, help='RCX_TRACK_TEMP_COUNT')
+    parser.add_argument('--header', default=HEADER, help='arch.h')
+    args = parser.parse_args()
+
+    cfg = read_defines(args.header)
+    for name, value in (('RCX_TRACK_SHIFT', args.shift),
+                        ('RCX_TRACK_INTERVAL_MIN', args.interval_min),
+                        ('RCX_TRACK_INTERVAL_MAX', args.interval_max),
+                        ('RCX_TRACK_STABLE_PPM', args.stable),
+                        ('RCX_TRACK_STEP_PPM', args.step),
+                        ('RCX_TRACK_TEMP_COUNT', args.temp_count)):
+        if value is not None:
+            cfg[name] = value
+
+    scenarios = (('idle conn 750 ms', idle(0.75), 0.75),
+                 ('idle conn 100 ms', idle(0.1), 0.1),
+                 ('advertising 1 s', idle(1.0, evt_len=1500), 1.0),
+                 ('streaming 7.5 ms', stream(), 0),
+                 ('50 min idle + 10 min str.', mixed(), 0.75))
+
+    print('%-26s %-16s %-18s %-22s %s' % ('scenario', 'meas/h', 'CPU ms/h', 'err ppm p99 (max)',
+                                          'p99 widening'))
+    for name, events, sleep in scenarios:
+        b_meas, b_cpu, b_err = per_event(events, Rcx(args, random.Random(args.seed)))
+        t_meas, t_cpu, t_err = tracked(events, Rcx(args, random.Random(args.seed)), cfg)
+        line = '%-26s %6d -> %-6d %7.0f -> %-7.0f' % (name, b_meas, t_meas, b_cpu / 1000, t_cpu / 1000)
+        if sleep:
+            line += ' %3.0f (%3.0f) -> %3.0f (%3.0f)  %3.0f -> %3.0f us' % (
+                pct(b_err, .99), pct(b_err, 1), pct(t_err, .99), pct(t_err, 1),
+                pct(b_err, .99) * sleep, pct(t_err, .99) * sleep)
+        else:
+            line += ' (no sleep)'
+        print(line)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,181 @@
+/**
+ ****************************************************************************************
+ *
+ * @file reconnect_sim.c
+ *
+ * @brief Household simulation of the reconnection policy (app_multi_bond/app_reconnect.c),
+ *        on the host.
+ *
+ * Three public hosts are bonded and used 60%, 30% and 10% of the time. Before each
+ * reconnection the user stays on the last host with the chance given on the command line,
+ * or picks another host with the weights above. A host scans in the background and finds a
+ * directed advertising burst (1.28s, BURST_MA) at a random point of it. If no burst reaches
+ * the wanted host, the device falls back to undirected advertising at 20ms (UNDIRECTED_MA),
+ * which the host picks up after a number of 1.28s scan windows.
+ *
+ * Two policies are compared over RECONNECTIONS reconnections:
+ *   - last host only: one burst to the host in bond_info, as without has_reconnect_policy;
+ *   - ranked: the bursts of app_reconnect_start() / app_reconnect_next().
+ * The test prints the mean and the max time to reconnect and the mean charge.
+ *
+ * Build and run from this directory:
+ *   cc -Istub -I../../src/modules/app/src/app_utils/app_multi_bond reconnect_sim.c -o reconnect_sim
+ *   ./reconnect_sim [chance the user stays on the same host, 0.7 by default]
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// the stand-ins of app_con_fsm.h and app_multi_bond.h go first: their guards hide the real
+// ones, next to app_reconnect.c
+#include "rwble_config.h"
+#include "stub/app_con_fsm.h"
+#include "stub/app_multi_bond.h"
+#include "app_reconnect.c"
+
+#define HOSTS           (3)
+#define RECONNECTIONS   (20000)
+#define BURST_S         (1.28)      // high duty directed advertising burst
+#define BURST_MA        (4.0)
+#define UNDIRECTED_MA   (0.6)       // undirected advertising at 20ms
+#define SCAN_S          (1.28)      // background scan window of a host
+#define SCAN_MISS       (0.56)      // chance that a scan window misses the undirected advertising
+
+struct bond_index_ bond_index = {{ADDR_PUBLIC, ADDR_PUBLIC, ADDR_PUBLIC}, (1 << HOSTS) - 1};
+
+static const double usage[HOSTS] = {0.6, 0.3, 0.1};
+static int active;
+
+bool app_alt_pair_load_entry(int8_t entry)
+{
+    active = entry;
+    return true;
+}
+
+int app_alt_peer_get_active_index(void)
+{
+    return active;
+}
+
+/*
+ * TEST
+ ****************************************************************************************
+ */
+
+static double uniform(void)
+{
+    return rand() / (RAND_MAX + 1.0);
+}
+
+static double undirected_latency(void)
+{
+    double t = uniform() * SCAN_S;
+
+    while (uniform() > SCAN_MISS) {
+        t += SCAN_S;
+    }
+    return t;
+}
+
+// the host the user wants next
+static int next_host(int wanted, double stay)
+{
+    double r, sum = 0;
+    int h;
+
+    if (uniform() <= stay) {
+        return wanted;
+    }
+    r = uniform() * (1 - usage[wanted]);
+    for (h = 0; h < HOSTS; h++) {
+        if (h == wanted) {
+            continue;
+        }
+        sum += usage[h];
+        if (r < sum) {
+            return h;
+        }
+    }
+    return wanted;
+}
+
+static void run(bool ranked, double stay)
+{
+    double time, charge, d, total_time = 0, total_charge = 0, max_time = 0;
+    bool connected, go;
+    int n, wanted = 0, last = 0;
+
+    srand(1);
+    active = 0;
+    memset(&reconnect_env, 0, sizeof(reconnect_env));
+
+    for (n = 0; n < RECONNECTIONS; n++) {
+        wanted = next_host(wanted, stay);
+        time = 0;
+        charge = 0;
+        connected = false;
+
+        if (!ranked) {
+            if (last == wanted) {
+                time = uniform() * BURST_S;
+                connected = true;
+            } else {
+                time = BURST_S;
+            }
+            charge = time * BURST_MA;
+        } else {
+            active = last;
+            go = app_reconnect_start();
+            while (go) {
+                if (reconnect_env.cand[reconnect_env.cur] == wanted) {
+                    d = uniform() * BURST_S;
+                    time += d;
+                    charge += d * BURST_MA;
+                    app_reconnect_connected();
+                    connected = true;
+                    break;
+                }
+                time += BURST_S;
+                charge += BURST_S * BURST_MA;
+                go = app_reconnect_next();
+            }
+        }
+
+        if (!connected) {
+            d = undirected_latency();
+            time += d;
+            charge += d * UNDIRECTED_MA;
+        }
+        if (ranked) {
+            app_reconnect_used(wanted);
+        }
+
+        last = wanted;
+        total_time += time;
+        total_charge += charge;
+        if (time > max_time) {
+            max_time = time;
+        }
+    }
+
+    printf("%-16s stay %.2f: mean %.2fs, max %.1fs, %.1f mC\n", ranked ? "ranked" : "last host only",
+           stay, total_time / RECONNECTIONS, max_time, total_charge / RECONNECTIONS);
+}
+
+int main(int argc, char **argv)
+{
+    const double stay = (argc > 1) ? atof(argv[1]) : 0.7;
+
+    run(false, stay);
+    run(true, stay);
+    return 0;
+}
@@ -0,0 +1,21 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_api.h
+ *
+ * @brief Host stand-in of app_api.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_API_H_
+#define APP_API_H_
+
+#endif // APP_API_H_
@@ -0,0 +1,33 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_multi_bond.h
+ *
+ * @brief Host stand-in of app_multi_bond.h: the bond index and the entry functions used by app_reconnect.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_MULTI_BOND_H_
+#define APP_MULTI_BOND_H_
+
+struct bond_index_
+{
+    uint8_t peer_addr_type[MAX_BOND_PEER];
+    uint8_t valid;                                  // bit n: entry n is bonded and indexed
+};
+
+extern struct bond_index_ bond_index;
+
+bool app_alt_pair_load_entry(int8_t entry);
+
+int app_alt_peer_get_active_index(void);
+
+#endif // APP_MULTI_BOND_H_
@@ -0,0 +1,279 @@
+/**
+ ****************************************************************************************
+ *
+ * @file rpa_cache_sim.c
+ *
+ * @brief Reconnection simulation of the cache of resolved private addresses
+ *        (app_multi_bond/app_rpa_cache.c), on the host.
+ *
+ * MAX_BOND_PEER hosts are bonded. Each one moves to a new resolvable private address every
+ * 15 minutes, the default TGAP(private_addr_int), with a random phase. The connections
+ * come at exponential gaps over DAYS days, from a host picked by the workload:
+ *   - sticky: the last host again with the chance STICKY, else any host;
+ *   - uniform: any host;
+ *   - round-robin: the hosts in turn, the worst case of the most recently resolved order.
+ * The cost of a connection is the count of AES operations until the IRK of the host is
+ * found, AES_MS each (the round trip of an LLM encryption). That time is an estimate, not a
+ * measurement, and can be changed on the command line.
+ *
+ * Three ways to resolve an address are compared:
+ *   - storage order: all the IRKs of the bond index, as without has_rpa_cache;
+ *   - MRU only: app_rpa_cache_irks(), without app_rpa_cache_lookup();
+ *   - cache + MRU: app_rpa_cache_lookup() first, app_rpa_cache_irks() on a miss.
+ * The test fails if the cache returns the wrong host, if an address is found after
+ * RPA_CACHE_TIMEOUT or after app_rpa_cache_forget().
+ *
+ * Build and run from this directory:
+ *   cc -Istub -I../../src/modules/app/src/app_utils/app_multi_bond rpa_cache_sim.c -o rpa_cache_sim -lm
+ *   ./rpa_cache_sim [-aes <ms>] [-days <n>]
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// the stand-ins of app_con_fsm.h and app_multi_bond.h go first: their guards hide the real
+// ones, next to app_rpa_cache.c
+#include "rwble_config.h"
+#include "co_bt.h"
+#include "gap.h"
+#include "stub/app_api.h"
+#include "stub/app_con_fsm.h"
+#include "stub/app_multi_bond.h"
+#include "app_rpa_cache.c"
+
+#define HOSTS           (MAX_BOND_PEER)
+#define SLOTS_PER_S     (1600)
+#define RPA_PERIOD_S    (15 * 60)
+#define STICKY          (0.8)
+
+enum workload
+{
+    STICKY_HOST,
+    UNIFORM,
+    ROUND_ROBIN,
+};
+
+enum method
+{
+    STORAGE_ORDER,
+    MRU_ONLY,
+    CACHE_MRU,
+    METHODS
+};
+
+struct bond_index_ bond_index;
+
+static double aes_ms = 0.35;
+static int days = 7;
+
+static uint64_t now;                // in slots, wraps at BLE_BASETIMECNT_MASK when read
+static double phase[HOSTS];         // of the address rotation, in s
+static int failures;
+
+uint32_t lld_evt_time_get(void)
+{
+    return (uint32_t)now & BLE_BASETIMECNT_MASK;
+}
+
+static double uniform(void)
+{
+    return rand() / (RAND_MAX + 1.0);
+}
+
+// the address of a host at the current time: one per host and rotation
+static void host_addr(int host, struct bd_addr *addr)
+{
+    const uint32_t epoch = (uint32_t)((now / (double)SLOTS_PER_S + phase[host]) / RPA_PERIOD_S);
+
+    addr->addr[0] = (uint8_t)host;
+    addr->addr[1] = (uint8_t)epoch;
+    addr->addr[2] = (uint8_t)(epoch >> 8);
+    addr->addr[3] = (uint8_t)(epoch >> 16);
+    addr->addr[4] = 0xA5;
+    addr->addr[5] = 0x40;           // resolvable private
+}
+
+static void bond_hosts(void)
+{
+    int j;
+
+    memset(&bond_index, 0, sizeof(bond_index));
+    for (j = 0; j < HOSTS; j++) {
+        bond_index.irk_entry[j] = j;
+        memset(bond_index.irk[j].key, j + 1, KEY_LEN);
+    }
+    bond_index.nb_irk = HOSTS;
+    app_rpa_cache_forget(MAX_BOND_PEER);
+}
+
+// the AES operations of the GAPM until the IRK of the host matches
+static int aes_operations(const struct gap_sec_key *irk, int host)
+{
+    int j;
+
+    for (j = 0; j < bond_index.nb_irk; j++) {
+        if (irk[j].key[0] == host + 1) {
+            return j + 1;
+        }
+    }
+    printf("FAIL the IRK of host %d is missing\n", host);
+    failures++;
+    return 0;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Runs the connections of a workload.
+ *
+ * @param[in]  workload The workload
+ * @param[in]  gap_min  The mean time between two connections, in min
+ * @param[in]  method   The way to resolve the addresses
+ * @param[out] hits     The share of the connections found by app_rpa_cache_lookup()
+ *
+ * @return The mean AES operations per connection
+ ****************************************************************************************
+ */
+static double run(enum workload workload, double gap_min, enum method method, double *hits)
+{
+    struct gap_sec_key irk[MAX_BOND_PEER];
+    struct bd_addr addr;
+    long connections = 0, found = 0, operations = 0;
+    int host = 0, entry, j;
+
+    srand(1);
+    for (j = 0; j < HOSTS; j++) {
+        phase[j] = uniform() * RPA_PERIOD_S;
+    }
+    bond_hosts();
+
+    for (now = 0; now < (uint64_t)days * 24 * 3600 * SLOTS_PER_S; ) {
+        now += (uint64_t)(-log(1.0 - uniform()) * gap_min * 60 * SLOTS_PER_S);
+
+        switch (workload) {
+        case STICKY_HOST:
+            if (uniform() >= STICKY) {
+                host = rand() % HOSTS;
+            }
+            break;
+        case UNIFORM:
+            host = rand() % HOSTS;
+            break;
+        default:
+            host = (host + 1) % HOSTS;
+            break;
+        }
+        host_addr(host, &addr);
+        connections++;
+
+        if (method == CACHE_MRU) {
+            entry = app_rpa_cache_lookup(&addr);
+            if (entry != MAX_BOND_PEER) {
+                if (entry != host) {
+                    printf("FAIL the cache gave host %d for host %d\n", entry, host);
+                    failures++;
+                }
+                found++;
+                continue;
+            }
+        }
+        if (method == STORAGE_ORDER) {
+            operations += aes_operations(bond_index.irk, host);
+        } else {
+            app_rpa_cache_irks(irk);
+            operations += aes_operations(irk, host);
+            app_rpa_cache_add(&addr, host);
+        }
+    }
+
+    *hits = 100.0 * found / connections;
+    return (double)operations / connections;
+}
+
+// an address is no longer found after RPA_CACHE_TIMEOUT or when its entry is written
+static void check_expiry(void)
+{
+    struct bd_addr addr;
+
+    bond_hosts();
+    now = BLE_BASETIMECNT_MASK - 100;       // across the wrap of the base time
+    host_addr(2, &addr);
+    app_rpa_cache_add(&addr, 2);
+
+    now += RPA_CACHE_TIMEOUT - 1;
+    if (app_rpa_cache_lookup(&addr) != 2) {
+        printf("FAIL the address is lost before RPA_CACHE_TIMEOUT\n");
+        failures++;
+    }
+    now += 1;
+    if (app_rpa_cache_lookup(&addr) != MAX_BOND_PEER) {
+        printf("FAIL the address is found after RPA_CACHE_TIMEOUT\n");
+        failures++;
+    }
+
+    app_rpa_cache_add(&addr, 2);
+    app_rpa_cache_forget(2);
+    if ((app_rpa_cache_lookup(&addr) != MAX_BOND_PEER) || rpa_cache_env.mru[0]) {
+        printf("FAIL the address is found after app_rpa_cache_forget()\n");
+        failures++;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static const struct
+    {
+        const char *name;
+        enum workload workload;
+        double gap_min;
+    } workloads[] =
+    {
+        {"sticky 80%, 2 min",   STICKY_HOST, 2},
+        {"sticky 80%, 12 min",  STICKY_HOST, 12},
+        {"uniform, 2 min",      UNIFORM,     2},
+        {"uniform, 38 min",     UNIFORM,     38},
+        {"round-robin, 5 min",  ROUND_ROBIN, 5},
+    };
+    double ops[METHODS], hits;
+    unsigned i;
+    int k, m;
+
+    for (k = 1; k + 1 < argc; k += 2) {
+        if (!strcmp(argv[k], "-aes")) {
+            aes_ms = atof(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-days")) {
+            days = atoi(argv[k + 1]);
+        }
+    }
+
+    printf("%d hosts, %d days, AES operations per connection (time at %.2fms each)\n", HOSTS,
+           days, aes_ms);
+    printf("workload, mean gap     storage order   MRU only        cache + MRU\n");
+    for (i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++) {
+        for (m = 0; m < METHODS; m++) {
+            ops[m] = run(workloads[i].workload, workloads[i].gap_min, m, &hits);
+        }
+        printf("%-21s", workloads[i].name);
+        for (m = 0; m < METHODS; m++) {
+            printf("  %4.2f (%4.2fms)", ops[m], ops[m] * aes_ms);
+        }
+        printf("  %2.0f%% hits\n", hits);
+    }
+
+    check_expiry();
+
+    if (!failures) {
+        printf("ok\n");
+    }
+    return failures != 0;
+}
@@ -0,0 +1,31 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_multi_bond.h
+ *
+ * @brief Host stand-in of app_multi_bond.h: the IRKs of the bond index used by
+ *        app_rpa_cache.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_MULTI_BOND_H_
+#define APP_MULTI_BOND_H_
+
+struct bond_index_
+{
+    uint8_t nb_irk;
+    uint8_t irk_entry[MAX_BOND_PEER];               // entry of each IRK
+    struct gap_sec_key irk[MAX_BOND_PEER];
+};
+
+extern struct bond_index_ bond_index;
+
+#endif // APP_MULTI_BOND_H_
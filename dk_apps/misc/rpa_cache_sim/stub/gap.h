@@ -0,0 +1,28 @@
+/**
+ ****************************************************************************************
+ *
+ * @file gap.h
+ *
+ * @brief Host stand-in of gap.h, for app_rpa_cache.c.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef GAP_H_
+#define GAP_H_
+
+#define KEY_LEN                 (16)
+
+struct gap_sec_key
+{
+    uint8_t key[KEY_LEN];
+};
+
+#endif // GAP_H_
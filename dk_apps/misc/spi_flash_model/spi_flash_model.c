@@ -0,0 +1,327 @@
+/**
+ ****************************************************************************************
+ *
+ * @file spi_flash_model.c
+ *
+ * @brief Test of the SPI flash driver (plf/refip/src/driver/spi_flash/spi_flash.c) on a
+ *        simulated NOR flash, on the host.
+ *
+ * The model decodes the SPI frames of the driver: READ_DATA, PAGE_PROGRAM (with the
+ * page wrap), the sector and block erases, CHIP_ERASE, WRITE_ENABLE/DISABLE and
+ * READ_STATUS_REG. A program or an erase without WEL is ignored. The flash is never
+ * busy.
+ *
+ * Random reads of 1 to 300 bytes, programs and erases go through the driver and are
+ * checked against a copy of the flash. Half of them hit a small range, so that the lines
+ * of the read cache are written while they are cached. spi_flash_init() is called from time to time, as
+ * at a power up of the flash, and must not lose writes. The test then counts the SPI
+ * accesses (spi_access() calls, any word size) of 60-byte and 8-byte reads.
+ *
+ * Last, it prints the read throughput of sequential reads of 16, 256 and 4096 bytes, in
+ * bytes/ms. The time of a read is the SPI bytes on the bus at SPI_BYTE_NS (SPI_XTAL_DIV_14
+ * of app_flash.c), ACCESS_NS of CPU for each spi_access() and COPY_NS for each byte
+ * copied out of the cache. These are estimates, not measurements; -byte, -access and
+ * -copy override them (ns). Only the reads of up to SPI_FLASH_CACHE_LINE_SIZE bytes go
+ * through the cache.
+ *
+ * Build and run from this directory, with the read cache of remote_audio (4 lines) or
+ * without it:
+ *   cc -DSPI_FLASH_CACHE_LINES=4 -Istub -I../../src/plf/refip/src/driver/spi_flash \
+ *      spi_flash_model.c ../../src/plf/refip/src/driver/spi_flash/spi_flash.c -o spi_flash_model
+ *   ./spi_flash_model [seed] [-byte <ns>] [-access <ns>] [-copy <ns>]
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "spi.h"
+#include "spi_flash.h"
+
+#define FLASH_SIZE      (0x40000)
+#define PAGE_SIZE       (0x100)
+#define HOT_BASE        (0x3B000)       // half of the operations go to 256 bytes here
+#define HOT_SIZE        (0x100)
+#define SPI_BYTE_NS     (7000)          // 8 bits at 16 MHz / 14
+#define ACCESS_NS       (1000)          // write, poll and read of the SPI registers
+#define COPY_NS         (125)           // memcpy() from a cache line, per byte
+#define STREAM_BASE     (0x10000)
+#define STREAM_SIZE     (0x10000)       // bytes read at each size
+
+static uint8_t flash[FLASH_SIZE];
+static uint8_t copy[FLASH_SIZE];
+static SPI_Word_Mode_t bitmode;
+static int frame_pos;                   // bytes of the frame sent since CS low
+static uint8_t frame_cmd;
+static uint32_t frame_addr;
+static uint8_t status;
+static long accesses;
+static long bus_bytes;
+
+/*
+ * SIMULATED FLASH
+ ****************************************************************************************
+ */
+
+void spi_init(SPI_Pad_t *cs_pad_param, SPI_Word_Mode_t bitmode_param, int role, int clk_pol,
+              int pha_mode, int irq, int freq)
+{
+    bitmode = bitmode_param;
+}
+
+void spi_set_bitmode(SPI_Word_Mode_t spiBitMode)
+{
+    bitmode = spiBitMode;
+}
+
+void spi_cs_low(void)
+{
+    frame_pos = 0;
+    frame_addr = 0;
+}
+
+static void erase(uint32_t size)
+{
+    if (status & STATUS_WEL) {
+        memset(&flash[(frame_addr % FLASH_SIZE) & ~(size - 1)], 0xFF, size);
+    }
+    status &= ~STATUS_WEL;
+}
+
+void spi_cs_high(void)
+{
+    if (frame_pos == 0) {
+        return;
+    }
+    switch (frame_cmd) {
+    case WRITE_ENABLE:
+        status |= STATUS_WEL;
+        break;
+    case WRITE_DISABLE:
+    case PAGE_PROGRAM:
+        status &= ~STATUS_WEL;
+        break;
+    case SECTOR_ERASE:
+        erase(0x1000);
+        break;
+    case BLOCK_ERASE_32:
+        erase(0x8000);
+        break;
+    case BLOCK_ERASE_64:
+        erase(0x10000);
+        break;
+    case CHIP_ERASE:
+        erase(FLASH_SIZE);
+        break;
+    }
+    frame_pos = 0;
+}
+
+static uint8_t spi_byte(uint8_t out)
+{
+    uint8_t in = 0xFF;
+
+    if (frame_pos == 0) {
+        frame_cmd = out;
+    } else if (frame_pos < 4) {
+        frame_addr = (frame_addr << 8) | out;
+    }
+
+    switch (frame_cmd) {
+    case READ_STATUS_REG:
+        in = status;
+        break;
+    case READ_DATA:
+        if (frame_pos >= 4) {
+            in = flash[frame_addr % FLASH_SIZE];
+            frame_addr++;
+        }
+        break;
+    case PAGE_PROGRAM:
+        if ((frame_pos >= 4) && (status & STATUS_WEL)) {
+            flash[frame_addr % FLASH_SIZE] &= out;
+            frame_addr = (frame_addr & ~(PAGE_SIZE - 1)) | ((frame_addr + 1) & (PAGE_SIZE - 1));
+        }
+        break;
+    }
+    frame_pos++;
+    return in;
+}
+
+uint32_t spi_access(uint32_t dataToSend)
+{
+    const int bytes = (bitmode == SPI_MODE_32BIT) ? 4 : (bitmode == SPI_MODE_16BIT) ? 2 : 1;
+    uint32_t data = 0;
+    int i;
+
+    accesses++;
+    bus_bytes += bytes;
+    for (i = bytes - 1; i >= 0; i--) {
+        data = (data << 8) | spi_byte((uint8_t)(dataToSend >> (8 * i)));
+    }
+    return data;
+}
+
+uint32_t spi_transaction(uint32_t dataToSend)
+{
+    uint32_t data;
+
+    spi_cs_low();
+    data = spi_access(dataToSend);
+    spi_cs_high();
+    return data;
+}
+
+/*
+ * TEST
+ ****************************************************************************************
+ */
+
+static int random_ops(int ops)
+{
+    static const SPI_erase_module_t erases[] = {SECTOR_ERASE, BLOCK_ERASE_32, BLOCK_ERASE_64};
+    static const uint32_t erase_size[] = {0x1000, 0x8000, 0x10000};
+    uint8_t buf[300];
+    uint32_t address, size, i;
+    int32_t expected, res;
+    int op, e;
+
+    for (op = 0; op < ops; op++) {
+        address = (rand() & 1) ? (HOT_BASE + rand() % HOT_SIZE) : (rand() % FLASH_SIZE);
+        // mostly small reads, which go through the cache
+        size = 1 + rand() % ((op & 1) ? 40 : 300);
+
+        switch (rand() % 50) {
+        case 0:
+            for (i = 0; i < size; i++) {
+                buf[i] = rand();
+            }
+            expected = (address + size > FLASH_SIZE) ? (FLASH_SIZE - address) : size;
+            if (spi_flash_write_data(buf, address, size) != expected) {
+                printf("op %d: write of %u bytes at 0x%05X failed\n", op, size, address);
+                return 1;
+            }
+            for (i = 0; i < (uint32_t)expected; i++) {
+                copy[address + i] &= buf[i];
+            }
+            break;
+        case 1:
+            e = rand() % 3;
+            if (spi_flash_block_erase(address, erases[e]) != ERR_OK) {
+                printf("op %d: erase at 0x%05X failed\n", op, address);
+                return 1;
+            }
+            memset(&copy[address & ~(erase_size[e] - 1)], 0xFF, erase_size[e]);
+            break;
+        case 2:
+            // a power up of the flash
+            spi_flash_init(FLASH_SIZE, PAGE_SIZE);
+            break;
+        default:
+            expected = (address + size > FLASH_SIZE) ? (FLASH_SIZE - address) : size;
+            memset(buf, 0, sizeof(buf));
+            res = spi_flash_read_data(buf, address, size);
+            if ((res != expected) || memcmp(buf, &copy[address], expected)) {
+                printf("op %d: read of %u bytes at 0x%05X is wrong\n", op, size, address);
+                return 1;
+            }
+            break;
+        }
+    }
+    return 0;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Prints the throughput of sequential reads of STREAM_SIZE bytes, for each size.
+ ****************************************************************************************
+ */
+static void read_throughput(long byte_ns, long access_ns, long copy_ns)
+{
+    static const uint32_t sizes[] = {16, 256, 4096};
+    static uint8_t buf[4096];
+    uint32_t address;
+    double ns;
+    int s;
+
+    printf("SPI_FLASH_CACHE_LINES %d, sequential reads (%ld ns/byte, %ld ns/access, %ld ns/copied byte):\n",
+           SPI_FLASH_CACHE_LINES, byte_ns, access_ns, copy_ns);
+    for (s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++) {
+        spi_flash_init(FLASH_SIZE, PAGE_SIZE);
+        accesses = 0;
+        bus_bytes = 0;
+        for (address = STREAM_BASE; address < STREAM_BASE + STREAM_SIZE; address += sizes[s]) {
+            spi_flash_read_data(buf, address, sizes[s]);
+        }
+        ns = (double)bus_bytes * byte_ns + (double)accesses * access_ns;
+        if ((SPI_FLASH_CACHE_LINES > 0) && (sizes[s] <= SPI_FLASH_CACHE_LINE_SIZE)) {
+            ns += (double)STREAM_SIZE * copy_ns;
+        }
+        printf("  %4u bytes: %.2f bus bytes/byte, %6.1f bytes/ms\n", sizes[s],
+               (double)bus_bytes / STREAM_SIZE, STREAM_SIZE / (ns / 1e6));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint8_t buf[64];
+    uint32_t i;
+    long byte_ns = SPI_BYTE_NS, access_ns = ACCESS_NS, copy_ns = COPY_NS;
+    int k;
+
+    srand((argc > 1) ? atoi(argv[1]) : 1);
+    for (k = 2; k + 1 < argc; k += 2) {
+        if (!strcmp(argv[k], "-byte")) {
+            byte_ns = atol(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-access")) {
+            access_ns = atol(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-copy")) {
+            copy_ns = atol(argv[k + 1]);
+        }
+    }
+    for (i = 0; i < FLASH_SIZE; i++) {
+        flash[i] = rand();
+    }
+    memcpy(copy, flash, FLASH_SIZE);
+    spi_flash_init(FLASH_SIZE, PAGE_SIZE);
+
+    if (random_ops(200000)) {
+        return 1;
+    }
+    if ((spi_flash_chip_erase() != ERR_OK) || (flash[rand() % FLASH_SIZE] != 0xFF)) {
+        printf("chip erase failed\n");
+        return 1;
+    }
+    memset(copy, 0xFF, FLASH_SIZE);
+    if (random_ops(20000)) {
+        return 1;
+    }
+
+    accesses = 0;
+    for (k = 0; k < 1000; k++) {
+        spi_flash_read_data(buf, 0x1000 + (k * 60) % 0x1000, 60);
+    }
+    printf("SPI_FLASH_CACHE_LINES %d: 60-byte reads %.1f accesses/read,", SPI_FLASH_CACHE_LINES,
+           accesses / 1000.0);
+
+    accesses = 0;
+    for (k = 0; k < 1000; k++) {
+        spi_flash_read_data(buf, 0x3B000 + (k % 16) * 8, 8);
+        if (k % 100 == 0) {
+            spi_flash_init(FLASH_SIZE, PAGE_SIZE);
+        }
+    }
+    printf(" 8-byte reads %.2f accesses/read\n", accesses / 1000.0);
+
+    read_throughput(byte_ns, access_ns, copy_ns);
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,56 @@
+/**
+ ****************************************************************************************
+ *
+ * @file spi.h
+ *
+ * @brief Host stand-in of the SPI driver used by spi_flash.c. spi_flash_model.c
+ *        implements the functions on a simulated flash.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _SPI_H_
+#define _SPI_H_
+
+#include <stdint.h>
+
+typedef int GPIO_PORT;
+typedef int GPIO_PIN;
+
+typedef struct
+{
+    GPIO_PORT port;
+    GPIO_PIN pin;
+} SPI_Pad_t;
+
+typedef enum {
+    SPI_MODE_8BIT,
+    SPI_MODE_16BIT,
+    SPI_MODE_32BIT,
+    SPI_MODE_9BIT,
+} SPI_Word_Mode_t;
+
+enum {
+    SPI_ROLE_MASTER,
+    SPI_CLK_IDLE_POL_LOW,
+    SPI_PHA_MODE_0,
+    SPI_MINT_DISABLE,
+    SPI_XTAL_DIV_8,
+};
+
+void spi_init(SPI_Pad_t *cs_pad_param, SPI_Word_Mode_t bitmode, int role, int clk_pol, int pha_mode,
+              int irq, int freq);
+void spi_set_bitmode(SPI_Word_Mode_t spiBitMode);
+void spi_cs_low(void);
+void spi_cs_high(void);
+uint32_t spi_access(uint32_t dataToSend);
+uint32_t spi_transaction(uint32_t dataToSend);
+
+#endif // _SPI_H_
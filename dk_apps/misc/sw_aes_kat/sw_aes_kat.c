@@ -0,0 +1,202 @@
+/**
+ ****************************************************************************************
+ *
+ * @file sw_aes_kat.c
+ *
+ * @brief Known answer tests of the software AES (modules/crypto/sw_aes.c), on the host.
+ *
+ * Vectors:
+ *   FIPS-197 appendix C.1 and C.3       AES-128 and AES-256 block encryption
+ *   NIST SP 800-38A F.2.1 and F.2.2     CBC-AES128, encryption and decryption
+ *   NIST SP 800-38A F.5.1 and F.5.5     CTR-AES128 and CTR-AES256
+ *   RFC 4493 section 4                  AES-CMAC, messages of 0, 16, 40 and 64 bytes
+ * and the CTR cases that the vectors do not cover: a message split at a block
+ * boundary, a partial last block and the carry of the counter.
+ *
+ * sw_aes_kat.sh builds and runs the tests for SW_AES_TABLES 0, 1 and 4, with and
+ * without SW_AES_TABLES_IN_RAM. A single variant is built with e.g.:
+ *   cc -Istub -I../../src/modules/crypto -DSW_AES_TABLES=4 -DSW_AES_TABLES_IN_RAM=1 \
+ *      sw_aes_kat.c ../../src/modules/crypto/sw_aes.c -o sw_aes_kat
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "sw_aes.h"
+
+#define KEY128          "2b7e151628aed2a6abf7158809cf4f3c"
+#define KEY256          "603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4"
+#define CTR_INIT        "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff"
+#define PLAIN_64        "6bc1bee22e409f96e93d7e117393172a" "ae2d8a571e03ac9c9eb76fac45af8e51" \
+                        "30c81c46a35ce411e5fbc1191a0a52ef" "f69f2445df4f9b17ad2b417be66c3710"
+#define CTR128_64       "874d6191b620e3261bef6864990db6ce" "9806f66b7970fdff8617187bb9fffdff" \
+                        "5ae4df3edbd5d35e5b4f09020db03eab" "1e031dda2fbe03d1792170a0f3009cee"
+#define CTR256_64       "601ec313775789a5b7a7f504bbf3d228" "f443e3ca4d62b59aca84e990cacaf5c5" \
+                        "2b0930daa23de94ce87017ba2d84988d" "dfc9c58db67aada613c2dd08457941a6"
+#define CBC128_64       "7649abac8119b246cee98e9b12e9197d" "5086cb9b507219ee95db113a917678b2" \
+                        "73bed6b8e3c1743b7116e69e22229516" "3ff1caa1681fac09120eca307586e1a7"
+
+static int failures;
+
+static void hex(const char *s, uint8_t *out, int len)
+{
+    int i;
+    unsigned int b;
+
+    for (i = 0; i < len; i++) {
+        sscanf(s + 2 * i, "%2x", &b);
+        out[i] = (uint8_t)b;
+    }
+}
+
+static void check(const char *name, const uint8_t *got, const char *expected, int len)
+{
+    uint8_t exp[64];
+
+    hex(expected, exp, len);
+    if (memcmp(got, exp, len)) {
+        printf("FAIL %s\n", name);
+        failures++;
+    }
+}
+
+static void set_key(AES_CTX *ctx, const char *key, AES_MODE mode)
+{
+    uint8_t k[32], iv[AES_IV_SIZE];
+
+    hex(key, k, (mode == AES_MODE_128) ? 16 : 32);
+    hex("000102030405060708090a0b0c0d0e0f", iv, AES_IV_SIZE);
+    AES_set_key(ctx, k, iv, mode);
+}
+
+static void block(const char *name, const char *key, AES_MODE mode, const char *plain,
+                  const char *cipher)
+{
+    AES_CTX ctx;
+    uint8_t in[16], out[16];
+    uint32_t data[4];
+    int i;
+
+    set_key(&ctx, key, mode);
+    hex(plain, in, 16);
+    for (i = 0; i < 4; i++) {
+        data[i] = ((uint32_t)in[4 * i] << 24) | ((uint32_t)in[4 * i + 1] << 16) |
+                  ((uint32_t)in[4 * i + 2] << 8) | in[4 * i + 3];
+    }
+    AES_encrypt(&ctx, data);
+    for (i = 0; i < 4; i++) {
+        out[4 * i] = data[i] >> 24;
+        out[4 * i + 1] = data[i] >> 16;
+        out[4 * i + 2] = data[i] >> 8;
+        out[4 * i + 3] = data[i];
+    }
+    check(name, out, cipher, 16);
+}
+
+static void cbc(void)
+{
+    AES_CTX ctx;
+    uint8_t plain[64], out[64];
+
+    hex(PLAIN_64, plain, 64);
+    set_key(&ctx, KEY128, AES_MODE_128);
+    AES_cbc_encrypt(&ctx, plain, out, 64);
+    check("SP 800-38A F.2.1", out, CBC128_64, 64);
+
+    set_key(&ctx, KEY128, AES_MODE_128);
+    AES_convert_key(&ctx);
+    hex(CBC128_64, plain, 64);
+    AES_cbc_decrypt(&ctx, plain, out, 64);
+    check("SP 800-38A F.2.2", out, PLAIN_64, 64);
+}
+
+static void ctr(void)
+{
+    AES_CTX ctx;
+    uint8_t plain[64], out[64], counter[16];
+    uint8_t expected[64];
+
+    hex(PLAIN_64, plain, 64);
+
+    set_key(&ctx, KEY128, AES_MODE_128);
+    hex(CTR_INIT, counter, 16);
+    AES_ctr_crypt(&ctx, counter, plain, out, 64);
+    check("SP 800-38A F.5.1", out, CTR128_64, 64);
+    // the counter holds the next one
+    check("CTR next counter", counter, "f0f1f2f3f4f5f6f7f8f9fafbfcfdff03", 16);
+
+    // decryption is the same operation, in place
+    hex(CTR_INIT, counter, 16);
+    AES_ctr_crypt(&ctx, counter, out, out, 64);
+    check("SP 800-38A F.5.2", out, PLAIN_64, 64);
+
+    // split at a block boundary
+    hex(CTR_INIT, counter, 16);
+    AES_ctr_crypt(&ctx, counter, plain, out, 16);
+    AES_ctr_crypt(&ctx, counter, plain + 16, out + 16, 48);
+    check("CTR split", out, CTR128_64, 64);
+
+    // a partial last block uses the start of its key stream
+    hex(CTR_INIT, counter, 16);
+    memset(out, 0, sizeof(out));
+    AES_ctr_crypt(&ctx, counter, plain, out, 37);
+    hex(CTR128_64, expected, 64);
+    memset(expected + 37, 0, 64 - 37);
+    if (memcmp(out, expected, 64)) {
+        printf("FAIL CTR partial\n");
+        failures++;
+    }
+    check("CTR partial counter", counter, "f0f1f2f3f4f5f6f7f8f9fafbfcfdff02", 16);
+
+    // the carry goes through the whole 128 bit counter
+    hex("00ffffffffffffffffffffffffffffff", counter, 16);
+    AES_ctr_crypt(&ctx, counter, plain, out, 16);
+    check("CTR carry", counter, "01000000000000000000000000000000", 16);
+
+    set_key(&ctx, KEY256, AES_MODE_256);
+    hex(CTR_INIT, counter, 16);
+    AES_ctr_crypt(&ctx, counter, plain, out, 64);
+    check("SP 800-38A F.5.5", out, CTR256_64, 64);
+}
+
+static void cmac(void)
+{
+    AES_CTX ctx;
+    uint8_t msg[64], mac[16];
+
+    hex(PLAIN_64, msg, 64);
+    set_key(&ctx, KEY128, AES_MODE_128);
+
+    AES_cmac(&ctx, msg, 0, mac);
+    check("RFC 4493 example 1", mac, "bb1d6929e95937287fa37d129b756746", 16);
+    AES_cmac(&ctx, msg, 16, mac);
+    check("RFC 4493 example 2", mac, "070a16b46b4d4144f79bdd9dd04a287c", 16);
+    AES_cmac(&ctx, msg, 40, mac);
+    check("RFC 4493 example 3", mac, "dfa66747de9ae63030ca32611497c827", 16);
+    AES_cmac(&ctx, msg, 64, mac);
+    check("RFC 4493 example 4", mac, "51f0bebf7e3b9d92fc49741779363cfe", 16);
+}
+
+int main(void)
+{
+    block("FIPS-197 C.1", "000102030405060708090a0b0c0d0e0f", AES_MODE_128,
+          "00112233445566778899aabbccddeeff", "69c4e0d86a7b0430d8cdb78070b4c55a");
+    block("FIPS-197 C.3", "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f",
+          AES_MODE_256, "00112233445566778899aabbccddeeff", "8ea2b7ca516745bfeafc49904b496089");
+    cbc();
+    ctr();
+    cmac();
+
+    printf("SW_AES_TABLES %d, SW_AES_TABLES_IN_RAM %d: %s\n", SW_AES_TABLES, SW_AES_TABLES_IN_RAM,
+           failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
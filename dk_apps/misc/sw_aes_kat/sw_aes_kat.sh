@@ -0,0 +1,24 @@
+#!/bin/sh
+#
+# Builds sw_aes_kat.c with modules/crypto/sw_aes.c for each SW_AES_TABLES variant,
+# and runs it. Usage: sw_aes_kat.sh [C compiler, cc by default]
+#
+cd "$(dirname "$0")" || exit 1
+CC=${1:-cc}
+OUT=$(mktemp -d) || exit 1
+status=0
+
+for tables in 0 1 4; do
+    for in_ram in 0 1; do
+        if [ $tables -eq 0 ] && [ $in_ram -eq 1 ]; then
+            continue
+        fi
+        $CC -O2 -Wall -Istub -I../../src/modules/crypto \
+            -DSW_AES_TABLES=$tables -DSW_AES_TABLES_IN_RAM=$in_ram \
+            sw_aes_kat.c ../../src/modules/crypto/sw_aes.c -o "$OUT/kat" || status=1
+        "$OUT/kat" || status=1
+    done
+done
+
+rm -rf "$OUT"
+exit $status
@@ -0,0 +1,34 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_api.h
+ *
+ * @brief Host stand-in of app_api.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_API_H_
+#define APP_API_H_
+
+#include <stdint.h>
+#include "arch.h"
+#include "ke_msg.h"
+
+#define TASK_APP                (1)
+
+enum
+{
+    APP_WHEEL_TIMER = 1,
+};
+
+void app_timer_set(ke_msg_id_t const timer_id, ke_task_id_t const task_id, uint16_t const delay);
+
+#endif // APP_API_H_
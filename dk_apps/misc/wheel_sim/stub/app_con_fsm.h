@@ -0,0 +1,29 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_con_fsm.h
+ *
+ * @brief Host stand-in of app_con_fsm.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_CON_FSM_H_
+#define APP_CON_FSM_H_
+
+enum main_fsm_states
+{
+    IDLE_ST,
+    CONNECTED_ST,
+};
+
+enum main_fsm_states app_con_fsm_get_state(void);
+
+#endif // APP_CON_FSM_H_
@@ -0,0 +1,25 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_kbd.h
+ *
+ * @brief Host stand-in of app_kbd.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_KBD_H_
+#define APP_KBD_H_
+
+#include <stdbool.h>
+
+bool app_kbd_check_conn_status(void);
+
+#endif // APP_KBD_H_
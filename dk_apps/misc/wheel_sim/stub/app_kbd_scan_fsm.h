@@ -0,0 +1,31 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_kbd_scan_fsm.h
+ *
+ * @brief Host stand-in of app_kbd_scan_fsm.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_KBD_SCAN_FSM_H_
+#define APP_KBD_SCAN_FSM_H_
+
+enum key_scan_states
+{
+    KEY_SCAN_INACTIVE,
+    KEY_SCAN_IDLE,
+    KEY_SCANNING,
+    KEY_STATUS_UPD,
+};
+
+extern enum key_scan_states current_scan_state;
+
+#endif // APP_KBD_SCAN_FSM_H_
@@ -0,0 +1,43 @@
+/**
+ ****************************************************************************************
+ *
+ * @file arch.h
+ *
+ * @brief Host stand-in of arch.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef ARCH_H_
+#define ARCH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define zero_init
+#define __INLINE                static inline
+
+#define GLOBAL_INT_DISABLE()
+#define GLOBAL_INT_RESTORE()
+
+// the registers used by app_wheel.c, in an array of the simulation
+extern uint16_t sim_regs[64];
+
+#define WKUP_SELECT_P0_REG      (0x10)
+#define WKUP_POL_P0_REG         (0x20)
+#define QDEC_CTRL2_REG          (0x30)
+#define CLK_PER_REG             (0x31)
+#define QUAD_ENABLE             (0x0400)
+
+#define GetWord16(a)            (sim_regs[(a)])
+#define SetWord16(a, v)         (sim_regs[(a)] = (uint16_t)(v))
+#define SetBits16(a, m, v)      (sim_regs[(a)] = (uint16_t)((sim_regs[(a)] & ~(m)) | ((v) ? (m) : 0)))
+
+#endif // ARCH_H_
@@ -0,0 +1,34 @@
+/**
+ ****************************************************************************************
+ *
+ * @file gpio.h
+ *
+ * @brief Host stand-in of gpio.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef GPIO_H_
+#define GPIO_H_
+
+#include <stdbool.h>
+
+typedef enum { GPIO_PORT_0, GPIO_PORT_1, GPIO_PORT_2, GPIO_PORT_3 } GPIO_PORT;
+typedef enum { GPIO_PIN_0, GPIO_PIN_1, GPIO_PIN_2, GPIO_PIN_3, GPIO_PIN_4, GPIO_PIN_5, GPIO_PIN_6,
+               GPIO_PIN_7, GPIO_PIN_8, GPIO_PIN_9 } GPIO_PIN;
+typedef enum { INPUT, INPUT_PULLUP, INPUT_PULLDOWN, OUTPUT } GPIO_PUPD;
+
+#define PID_GPIO                (0)
+#define RESERVE_GPIO(name, port, pin, func)
+
+void GPIO_ConfigurePin(GPIO_PORT port, GPIO_PIN pin, GPIO_PUPD mode, int function, const bool high);
+bool GPIO_GetPinStatus(GPIO_PORT port, GPIO_PIN pin);
+
+#endif // GPIO_H_
@@ -0,0 +1,28 @@
+/**
+ ****************************************************************************************
+ *
+ * @file ke_msg.h
+ *
+ * @brief Host stand-in of ke_msg.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef KE_MSG_H_
+#define KE_MSG_H_
+
+#include <stdint.h>
+
+typedef uint16_t ke_msg_id_t;
+typedef uint16_t ke_task_id_t;
+
+#define KE_MSG_CONSUMED         (0)
+
+#endif // KE_MSG_H_
@@ -0,0 +1,25 @@
+/**
+ ****************************************************************************************
+ *
+ * @file l2cm.h
+ *
+ * @brief Host stand-in of l2cm.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef L2CM_H_
+#define L2CM_H_
+
+#include <stdint.h>
+
+uint8_t l2cm_get_nb_buffer_available(void);
+
+#endif // L2CM_H_
@@ -0,0 +1,51 @@
+/**
+ ****************************************************************************************
+ *
+ * @file wkupct_quadec.h
+ *
+ * @brief Host stand-in of wkupct_quadec.h.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef WKUPCT_QUADEC_H_
+#define WKUPCT_QUADEC_H_
+
+#include <stdint.h>
+
+typedef enum
+{
+    QUAD_DEC_CHXA_NONE_AND_CHXB_NONE = 0,
+    QUAD_DEC_CHXA_P27_AND_CHXB_P28 = 9,
+} CHX_PORT_SEL_t;
+
+typedef enum
+{
+    QUAD_DEC_CHYA_NONE_AND_CHYB_NONE = 0 << 4,
+} CHY_PORT_SEL_t;
+
+typedef enum
+{
+    QUAD_DEC_CHZA_NONE_AND_CHZB_NONE = 0 << 8,
+} CHZ_PORT_SEL_t;
+
+typedef struct
+{
+    CHX_PORT_SEL_t chx_port_sel;
+    CHY_PORT_SEL_t chy_port_sel;
+    CHZ_PORT_SEL_t chz_port_sel;
+    uint16_t qdec_clockdiv;
+    uint8_t qdec_events_count_to_trigger_interrupt;
+} QUAD_DEC_INIT_PARAMS_t;
+
+void quad_decoder_init(QUAD_DEC_INIT_PARAMS_t *quad_dec_init_params);
+int16_t quad_decoder_get_x_counter(void);
+
+#endif // WKUPCT_QUADEC_H_
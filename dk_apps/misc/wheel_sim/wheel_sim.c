@@ -0,0 +1,319 @@
+/**
+ ****************************************************************************************
+ *
+ * @file wheel_sim.c
+ *
+ * @brief Report rate and current of the scroll wheel (remote_audio/wheel/app_wheel.c)
+ *        against a report per decoder IRQ, on the host.
+ *
+ * The wheel turns in gestures: a number of detents at a given rate, then a pause with an
+ * exponential length. The connection has an event every INTERVAL_MS; an event sends up to
+ * PKT_PER_EVT notifications and there are NB_BUFFERS L2CM buffers.
+ *
+ * Both designs hand the idle wheel to the Wakeup Controller. The detent that wakes the
+ * system up is not counted; the Quadrature Decoder then counts and keeps the system out of
+ * Extended sleep until the wheel has not moved for WHEEL_IDLE_TIMEOUT.
+ *   - app_wheel.c, unchanged: the counter is read at the end of each connection event and
+ *     the movement since the previous event is sent in one Mouse report;
+ *   - per IRQ: the decoder interrupts on each count (qdec_events_count_to_trigger_interrupt
+ *     = 1) and each interrupt sends a report of one count. A report without a free buffer
+ *     is lost, as a silently discarded notification would be.
+ *
+ * The simulation prints the reports per second of movement, the counts lost, the mean delay
+ * from a detent to the connection event that carries it, the share of the time out of
+ * Extended sleep and the mean current. The current is a model, not a measurement: the
+ * charges and currents are estimates for the DA14580 and can be changed on the command
+ * line.
+ *
+ * Build and run from this directory:
+ *   cc -Istub -I../../src/modules/app/src/app_project/remote_audio/wheel \
+ *      -I../../src/modules/app/src/app_project/remote_audio \
+ *      -I../../src/modules/app/src/app_project/remote_audio/system wheel_sim.c -lm -o wheel_sim
+ *   ./wheel_sim [-i <interval ms>] [-s <seed>] [-sleep <uA>] [-idle <mA>] [-evt <uC>] [-pkt <uC>] [-irq <uC>]
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define HAS_QUADEC_WHEEL        (1)
+#define HAS_DELAYED_WAKEUP      (0)
+#define WHEEL_QUADEC_CHX        QUAD_DEC_CHXA_P27_AND_CHXB_P28
+#define WHEEL_A_PORT            (2)
+#define WHEEL_A_PIN             (7)
+#define WHEEL_B_PORT            (2)
+#define WHEEL_B_PIN             (8)
+
+#include "app_wheel.c"
+
+#define TICK_US                 (250)
+#define SESSION_S               (600)
+#define PKT_PER_EVT             (4)
+#define NB_BUFFERS              (4)
+#define MAX_COUNTS              (200000)
+
+struct gesture
+{
+    const char *name;
+    double rate;                // detents per second
+    int detents;                // mean detents per gesture
+    double pause;               // mean pause, s
+};
+
+struct result
+{
+    long reports;
+    long lost;
+    long delivered;
+    double delay_sum;
+    double moving_s;
+    double awake_s;
+    double charge_uc;
+};
+
+static double i_sleep_ua = 1.4;     // Extended sleep, RAM retained
+static double i_idle_ma = 1.0;      // XTAL16 and the peripheral domain on, CPU in WFI
+static double q_evt_uc = 4.0;       // an empty connection event, wakeup included
+static double q_pkt_uc = 1.5;       // one more notification in an event
+static double q_irq_uc = 0.15;      // the CPU out of WFI for a decoder interrupt
+
+uint16_t sim_regs[64];
+unsigned volatile char wheel_cpt_event;
+volatile uint32_t app_event_field;
+enum key_scan_states current_scan_state = KEY_SCAN_IDLE;
+bool conn_upd_pending;
+
+static bool qdec_on;
+static int16_t qdec_cnt;
+static long timer_expiry = -1;      // us
+static long now;                    // us
+static int queued;                  // notifications waiting for an event
+static int queued_counts[NB_BUFFERS];
+static double count_time[MAX_COUNTS];
+static int count_head, count_tail;
+static struct result *res;
+
+/*
+ * STAND-INS
+ ****************************************************************************************
+ */
+
+void GPIO_ConfigurePin(GPIO_PORT port, GPIO_PIN pin, GPIO_PUPD mode, int function, const bool high)
+{
+}
+
+bool GPIO_GetPinStatus(GPIO_PORT port, GPIO_PIN pin)
+{
+    return true;
+}
+
+void app_timer_set(ke_msg_id_t const timer_id, ke_task_id_t const task_id, uint16_t const delay)
+{
+    timer_expiry = now + 10000L * delay;
+}
+
+bool app_kbd_check_conn_status(void)
+{
+    return true;
+}
+
+enum main_fsm_states app_con_fsm_get_state(void)
+{
+    return CONNECTED_ST;
+}
+
+uint8_t l2cm_get_nb_buffer_available(void)
+{
+    return NB_BUFFERS - queued;
+}
+
+void quad_decoder_init(QUAD_DEC_INIT_PARAMS_t *quad_dec_init_params)
+{
+    SetBits16(CLK_PER_REG, QUAD_ENABLE, 1);
+}
+
+int16_t quad_decoder_get_x_counter(void)
+{
+    return qdec_cnt;
+}
+
+void app_mouse_send_report(uint8_t buttons, int8_t x, int8_t y, int8_t wheel)
+{
+    if (queued == NB_BUFFERS) {
+        res->lost += abs(wheel);
+        count_head -= abs(wheel);          // the newest counts
+        return;
+    }
+    queued_counts[queued++] = abs(wheel);
+    res->reports++;
+}
+
+/*
+ * SIMULATION
+ ****************************************************************************************
+ */
+
+static double uniform(void)
+{
+    return rand() / (RAND_MAX + 1.0);
+}
+
+static bool wheel_armed(void)
+{
+    return (GetWord16(WKUP_SELECT_P0_REG + 2 * WHEEL_A_PORT) & (1 << WHEEL_A_PIN)) != 0;
+}
+
+// the connection event: sends the queued notifications, oldest first
+static void connection_event(void)
+{
+    int n = (queued < PKT_PER_EVT) ? queued : PKT_PER_EVT;
+    int i, c;
+
+    res->charge_uc += q_evt_uc + n * q_pkt_uc;
+    for (i = 0; i < n; i++) {
+        for (c = 0; c < queued_counts[i]; c++, count_tail++) {
+            res->delay_sum += now / 1e6 - count_time[count_tail % MAX_COUNTS];
+            res->delivered++;
+        }
+    }
+    memmove(queued_counts, &queued_counts[n], (queued - n) * sizeof(queued_counts[0]));
+    queued -= n;
+}
+
+static void run(const struct gesture *g, double interval_ms, bool per_irq, unsigned seed, struct result *r)
+{
+    const long interval_us = (long)(interval_ms * 1000);
+    long next_evt = interval_us, last_move = 0;
+    double next_detent = 1.0;
+    int left = 0;
+
+    memset(r, 0, sizeof(*r));
+    res = r;
+    srand(seed);
+    memset(sim_regs, 0, sizeof(sim_regs));
+    qdec_cnt = 0;
+    queued = 0;
+    count_head = count_tail = 0;
+    timer_expiry = -1;
+    wheel_cpt_event = 0;
+
+    app_wheel_init();
+    app_wheel_arm_wakeup();
+
+    for (now = 0; now < SESSION_S * 1000000L; now += TICK_US) {
+        qdec_on = (GetWord16(CLK_PER_REG) & QUAD_ENABLE) != 0;
+
+        // the wheel
+        if (now / 1e6 >= next_detent) {
+            if (left == 0) {
+                left = 1 + (int)(-g->detents * log(1.0 - uniform()));
+            }
+            if (qdec_on) {
+                qdec_cnt++;
+                count_time[count_head++ % MAX_COUNTS] = now / 1e6;
+                if (per_irq) {
+                    res->charge_uc += q_irq_uc;
+                    app_mouse_send_report(0, 0, 0, 1);
+                    app_wheel_poll();       // the IRQ design reads the same counter
+                }
+            } else if (wheel_armed()) {
+                // the Wakeup Controller: wakeup_handler() calls app_wheel_wakeup()
+                memset(&sim_regs[WKUP_SELECT_P0_REG], 0, 8 * sizeof(sim_regs[0]));
+                app_wheel_wakeup();
+                app_wheel_send_report();
+            }
+            last_move = now;
+            left--;
+            next_detent += (left > 0) ? (1.0 / g->rate) * (0.8 + 0.4 * uniform())
+                                      : -g->pause * log(1.0 - uniform());
+        }
+
+        // the connection event, then the main loop after its end
+        if (now >= next_evt) {
+            connection_event();
+            next_evt += interval_us;
+            if (!per_irq) {
+                wheel_cpt_event = 1;
+                app_wheel_send_report();
+            } else {
+                wheel_cpt_event = 0;
+                app_wheel_send_report();    // only starts the idle timer after a wakeup
+                wheel_delta = 0;
+            }
+        }
+
+        if ((timer_expiry >= 0) && (now >= timer_expiry)) {
+            timer_expiry = -1;
+            app_wheel_timer_handler(APP_WHEEL_TIMER, NULL, TASK_APP, TASK_APP);
+        }
+
+        if (app_wheel_is_active()) {
+            res->awake_s += TICK_US / 1e6;
+            res->charge_uc += i_idle_ma * TICK_US / 1000.0;
+        } else {
+            res->charge_uc += i_sleep_ua * TICK_US / 1e6;
+        }
+        if (now - last_move < 200000) {
+            res->moving_s += TICK_US / 1e6;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static const struct gesture gestures[] = {
+        {"slow, 4/s",       4,  5,  3.0},
+        {"normal, 15/s",    15, 10, 3.0},
+        {"fast, 40/s",      40, 20, 3.0},
+        {"flick, 120/s",    120, 40, 5.0},
+    };
+    double interval_ms = 15;
+    unsigned seed = 1, i;
+    struct result a, b;
+    int k;
+
+    for (k = 1; k + 1 < argc; k += 2) {
+        if (!strcmp(argv[k], "-i")) {
+            interval_ms = atof(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-s")) {
+            seed = atoi(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-sleep")) {
+            i_sleep_ua = atof(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-idle")) {
+            i_idle_ma = atof(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-evt")) {
+            q_evt_uc = atof(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-pkt")) {
+            q_pkt_uc = atof(argv[k + 1]);
+        } else if (!strcmp(argv[k], "-irq")) {
+            q_irq_uc = atof(argv[k + 1]);
+        }
+    }
+
+    printf("interval %.2fms, %d s per gesture type; app_wheel.c -> per IRQ\n", interval_ms, SESSION_S);
+    printf("%-14s %-18s %-14s %-18s %-18s %s\n", "gestures", "reports/s moving", "counts lost",
+           "delay ms", "out of sleep %", "current uA");
+    for (i = 0; i < sizeof(gestures) / sizeof(gestures[0]); i++) {
+        run(&gestures[i], interval_ms, false, seed, &a);
+        run(&gestures[i], interval_ms, true, seed, &b);
+        printf("%-14s %5.1f -> %-8.1f %5ld -> %-6ld %5.1f -> %-8.1f %5.1f -> %-8.1f %5.1f -> %.1f\n",
+               gestures[i].name,
+               a.reports / a.moving_s, b.reports / b.moving_s,
+               a.lost, b.lost,
+               a.delivered ? 1000 * a.delay_sum / a.delivered : 0.0,
+               b.delivered ? 1000 * b.delay_sum / b.delivered : 0.0,
+               100 * a.awake_s / SESSION_S, 100 * b.awake_s / SESSION_S,
+               a.charge_uc / SESSION_S, b.charge_uc / SESSION_S);
+    }
+    return 0;
+}
@@ -54,6 +54,14 @@
 #include "adc.h"
 #include "periph_setup.h"
 #include "arch_sleep.h"
+#ifdef KBD_LATENCY_TRACE_ON
+#include "app_kbd_trace.h"
+#endif
+#include "rwble_link_quality.h"
+#if (BLE_APP_PRESENT)
+#include "app_event.h"
+#include "app_energy.h"
+#endif
 
 uint8_t             rwble_last_event                __attribute__((section("retention_mem_area0"), zero_init));
 boost_overhead_st   set_boost_low_vbat1v_overhead   __attribute__((section("retention_mem_area0"), zero_init));
@@ -278,6 +286,10 @@ unsigned volatile char motion_cpt_event = 0;
 int transmitting_data = 0;
 #endif //(STREAMDATA_QUEUE)
 
+#if (HAS_QUADEC_WHEEL)
+unsigned volatile char wheel_cpt_event = 0;
+#endif
+
 #ifdef METRICS
 
 /**
@@ -294,34 +306,82 @@ int transmitting_data = 0;
  ****************************************************************************************
 */
 void metrics_packet_rx_func(uint8_t packet_error_status);
+#endif // METRICS
 
-void measure_errors_received(unsigned char pkts)
+/**
+ ****************************************************************************************
+ * @brief Passes the status of the packets received in the event in progress to the link
+ *        quality monitor (and to the metrics hook).
+ *
+ * @param[in] pkts  The packets not handled yet by lld_evt_rx_isr()
+ ****************************************************************************************
+*/
+static void measure_errors_received(unsigned char pkts)
 {
     uint8_t rx_cnt = pkts;
     uint8_t rx_hdl = co_buf_rx_current_get();
     struct lld_evt_tag *evt;
     evt = (struct lld_evt_tag *)co_list_pick(&lld_evt_env.evt_prog);
+    if (evt == NULL) {
+        return;
+    }
+#ifdef METRICS
     ke_task_id_t destid = (evt->conhdl == LLD_ADV_HDL) ? TASK_LLM : KE_BUILD_ID(TASK_LLC, evt->conhdl);
     uint16_t conhdl = KE_IDX_GET(destid);
+#endif
 
     while(rx_cnt--)
     {
         struct co_buf_rx_desc *rxdesc = co_buf_rx_get(rx_hdl);
-        unsigned char status = rxdesc->rxstatus & 0x7F;
-        uint8_t packet_error_status = 0;
-        
-        if ((status & (BLE_MIC_ERR_BIT | BLE_CRC_ERR_BIT | BLE_LEN_ERR_BIT | BLE_TYPE_ERR_BIT | BLE_SYNC_ERR_BIT))\
-           && (llc_env[conhdl]->rssi > llm_get_min_rssi()))
+        uint16_t status = rxdesc->rxstatus;
+
+        if (evt->conhdl != LLD_ADV_HDL) {
+            rwble_lq_rx(evt->conhdl, status);
+        }
+
+#ifdef METRICS
         {
-            packet_error_status = 1;
+            uint8_t packet_error_status = 0;
+
+            status &= 0x7F;
+            if ((status & (BLE_MIC_ERR_BIT | BLE_CRC_ERR_BIT | BLE_LEN_ERR_BIT | BLE_TYPE_ERR_BIT | BLE_SYNC_ERR_BIT))\
+               && (llc_env[conhdl]->rssi > llm_get_min_rssi()))
+            {
+                packet_error_status = 1;
+            }
+            
+            metrics_packet_rx_func(packet_error_status);
         }
-        
-        metrics_packet_rx_func(packet_error_status);
+#endif // METRICS
         
         rx_hdl = co_buf_rx_next(rx_hdl);
     }
 }
-#endif // METRICS
+
+/**
+ ****************************************************************************************
+ * @brief Handles the packets received at the end of an event and passes the end of a
+ *        connection event to the link quality monitor.
+ ****************************************************************************************
+*/
+static void measure_evt_end(void)
+{
+    struct lld_evt_tag *evt;
+    uint8_t rx_cnt;
+
+    evt = (struct lld_evt_tag *)co_list_pick(&lld_evt_env.evt_prog);
+    if (evt == NULL) {
+        return;
+    }
+    rx_cnt = ble_rxdesccnt_getf(evt->conhdl);
+
+    // Event has been processed, handle the transmitted and received data
+    measure_errors_received(rx_cnt - evt->rx_cnt);
+
+    if (evt->conhdl != LLD_ADV_HDL) {
+        rwble_lq_evt_end(evt->conhdl, lld_evt_time_get(), llc_env[evt->conhdl]->sup_to);
+    }
+}
 
 
 
@@ -357,6 +417,10 @@ void lld_sleep_compensate_func_patched(void)
     // Start the correction
     ble_deep_sleep_corr_en_setf(1);
 
+#if (BLE_APP_PRESENT)
+    APP_ENERGY_BLE_SLEPT(dur_us);
+#endif
+
 #if (DEVELOPMENT_DEBUG) && defined(USE_POWER_OPTIMIZATIONS)
     slp_period_retained = slp_period;
     // if this Assertion hits then the LP ISR lasts longer than the time
@@ -542,7 +606,10 @@ void BLE_SLP_Handler(void)
 	rf_reinit();	
 
     if ( ((lp_clk_sel == LP_CLK_RCX20) && (CFG_LP_CLK == LP_CLK_FROM_OTP)) || (CFG_LP_CLK == LP_CLK_RCX20) )
-        calibrate_rcx20(20);
+    {
+        rcx_track_wakeup();
+        rcx_track_start();
+    }
     
     rwble_last_event = BLE_EVT_SLP;
 }
@@ -577,9 +644,7 @@ void $Sub$$BLE_RX_Handler(void)
 #endif
 {
     
-#ifdef METRICS    
     measure_errors_received(LLD_RX_IRQ_THRES);
-#endif // METRICS
     lld_evt_rx_isr();
     //SetBits32(BLE_INTACK_REG, RXINTACK, 1);
 }
@@ -607,16 +672,22 @@ void $Sub$$BLE_EVENT_Handler(void)
 	motion_cpt_event = 0x1;
 #endif      
 #endif // STREAMDATA_QUEUE
+
+#if (HAS_QUADEC_WHEEL)
+        wheel_cpt_event = 0x1;
+#endif
+
+#ifdef KBD_LATENCY_TRACE_ON
+        app_kbd_trace_ble_evt_end();
+#endif
+
+#if (BLE_APP_PRESENT)
+        // Tx buffers have been freed, reports and stream data can be queued
+        app_event_set(APP_EVENT_TRM);
+        app_event_set(APP_EVENT_STREAM);
+#endif
         
-#ifdef METRICS
-        {
-            struct lld_evt_tag *evt;
-             evt = (struct lld_evt_tag *)co_list_pick(&lld_evt_env.evt_prog);
-             uint8_t rx_cnt = ble_rxdesccnt_getf(evt->conhdl);
-            // Event has been processed, handle the transmitted and received data
-             measure_errors_received( rx_cnt - evt->rx_cnt);
-        }            
-#endif // METRICS
+        measure_evt_end();
         
         lld_evt_end_isr();
         
@@ -815,10 +886,11 @@ void BLE_SLP_Handler(void)
     rf_reinit();	
 
     /*
-     * Start RCX calibration (if applicable).
+     * The RCX measurement in progress, if any, is lost. The next one is started at the fine
+     * target, when the XTAL16 runs.
      */
     if ( ((lp_clk_sel == LP_CLK_RCX20) && (CFG_LP_CLK == LP_CLK_FROM_OTP)) || (CFG_LP_CLK == LP_CLK_RCX20) )
-        calibrate_rcx20(20);
+        rcx_track_wakeup();
     
     /*
      * Mark event type.
@@ -915,7 +987,7 @@ void $Sub$$BLE_FINETGTIM_Handler(void)
         //SetBits32(BLE_INTACK_REG, FINETGTIMINTACK, 1);
 
         if ( ((lp_clk_sel == LP_CLK_RCX20) && (CFG_LP_CLK == LP_CLK_FROM_OTP)) || (CFG_LP_CLK == LP_CLK_RCX20) )
-            calibrate_rcx20(20);
+            rcx_track_start();
     }
 }
 
@@ -948,9 +1020,7 @@ void __wrap_BLE_RX_Handler(void)
 void $Sub$$BLE_RX_Handler(void)
 #endif
 {
-#ifdef METRICS    
     measure_errors_received(LLD_RX_IRQ_THRES);
-#endif // METRICS
     lld_evt_rx_isr();
     //SetBits32(BLE_INTACK_REG, RXINTACK, 1);
 }
@@ -979,19 +1049,22 @@ void $Sub$$BLE_EVENT_Handler(void)
 	motion_cpt_event = 0x1;
 #endif      
 #endif // STREAMDATA_QUEUE        
+
+#if (HAS_QUADEC_WHEEL)
+        wheel_cpt_event = 0x1;
+#endif
+
+#ifdef KBD_LATENCY_TRACE_ON
+        app_kbd_trace_ble_evt_end();
+#endif
+
+#if (BLE_APP_PRESENT)
+        // Tx buffers have been freed, reports and stream data can be queued
+        app_event_set(APP_EVENT_TRM);
+        app_event_set(APP_EVENT_STREAM);
+#endif
         
-#ifdef METRICS
-        {
-            struct lld_evt_tag *evt;
-            uint8_t rx_cnt;
-            
-            evt = (struct lld_evt_tag *)co_list_pick(&lld_evt_env.evt_prog);
-            rx_cnt = ble_rxdesccnt_getf(evt->conhdl);
-            
-            // Event has been processed, handle the transmitted and received data
-            measure_errors_received(rx_cnt - evt->rx_cnt);
-        }            
-#endif // METRICS
+        measure_evt_end();
         lld_evt_end_isr();
 
         rwble_last_event = BLE_EVT_END;
@@ -1034,6 +1107,9 @@ void $Sub$$BLE_RF_DIAG_Handler(void)
 #if (STREAMDATA_QUEUE)   
         transmitting_data=1;
 #endif  
+#if (BLE_APP_PRESENT)
+        app_event_set(APP_EVENT_STREAM);
+#endif
         rwble_last_event = BLE_EVT_TX;
         
 #ifdef PRODUCTION_TEST  
@@ -0,0 +1,254 @@
+/**
+ ****************************************************************************************
+ *
+ * @file rwble_link_quality.c
+ *
+ * @brief Link quality monitor: windowed error, missed anchor and retransmission rates per
+ *        connection.
+ *
+ * The counts of a window are turned into rates at its end and smoothed (1/4 of the new
+ * window), so about 20 bytes are kept per connection. The state is decided on the rates
+ * of the last window, so a degradation is reported RWBLE_LQ_WINDOW events after it starts
+ * at the latest; a link that goes silent is reported before a quarter of the supervision
+ * timeout has elapsed.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @addtogroup ROOT
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include "rwip_config.h"
+#include "arch.h"
+
+#include <string.h>
+#include "reg_blecore.h"
+#include "reg_ble_em_rx.h"
+#include "rwble_link_quality.h"
+#if (BLE_APP_PRESENT)
+#include "app_event.h"
+#endif
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// RX status bits of a packet received with an error
+#define RWBLE_LQ_ERR_BITS   (BLE_MIC_ERR_BIT | BLE_CRC_ERR_BIT | BLE_LEN_ERR_BIT | BLE_TYPE_ERR_BIT | BLE_SYNC_ERR_BIT)
+/// RX status bits of a retransmission
+#define RWBLE_LQ_RETX_BITS  (BLE_NESN_ERR_BIT | BLE_SN_ERR_BIT)
+
+struct rwble_lq_env_tag
+{
+    uint32_t last_ok;                               // base time of the last event with a valid packet
+    uint32_t silence;                               // slots from last_ok to the last event
+    uint16_t rx_ok;                                 // counts of the window
+    uint8_t rx_err;
+    uint8_t retx;
+    uint8_t missed;
+    uint8_t evts;
+    uint8_t evt_ok;                                 // valid packets in the event in progress
+    uint8_t per;                                    // smoothed rates, in %
+    uint8_t missed_avg;
+    uint8_t retx_avg;
+    uint8_t state;
+    uint8_t better;                                 // better windows in a row
+    bool started;                                   // last_ok is valid
+};
+
+struct rwble_lq_env_tag rwble_lq_env[BLE_CONNECTION_MAX_USER]   __attribute__((section("retention_mem_area0"), zero_init));
+
+/*
+ * LOCAL FUNCTIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief       Gets a rate.
+ *
+ * @return      n in % of total, 0 if total is 0
+ ****************************************************************************************
+ */
+static uint8_t rwble_lq_pct(uint16_t n, uint16_t total)
+{
+    return total ? (uint8_t)((100UL * n) / total) : 0;
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Gets the state that matches the rates of a window.
+ *
+ * @return      The state
+ ****************************************************************************************
+ */
+static uint8_t rwble_lq_level(uint8_t per, uint8_t missed, uint8_t retx)
+{
+    if ((per >= RWBLE_LQ_POOR_PER) || (missed >= RWBLE_LQ_POOR_MISSED) || (retx >= RWBLE_LQ_POOR_RETX)) {
+        return RWBLE_LQ_POOR;
+    }
+    if ((per >= RWBLE_LQ_FAIR_PER) || (missed >= RWBLE_LQ_FAIR_MISSED) || (retx >= RWBLE_LQ_FAIR_RETX)) {
+        return RWBLE_LQ_FAIR;
+    }
+    return RWBLE_LQ_GOOD;
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Changes the state of a link and lets the application know.
+ *
+ * @param[in]   lq      The link
+ * @param[in]   state   The new state
+ ****************************************************************************************
+ */
+static void rwble_lq_set_state(struct rwble_lq_env_tag *lq, uint8_t state)
+{
+    if (lq->state != state) {
+        lq->state = state;
+#if (BLE_APP_PRESENT)
+        app_event_set(APP_EVENT_LINK_QUALITY);
+#endif
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Ends a window: smooths its rates and updates the state.
+ *
+ * @param[in]   lq      The link
+ ****************************************************************************************
+ */
+static void rwble_lq_window_end(struct rwble_lq_env_tag *lq)
+{
+    const uint16_t rx = lq->rx_ok + lq->rx_err;
+    const uint8_t per = rwble_lq_pct(lq->rx_err, rx);
+    const uint8_t missed = rwble_lq_pct(lq->missed, lq->evts);
+    const uint8_t retx = rwble_lq_pct(lq->retx, lq->rx_ok);
+    const uint8_t level = rwble_lq_level(per, missed, retx);
+
+    lq->per = (3 * lq->per + per) / 4;
+    lq->missed_avg = (3 * lq->missed_avg + missed) / 4;
+    lq->retx_avg = (3 * lq->retx_avg + retx) / 4;
+
+    if (level >= lq->state) {
+        lq->better = 0;
+        rwble_lq_set_state(lq, level);
+    } else if (++lq->better >= RWBLE_LQ_RECOVER_WINDOWS) {
+        lq->better = 0;
+        rwble_lq_set_state(lq, lq->state - 1);
+    }
+
+    lq->rx_ok = 0;
+    lq->rx_err = 0;
+    lq->retx = 0;
+    lq->missed = 0;
+    lq->evts = 0;
+}
+
+/*
+ * EXPORTED FUNCTIONS
+ ****************************************************************************************
+ */
+
+void rwble_lq_reset(uint16_t conhdl)
+{
+    if (conhdl < BLE_CONNECTION_MAX_USER) {
+        memset(&rwble_lq_env[conhdl], 0, sizeof(struct rwble_lq_env_tag));
+    }
+}
+
+
+void rwble_lq_rx(uint16_t conhdl, uint16_t status)
+{
+    struct rwble_lq_env_tag *lq;
+
+    if (conhdl >= BLE_CONNECTION_MAX_USER) {
+        return;
+    }
+    lq = &rwble_lq_env[conhdl];
+
+    if (status & RWBLE_LQ_ERR_BITS) {
+        if (lq->rx_err < 0xFF) {
+            lq->rx_err++;
+        }
+        return;
+    }
+
+    lq->rx_ok++;
+    if (lq->evt_ok < 0xFF) {
+        lq->evt_ok++;
+    }
+    if ((status & RWBLE_LQ_RETX_BITS) && (lq->retx < 0xFF)) {
+        lq->retx++;
+    }
+}
+
+
+void rwble_lq_evt_end(uint16_t conhdl, uint32_t now, uint16_t sup_to)
+{
+    struct rwble_lq_env_tag *lq;
+
+    if (conhdl >= BLE_CONNECTION_MAX_USER) {
+        return;
+    }
+    lq = &rwble_lq_env[conhdl];
+
+    if (lq->evt_ok || !lq->started) {
+        lq->last_ok = now;
+        lq->started = true;
+    }
+    if (!lq->evt_ok) {
+        lq->missed++;
+    }
+    lq->evt_ok = 0;
+
+    // a quarter of the supervision timeout, in slots: sup_to * 16 / 4
+    lq->silence = (now - lq->last_ok) & BLE_BASETIMECNT_MASK;
+    if (lq->silence >= ((uint32_t)sup_to * 4)) {
+        lq->better = 0;
+        rwble_lq_set_state(lq, RWBLE_LQ_POOR);
+    }
+
+    if (++lq->evts >= RWBLE_LQ_WINDOW) {
+        rwble_lq_window_end(lq);
+    }
+}
+
+
+void rwble_lq_get(uint16_t conhdl, struct rwble_lq_info *info)
+{
+    const struct rwble_lq_env_tag *lq;
+
+    memset(info, 0, sizeof(struct rwble_lq_info));
+    if (conhdl >= BLE_CONNECTION_MAX_USER) {
+        return;
+    }
+    lq = &rwble_lq_env[conhdl];
+
+    GLOBAL_INT_STOP();
+    info->state = lq->state;
+    info->per = lq->per;
+    info->missed = lq->missed_avg;
+    info->retx = lq->retx_avg;
+    info->silence = lq->silence;
+    GLOBAL_INT_START();
+}
+
+/// @} RWBLE
@@ -0,0 +1,133 @@
+/**
+ ****************************************************************************************
+ *
+ * @file rwble_link_quality.h
+ *
+ * @brief Link quality monitor: windowed error, missed anchor and retransmission rates per
+ *        connection.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef RWBLE_LINK_QUALITY_H_
+#define RWBLE_LINK_QUALITY_H_
+
+/*
+ ****************************************************************************************
+ * USAGE
+ * The BLE interrupt handlers of rwble.c report each received packet (rwble_lq_rx()) and
+ * the end of each connection event (rwble_lq_evt_end()). The monitor counts over windows
+ * of RWBLE_LQ_WINDOW events:
+ * - the packets received with an error (CRC, length, type, MIC, sync),
+ * - the missed anchors: events without a valid packet from the master,
+ * - the retransmissions: valid packets that do not acknowledge the last packet sent
+ *   (NESN error) or repeat the last packet received (SN error).
+ *
+ * The link is RWBLE_LQ_POOR, RWBLE_LQ_FAIR or RWBLE_LQ_GOOD by the rates of the last
+ * window. It becomes worse at the end of the window that shows it, and at once when
+ * nothing valid has been received for a quarter of the supervision timeout. It becomes
+ * better by one level after RWBLE_LQ_RECOVER_WINDOWS better windows in a row.
+ *
+ * Changes of state set APP_EVENT_LINK_QUALITY. The application reads the state and the
+ * smoothed rates with rwble_lq_get() and calls rwble_lq_reset() for each new connection.
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Connection events per window
+#define RWBLE_LQ_WINDOW                 (32)
+/// Better windows in a row before the state becomes better
+#define RWBLE_LQ_RECOVER_WINDOWS        (2)
+
+/// Thresholds in % of the window: packet errors, missed anchors, retransmissions
+#define RWBLE_LQ_FAIR_PER               (10)
+#define RWBLE_LQ_FAIR_MISSED            (10)
+#define RWBLE_LQ_FAIR_RETX              (25)
+#define RWBLE_LQ_POOR_PER               (30)
+#define RWBLE_LQ_POOR_MISSED            (30)
+#define RWBLE_LQ_POOR_RETX              (50)
+
+/// Link quality, the best first
+enum rwble_lq_state
+{
+    RWBLE_LQ_GOOD,
+    RWBLE_LQ_FAIR,
+    RWBLE_LQ_POOR,
+};
+
+/// Link quality published to the application
+struct rwble_lq_info
+{
+    uint8_t state;                      ///< enum rwble_lq_state
+    uint8_t per;                        ///< % of the packets received with an error, smoothed
+    uint8_t missed;                     ///< % of the anchors missed, smoothed
+    uint8_t retx;                       ///< % of the valid packets with a retransmission, smoothed
+    uint32_t silence;                   ///< slots (625us) from the last valid packet to the last event
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief       Starts over, when a connection is established.
+ *
+ * @param[in]   conhdl  The connection
+ ****************************************************************************************
+ */
+void rwble_lq_reset(uint16_t conhdl);
+
+/**
+ ****************************************************************************************
+ * @brief       Counts a received packet. Called from the BLE interrupt handlers.
+ *
+ * @param[in]   conhdl  The connection
+ * @param[in]   status  The RX status of its descriptor
+ ****************************************************************************************
+ */
+void rwble_lq_rx(uint16_t conhdl, uint16_t status);
+
+/**
+ ****************************************************************************************
+ * @brief       Counts the end of a connection event. Called from the BLE interrupt
+ *              handler, after the packets of the event have been counted.
+ *
+ * @param[in]   conhdl  The connection
+ * @param[in]   now     Base time, in slots
+ * @param[in]   sup_to  Supervision timeout, in 10ms units
+ ****************************************************************************************
+ */
+void rwble_lq_evt_end(uint16_t conhdl, uint32_t now, uint16_t sup_to);
+
+/**
+ ****************************************************************************************
+ * @brief       Gets the quality of a link.
+ *
+ * @param[in]   conhdl  The connection
+ * @param[out]  info    The state and the smoothed rates
+ ****************************************************************************************
+ */
+void rwble_lq_get(uint16_t conhdl, struct rwble_lq_info *info);
+
+#endif // RWBLE_LINK_QUALITY_H_
@@ -168,6 +168,15 @@ enum APP_MSG
     APP_MOT_TIMER,
     APP_MOT_DIS_TIMER,
 #endif
+
+#if (HAS_QUADEC_WHEEL)
+    APP_WHEEL_TIMER,
+#endif
+
+#if (HAS_SPI_FLASH_ASYNC)
+    APP_FLASH_ASYNC_TIMER,
+    APP_FLASH_ASYNC_CMP_IND,
+#endif
 };
 
 /*
@@ -38,6 +38,14 @@
 #include "app_motion_sensor.h"
 #endif
 
+#if (HAS_QUADEC_WHEEL)
+#include "app_wheel.h"
+#endif
+
+#if (HAS_SPI_FLASH_ASYNC)
+#include "app_flash_async.h"
+#endif
+
 #if (USE_CONNECTION_FSM)
 #include "app_con_fsm_task.h"
 #endif
@@ -111,6 +119,9 @@ EXTERN KBD_TYPE_QUALIFIER struct ke_msg_handler app_default_state[] KBD_ARRAY_AT
     {APP_MOT_TIMER,                         (ke_msg_func_t)app_motion_timer_handler},
     {APP_MOT_DIS_TIMER,                     (ke_msg_func_t)app_motion_disconnect_timer_handler},
 #endif
+#if (HAS_QUADEC_WHEEL)
+    {APP_WHEEL_TIMER,                       (ke_msg_func_t)app_wheel_timer_handler},
+#endif
 #if (HAS_KEYBOARD_LEDS)
     {APP_GREEN_LED_TIMER,                   (ke_msg_func_t)app_green_led_timer_handler},
     {APP_RED_LED_TIMER,                     (ke_msg_func_t)app_red_led_timer_handler},
@@ -182,6 +193,10 @@ EXTERN KBD_TYPE_QUALIFIER struct ke_msg_handler app_default_state[] KBD_ARRAY_AT
     {SPOTAR_CREATE_DB_CFM,                  (ke_msg_func_t)spotar_create_db_cfm_handler},
 #endif //BLE_SPOTA_RECEIVER
 
+#if (HAS_SPI_FLASH_ASYNC)
+    {APP_FLASH_ASYNC_TIMER,                 (ke_msg_func_t)app_flash_async_timer_handler},
+#endif
+
 #if BLE_APP_SMARTTAG    
     {APP_ADV_TIMER,							(ke_msg_func_t)app_adv_timer_handler},
     {APP_ADV_BLINK_TIMER,					(ke_msg_func_t)app_adv_blink_timer_handler},  
@@ -35,6 +35,7 @@
 #include "bass_task.h"
 #include "app_batt.h"
 #include "gpio.h"
+#include "arch.h"
 #include "battery.h" 
 
 uint16_t bat_poll_timeout __attribute__((section("retention_mem_area0"),zero_init)); //@RETENTION MEMORY
@@ -178,7 +179,10 @@ void app_batt_lvl(void)
 #endif
 	
 	if (batt_lvl != cur_batt_level)
+	{
 		app_batt_set_level(batt_lvl);
+		rcx_track_kick();	// the RCX20 frequency follows the supply voltage
+	}
 	
 	//update old_batt_lvl for the next use
 	cur_batt_level = batt_lvl;
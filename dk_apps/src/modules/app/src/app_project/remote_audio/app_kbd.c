@@ -42,6 +42,13 @@
 #include "app_con_fsm_debug.h"
 
 #include "wkupct_quadec.h"
+#if (HAS_QUADEC_WHEEL)
+#include "app_wheel.h"
+#endif
+#include "app_mouse.h"
+#include "app_kbd_trace.h"
+#include "app_event.h"
+#include "app_energy.h"
 #include "app_stream.h"
 #include "app_kbd_matrix.h"
 
@@ -123,6 +130,10 @@ struct debounce_counter_t kbd_bounce_counters[DEBOUNCE_BUFFER_SIZE];// counter f
 uint8_t kbd_global_deb_cnt;                                         // counts down for press debouncing time when after a scan no new key has been detected
 bool sync_key_press_evt;                                            // flag to indicate a Key press to the high-level FSM synchronously to the BLE
 
+#ifdef KBD_ROW_TIME_MEASURE_ON
+uint32_t kbd_row_proc_ticks_max;                                    // worst-case time (SysTick ticks) spent in a row scan step, must stay below ROW_SCAN_TIME
+#endif
+
 #if (HAS_AUDIO)
 bool user_audio_sw_pressed=false;
 bool user_audio_sw_released=false;
@@ -292,6 +303,7 @@ kbd_rep_info *kbd_search_in_list(kbd_rep_info *list, enum KEY_BUFF_TYPE type)
 static inline void systick_start(const int ticks, const int mode)
 {
     systick_hit = false;
+    KBD_TRACE_SYSTICK_STOP();
 	SetWord32(0xE000E010, 0x00000000);      // disable systick
 	SetWord32(0xE000E014, ticks);           // set systick timeout based on 16MHz clock
 	SetWord32(0xE000E018, ticks);           // set systick timeout based on 16MHz clock
@@ -312,6 +324,7 @@ static inline void systick_start(const int ticks, const int mode)
 static inline void systick_stop(void)
 {
 	// leave systick in a known state
+    KBD_TRACE_SYSTICK_STOP();
 	SetWord32(0xE000E010, 0x00000000);      // disable systick
 	GetWord32(0xE000E010);                  // make sure COUNTFLAG is reset
 }
@@ -529,6 +542,9 @@ bool app_kbd_scan_matrix(int *row)
     int j;
 	int8_t prev_line = -1;
 	const scan_t scanmask = (1 << KBD_NR_INPUTS) - 1;
+#ifdef KBD_ROW_TIME_MEASURE_ON
+    const uint32_t row_start = GetWord32(0xE000E018);
+#endif
 
 	ASSERT_ERROR(kbd_membrane_status != 0);
     
@@ -580,13 +596,21 @@ bool app_kbd_scan_matrix(int *row)
 		// so this is a great time to spend some cycles to process the previous readout
 			
 		// fill in the scanword bits (we have plenty of time to burn these cycles
+#if defined(KBD_LAYOUT_GENERATED)
+        // one masked shift per (port, distance) group, see the generated gather plan
+		scanword = KBD_INPUT_GATHER(kbd_gpio_in);
+#else
 		for (j = KBD_NR_INPUTS - 1; j >= 0; --j) {
 			const uint8_t input_port = kbd_input_ports[j];
 			scanword = (scanword << 1) | ((kbd_gpio_in[input_port >> 4] >> (input_port & 0x0F)) & 1);
 		}
+#endif
         
         // if key press and there's no debouncing counter set for the key => new key press is detected!
         if ( ((~scanword & scanmask) != kbd_bounce_rows[prev_line]) ) {  // if the button is not being debounced
+            if (!kbd_new_key_detected) {
+                KBD_TRACE(KBD_TRACE_KEY_DETECTED, prev_line);
+            }
             kbd_new_key_detected = true;
         }
         // update scan status
@@ -601,6 +625,19 @@ bool app_kbd_scan_matrix(int *row)
 
 	*row = i + 1;
 	
+#ifdef KBD_ROW_TIME_MEASURE_ON
+    {
+        // SysTick counts down and reloads at 0
+        const uint32_t row_end = GetWord32(0xE000E018);
+        const uint32_t elapsed = (row_start >= row_end) ? (row_start - row_end) : (row_start + GetWord32(0xE000E014) - row_end);
+        
+        if (elapsed > kbd_row_proc_ticks_max) {
+            kbd_row_proc_ticks_max = elapsed;
+        }
+        ASSERT_WARNING(elapsed < (ROW_SCAN_TIME * SYSTICK_TICKS_PER_US));
+    }
+#endif
+
     // 6. processing of the results has to be done just after the last row has been scanned
     // no need to have a separate state for this! idle time follows the completion of the processing!
     if (i == KBD_NR_OUTPUTS) {
@@ -696,7 +733,7 @@ static inline int debounce_key(const uint16 output, const uint16 input, const in
     // keymap and may appear in secondary keymaps as well.
     // if this is not sufficient for a specific application then additional 
     // logic needs to be implemented.
-    if (kbd_keymap[0][output][input] == 0) {
+    if (kbd_keymap_get(0, output, input) == 0) {
         return 0;                       // this key does not exist in the default 
     }                                    // keymap => it's a ghost!
 
@@ -903,13 +940,13 @@ static inline int record_key(const uint16 output, const uint16 input, const int
                             // indicate the current status of the matrix but the previous one!
                             int cnt = 0;
                             
-                            if (kbd_keymap[0][output][i]) {
+                            if (kbd_keymap_get(0, output, i)) {
                                 cnt++;
                             }
-                            if (kbd_keymap[0][o][input]) {
+                            if (kbd_keymap_get(0, o, input)) {
                                 cnt++;
                             }
-                            if (kbd_keymap[0][o][i]) {
+                            if (kbd_keymap_get(0, o, i)) {
                                 cnt++;
                             }
                             if (cnt == 3) {
@@ -941,13 +978,13 @@ static inline int record_key(const uint16 output, const uint16 input, const int
                     if ( !d1 || !d2 ) {      // at least one row uses an extra column. a "square" is formed
                         int cnt = 0;
                         
-                        if (kbd_keymap[0][output][i]) {
+                        if (kbd_keymap_get(0, output, i)) {
                             cnt++;
                         }
-                        if (kbd_keymap[0][o][input]) {
+                        if (kbd_keymap_get(0, o, input)) {
                             cnt++;
                         }
-                        if (kbd_keymap[0][o][i]) {
+                        if (kbd_keymap_get(0, o, i)) {
                             cnt++;
                         }
                         if (cnt == 3) {
@@ -962,8 +999,8 @@ static inline int record_key(const uint16 output, const uint16 input, const int
     // if no ghosting, then continue to buffer.
     bool block_key = false;
     
-    if ((kbd_keymap[kbd_fn_modifier][output][input] >> 8) == 0xF8) { // 'Fn'
-        uint8_t keychar = kbd_keymap[kbd_fn_modifier][output][input] & 0xFF;
+    if ((kbd_keymap_get(kbd_fn_modifier, output, input) >> 8) == 0xF8) { // 'Fn'
+        uint8_t keychar = kbd_keymap_get(kbd_fn_modifier, output, input) & 0xFF;
         kbd_fn_modifier = (kbd_fn_modifier & (~keychar)) | (pressed ? keychar : 0);
         block_key = true;   // do not send KEY_PRESS_EVT for 'Fn' press / release
                             // advertising does not start by pressing 'Fn' since 
@@ -971,7 +1008,7 @@ static inline int record_key(const uint16 output, const uint16 input, const int
     }
         
     // exception: 'Fn'+'c' is served asynchronously to make sure the storage memory can be cleared even when we are disconnected
-    if (kbd_keymap[kbd_fn_modifier][output][input] == CLRP) {
+    if (kbd_keymap_get(kbd_fn_modifier, output, input) == CLRP) {
         if (!pressed) {
             app_alt_pair_clear_all_bond_data();
             app_con_fsm_request_reset_bonding_data(true);
@@ -999,6 +1036,10 @@ static inline int record_key(const uint16 output, const uint16 input, const int
         kbd_keycode_buffer[kbd_keycode_buffer_tail].input = input;
         kbd_keycode_buffer[kbd_keycode_buffer_tail].output = output;
         kbd_keycode_buffer_tail = next_tail;
+
+        // HID reports are prepared when the BLE runs. Wake it up if it sleeps.
+        app_event_set(APP_EVENT_TRM);
+        app_event_set(APP_EVENT_BLE_WAKEUP);
     }
     else {
         keycode_buf_overflow = true;
@@ -1338,6 +1379,7 @@ static void kbd_start_sw_scanning(void)
     full_scan = true;                   // Force a full key scan
     
     update_scan_times();                // Start SysTick
+    KBD_TRACE(KBD_TRACE_SCAN_START, 0);
     GLOBAL_INT_DISABLE();
     kbd_membrane_output_wakeup();       // Set outputs to 'high-Z' to enable SW scanning
 
@@ -1692,7 +1734,7 @@ static int modify_kbd_keyreport(const char keymode, const char keychar, uint8_t
                     uint8_t input = roll_over_info.intersections[i];
                     uint8_t output = (roll_over_info.intersections[i] >> 8) & 0x3F;
                     
-                    pReportInfo->pBuf[i+2] = kbd_keymap[fn_mod][output][input];
+                    pReportInfo->pBuf[i+2] = kbd_keymap_get(fn_mod, output, input);
                 }
                 return 1;
             }
@@ -1791,7 +1833,7 @@ static int kbd_process_keycode(struct keycode_buffer_tag *keycode_idx)
     const int pressed = keycode_idx->flags & KEY_STATUS_MASK;
     const uint8_t output = keycode_idx->output;
     const uint8_t input = keycode_idx->input;
-    const uint16_t keycode = kbd_keymap[fn_mod][output][input];
+    const uint16_t keycode = kbd_keymap_get(fn_mod, output, input);
     const int intersection = (output << 8) | (input);
 
     // Roll-Over processing (all key releases are cleared from the Roll-Over buffer)
@@ -1942,6 +1984,7 @@ static int kbd_process_keycode(struct keycode_buffer_tag *keycode_idx)
                         } else {
                             user_motion_keys_pressed = false;
                         }
+                        app_event_set(APP_EVENT_BLE_WAKEUP);    // the motion state machine runs when the BLE runs
                         break;
                     case 6:
                         if (pressed) {
@@ -1995,6 +2038,7 @@ static int kbd_process_keycode(struct keycode_buffer_tag *keycode_idx)
 static int prepare_kbd_keyreport(void)
 {
     int ret;
+    int processed = 0;
     
     if (kbd_free_list == NULL) {
         return 0;
@@ -2012,9 +2056,14 @@ static int prepare_kbd_keyreport(void)
         ret = kbd_process_keycode(&kbd_keycode_buffer[kbd_keycode_buffer_head]);
         if (ret) {
             kbd_keycode_buffer_head = (kbd_keycode_buffer_head + 1) % KEYCODE_BUFFER_SIZE;
+            processed++;
         }
     } while ( ret && kbd_free_list && (keycode_buffer_written_sz() > 0) );
 
+    if (processed) {
+        KBD_TRACE(KBD_TRACE_REPORT_PREPARED, processed);
+    }
+
     return 1;
 }
 
@@ -2060,6 +2109,7 @@ static int send_boot_report(void)
                             (int)p->pBuf[0], (int)p->pBuf[2], (int)p->pBuf[3], (int)p->pBuf[4], (int)p->pBuf[5], (int)p->pBuf[6], (int)p->pBuf[7]);
                             
                 ke_msg_send(req);
+                KBD_TRACE(KBD_TRACE_HOGPD_REQ, 0);
 
                 memcpy(normal_key_report_st, p->pBuf, 8);
             }
@@ -2118,6 +2168,7 @@ static int send_hid_report(void)
         app_stream_send_keyreport(req);
 #endif                    
         ke_msg_send(req);
+        KBD_TRACE(KBD_TRACE_HOGPD_REQ, p->char_id);
 
         switch (p->char_id) {
         case NORMAL_REPORT:
@@ -2227,6 +2278,8 @@ void KEYBRD_Handler(void)
     next_is_full_scan = true;
         
     kbd_cntrl_active = false;
+
+    KBD_TRACE(KBD_TRACE_KBD_IRQ, KBD_TRACE_START_ACTIVE);
 }
 
 
@@ -2248,6 +2301,9 @@ void wakeup_handler(void)
 {
 	NVIC_DisableIRQ(WKUP_QUADEC_IRQn);
 	
+    KBD_TRACE(KBD_TRACE_WAKEUP, !GetBits16(SYS_STAT_REG, PER_IS_DOWN) ? KBD_TRACE_START_ACTIVE :
+                                (app_get_sleep_mode() == 2) ? KBD_TRACE_START_DEEP_SLEEP : KBD_TRACE_START_EXT_SLEEP);
+
 	/*
 	* Init System Power Domain blocks: GPIO, WD Timer, Sys Timer, etc.
 	* Power up and init Peripheral Power Domain blocks,
@@ -2257,6 +2313,10 @@ void wakeup_handler(void)
 		periph_init();
     }
     
+#if (HAS_QUADEC_WHEEL)
+    app_wheel_wakeup();             // the wakeup may have come from the wheel
+#endif
+
 #ifdef DELAYED_WAKEUP_ON
 	/*
 	* Notify HID Application to start delay monitoring
@@ -2270,16 +2330,19 @@ void wakeup_handler(void)
             trigger_kbd_delayed_start_st = RELEASED_TRIGGER;
         }
         monitor_kbd_delayed_start_st = MONITOR_IDLE;
+        app_event_set(APP_EVENT_DELAYED_START);
     }
     else {
         trigger_kbd_delayed_start_st = NO_TRIGGER;
         wkup_hit = true;
+        app_event_set(APP_EVENT_KBD_SCAN);
     }
 #else
 	/*
 	* Notify HID Application to start scanning
 	*/
 	wkup_hit = true;
+    app_event_set(APP_EVENT_KBD_SCAN);
 #endif
 }
 
@@ -2388,6 +2451,7 @@ void app_kbd_enable_delayed_scanning(bool press)
                 // Emulate interrupt hit
                 monitor_kbd_delayed_start_st = MONITOR_IDLE;
                 trigger_kbd_delayed_start_st = RELEASED_TRIGGER;
+                app_event_set(APP_EVENT_DELAYED_START);
                 
                 SetBits16(WKUP_CTRL_REG, WKUP_ENABLE_IRQ, 0); //No more interrupts of this kind
                 // close WKUP
@@ -2429,6 +2493,10 @@ static void app_kbd_enable_wakeup_irq(void)
     SetWord16(WKUP_POL_P2_REG, wkup_mask_p2);    
     SetWord16(WKUP_POL_P3_REG, wkup_mask_p3);    
 
+#if (HAS_QUADEC_WHEEL)
+    app_wheel_arm_wakeup();                                         // add the wheel pins, if the wheel is idle
+#endif
+
     SetWord16(WKUP_RESET_IRQ_REG, 1);                               // clear any garbagge
     NVIC_ClearPendingIRQ(WKUP_QUADEC_IRQn);                         // clear it to be on the safe side...
 
@@ -2459,8 +2527,13 @@ void SysTick_Handler(void)
 { 
 	ASSERT_ERROR(kbd_membrane_status != 0);
     
-    if (current_scan_state != KEY_SCAN_INACTIVE)
-    systick_hit = true;
+    KBD_TRACE_SYSTICK_WRAP();
+    APP_ENERGY_AWAKE((GetWord32(0xE000E014) + 1) / SYSTICK_TICKS_PER_US);     // one period of the SysTick
+
+    if (current_scan_state != KEY_SCAN_INACTIVE) {
+        systick_hit = true;
+        app_event_set(APP_EVENT_KBD_SCAN);
+    }
 }
 
 
@@ -2510,6 +2583,7 @@ void app_keyboard_init(void)
     // Clear status
     wkup_hit = false;
 
+    app_event_set(APP_EVENT_KBD_SCAN);  // the scan FSM leaves KEY_SCAN_INACTIVE on its first run
 
     kbd_init_keyreport();           // Initialize key report buffers and vars and the fn modifier var
 
@@ -2586,6 +2660,12 @@ void app_hid_create_db(void)
    features->report_char_cfg[8] = HOGPD_CFG_REPORT_IN | HOGPD_REPORT_NTF_CFG_MASK | HOGPD_CFG_REPORT_WR;
 #endif
 
+#if (HAS_MOUSE_REPORT)
+    //------Mouse report (wheel, motion pointer)
+    features->report_nb          = MOUSE_REPORT_NR + 1;
+    features->report_char_cfg[MOUSE_REPORT_NR] = HOGPD_CFG_REPORT_IN | HOGPD_REPORT_NTF_CFG_MASK | HOGPD_CFG_REPORT_WR;
+#endif
+
     hid_info->bcdHID = 0x100;
     hid_info->bCountryCode = 0;
     if (HAS_REMOTE_WAKEUP) {
@@ -2896,7 +2976,7 @@ int app_kbd_prepare_keyreports(void)
                         int pressed = kbd_keycode_buffer[kbd_keycode_buffer_head].flags & KEY_STATUS_MASK;
                         uint8_t output = kbd_keycode_buffer[kbd_keycode_buffer_head].output;
                         uint8_t input = kbd_keycode_buffer[kbd_keycode_buffer_head].input;
-                        uint16_t keycode = kbd_keymap[fn_mod][output][input];
+                        uint16_t keycode = kbd_keymap_get(fn_mod, output, input);
                         const char keymode = keycode >> 8;
                         const char keychar = keycode & 0xFF;
                         
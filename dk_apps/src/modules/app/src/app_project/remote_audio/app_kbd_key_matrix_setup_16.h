@@ -11,6 +11,12 @@
  ****************************************************************************************
  */
 
+/*
+ * GENERATED FILE - DO NOT EDIT.
+ * Generated by misc/kbd_matrix_gen/kbd_matrix_gen.py from misc/kbd_matrix_gen/layouts/setup_16.kbd.
+ */
+
+
 #ifndef _APP_KBD_KEY_MATRIX_SETUP_16_H_
     #define _APP_KBD_KEY_MATRIX_SETUP_16_H_
 
@@ -30,18 +36,16 @@
  */
 __INLINE void declare_keyboard_gpios()
 {
-    RESERVE_GPIO(INPUT_COL_0,       GPIO_PORT_2, GPIO_PIN_4, PID_GPIO);
-    RESERVE_GPIO(INPUT_COL_1,       GPIO_PORT_3, GPIO_PIN_5, PID_GPIO);
-    RESERVE_GPIO(INPUT_COL_2,       GPIO_PORT_2, GPIO_PIN_5, PID_GPIO);
-    RESERVE_GPIO(INPUT_COL_3,       GPIO_PORT_2, GPIO_PIN_6, PID_GPIO);
-    RESERVE_GPIO(INPUT_COL_4,       GPIO_PORT_2, GPIO_PIN_0, PID_GPIO);
-		RESERVE_GPIO(INPUT_COL_5,       GPIO_PORT_2, GPIO_PIN_9, PID_GPIO);
-    RESERVE_GPIO(OUTPUT_ROW_0,      GPIO_PORT_1, GPIO_PIN_0, PID_GPIO);
-    RESERVE_GPIO(OUTPUT_ROW_1,      GPIO_PORT_3, GPIO_PIN_6, PID_GPIO);
-    RESERVE_GPIO(OUTPUT_ROW_2,      GPIO_PORT_1, GPIO_PIN_2, PID_GPIO);
-    RESERVE_GPIO(OUTPUT_ROW_3,      GPIO_PORT_1, GPIO_PIN_1, PID_GPIO);
-    //RESERVE_GPIO(OUTPUT_ROW_4,      GPIO_PORT_1, GPIO_PIN_1, PID_GPIO);
-    //RESERVE_GPIO(OUTPUT_ROW_5,      GPIO_PORT_2, GPIO_PIN_8, PID_GPIO);
+    RESERVE_GPIO(INPUT_COL_0,      GPIO_PORT_2, GPIO_PIN_4, PID_GPIO);
+    RESERVE_GPIO(INPUT_COL_1,      GPIO_PORT_3, GPIO_PIN_5, PID_GPIO);
+    RESERVE_GPIO(INPUT_COL_2,      GPIO_PORT_2, GPIO_PIN_5, PID_GPIO);
+    RESERVE_GPIO(INPUT_COL_3,      GPIO_PORT_2, GPIO_PIN_6, PID_GPIO);
+    RESERVE_GPIO(INPUT_COL_4,      GPIO_PORT_2, GPIO_PIN_0, PID_GPIO);
+    RESERVE_GPIO(INPUT_COL_5,      GPIO_PORT_2, GPIO_PIN_9, PID_GPIO);
+    RESERVE_GPIO(OUTPUT_ROW_0,     GPIO_PORT_1, GPIO_PIN_0, PID_GPIO);
+    RESERVE_GPIO(OUTPUT_ROW_1,     GPIO_PORT_3, GPIO_PIN_6, PID_GPIO);
+    RESERVE_GPIO(OUTPUT_ROW_2,     GPIO_PORT_1, GPIO_PIN_2, PID_GPIO);
+    RESERVE_GPIO(OUTPUT_ROW_3,     GPIO_PORT_1, GPIO_PIN_1, PID_GPIO);
 }
 
 /// @} APP
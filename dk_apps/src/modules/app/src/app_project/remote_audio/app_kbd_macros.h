@@ -59,6 +59,11 @@
     #define SET_INPUT_MODE_REG(x)   ( (COLUMN_##x##_PORT < 4) ? ( ((P00_MODE_REG - P0_DATA_REG) + (COLUMN_##x##_PORT == 3 ? 4 : COLUMN_##x##_PORT) * 0x20) + (COLUMN_##x##_PIN * 2) ) : (0) )
 #endif
 
+// Input gather plan of generated layouts: the bit of column x in its port data word
+// (0 if the column has been remapped) and the scanword bit of a remapped column
+#define SET_GATHER_BIT(x)       ( ((COL(x) >> 4) < 4) ? (1 << COLUMN_##x##_PIN) : 0 )
+#define SET_GATHER_ONE(x)       ( ((COL(x) >> 4) < 4) ? 0 : (1 << (x)) )
+
 #define SET_MASK0_FROM_COLUMN(x)    ( (COLUMN_##x##_PORT == 0) ? (1 << COLUMN_##x##_PIN) : 0 )
 #define SET_MASK12_FROM_COLUMN(x)   ( (COLUMN_##x##_PORT == 1) ? (0x0400 << COLUMN_##x##_PIN) : ((COLUMN_##x##_PORT == 2) ? (1 << COLUMN_##x##_PIN) : 0) )
 #define SET_MASK3_FROM_COLUMN(x)    ( (COLUMN_##x##_PORT == 3) ? (1 << COLUMN_##x##_PIN) : 0 )
@@ -28,6 +28,13 @@ struct key_combinations_t {
     uint32_t action;
 };
 
+// Fn keymap entry of a generated layout (see misc/kbd_matrix_gen).
+// Only keys that differ from set #0 are stored.
+struct kbd_keymap_entry_t {
+    uint16_t intersection;  // (output << 8) | input
+    uint16_t keycode;
+};
+
 #ifndef KEYBOARD_MEASURE_EXT_SLP_ON
 #define KBD_NR_COMBINATIONS 0
 #endif
@@ -250,6 +257,42 @@ uint16_t kbd_keybuffer_idx;
 const struct key_combinations_t *key_comb = NULL;
 #endif
 
+#if defined(KBD_LAYOUT_GENERATED)
+/**
+ ****************************************************************************************
+ * @brief Returns the keycode of a key from the packed keymap of a generated layout.
+ *        Fn sets are sparse; keys missing from a set use the keycode of set #0.
+ *
+ * @param[in] set       keymap set (Fn modifier)
+ * @param[in] output    row of the key
+ * @param[in] input     column of the key
+ *
+ * @return the keycode
+ ****************************************************************************************
+ */
+__INLINE uint16_t kbd_keymap_get(int set, int output, int input)
+{
+#if (KBD_NR_SETS > 1)
+    if (set) {
+        const uint16_t intersection = (output << 8) | input;
+        int i;
+        
+        for (i = kbd_keymap_layer_start[set - 1]; i < kbd_keymap_layer_start[set]; i++) {
+            if (kbd_keymap_layers[i].intersection == intersection) {
+                return kbd_keymap_layers[i].keycode;
+            }
+            if (kbd_keymap_layers[i].intersection > intersection) {
+                break;
+            }
+        }
+    }
+#endif
+    return kbd_keymap_base[output][input];
+}
+#else
+#define kbd_keymap_get(set, output, input)      (kbd_keymap[(set)][(output)][(input)])
+#endif
+
 #if KBD_NR_INPUTS < 9
 typedef uint8_t scan_t;
 #elif KBD_NR_INPUTS < 17
@@ -283,4 +326,39 @@ typedef uint32_t scan_t;
 #error "WKUP controller masks not defined properly!"
 #endif
 
+#if (HAS_QUADEC_WHEEL)
+// The wheel pins (hw_config.h) must not be pins of the matrix
+#define KBD_IS_WHEEL_PIN(port, pin)     (   ((port) == WHEEL_A_PORT && (pin) == WHEEL_A_PIN)    \
+                                         || ((port) == WHEEL_B_PORT && (pin) == WHEEL_B_PIN) )
+
+#if ((KBD_NR_INPUTS > 0 && KBD_IS_WHEEL_PIN(COLUMN_0_PORT, COLUMN_0_PIN)) || \
+     (KBD_NR_INPUTS > 1 && KBD_IS_WHEEL_PIN(COLUMN_1_PORT, COLUMN_1_PIN)) || \
+     (KBD_NR_INPUTS > 2 && KBD_IS_WHEEL_PIN(COLUMN_2_PORT, COLUMN_2_PIN)) || \
+     (KBD_NR_INPUTS > 3 && KBD_IS_WHEEL_PIN(COLUMN_3_PORT, COLUMN_3_PIN)) || \
+     (KBD_NR_INPUTS > 4 && KBD_IS_WHEEL_PIN(COLUMN_4_PORT, COLUMN_4_PIN)) || \
+     (KBD_NR_INPUTS > 5 && KBD_IS_WHEEL_PIN(COLUMN_5_PORT, COLUMN_5_PIN)) || \
+     (KBD_NR_INPUTS > 6 && KBD_IS_WHEEL_PIN(COLUMN_6_PORT, COLUMN_6_PIN)) || \
+     (KBD_NR_INPUTS > 7 && KBD_IS_WHEEL_PIN(COLUMN_7_PORT, COLUMN_7_PIN)) || \
+     (KBD_NR_INPUTS > 8 && KBD_IS_WHEEL_PIN(COLUMN_8_PORT, COLUMN_8_PIN)) || \
+     (KBD_NR_INPUTS > 9 && KBD_IS_WHEEL_PIN(COLUMN_9_PORT, COLUMN_9_PIN)) || \
+     (KBD_NR_INPUTS > 10 && KBD_IS_WHEEL_PIN(COLUMN_10_PORT, COLUMN_10_PIN)) || \
+     (KBD_NR_INPUTS > 11 && KBD_IS_WHEEL_PIN(COLUMN_11_PORT, COLUMN_11_PIN)) || \
+     (KBD_NR_INPUTS > 12 && KBD_IS_WHEEL_PIN(COLUMN_12_PORT, COLUMN_12_PIN)) || \
+     (KBD_NR_INPUTS > 13 && KBD_IS_WHEEL_PIN(COLUMN_13_PORT, COLUMN_13_PIN)) || \
+     (KBD_NR_INPUTS > 14 && KBD_IS_WHEEL_PIN(COLUMN_14_PORT, COLUMN_14_PIN)) || \
+     (KBD_NR_INPUTS > 15 && KBD_IS_WHEEL_PIN(COLUMN_15_PORT, COLUMN_15_PIN)) || \
+     (KBD_NR_INPUTS > 16 && KBD_IS_WHEEL_PIN(COLUMN_16_PORT, COLUMN_16_PIN)) || \
+     (KBD_NR_INPUTS > 17 && KBD_IS_WHEEL_PIN(COLUMN_17_PORT, COLUMN_17_PIN)) || \
+     (KBD_NR_OUTPUTS > 0 && KBD_IS_WHEEL_PIN(ROW_0_PORT, ROW_0_PIN)) || \
+     (KBD_NR_OUTPUTS > 1 && KBD_IS_WHEEL_PIN(ROW_1_PORT, ROW_1_PIN)) || \
+     (KBD_NR_OUTPUTS > 2 && KBD_IS_WHEEL_PIN(ROW_2_PORT, ROW_2_PIN)) || \
+     (KBD_NR_OUTPUTS > 3 && KBD_IS_WHEEL_PIN(ROW_3_PORT, ROW_3_PIN)) || \
+     (KBD_NR_OUTPUTS > 4 && KBD_IS_WHEEL_PIN(ROW_4_PORT, ROW_4_PIN)) || \
+     (KBD_NR_OUTPUTS > 5 && KBD_IS_WHEEL_PIN(ROW_5_PORT, ROW_5_PIN)) || \
+     (KBD_NR_OUTPUTS > 6 && KBD_IS_WHEEL_PIN(ROW_6_PORT, ROW_6_PIN)) || \
+     (KBD_NR_OUTPUTS > 7 && KBD_IS_WHEEL_PIN(ROW_7_PORT, ROW_7_PIN)))
+#error "A wheel pin is a pin of the keyboard matrix!"
+#endif
+#endif
+
 #endif // APP_KBD_MATRIX_H_
@@ -35,11 +35,17 @@
 
 #include "app_kbd_proj.h"
 #include "app_kbd_debug.h"
+#include "app_event.h"
+#include "app_energy.h"
 #include "app_kbd.h"
 
 #include "app_dis.h"
 #include "app_batt.h"
 
+#if (HAS_QUADEC_WHEEL)
+#include "app_wheel.h"
+#endif
+
 #if (HAS_BMI055)
 #include "app_motion_sensor.h"
 #endif
@@ -54,6 +60,15 @@
 
 #include "app_utils.h"
 
+#ifdef WLAN_COEX_ENABLED
+#include "wlan_coex.h"
+#endif
+
+#include "rwble_link_quality.h"
+#if (USE_CONNECTION_FSM)
+#include "app_conn_params.h"
+#endif
+
     #if (BLE_SPOTA_RECEIVER)    
         #include "app_con_fsm_task.h"
     #endif
@@ -211,6 +226,10 @@ void app_init_func(void)
     app_delay(8000);    // wait for BMI to power up
     app_motion_init_state_machine();
 #endif
+
+#if (HAS_QUADEC_WHEEL)
+    app_wheel_init();
+#endif
     
 #if (BLE_SPOTA_RECEIVER)    
 	app_spotar_init(app_spotar_callback);
@@ -583,11 +602,43 @@ void app_connection_func(struct gapc_connection_req_ind const *param)
     app_env.peer_addr_type = param->peer_addr_type;
     app_env.peer_addr = param->peer_addr;
                 
+    rwble_lq_reset(param->conhdl);
+    app_link_quality_func();
+    
+#ifdef WLAN_COEX_ENABLED
+// Raise the BLE priority when the app data is urgent or events are being missed
+    wlan_coex_prio_criteria_add(BLEMPRIO_URGENT, param->conhdl, 0);
+    wlan_coex_prio_criteria_add(BLEMPRIO_MISSED, param->conhdl, WLAN_COEX_MISSED_EVENTS);
+#endif
+
 #if (BLE_SPOTA_RECEIVER)
     app_spotar_enable();
 #endif //BLE_SPOTA_RECEIVER    
 }
 
+/**
+ ****************************************************************************************
+ * @brief   Adapts the application to the quality of the link.
+ *
+ * @return  void
+ ****************************************************************************************
+ */
+void app_link_quality_func(void)
+{
+    struct rwble_lq_info info;
+
+    rwble_lq_get(app_env.conhdl, &info);
+
+#if (USE_CONNECTION_FSM)
+    // Listen to more anchors while the link is poor, so it gets more chances before the
+    // supervision timeout
+    app_conn_params_hold(CONN_LOAD_TYPING, info.state == RWBLE_LQ_POOR);
+#endif
+#if (HAS_AUDIO)
+    app_audio439_link_quality(info.state);
+#endif
+}
+
 /**
  ****************************************************************************************
  * @brief   Configures the application when the connection is terminated.
@@ -609,6 +660,11 @@ void app_disconnect_func(ke_task_id_t const task_id, struct gapc_disconnect_ind
         app_con_fsm_disconnect_func();
         app_kbd_stop_reporting();
         app_batt_poll_stop();    // stop battery polling
+#ifdef WLAN_COEX_ENABLED
+        wlan_coex_prio_criteria_del(BLEMPRIO_URGENT, param->conhdl, 0);
+        wlan_coex_prio_criteria_del(BLEMPRIO_MISSED, param->conhdl, 0);
+        wlan_coex_urgency_reset();
+#endif
     }
     // There is an extreme case where this message is received twice. This happens when 
     // both the device and the host decide to terminate the connection at the same time.
@@ -761,6 +817,7 @@ int app_hid_timer_handler(ke_msg_id_t const msgid,
             trigger_kbd_delayed_start_st = NO_TRIGGER;
             
             wkup_hit = true;
+            app_event_set(APP_EVENT_KBD_SCAN);
         }
     }
     
@@ -790,6 +847,16 @@ void streamdatad_streamonoff_hogpd (void)
 
 	int on = (streamdatad_en[0]>0);
     int tp = (int)(streamdatad_en[1])&0x00FF;    /* If second byte is zero, consider this the Enable signal. */
+#if (HAS_ENERGY_LEDGER)
+    if ((len > 1) && (tp == APP_ENERGY_CMD_READ)) {
+        app_stream_send_energy();
+        return;
+    }
+    if ((len > 1) && (tp == APP_ENERGY_CMD_RESET)) {
+        app_energy_reset();
+        return;
+    }
+#endif
     if ((len == 1) || (tp == 0)) {
         if (on) {
             app_stream_start();
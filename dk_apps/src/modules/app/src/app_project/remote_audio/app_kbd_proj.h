@@ -129,6 +129,19 @@ int app_hid_msg_handler(ke_msg_id_t const msgid,
 #if (HAS_AUDIO || HAS_BMI055)
 void streamdatad_streamonoff_hogpd (void);
 #endif                                    
+
+/**
+ ****************************************************************************************
+ * @brief Adapt the application to the quality of the link
+ *        Called when APP_EVENT_LINK_QUALITY is set
+ *
+ * @param    none
+ *
+ * @return   void
+ ****************************************************************************************
+ */                                    
+void app_link_quality_func(void);
+
 /// @} APP
 
 #endif // APP_KBD_PROJ_H_
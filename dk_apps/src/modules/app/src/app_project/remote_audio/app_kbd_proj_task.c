@@ -26,6 +26,8 @@
 #include "app_task.h"                  // Application Task API
 #include "app_kbd.h"
 #include "app_kbd_hid_sensor.h"
+#include "app_mouse.h"
+#include "app_kbd_trace.h"
 
 
 #define REPORT_MAP_LEN sizeof(report_map)
@@ -182,7 +184,38 @@ KBD_TYPE_QUALIFIER uint8 report_map[] KBD_ARRAY_ATTRIBUTE =
         HID_INPUT         (HID_DATA_BIT | HID_ARY_BIT | HID_ABS_BIT |
                            HID_NPREF_BIT),                              // INPUT (Data,Ary,Abs,NPrf)
 #endif        
-        HID_END_COLLECTION                          
+        HID_END_COLLECTION,
+        
+#if (HAS_MOUSE_REPORT)
+        HID_USAGE_PAGE    (HID_USAGE_PAGE_GENERIC_DESKTOP),
+        HID_USAGE         (HID_GEN_DESKTOP_USAGE_MOUSE),
+        HID_COLLECTION    (HID_APPLICATION),
+        HID_REPORT_ID     (MOUSE_REPORT_ID),
+        HID_USAGE         (HID_GEN_DESKTOP_USAGE_POINTER),
+        HID_COLLECTION    (HID_PHYSICAL),
+        HID_USAGE_PAGE    (HID_USAGE_PAGE_BUTTONS),
+        HID_USAGE_MIN_8   (0x01),
+        HID_USAGE_MAX_8   (0x03),
+        HID_LOGICAL_MIN_8 (0x00),
+        HID_LOGICAL_MAX_8 (0x01),
+        HID_REPORT_COUNT  (0x03),
+        HID_REPORT_SIZE   (0x01),
+        HID_INPUT         (HID_DATA_BIT | HID_VAR_BIT | HID_ABS_BIT),   //  Input: (Data, Variable, Absolute) ; 3 buttons
+        HID_REPORT_COUNT  (0x01),
+        HID_REPORT_SIZE   (0x05),
+        HID_INPUT         (HID_CONST_BIT),                              //  Input: (Constant) ; padding
+        HID_USAGE_PAGE    (HID_USAGE_PAGE_GENERIC_DESKTOP),
+        HID_USAGE         (HID_GEN_DESKTOP_USAGE_X),
+        HID_USAGE         (HID_GEN_DESKTOP_USAGE_Y),
+        HID_USAGE         (HID_GEN_DESKTOP_USAGE_WHEEL),
+        HID_LOGICAL_MIN_8 (0x81),                                       //  -127
+        HID_LOGICAL_MAX_8 (0x7F),                                       //  127
+        HID_REPORT_SIZE   (0x08),
+        HID_REPORT_COUNT  (0x03),
+        HID_INPUT         (HID_DATA_BIT | HID_VAR_BIT | HID_REL_BIT),   //  Input: (Data, Variable, Relative) ; X, Y, Wheel
+        HID_END_COLLECTION,
+        HID_END_COLLECTION,
+#endif
 	};
 
 /*
@@ -224,14 +257,8 @@ int keyboard_ntf_sent_cfm_handler(ke_msg_id_t const msgid,
                                       ke_task_id_t const dest_id,
                                       ke_task_id_t const src_id)
 {
-    //Clear pending ack's for param->report_nb == 0 (normal key report) and == 2 (ext. key report)
-    if (param->status == PRF_ERR_OK) {
-        if (param->hids_nb == 0) {
-            if (param->report_nb == 0) {
-            } 
-            else if (param->report_nb == 2) {
-            }
-        }
+    if ((param->status == PRF_ERR_OK) && (param->hids_nb == 0)) {
+        KBD_TRACE(KBD_TRACE_L2CM, param->report_nb);
     }
     return (KE_MSG_CONSUMED);
 }
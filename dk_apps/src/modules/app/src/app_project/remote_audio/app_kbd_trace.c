@@ -0,0 +1,227 @@
+ /**
+ ****************************************************************************************
+ *
+ * @file app_kbd_trace.c
+ *
+ * @brief Keyboard (HID) key-to-air latency trace.
+ *
+ * Each stage of a key press, from the wakeup (or the Keyboard Controller interrupt) to
+ * the end of the BLE event that carried the HID report, adds an 8-byte entry to a ring
+ * in the retention memory. The entries are printed over the UART while the keyboard is
+ * idle and are analyzed off-line (dk_apps/misc/kbd_latency/kbd_latency.py).
+ *
+ * All timestamps are in usec of the BLE timer. When a key wakes up the system the BLE
+ * core is still sleeping. The first stages are then timed with the SysTick, which runs
+ * at 1MHz while the keyboard scans, and are moved to the BLE time base when the BLE
+ * core wakes up. The SysTick does not run between the wakeup interrupt and the start
+ * of the scanning, so the WAKEUP entry of a sleep start is marked KBD_TRACE_CLK_NONE.
+ *
+ * Copyright (C) 2014. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include "app_kbd_trace.h"
+
+#if (HAS_KBD_LATENCY_TRACE)
+
+#include "arch.h"
+#include "rwip.h"
+#include "lld_evt.h"
+#include "reg_blecore.h"
+#include "app_console.h"
+#include "app_kbd.h"
+
+#define KBD_TRACE_MASK                  (KBD_TRACE_SIZE - 1)
+
+#if (KBD_TRACE_SIZE & KBD_TRACE_MASK) || (KBD_TRACE_SIZE > 128)
+#error "KBD_TRACE_SIZE must be a power of 2, up to 128!"
+#endif
+
+static struct kbd_trace_entry kbd_trace_ring[KBD_TRACE_SIZE]    __attribute__((section("retention_mem_area0"), zero_init));
+static uint8_t kbd_trace_head                                   __attribute__((section("retention_mem_area0"), zero_init)); // next entry to write
+static uint8_t kbd_trace_pend                                   __attribute__((section("retention_mem_area0"), zero_init)); // first entry not in the BLE time base
+static uint8_t kbd_trace_tail                                   __attribute__((section("retention_mem_area0"), zero_init)); // next entry to export
+static uint8_t kbd_trace_seq                                    __attribute__((section("retention_mem_area0"), zero_init));
+static uint16_t kbd_trace_lost                                  __attribute__((section("retention_mem_area0"), zero_init));
+static bool kbd_trace_ntf_pending                               __attribute__((section("retention_mem_area0"), zero_init));
+static uint32_t kbd_trace_systick_ticks                         __attribute__((section("retention_mem_area0"), zero_init)); // completed SysTick ticks
+
+/**
+ ****************************************************************************************
+ * @brief Checks if the BLE timer can be read
+ *
+ * @return true, if the BLE core is powered and not sleeping or waking up
+ ****************************************************************************************
+ */
+static inline bool kbd_trace_ble_is_running(void)
+{
+    return (GetBits16(CLK_RADIO_REG, BLE_ENABLE) == 1) &&
+           (GetBits32(BLE_DEEPSLCNTL_REG, DEEP_SLEEP_STAT) == 0) &&
+           !(rwip_prevent_sleep_get() & RW_WAKE_UP_ONGOING);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Gets the BLE time
+ *
+ * @return The time in usec (wraps every ~71 min)
+ ****************************************************************************************
+ */
+static inline uint32_t kbd_trace_ble_time(void)
+{
+    // The fine counter is sampled together with the base time. It counts down from 624.
+    const uint32_t slots = lld_evt_time_get();
+    const uint32_t fine = ble_finetimecnt_get() & BLE_FINECNT_MASK;
+
+    return (slots * 625) + (624 - fine);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Checks if the SysTick is counting
+ *
+ * @return true, if it is enabled
+ ****************************************************************************************
+ */
+static inline bool kbd_trace_systick_is_running(void)
+{
+    return (GetWord32(0xE000E010) & 1);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Gets the SysTick time. It only advances while the SysTick is enabled.
+ *
+ * @return The time in usec
+ ****************************************************************************************
+ */
+static inline uint32_t kbd_trace_systick_time(void)
+{
+    uint32_t ticks = kbd_trace_systick_ticks;
+
+    if (kbd_trace_systick_is_running()) {
+        ticks += GetWord32(0xE000E014) - GetWord32(0xE000E018);     // SysTick counts down from the reload value
+    }
+    return ticks / SYSTICK_TICKS_PER_US;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Moves the entries taken while the BLE was sleeping to the BLE time base.
+ *        Must be called with the interrupts disabled.
+ *
+ * @param[in] ble_now   The current BLE time
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void kbd_trace_rebase(uint32_t ble_now)
+{
+    const uint32_t systick_now = kbd_trace_systick_time();
+    const bool exact = kbd_trace_systick_is_running();
+
+    for (; kbd_trace_pend != kbd_trace_head; kbd_trace_pend++) {
+        struct kbd_trace_entry *entry = &kbd_trace_ring[kbd_trace_pend & KBD_TRACE_MASK];
+
+        entry->time = ble_now - (systick_now - entry->time);
+        if (!exact) {
+            // the SysTick was stopped for an unknown time before now
+            entry->clk = KBD_TRACE_CLK_NONE;
+        }
+    }
+}
+
+
+void app_kbd_trace_record(uint8_t stage, uint8_t arg)
+{
+    GLOBAL_INT_DISABLE();
+    if ((stage == KBD_TRACE_WAKEUP) || (stage == KBD_TRACE_KBD_IRQ)) {
+        kbd_trace_seq++;
+    } else if (stage == KBD_TRACE_L2CM) {
+        kbd_trace_ntf_pending = true;
+    }
+
+    if ((uint8_t)(kbd_trace_head - kbd_trace_tail) >= KBD_TRACE_SIZE) {
+        kbd_trace_lost++;
+    } else {
+        struct kbd_trace_entry *entry = &kbd_trace_ring[kbd_trace_head & KBD_TRACE_MASK];
+
+        entry->stage = stage;
+        entry->arg = arg;
+        entry->seq = kbd_trace_seq;
+
+        if (kbd_trace_ble_is_running()) {
+            const uint32_t now = kbd_trace_ble_time();
+
+            kbd_trace_rebase(now);
+            entry->time = now;
+            entry->clk = KBD_TRACE_CLK_BLE;
+            kbd_trace_head++;
+            kbd_trace_pend = kbd_trace_head;
+        } else {
+            entry->time = kbd_trace_systick_time();
+            entry->clk = kbd_trace_systick_is_running() ? KBD_TRACE_CLK_SYSTICK : KBD_TRACE_CLK_NONE;
+            kbd_trace_head++;
+        }
+    }
+    GLOBAL_INT_RESTORE();
+}
+
+
+void app_kbd_trace_systick_wrap(void)
+{
+    kbd_trace_systick_ticks += GetWord32(0xE000E014) + 1;
+}
+
+
+void app_kbd_trace_systick_stop(void)
+{
+    if (kbd_trace_systick_is_running()) {
+        kbd_trace_systick_ticks += GetWord32(0xE000E014) - GetWord32(0xE000E018);
+    }
+}
+
+
+void app_kbd_trace_ble_evt_end(void)
+{
+    if (kbd_trace_ntf_pending) {
+        kbd_trace_ntf_pending = false;
+        app_kbd_trace_record(KBD_TRACE_AIR, 0);
+    }
+}
+
+
+void app_kbd_trace_export(void)
+{
+    int n;
+
+    GLOBAL_INT_DISABLE();
+    if ((kbd_trace_pend != kbd_trace_head) && kbd_trace_ble_is_running()) {
+        kbd_trace_rebase(kbd_trace_ble_time());
+    }
+    n = kbd_trace_lost;
+    kbd_trace_lost = 0;
+    GLOBAL_INT_RESTORE();
+
+    if (n) {
+        arch_printf("KT,LOST,%d\r\n", n);
+    }
+
+    for (n = 0; (n < KBD_TRACE_EXPORT_BURST) && (kbd_trace_tail != kbd_trace_pend); n++) {
+        const struct kbd_trace_entry entry = kbd_trace_ring[kbd_trace_tail & KBD_TRACE_MASK];
+
+        kbd_trace_tail++;
+
+        // arch_printf() prints signed values only, so the time is printed in two halves
+        arch_printf("KT,%d,%d,%d,%d,%04x%04x\r\n", entry.seq, entry.stage, entry.arg, entry.clk,
+                    (int)(entry.time >> 16), (int)(entry.time & 0xFFFF));
+    }
+}
+
+#endif // HAS_KBD_LATENCY_TRACE
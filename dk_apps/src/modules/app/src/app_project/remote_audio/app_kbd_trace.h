@@ -0,0 +1,165 @@
+ /**
+ ****************************************************************************************
+ *
+ * @file app_kbd_trace.h
+ *
+ * @brief Keyboard (HID) key-to-air latency trace.
+ *
+ * Copyright (C) 2014. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_KBD_TRACE_H_
+#define APP_KBD_TRACE_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Code switches
+ ****************************************************************************************
+ */
+
+#ifdef KBD_LATENCY_TRACE_ON
+#define HAS_KBD_LATENCY_TRACE                   1
+#else
+#define HAS_KBD_LATENCY_TRACE                   0
+#endif
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+// Number of trace entries (8 bytes each). Must be a power of 2.
+#define KBD_TRACE_SIZE                          (32)
+
+// Maximum number of entries printed per call of app_kbd_trace_export()
+#define KBD_TRACE_EXPORT_BURST                  (4)
+
+// Trace points, in the order they are passed by a key press
+enum kbd_trace_stage {
+    KBD_TRACE_WAKEUP = 0,       // wakeup_handler(), arg is the kbd_trace_start type
+    KBD_TRACE_KBD_IRQ,          // KEYBRD_Handler() (key press while scanning)
+    KBD_TRACE_SCAN_START,       // SW scanning started after a wakeup
+    KBD_TRACE_KEY_DETECTED,     // app_kbd_scan_matrix() found a new key, arg is the row
+    KBD_TRACE_REPORT_PREPARED,  // app_kbd_prepare_keyreports() put a report in the trm list
+    KBD_TRACE_HOGPD_REQ,        // HOGPD_REPORT_UPD_REQ sent, arg is the report_nb
+    KBD_TRACE_L2CM,             // HOGPD_NTF_SENT_CFM, the notification is in an L2CM buffer
+    KBD_TRACE_AIR,              // end of the first BLE event after the hand-off to L2CM
+    KBD_TRACE_NR_STAGES,
+};
+
+// How the system was running when the key was pressed
+enum kbd_trace_start {
+    KBD_TRACE_START_ACTIVE = 0,
+    KBD_TRACE_START_EXT_SLEEP,
+    KBD_TRACE_START_DEEP_SLEEP,
+};
+
+// Clock of the timestamp of an entry
+enum kbd_trace_clock {
+    KBD_TRACE_CLK_BLE = 0,      // BLE timer, when the entry was recorded
+    KBD_TRACE_CLK_SYSTICK,      // SysTick, moved to the BLE time base when the BLE woke up
+    KBD_TRACE_CLK_NONE,         // no clock was running, the time is a lower bound
+};
+
+struct kbd_trace_entry {
+    uint32_t time;              // in usec
+    uint8_t stage;              // enum kbd_trace_stage
+    uint8_t arg;
+    uint8_t clk;                // enum kbd_trace_clock
+    uint8_t seq;                // key press sequence number
+};
+
+/*
+ * TRACE POINTS
+ ****************************************************************************************
+ */
+
+#if (HAS_KBD_LATENCY_TRACE)
+#define KBD_TRACE(stage, arg)           app_kbd_trace_record(stage, arg)
+#define KBD_TRACE_SYSTICK_WRAP()        app_kbd_trace_systick_wrap()
+#define KBD_TRACE_SYSTICK_STOP()        app_kbd_trace_systick_stop()
+#else
+#define KBD_TRACE(stage, arg)
+#define KBD_TRACE_SYSTICK_WRAP()
+#define KBD_TRACE_SYSTICK_STOP()
+#endif
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Adds an entry to the trace ring. The entry is dropped if the ring is full.
+ *        May be called from interrupt context.
+ *
+ *        The timestamp is taken from the BLE timer when the BLE core is awake. While it
+ *        sleeps, the SysTick of the key scanning is used and the entries are moved to the
+ *        BLE time base by the first entry recorded after the BLE wakes up.
+ *        WAKEUP and KBD_IRQ start a new key press sequence.
+ *
+ * @param[in] stage     enum kbd_trace_stage
+ * @param[in] arg       Stage specific argument
+ *
+ * @return void
+ ****************************************************************************************
+ */
+void app_kbd_trace_record(uint8_t stage, uint8_t arg);
+
+/**
+ ****************************************************************************************
+ * @brief Called from the SysTick_Handler. Accounts a full SysTick period.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+void app_kbd_trace_systick_wrap(void);
+
+/**
+ ****************************************************************************************
+ * @brief Called before the SysTick is stopped or re-programmed. Accounts the part of
+ *        the current period that has elapsed.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+void app_kbd_trace_systick_stop(void);
+
+/**
+ ****************************************************************************************
+ * @brief Marks the end of the BLE event. Records KBD_TRACE_AIR if a notification was
+ *        handed to L2CM since the previous event. Called from the BLE_EVENT_Handler.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+void app_kbd_trace_ble_evt_end(void);
+
+/**
+ ****************************************************************************************
+ * @brief Prints up to KBD_TRACE_EXPORT_BURST entries over the UART, one line each:
+ *        "KT,<seq>,<stage>,<arg>,<clk>,<time>". The number of dropped entries is
+ *        printed as "KT,LOST,<n>". Entries still waiting for the BLE time base are
+ *        kept. Called from the main loop when the keyboard is idle.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+void app_kbd_trace_export(void);
+
+#endif // APP_KBD_TRACE_H_
@@ -0,0 +1,42 @@
+ /**
+ ****************************************************************************************
+ *
+ * @file app_mouse.c
+ *
+ * @brief HID Mouse report, shared by the scroll wheel and the motion pointer.
+ *
+ * Copyright (C) 2014. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#if (HAS_MOUSE_REPORT)
+
+#include "app_api.h"
+#include "app_mouse.h"
+#include "hogpd_task.h"
+
+
+void app_mouse_send_report(uint8_t buttons, int8_t x, int8_t y, int8_t wheel)
+{
+    struct hogpd_report_info *req = KE_MSG_ALLOC_DYN(HOGPD_REPORT_UPD_REQ, TASK_HOGPD, TASK_APP,
+                                                      hogpd_report_info, MOUSE_REPORT_LEN);
+
+    req->conhdl = app_env.conhdl;
+    req->hids_nb = 0;
+    req->report_nb = MOUSE_REPORT_NR;
+    req->report_length = MOUSE_REPORT_LEN;
+    req->report[0] = buttons;
+    req->report[1] = (uint8_t)x;
+    req->report[2] = (uint8_t)y;
+    req->report[3] = (uint8_t)wheel;
+
+    ke_msg_send(req);
+}
+
+#endif // HAS_MOUSE_REPORT
@@ -0,0 +1,72 @@
+ /**
+ ****************************************************************************************
+ *
+ * @file app_mouse.h
+ *
+ * @brief HID Mouse report, shared by the scroll wheel and the motion pointer.
+ *
+ * Copyright (C) 2014. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_MOUSE_H_
+#define APP_MOUSE_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+// The Mouse report is appended after the last report of the HID service
+#if (HAS_BMI055)
+#define MOUSE_REPORT_NR             (9)
+#elif (HAS_AUDIO)
+#define MOUSE_REPORT_NR             (8)
+#else
+#define MOUSE_REPORT_NR             (3)
+#endif
+
+// hogpd assigns Report IDs in the order of the Report characteristics (1, 2, ...)
+#define MOUSE_REPORT_ID             (MOUSE_REPORT_NR + 1)
+
+// Buttons, X, Y, Wheel
+#define MOUSE_REPORT_LEN            (4)
+
+// Buttons
+#define MOUSE_BUTTON_LEFT           (0x01)
+#define MOUSE_BUTTON_RIGHT          (0x02)
+#define MOUSE_BUTTON_MIDDLE         (0x04)
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Sends a Mouse report. The caller must check that a Tx buffer is available.
+ *
+ * @param buttons   The pressed buttons (MOUSE_BUTTON_*)
+ * @param x         The horizontal movement, -127 to 127
+ * @param y         The vertical movement, -127 to 127
+ * @param wheel     The wheel movement, in detents, -127 to 127
+ *
+ * @return void
+ ****************************************************************************************
+ */
+void app_mouse_send_report(uint8_t buttons, int8_t x, int8_t y, int8_t wheel);
+
+#endif // APP_MOUSE_H_
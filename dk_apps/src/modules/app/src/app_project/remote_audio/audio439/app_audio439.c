@@ -37,6 +37,10 @@ char stop_when_buffer_empty = 0;
 #include "app_audio_codec.h"
 #include "app_stream.h"
 #include "pwm.h"
+#include "app_event.h"
+#if (USE_CONNECTION_FSM)
+#include "app_conn_params.h"
+#endif
 
 #define USE_IMA
 //#define APP_AUDIO439_DEBUG      //DEBUG FUNCTIONS
@@ -53,10 +57,55 @@ volatile app_audio439_ima_mode_t app_audio439_imamode   __attribute__((section("
 volatile int app_audio439_imaauto   __attribute__((section("retention_mem_area0"), zero_init));
 int app_audio439_imacnt;
 int app_audio439_imatst=0;
+static uint8_t app_audio439_lq_step;
 #endif
 
 static void app_audio439_set_ima_mode(void);
 
+#ifdef CFG_AUDIO439_ADAPTIVE_RATE
+/**
+ ****************************************************************************************
+ * @brief Get the IMA mode to encode with: the configured mode, lowered for the link quality
+ *
+ * @return the mode
+ ****************************************************************************************
+ */
+static app_audio439_ima_mode_t app_audio439_rate_mode(void)
+{
+    int mode = app_audio439_imamode;
+
+    if (app_audio439_imaauto == 0) {
+        mode += app_audio439_lq_step;
+        if (mode > IMA_MODE_24KBPS_3_8KHZ) {
+            mode = IMA_MODE_24KBPS_3_8KHZ;
+        }
+    }
+    return (app_audio439_ima_mode_t)mode;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Announce a new IMA mode to the host, in the stream
+ *
+ * @param[in] mode
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_audio439_send_rate(uint8_t mode)
+{
+    char *data = (char*)app_stream_fifo_get_next_dataptr();
+    memset(data,0,APP_STREAM_PACKET_SIZE);
+    data[1] = 4;   // TYPE of message = RATE
+    data[2] = mode;
+    data[4] = 4;
+    data[5] = mode;
+    data[6] = (uint8)app_audio439_env.audio439SlotSize;
+    data[7] = (uint8)app_stream_env.fifo_size;
+    app_stream_fifo_commit_enable_pkt();
+}
+#endif
+
 /**
  ****************************************************************************************
  * @brief Initiliaze the 439 state variable.
@@ -367,6 +416,9 @@ void app_audio439_encode(int maxNr)
             // The intermediate buffer is empty, go to next iteration so it can be filled up..
         }
     }
+    if (app_audio439_env.audioSlots[app_audio439_env.audio439SlotRdNr].hasData == 1) {
+        app_event_set(APP_EVENT_AUDIO);     // blocks are left, continue in the next pass of the main loop
+    }
     /*
     ** If buffer errors have been detected, send out "enable" notification with error values..
     */
@@ -392,17 +444,13 @@ void app_audio439_encode(int maxNr)
     if ((app_audio439_imacnt > 400) && (app_audio439_imaauto == 1) && (app_stream_fifo_check_next() == 0) ) {
         //app_audio439_imamode = (app_audio439_imamode+1) & 0x03;  // Iterate from 0,1,2,3,0,1,2,3,..
         app_audio439_imatst = (app_audio439_imatst+1) & 0x03;  // Iterate from 0,1,2,3,0,1,2,3,..
-        char *data = (char*)app_stream_fifo_get_next_dataptr();
-        memset(data,0,APP_STREAM_PACKET_SIZE);
-        data[1] = 4;   // TYPE of message = RATE
-        data[2] = (uint8)app_audio439_imatst;
-        data[4] = 4;
-        data[5] = (uint8)app_audio439_imatst;
-        data[6] = (uint8)app_audio439_env.audio439SlotSize;
-        data[7] = (uint8)app_stream_env.fifo_size;
-        app_stream_fifo_commit_enable_pkt();
+        app_audio439_send_rate((uint8)app_audio439_imatst);
         app_audio439_imamode = (app_audio439_ima_mode_t)app_audio439_imatst;
         app_audio439_set_ima_mode();
+    } else if ((app_audio439_rate_mode() != app_audio439_env.ima_mode) && (app_stream_fifo_check_next() == 0)) {
+        /* The link quality has changed, switch between two packets */
+        app_audio439_send_rate((uint8)app_audio439_rate_mode());
+        app_audio439_set_ima_mode();
     }
 #endif
 #endif
@@ -529,6 +577,7 @@ void SWTIM_Callback(void)
     if (session_swtim_ints < 2) {
         session_swtim_ints++;   //increase this way to avoid overflow.
     }
+    app_event_set(APP_EVENT_AUDIO);
 }
     
 
@@ -564,6 +613,11 @@ void app_audio439_start(void)
     swtim_start();              //start the timer
     session_swtim_ints =0;
     app_audio439_timer_started = 1;
+#if (USE_CONNECTION_FSM)
+    if (con_fsm_params.has_conn_params_manager) {
+        app_conn_params_hold(CONN_LOAD_VOICE, true);
+    }
+#endif
 #ifdef CLICK_STARTUP_CLEAN
     click_packages=0;   //changing logic
 #endif
@@ -584,6 +638,11 @@ void app_audio439_stop(void)
         
     if (app_audio439_timer_started) {
         app_restore_sleep_mode();
+#if (USE_CONNECTION_FSM)
+        if (con_fsm_params.has_conn_params_manager) {
+            app_conn_params_hold(CONN_LOAD_VOICE, false);
+        }
+#endif
     }
 
     app_audio439_timer_started = 0;
@@ -628,6 +687,13 @@ void app_audio439_configure_ima_mode(app_audio439_ima_mode_t mode)
 #endif    
 }
 
+void app_audio439_link_quality(uint8_t state)
+{
+#ifdef CFG_AUDIO439_ADAPTIVE_RATE    
+    app_audio439_lq_step = state;
+#endif    
+}
+
 /**
  ****************************************************************************************
  * @brief Set the correct IMA encoding parameters 
@@ -646,7 +712,9 @@ void app_audio439_set_ima_mode(void)
     int AUDIO_IMA_SIZE;    
     
 #ifdef CFG_AUDIO439_ADAPTIVE_RATE    
-    switch (app_audio439_imamode) {
+    app_audio439_ima_mode_t mode = app_audio439_rate_mode();
+
+    switch (mode) {
         case IMA_MODE_24KBPS_3_8KHZ:
         case IMA_MODE_32KBPS_4_8KHZ:
             app_audio439_env.sample_mode = 1;
@@ -658,12 +726,12 @@ void app_audio439_set_ima_mode(void)
         default:
             break;
     }
-    app_audio439_env.ima_mode  = app_audio439_imamode;
+    app_audio439_env.ima_mode  = mode;
     app_audio439_imacnt = 0;
 #endif
 
 #ifdef CFG_AUDIO439_ADAPTIVE_RATE    
-    switch (app_audio439_imamode) {
+    switch (mode) {
 #else        
     switch (IMA_DEFAULT_MODE) {
 #endif
@@ -146,6 +146,19 @@ void app_audio439_init(void);
  */
 void app_audio439_configure_ima_mode(app_audio439_ima_mode_t mode);
 
+/**
+ ****************************************************************************************
+ * @brief Lowers the IMA rate by one step from the configured mode for each level the
+ *        link quality is below RWBLE_LQ_GOOD. Used only with CFG_AUDIO439_ADAPTIVE_RATE,
+ *        when the rate is not iterated (app_audio439_config() type 6).
+ *
+ * @param[in] state     enum rwble_lq_state
+ *
+ * @return void
+ ****************************************************************************************
+ */
+void app_audio439_link_quality(uint8_t state);
+
 #ifdef APP_AUDIO439_DEBUG
 /**
  ****************************************************************************************
@@ -0,0 +1,182 @@
+ /**
+ ****************************************************************************************
+ *
+ * @file app_motion_codec.c
+ *
+ * @brief Delta encoding of the motion reports.
+ *
+ * Copyright (C) 2014. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#if (HAS_MOTION_DELTA)
+
+#include "app_api.h"
+#include "app_motion_codec.h"
+#include "app_stream.h"
+
+// A 14-bit zig-zag value needs 5 nibbles
+#define CODEC_MAX_NIBBLES               (MOTION_CODEC_AXES * 5)
+
+struct codec_report_tag
+{
+    uint8_t buf[APP_STREAM_PACKET_SIZE];
+    uint8_t len;
+    bool half;                      // the high nibble of buf[len - 1] is free
+};
+
+static int16_t codec_prev[MOTION_CODEC_AXES];
+static uint8_t codec_reports;       // reports since the last keyframe
+static bool codec_key_pending;
+static int8_t codec_temperature;
+
+/**
+ ****************************************************************************************
+ * @brief Codes a sample as nibbles
+ *
+ * @param sample    The sample
+ * @param base      The previous sample, NULL for a keyframe
+ * @param nibbles   The nibbles (CODEC_MAX_NIBBLES)
+ *
+ * @return Number of nibbles
+ ****************************************************************************************
+ */
+static int codec_encode_sample(const int16_t *sample, const int16_t *base, uint8_t *nibbles)
+{
+    int i, n = 0;
+
+    for (i = 0; i < MOTION_CODEC_AXES; i++) {
+        const int16_t diff = base ? (sample[i] - base[i]) : sample[i];
+        uint16_t z = (uint16_t)((diff << 1) ^ (diff >> 15));
+
+        while (z > 0x7) {
+            nibbles[n++] = (z & 0x7) | 0x8;
+            z >>= 3;
+        }
+        nibbles[n++] = z;
+    }
+    return n;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Starts a report
+ *
+ * @param report        The report
+ * @param timestamp     Sample counter of the first sample
+ * @param info          MOTION_CODEC_INFO_CLICK and/or MOTION_CODEC_INFO_GAP
+ * @param temperature   Temperature of the accelerometer
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void codec_start_report(struct codec_report_tag *report, uint8_t timestamp, uint8_t info,
+                               int8_t temperature)
+{
+    if (codec_key_pending || (codec_reports >= MOTION_CODEC_KEY_INTERVAL)) {
+        info |= MOTION_CODEC_INFO_KEY;
+    }
+
+    report->buf[0] = timestamp;
+    report->len = 2;
+    report->half = false;
+
+    if ((info & MOTION_CODEC_INFO_KEY) || (temperature != codec_temperature)) {
+        info |= MOTION_CODEC_INFO_TEMP;
+        report->buf[report->len++] = (uint8_t)temperature;
+    }
+    report->buf[1] = info;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Sends a report. If it cannot be sent, the next report is a keyframe.
+ *
+ * @param report    The report
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void codec_send_report(struct codec_report_tag *report)
+{
+    const uint8_t info = report->buf[1];
+
+    if (app_stream_send_motionreport(report->buf, report->len)) {
+        if (info & MOTION_CODEC_INFO_KEY) {
+            codec_key_pending = false;
+            codec_reports = 0;
+        }
+        codec_reports++;
+        if (info & MOTION_CODEC_INFO_TEMP) {
+            codec_temperature = (int8_t)report->buf[2];
+        }
+    } else {
+        codec_key_pending = true;
+    }
+}
+
+
+void app_motion_codec_reset(void)
+{
+    codec_key_pending = true;
+    codec_reports = 0;
+}
+
+
+void app_motion_codec_send(const int16_t samples[][MOTION_CODEC_AXES], uint8_t nb,
+                           uint8_t timestamp, uint8_t info, int8_t temperature)
+{
+    struct codec_report_tag report;
+    uint8_t nibbles[CODEC_MAX_NIBBLES];
+    uint8_t i, in_report = 0;
+    int n, k;
+
+    for (i = 0; i < nb; i++) {
+        if (in_report == 0) {
+            codec_start_report(&report, timestamp + i, info, temperature);
+            info &= ~MOTION_CODEC_INFO_GAP;
+        }
+
+        n = codec_encode_sample(samples[i],
+                                ((in_report == 0) && (report.buf[1] & MOTION_CODEC_INFO_KEY)) ? NULL : codec_prev,
+                                nibbles);
+
+        if ((n > (2 * (APP_STREAM_PACKET_SIZE - report.len) + report.half)) ||
+            (in_report == MOTION_CODEC_INFO_SAMPLES)) {
+            // full. The sample starts the next report.
+            report.buf[1] |= in_report;
+            codec_send_report(&report);
+
+            codec_start_report(&report, timestamp + i, info, temperature);
+            in_report = 0;
+            n = codec_encode_sample(samples[i],
+                                    (report.buf[1] & MOTION_CODEC_INFO_KEY) ? NULL : codec_prev,
+                                    nibbles);
+        }
+
+        for (k = 0; k < n; k++) {
+            if (report.half) {
+                report.buf[report.len - 1] |= nibbles[k] << 4;
+                report.half = false;
+            } else {
+                report.buf[report.len++] = nibbles[k];
+                report.half = true;
+            }
+        }
+        memcpy(codec_prev, samples[i], sizeof(codec_prev));
+        in_report++;
+    }
+
+    if (in_report) {
+        report.buf[1] |= in_report;
+        codec_send_report(&report);
+    }
+}
+
+#endif // HAS_MOTION_DELTA
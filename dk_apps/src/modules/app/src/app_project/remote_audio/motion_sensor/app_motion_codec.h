@@ -0,0 +1,95 @@
+ /**
+ ****************************************************************************************
+ *
+ * @file app_motion_codec.h
+ *
+ * @brief Delta encoding of the motion reports.
+ *
+ * Report format (up to APP_STREAM_PACKET_SIZE bytes, only the used bytes are sent):
+ *   byte 0:    sample counter of the first sample (1/MOTION_ODR_HZ)
+ *   byte 1:    info (MOTION_CODEC_INFO_*)
+ *   [byte 2]:  temperature of the accelerometer (0.5K/LSB, 0 = 23C), if INFO_TEMP is set
+ *   then:      the samples as a stream of nibbles, low nibble first
+ *
+ * Each sample is the difference of its 6 axes (acc X, Y, Z, rot X, Y, Z, in the 12-bit
+ * units of t_app_motion_burst) from the previous sample. In a keyframe (INFO_KEY) the
+ * first sample is coded as a difference from 0. Each difference is zig-zag coded
+ * (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...) and sent 3 bits per nibble, least significant
+ * first. Bit 3 of a nibble is set when more nibbles of the same value follow. The last
+ * nibble of a report may be padding.
+ *
+ * The previous sample of the first sample of a report is the last sample of the previous
+ * report. A keyframe is sent every MOTION_CODEC_KEY_INTERVAL reports and after a report
+ * could not be sent, so that the host can resynchronize.
+ *
+ * Copyright (C) 2014. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_MOTION_CODEC_H_
+#define APP_MOTION_CODEC_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define MOTION_CODEC_AXES               (6)
+
+// info field
+#define MOTION_CODEC_INFO_SAMPLES       (0x0F)  // number of samples in the report
+#define MOTION_CODEC_INFO_CLICK         (0x10)  // left click is pressed
+#define MOTION_CODEC_INFO_GAP           (0x20)  // samples were lost before the first sample
+#define MOTION_CODEC_INFO_KEY           (0x40)  // keyframe
+#define MOTION_CODEC_INFO_TEMP          (0x80)  // the temperature follows the info byte
+
+// Reports between keyframes
+#define MOTION_CODEC_KEY_INTERVAL       (16)
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Starts a new stream. The next report is a keyframe and carries the temperature.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+void app_motion_codec_reset(void);
+
+/**
+ ****************************************************************************************
+ * @brief Encodes consecutive samples and sends them in as few motion reports as
+ *        possible. The temperature is sent only if it has changed since it was last
+ *        sent, and in keyframes.
+ *
+ * @param samples       The samples (acc X, Y, Z, rot X, Y, Z)
+ * @param nb            Number of samples
+ * @param timestamp     Sample counter of the first sample
+ * @param info          MOTION_CODEC_INFO_CLICK and/or MOTION_CODEC_INFO_GAP
+ * @param temperature   Temperature of the accelerometer
+ *
+ * @return void
+ ****************************************************************************************
+ */
+void app_motion_codec_send(const int16_t samples[][MOTION_CODEC_AXES], uint8_t nb,
+                           uint8_t timestamp, uint8_t info, int8_t temperature);
+
+#endif // APP_MOTION_CODEC_H_
@@ -0,0 +1,298 @@
+ /**
+ ****************************************************************************************
+ *
+ * @file app_motion_fusion.c
+ *
+ * @brief Fixed-point orientation filter of the motion sensor and pointer projection.
+ *
+ * A Mahony filter (proportional accelerometer correction) keeps the orientation of the
+ * remote as a Q30 quaternion. Only the direction of gravity ("up" in the frame of the
+ * remote) is used: the rotation rate around "up" moves the pointer horizontally and
+ * the rate around the horizontal axis, perpendicular to the pointing direction, moves
+ * it vertically. This way the pointer follows the hand whatever the roll of the remote.
+ *
+ * The sensor X axis is the pointing direction and Z is up when the remote lies flat.
+ *
+ * The gyro bias is estimated while the remote is still and removed from every sample.
+ * All arithmetic is 32-bit integer: the Cortex-M0 has no 32x32->64 bit multiply and no
+ * divide, so 64-bit products and quotients would call the run-time library. Products
+ * are split in 16-bit halves instead and an update needs two 32-bit divisions.
+ *
+ * Copyright (C) 2014. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#if (HAS_MOTION_POINTER)
+
+#include <stdlib.h>
+#include "arch.h"
+#include "app_motion_fusion.h"
+
+#define Q30_ONE                         (1L << 30)
+
+// Pointer movement kept in the accumulators (pixels). Faster movement is dropped.
+#define FUSION_POINTER_MAX              (255)
+
+static int32_t fusion_q[4];                 // orientation, Q30
+static int32_t fusion_bias[3];              // gyro bias, Q16 LSB
+static int16_t fusion_prev_rot[3];          // previous gyro sample, until the bias is known
+static bool fusion_bias_valid;
+static uint8_t fusion_still_cnt;
+static uint8_t fusion_fast_cnt;
+static int32_t fusion_dx;                   // pointer movement, Q16 pixels
+static int32_t fusion_dy;
+
+/**
+ ****************************************************************************************
+ * @brief Multiplies two Q30 numbers, |a| < 2 and |b| <= 1. The product of the low
+ *        halves is dropped: the result may be up to 2 LSB below a * b.
+ *
+ * @return a * b in Q30
+ ****************************************************************************************
+ */
+__INLINE int32_t mul_q30(int32_t a, int32_t b)
+{
+    const int32_t ah = a >> 15;
+    const int32_t bh = b >> 15;
+    const int32_t al = a & 0x7FFF;
+    const int32_t bl = b & 0x7FFF;
+
+    return (ah * bh) + ((ah * bl) >> 15) + ((al * bh) >> 15);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Computes (a * b) >> shift, for a product that does not fit in 32 bits but
+ *        whose result does. The low part of a must fit in 32 bits once multiplied by b.
+ *
+ * @param a     The first factor
+ * @param b     The second factor, positive
+ * @param shift The right shift, up to 16
+ *
+ * @return (a * b) >> shift, rounded down as the 64-bit expression
+ ****************************************************************************************
+ */
+__INLINE int32_t mul_shift(int32_t a, uint32_t b, int shift)
+{
+    const uint32_t mask = (1UL << shift) - 1;
+
+    return ((a >> shift) * (int32_t)b) + (int32_t)(((a & mask) * b) >> shift);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Integer square root
+ *
+ * @param x     The radicand
+ *
+ * @return floor(sqrt(x))
+ ****************************************************************************************
+ */
+static uint32_t fusion_isqrt(uint32_t x)
+{
+    uint32_t res = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (x >= res + bit) {
+            x -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return res;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Detects if the remote is still and updates the gyro bias
+ *
+ * @param rot   The gyro sample
+ *
+ * @return true, if the remote is still
+ ****************************************************************************************
+ */
+static bool fusion_update_bias(const int16_t rot[3])
+{
+    bool still = true;
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        const int32_t ref = fusion_bias_valid ? fusion_bias[i] : (fusion_prev_rot[i] << 16);
+
+        if ((abs((rot[i] << 16) - ref) > (FUSION_STILL_THRESHOLD << 16)) ||
+            (abs(rot[i]) > FUSION_BIAS_MAX)) {
+            still = false;      // moving, or turning at a constant rate
+        }
+        fusion_prev_rot[i] = rot[i];
+    }
+
+    if (!still) {
+        fusion_still_cnt = 0;
+        return false;
+    }
+
+    if (fusion_still_cnt < FUSION_STILL_SAMPLES) {
+        fusion_still_cnt++;
+        return false;
+    }
+
+    for (i = 0; i < 3; i++) {
+        if (fusion_bias_valid) {
+            fusion_bias[i] += ((rot[i] << 16) - fusion_bias[i]) >> FUSION_BIAS_SHIFT;
+        } else {
+            fusion_bias[i] = rot[i] << 16;
+        }
+    }
+    fusion_bias_valid = true;
+    return true;
+}
+
+
+void app_motion_fusion_reset(void)
+{
+    fusion_q[0] = Q30_ONE;
+    fusion_q[1] = 0;
+    fusion_q[2] = 0;
+    fusion_q[3] = 0;
+    fusion_bias[0] = fusion_bias[1] = fusion_bias[2] = 0;
+    fusion_prev_rot[0] = fusion_prev_rot[1] = fusion_prev_rot[2] = 0;
+    fusion_bias_valid = false;
+    fusion_still_cnt = 0;
+    fusion_fast_cnt = FUSION_FAST_SAMPLES;
+    fusion_dx = 0;
+    fusion_dy = 0;
+}
+
+
+void app_motion_fusion_update(const int16_t acc[3], const int16_t rot[3])
+{
+    int32_t g[3];       // rotation during the sample, without the bias, Q30 rad
+    int32_t w[3];       // g with the accelerometer correction
+    int32_t u[3];       // "up" in the frame of the remote, Q30
+    int32_t q0 = fusion_q[0], q1 = fusion_q[1], q2 = fusion_q[2], q3 = fusion_q[3];
+    int32_t n, yaw, pitch;
+    uint32_t mag, inv;
+    int i;
+    const bool still = fusion_update_bias(rot);
+
+    for (i = 0; i < 3; i++) {
+        g[i] = mul_shift((rot[i] << 16) - fusion_bias[i], FUSION_GYRO_LSB_Q30, 16);
+        w[i] = g[i];
+    }
+
+    // Direction of gravity estimated by the orientation
+    u[0] = (mul_q30(q1, q3) - mul_q30(q0, q2)) << 1;
+    u[1] = (mul_q30(q0, q1) + mul_q30(q2, q3)) << 1;
+    u[2] = mul_q30(q0, q0) - mul_q30(q1, q1) - mul_q30(q2, q2) + mul_q30(q3, q3);
+
+    // Correction towards the measured gravity. Skipped while the remote accelerates.
+    mag = fusion_isqrt((int32_t)acc[0] * acc[0] + (int32_t)acc[1] * acc[1] + (int32_t)acc[2] * acc[2]);
+    if ((mag > (FUSION_ACC_1G * 3 / 4)) && (mag < (FUSION_ACC_1G * 5 / 4))) {
+        int32_t a[3];
+        const int shift = fusion_fast_cnt ? FUSION_KP_SHIFT_FAST : FUSION_KP_SHIFT;
+
+        // a = acc / |acc|, with 1 / |acc| in Q26 (|acc| > 192)
+        inv = (1UL << 26) / mag;
+        for (i = 0; i < 3; i++) {
+            a[i] = (acc[i] * (int32_t)inv) << 4;
+        }
+        w[0] += (mul_q30(a[1], u[2]) - mul_q30(a[2], u[1])) >> shift;
+        w[1] += (mul_q30(a[2], u[0]) - mul_q30(a[0], u[2])) >> shift;
+        w[2] += (mul_q30(a[0], u[1]) - mul_q30(a[1], u[0])) >> shift;
+
+        if (fusion_fast_cnt) {
+            fusion_fast_cnt--;
+        }
+    }
+
+    // q += q * (0, w) / 2
+    w[0] >>= 1;
+    w[1] >>= 1;
+    w[2] >>= 1;
+    fusion_q[0] = q0 - mul_q30(q1, w[0]) - mul_q30(q2, w[1]) - mul_q30(q3, w[2]);
+    fusion_q[1] = q1 + mul_q30(q0, w[0]) + mul_q30(q2, w[2]) - mul_q30(q3, w[1]);
+    fusion_q[2] = q2 + mul_q30(q0, w[1]) - mul_q30(q1, w[2]) + mul_q30(q3, w[0]);
+    fusion_q[3] = q3 + mul_q30(q0, w[2]) + mul_q30(q1, w[1]) - mul_q30(q2, w[0]);
+
+    // Normalize. |q| stays close to 1, so 1/sqrt(n) ~ (3 - n) / 2.
+    n = 0;
+    for (i = 0; i < 4; i++) {
+        n += mul_q30(fusion_q[i], fusion_q[i]);
+    }
+    n = (3 * (Q30_ONE >> 1)) - (n >> 1);
+    for (i = 0; i < 4; i++) {
+        fusion_q[i] = mul_q30(fusion_q[i], n);
+    }
+
+    if (still) {
+        // do not let the residual of the bias move the pointer
+        fusion_dx = 0;
+        fusion_dy = 0;
+        return;
+    }
+
+    // Pointer: yaw around "up", pitch around "right" = X x up = (0, -u2, u1)
+    yaw = mul_q30(g[0], u[0]) + mul_q30(g[1], u[1]) + mul_q30(g[2], u[2]);
+    mag = fusion_isqrt(mul_q30(u[1], u[1]) + mul_q30(u[2], u[2]));     // Q15
+    if (mag > (1 << 12)) {
+        // divide by |right| = mag, with 1 / |right| in Q13 (< 2^16)
+        inv = (1UL << 28) / mag;
+        pitch = mul_shift(mul_q30(g[2], u[1]) - mul_q30(g[1], u[2]), inv, 13);
+    } else {
+        pitch = 0;      // pointing up or down, the horizontal axis is undefined
+    }
+
+    fusion_dx -= mul_shift(yaw, FUSION_POINTER_GAIN, 14);
+    fusion_dy -= mul_shift(pitch, FUSION_POINTER_GAIN, 14);
+
+    if (fusion_dx > (FUSION_POINTER_MAX << 16)) {
+        fusion_dx = FUSION_POINTER_MAX << 16;
+    } else if (fusion_dx < -(FUSION_POINTER_MAX << 16)) {
+        fusion_dx = -(FUSION_POINTER_MAX << 16);
+    }
+    if (fusion_dy > (FUSION_POINTER_MAX << 16)) {
+        fusion_dy = FUSION_POINTER_MAX << 16;
+    } else if (fusion_dy < -(FUSION_POINTER_MAX << 16)) {
+        fusion_dy = -(FUSION_POINTER_MAX << 16);
+    }
+}
+
+
+bool app_motion_fusion_get_pointer(int8_t *dx, int8_t *dy)
+{
+    // whole pixels, rounded towards zero. The fraction is kept.
+    int32_t x = fusion_dx / (1 << 16);
+    int32_t y = fusion_dy / (1 << 16);
+
+    if (x > 127) {
+        x = 127;
+    } else if (x < -127) {
+        x = -127;
+    }
+    if (y > 127) {
+        y = 127;
+    } else if (y < -127) {
+        y = -127;
+    }
+
+    fusion_dx -= x << 16;
+    fusion_dy -= y << 16;
+    *dx = (int8_t)x;
+    *dy = (int8_t)y;
+
+    return (x != 0) || (y != 0);
+}
+
+#endif // HAS_MOTION_POINTER
@@ -0,0 +1,99 @@
+ /**
+ ****************************************************************************************
+ *
+ * @file app_motion_fusion.h
+ *
+ * @brief Fixed-point orientation filter of the motion sensor and pointer projection.
+ *
+ * Copyright (C) 2014. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_MOTION_FUSION_H_
+#define APP_MOTION_FUSION_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+// Rotation of one gyro LSB during one sample, in Q30 radians:
+// 500 deg/s / 2048 LSB * PI / 180 / MOTION_ODR_HZ * 2^30
+#define FUSION_GYRO_LSB_Q30             (45752)
+
+// 1g in accelerometer LSB (+/-8g, 12 bits)
+#define FUSION_ACC_1G                   (256)
+
+// Accelerometer correction, as a right shift of the error (Kp = 100 / 2^shift rad/s)
+#define FUSION_KP_SHIFT                 (7)
+// Stronger correction while the filter converges after a reset
+#define FUSION_KP_SHIFT_FAST            (3)
+#define FUSION_FAST_SAMPLES             (50)
+
+// The remote is still when no gyro axis deviates more than this from the bias (LSB)...
+#define FUSION_STILL_THRESHOLD          (8)
+// ...for this number of samples. The bias is then tracked with a 1/2^shift IIR.
+#define FUSION_STILL_SAMPLES            (50)
+#define FUSION_BIAS_SHIFT               (5)
+// Largest gyro bias accepted (LSB, ~10 deg/s)
+#define FUSION_BIAS_MAX                 (40)
+
+// Pointer gain in pixels per radian
+#define FUSION_POINTER_GAIN             (800)
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Resets the orientation, the gyro bias and the pointer movement.
+ *        Called when the motion sensor is (re)configured.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+void app_motion_fusion_reset(void);
+
+/**
+ ****************************************************************************************
+ * @brief Adds a sample (taken at MOTION_ODR_HZ) to the orientation filter and
+ *        accumulates the pointer movement.
+ *
+ * @param acc   The accelerometer X, Y and Z axes (12 bits, +/-8g)
+ * @param rot   The gyro X, Y and Z axes (12 bits, +/-500 deg/s)
+ *
+ * @return void
+ ****************************************************************************************
+ */
+void app_motion_fusion_update(const int16_t acc[3], const int16_t rot[3]);
+
+/**
+ ****************************************************************************************
+ * @brief Takes the pointer movement accumulated since the previous call, up to
+ *        +/-127 pixels per axis. The rest is kept for the next call.
+ *
+ * @param dx    Horizontal movement, positive to the right
+ * @param dy    Vertical movement, positive down
+ *
+ * @return true, if there is movement to report
+ ****************************************************************************************
+ */
+bool app_motion_fusion_get_pointer(int8_t *dx, int8_t *dy);
+
+#endif // APP_MOTION_FUSION_H_
@@ -21,11 +21,90 @@
 #include "app_stream.h"
 #include "i2c_bmi055.h"
 #include "app_kbd.h"
+#if (HAS_MOTION_DELTA)
+#include "app_motion_codec.h"
+#endif
+#if (HAS_MOTION_POINTER)
+#include "app_motion_fusion.h"
+#include "app_mouse.h"
+#include "l2cm.h"
+#endif
+#if (HAS_I2C_ASYNC)
+#include "i2c_async.h"
+#include "app_event.h"
+#endif
+#if (HAS_MOTION_POWER)
+#include <stdlib.h>
+#endif
+#if (HAS_MOTION_INT_PIN)
+#include "gpio.h"
+#endif
+#if (USE_CONNECTION_FSM)
+#include "app_conn_params.h"
+#endif
 
 
 static int cnt=0;
 static bool device_ready=false;
 
+#if (HAS_BMI055_FIFO)
+// Sample periods of the FIFOs and time of a byte on the I2C bus at 400kHz, in us
+#define MOTION_ROT_PERIOD_US    (1000000 / MOTION_ODR_HZ)
+#define MOTION_ACC_PERIOD_US    (1000000 / MOTION_ACC_ODR_HZ)
+#define MOTION_I2C_BYTE_US      (23)
+
+static bool motion_gap=false;
+static int16_t last_acc_motion[3];
+static uint8_t motion_rot[BMI055_FIFO_MAX_BURST * BMI055_FIFO_FRAME_SIZE];
+static uint8_t motion_acc[BMI055_FIFO_MAX_BURST * BMI055_FIFO_FRAME_SIZE];
+static uint8_t motion_nb_rot=0, motion_nb_acc=0, motion_dropped=0, motion_dropped_acc=0;
+static int8_t motion_temperature=0;
+static uint8_t motion_temp_cnt=0;
+#if !(HAS_MOTION_DELTA)
+static bool motion_temp_high=false;
+#endif
+#endif
+
+#if (HAS_I2C_ASYNC)
+// Steps of the burst read. Each one is an I2C transaction.
+enum motion_rd_step {
+    MOTION_RD_IDLE,
+    MOTION_RD_ROT_STATUS,
+    MOTION_RD_ROT,
+    MOTION_RD_ACC_STATUS,
+    MOTION_RD_ACC,
+    MOTION_RD_TEMP,
+};
+
+static struct i2c_async_trans motion_trans;
+static struct i2c_async_trans motion_clear_trans[2];   // gyro, accelerometer
+static volatile uint8_t motion_rd_step=MOTION_RD_IDLE;
+static volatile bool motion_burst_ready=false;
+static uint8_t motion_fifo_status;
+static const uint8_t motion_fifo_stream = BMI055_FIFO_MODE_STREAM | BMI055_FIFO_DATA_XYZ;
+#endif
+
+#if (HAS_MOTION_POINTER)
+static uint8_t motion_buttons=0;
+#endif
+
+#if (HAS_MOTION_POWER)
+enum motion_power_level {
+    MOTION_PWR_ACTIVE,      // both sensors sampling, the samples are sent
+    MOTION_PWR_DOZE,        // gyro in fast power-up, accelerometer waiting for motion
+    MOTION_PWR_STANDBY,     // gyro suspended, accelerometer sampling every 100ms
+};
+
+static uint8_t motion_level=MOTION_PWR_ACTIVE;
+static uint8_t motion_still_cnt=0;
+static bool motion_bw_wide=true;
+static bool motion_standby_due=false;
+static int16_t motion_prev_rot[3];
+#endif
+
+// The self-test of the gyro runs once after power-up
+static bool motion_bist_passed __attribute__((section("retention_mem_area0"), zero_init));
+
 extern bool user_motion_left_click_pressed;
 
 /**
@@ -47,6 +126,7 @@ __INLINE void allign(int16_t *data, bool left)
     }
 }
 
+#if !(HAS_BMI055_FIFO)
 /**
  ****************************************************************************************
  * @brief Resets the LSB of a 16-bit integer or shifts it right by 4 places
@@ -74,6 +154,693 @@ static void app_motion_read_data(struct s_app_motion_data *data)
     i2c_bmi055_read_data((uint8_t *)data->rot_motion,2,0x6);
     data->click_events=user_motion_left_click_pressed;
 }
+#endif
+
+#if (HAS_BMI055_FIFO)
+/**
+ ****************************************************************************************
+ * @brief Packs two 12-bit values in 3 bytes
+ *
+ * @param dst   Pointer to the 3 bytes
+ * @param a     First value
+ * @param b     Second value
+ *
+ * @return void
+ ****************************************************************************************
+ */
+__INLINE void app_motion_pack12(uint8_t *dst, int16_t a, int16_t b)
+{
+    dst[0] = (uint8_t)a;
+    dst[1] = ((a >> 8) & 0x0F) | ((b & 0x0F) << 4);
+    dst[2] = (uint8_t)(b >> 4);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Reads a 16-bit axis of a FIFO frame and returns its upper 12 bits
+ *
+ * @param frame  Pointer to the frame
+ * @param axis   0 for X, 1 for Y, 2 for Z
+ *
+ * @return The axis value
+ ****************************************************************************************
+ */
+__INLINE int16_t app_motion_frame_axis(const uint8_t *frame, int axis)
+{
+    return ((int16_t)(frame[2 * axis] | (frame[2 * axis + 1] << 8))) >> 4;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Empties the FIFO of the selected device
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_motion_clear_fifo(void)
+{
+    i2c_bmi055_write_byte(BMI055_FIFO_CONFIG_1, BMI055_FIFO_MODE_STREAM | BMI055_FIFO_DATA_XYZ);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Waits for the interrupt driven I2C transactions to end, before the blocking
+ *        driver is used. The burst read ends within a few hundred us.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_motion_i2c_wait(void)
+{
+#if (HAS_I2C_ASYNC)
+    while (i2c_async_is_busy());
+#endif
+}
+
+/**
+ ****************************************************************************************
+ * @brief Gets the number of frames to read from the status of a FIFO
+ *
+ * @param status    FIFO_STATUS of the device
+ * @param dropped   Frames that do not fit in a burst
+ *
+ * @return Number of frames to read, up to BMI055_FIFO_MAX_BURST
+ ****************************************************************************************
+ */
+static uint8_t app_motion_fifo_frames(uint8_t status, uint8_t *dropped)
+{
+    uint8_t nb = status & BMI055_FIFO_FRAME_COUNTER;
+
+    if (nb > BMI055_FIFO_MAX_BURST) {
+        nb = BMI055_FIFO_MAX_BURST;
+    }
+    *dropped = (status & BMI055_FIFO_FRAME_COUNTER) - nb;
+    return nb;
+}
+
+#if (HAS_I2C_ASYNC)
+/**
+ ****************************************************************************************
+ * @brief Submits the next step of the burst read
+ *
+ * @param dev       Slave address of the gyro (0x69) or of the accelerometer (0x19)
+ * @param reg       First register
+ * @param data      Read data
+ * @param len       Number of bytes to read
+ * @param step      The step
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_motion_i2c_read(uint8_t dev, uint8_t reg, uint8_t *data, uint16_t len, uint8_t step)
+{
+    motion_rd_step = step;
+    motion_trans.dev_address = dev;
+    motion_trans.reg = reg;
+    motion_trans.rd_data = data;
+    motion_trans.rd_len = len;
+    i2c_async_submit(&motion_trans);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Queues a write of FIFO_CONFIG_1, which empties the FIFO of a device
+ *
+ * @param dev       Slave address of the gyro (0x69) or of the accelerometer (0x19)
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_motion_i2c_clear_fifo(uint8_t dev)
+{
+    struct i2c_async_trans *t = &motion_clear_trans[dev == 0x19];
+
+    t->callback = NULL;
+    t->dev_address = dev;
+    t->speed = I2C_FAST;
+    t->reg = BMI055_FIFO_CONFIG_1;
+    t->reg_len = 1;
+    t->wr_data = &motion_fifo_stream;
+    t->wr_len = 1;
+    t->rd_len = 0;
+    i2c_async_submit(t);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Ends the burst read. The samples are sent from the main loop.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_motion_i2c_burst_done(void)
+{
+    motion_rd_step = MOTION_RD_IDLE;
+    motion_burst_ready = true;
+    app_event_set(APP_EVENT_TRM);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Reads the temperature if it is due, else ends the burst read
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_motion_i2c_read_temp(void)
+{
+    if (motion_temp_cnt == 0) {
+        motion_temp_cnt = MOTION_TEMP_INTERVAL - 1;
+        app_motion_i2c_read(0x19, BMI055_ACCD_TEMP, (uint8_t *)&motion_temperature, 1, MOTION_RD_TEMP);
+        return;
+    }
+    motion_temp_cnt--;
+    app_motion_i2c_burst_done();
+}
+
+/**
+ ****************************************************************************************
+ * @brief Completion of a step of the burst read (I2C interrupt). Submits the next step.
+ *
+ * @param trans     The transaction
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_motion_i2c_cb(struct i2c_async_trans *trans)
+{
+    if (trans->status != I2C_ASYNC_OK) {
+        // the burst is lost
+        motion_nb_rot = 0;
+        motion_gap = true;
+        app_motion_i2c_burst_done();
+        return;
+    }
+
+    switch (motion_rd_step) {
+    case MOTION_RD_ROT_STATUS:
+        motion_nb_rot = app_motion_fifo_frames(motion_fifo_status, &motion_dropped);
+        if (motion_nb_rot) {
+            app_motion_i2c_read(0x69, BMI055_FIFO_DATA, motion_rot, motion_nb_rot * BMI055_FIFO_FRAME_SIZE, MOTION_RD_ROT);
+        }
+        if ((motion_fifo_status & BMI055_FIFO_OVERRUN) || motion_dropped) {
+            app_motion_i2c_clear_fifo(0x69);
+            motion_gap = true;
+        }
+        if (motion_nb_rot == 0) {
+            app_motion_i2c_burst_done();
+        }
+        break;
+    case MOTION_RD_ROT:
+        app_motion_i2c_read(0x19, BMI055_FIFO_STATUS, &motion_fifo_status, 1, MOTION_RD_ACC_STATUS);
+        break;
+    case MOTION_RD_ACC_STATUS:
+        motion_nb_acc = app_motion_fifo_frames(motion_fifo_status, &motion_dropped_acc);
+        if (motion_nb_acc) {
+            app_motion_i2c_read(0x19, BMI055_FIFO_DATA, motion_acc, motion_nb_acc * BMI055_FIFO_FRAME_SIZE, MOTION_RD_ACC);
+        }
+        if ((motion_fifo_status & BMI055_FIFO_OVERRUN) || motion_dropped_acc) {
+            app_motion_i2c_clear_fifo(0x19);
+        }
+        if (motion_nb_acc == 0) {
+            app_motion_i2c_read_temp();
+        }
+        break;
+    case MOTION_RD_ACC:
+        app_motion_i2c_read_temp();
+        break;
+    case MOTION_RD_TEMP:
+    default:
+        app_motion_i2c_burst_done();
+        break;
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Starts reading the samples collected since the previous call. The FIFO status
+ *        and data of the gyro, then of the accelerometer, are read by a chain of I2C
+ *        transactions, without waiting. app_motion_send_motion_burst() sends them when
+ *        motion_burst_ready is set.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_motion_read_burst(void)
+{
+    if ((motion_rd_step != MOTION_RD_IDLE) || motion_burst_ready || i2c_async_is_busy()) {
+        return;     // the previous burst has not been sent yet, the frames stay in the FIFO
+    }
+
+    motion_nb_rot = 0;
+    motion_nb_acc = 0;
+    motion_dropped = 0;
+    motion_dropped_acc = 0;
+    motion_trans.callback = app_motion_i2c_cb;
+    motion_trans.speed = I2C_FAST;
+    motion_trans.reg_len = 1;
+    motion_trans.wr_len = 0;
+    app_motion_i2c_read(0x69, BMI055_FIFO_STATUS, &motion_fifo_status, 1, MOTION_RD_ROT_STATUS);
+}
+#else
+/**
+ ****************************************************************************************
+ * @brief Reads the samples collected since the previous call, in one I2C burst per
+ *        sensor.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_motion_read_burst(void)
+{
+    uint8_t status;
+
+    motion_nb_acc = 0;
+    motion_dropped_acc = 0;
+
+    i2c_bmi055_init (0x69, 2, 0);
+    status = i2c_bmi055_read_fifo(motion_rot, BMI055_FIFO_MAX_BURST);
+    motion_nb_rot = app_motion_fifo_frames(status, &motion_dropped);
+    if ((status & BMI055_FIFO_OVERRUN) || motion_dropped) {
+        app_motion_clear_fifo();
+        motion_gap = true;
+    }
+    if (motion_nb_rot == 0) {
+        return;
+    }
+
+    i2c_bmi055_init (0x19, 2, 0);
+    status = i2c_bmi055_read_fifo(motion_acc, BMI055_FIFO_MAX_BURST);
+    motion_nb_acc = app_motion_fifo_frames(status, &motion_dropped_acc);
+    if ((status & BMI055_FIFO_OVERRUN) || motion_dropped_acc) {
+        app_motion_clear_fifo();
+    }
+
+    if (motion_temp_cnt == 0) {
+        motion_temperature = (int8_t)i2c_bmi055_read_byte(BMI055_ACCD_TEMP);
+        motion_temp_cnt = MOTION_TEMP_INTERVAL;
+    }
+    motion_temp_cnt--;
+}
+#endif // HAS_I2C_ASYNC
+
+/**
+ ****************************************************************************************
+ * @brief Gets the sample time of a FIFO frame of the burst, in us before the read of the
+ *        gyro FIFO status. The newest frame of a FIFO was taken within one period before
+ *        its status was read, and the frames that did not fit in the burst are newer
+ *        than the ones read.
+ *
+ * @param idx       Index of the frame in the burst
+ * @param nb        Frames read from the FIFO
+ * @param dropped   Frames dropped from the FIFO
+ * @param period    Sample period of the FIFO, in us
+ *
+ * @return The time, in us (negative)
+ ****************************************************************************************
+ */
+__INLINE int32_t app_motion_frame_time(uint8_t idx, uint8_t nb, uint8_t dropped, int32_t period)
+{
+    return -(int32_t)(nb + dropped - 1 - idx) * period;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Finds the accelerometer frame of the burst taken closest in time to a gyro
+ *        frame. The accelerometer FIFO status is read after the gyro frames.
+ *
+ * @param rot_idx   Index of the gyro frame
+ * @param acc_idx   Index of the accelerometer frame paired with the previous gyro frame
+ *
+ * @return Index of the accelerometer frame
+ ****************************************************************************************
+ */
+static uint8_t app_motion_pair_acc(uint8_t rot_idx, uint8_t acc_idx)
+{
+    const int32_t acc_read = (motion_nb_rot * BMI055_FIFO_FRAME_SIZE + 4) * MOTION_I2C_BYTE_US;
+    const int32_t t_rot = app_motion_frame_time(rot_idx, motion_nb_rot, motion_dropped, MOTION_ROT_PERIOD_US);
+
+    // the frames of both FIFOs are in time order
+    while (acc_idx + 1 < motion_nb_acc) {
+        const int32_t t_acc = acc_read + app_motion_frame_time(acc_idx, motion_nb_acc, motion_dropped_acc, MOTION_ACC_PERIOD_US);
+
+        if (t_rot - t_acc <= MOTION_ACC_PERIOD_US / 2) {
+            break;      // the next frame is not closer
+        }
+        acc_idx++;
+    }
+    return acc_idx;
+}
+
+#if !(HAS_MOTION_DELTA)
+/**
+ ****************************************************************************************
+ * @brief Gets the half of the temperature carried by the next burst report. The 20-byte
+ *        report has no room for a full byte, so the reports alternate between the low
+ *        and the high 3 bits.
+ *
+ * @return The MOTION_INFO_TEMP and MOTION_INFO_TEMP_HIGH bits of the info field
+ ****************************************************************************************
+ */
+static uint8_t app_motion_temp_info(void)
+{
+    int8_t temp = motion_temperature >> 1;      // the sensor has 0.5K/LSB
+
+    if (temp > MOTION_TEMP_MAX) {
+        temp = MOTION_TEMP_MAX;
+    } else if (temp < MOTION_TEMP_MIN) {
+        temp = MOTION_TEMP_MIN;
+    }
+
+    motion_temp_high = !motion_temp_high;
+    if (motion_temp_high) {
+        return MOTION_INFO_TEMP_HIGH | (((temp >> 3) << 5) & MOTION_INFO_TEMP);
+    }
+    return (temp << 5) & MOTION_INFO_TEMP;
+}
+#endif
+
+/**
+ ****************************************************************************************
+ * @brief Sends the samples read by app_motion_read_burst() in motion reports of up to
+ *        MOTION_BURST_SAMPLES.
+ *
+ *        The accelerometer runs at a higher ODR than the gyro. Each gyro sample is paired
+ *        with the accelerometer sample taken closest in time, so the pairs do not drift
+ *        when the two FIFOs hold a different number of frames. Frames that do not fit in
+ *        a burst are dropped and the next report is flagged with MOTION_INFO_GAP. Its
+ *        timestamp includes the dropped samples.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_motion_send_motion_burst(void)
+{
+    const uint8_t *rot = motion_rot;
+    const uint8_t *acc = motion_acc;
+    const uint8_t nb_rot = motion_nb_rot;
+    const uint8_t nb_acc = motion_nb_acc;
+    uint8_t i, j, k = 0;
+    int16_t rot_motion[3];
+#if (HAS_MOTION_DELTA)
+    int16_t samples[BMI055_FIFO_MAX_BURST][MOTION_CODEC_AXES];
+    const uint8_t timestamp = (uint8_t)cnt;
+    uint8_t info;
+#else
+    t_app_motion_burst report;
+#endif
+
+    if (nb_rot == 0) {
+        return;
+    }
+
+#if (HAS_MOTION_DELTA)
+    for (i = 0; i < nb_rot; i++) {
+        const uint8_t *rot_frame = &rot[i * BMI055_FIFO_FRAME_SIZE];
+
+        if (nb_acc) {
+            const uint8_t *acc_frame;
+
+            k = app_motion_pair_acc(i, k);
+            acc_frame = &acc[k * BMI055_FIFO_FRAME_SIZE];
+
+            last_acc_motion[0] = app_motion_frame_axis(acc_frame, 0);
+            last_acc_motion[1] = app_motion_frame_axis(acc_frame, 1);
+            last_acc_motion[2] = app_motion_frame_axis(acc_frame, 2);
+        }
+
+        for (j = 0; j < 3; j++) {
+            rot_motion[j] = app_motion_frame_axis(rot_frame, j);
+            samples[i][j] = last_acc_motion[j];
+            samples[i][j + 3] = rot_motion[j];
+        }
+#if (HAS_MOTION_POINTER)
+        app_motion_fusion_update(last_acc_motion, rot_motion);
+#endif
+        cnt++;
+    }
+
+    info = user_motion_left_click_pressed ? MOTION_CODEC_INFO_CLICK : 0;
+    if (motion_gap) {
+        info |= MOTION_CODEC_INFO_GAP;
+        motion_gap = false;
+    }
+    app_motion_codec_send(samples, nb_rot, timestamp, info, motion_temperature);
+#else
+    for (i = 0; i < nb_rot; i += MOTION_BURST_SAMPLES) {
+        memset(&report, 0, sizeof(report));
+        report.timestamp = (uint8_t)cnt;
+        report.info = user_motion_left_click_pressed ? MOTION_INFO_CLICK : 0;
+        report.info |= app_motion_temp_info();
+        if (motion_gap) {
+            report.info |= MOTION_INFO_GAP;
+            motion_gap = false;
+        }
+
+        for (j = 0; (j < MOTION_BURST_SAMPLES) && ((i + j) < nb_rot); j++) {
+            const uint8_t *rot_frame = &rot[(i + j) * BMI055_FIFO_FRAME_SIZE];
+            uint8_t *dst = report.samples[j];
+
+            if (nb_acc) {
+                const uint8_t *acc_frame;
+
+                k = app_motion_pair_acc(i + j, k);
+                acc_frame = &acc[k * BMI055_FIFO_FRAME_SIZE];
+
+                last_acc_motion[0] = app_motion_frame_axis(acc_frame, 0);
+                last_acc_motion[1] = app_motion_frame_axis(acc_frame, 1);
+                last_acc_motion[2] = app_motion_frame_axis(acc_frame, 2);
+            }
+
+            rot_motion[0] = app_motion_frame_axis(rot_frame, 0);
+            rot_motion[1] = app_motion_frame_axis(rot_frame, 1);
+            rot_motion[2] = app_motion_frame_axis(rot_frame, 2);
+
+            app_motion_pack12(&dst[0], last_acc_motion[0], last_acc_motion[1]);
+            app_motion_pack12(&dst[3], last_acc_motion[2], rot_motion[0]);
+            app_motion_pack12(&dst[6], rot_motion[1], rot_motion[2]);
+#if (HAS_MOTION_POINTER)
+            app_motion_fusion_update(last_acc_motion, rot_motion);
+#endif
+            cnt++;
+        }
+        report.info |= j;
+
+        app_stream_send_motionreport(&report, sizeof(report));
+    }
+#endif // HAS_MOTION_DELTA
+    
+    // the dropped frames were newer than the ones sent
+    cnt += motion_dropped;
+}
+#endif // HAS_BMI055_FIFO
+
+#if (HAS_MOTION_POINTER)
+/**
+ ****************************************************************************************
+ * @brief Sends the pointer movement and the left click in a Mouse report, once per
+ *        connection event. The movement is kept if no Tx buffer is available.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_motion_send_pointer(void)
+{
+    const uint8_t buttons = user_motion_left_click_pressed ? MOUSE_BUTTON_LEFT : 0;
+    int8_t dx, dy;
+
+    if (!l2cm_get_nb_buffer_available()) {
+        return;
+    }
+
+    if (app_motion_fusion_get_pointer(&dx, &dy) || (buttons != motion_buttons)) {
+        app_mouse_send_report(buttons, dx, dy, 0);
+        motion_buttons = buttons;
+    }
+}
+#endif // HAS_MOTION_POINTER
+
+#if (HAS_MOTION_POWER)
+/**
+ ****************************************************************************************
+ * @brief Sets the bandwidth of the gyro. The ODR stays MOTION_ODR_HZ.
+ *
+ * @param wide  true for 32Hz, false for 12Hz
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_motion_gyro_bw(bool wide)
+{
+    app_motion_i2c_wait();
+
+    i2c_bmi055_init (0x69, 2, 0);
+    i2c_bmi055_write_byte(BMI055_PMU_BW, wide ? BMI055_GYR_BW_100HZ_32HZ : BMI055_GYR_BW_100HZ_12HZ);
+    motion_bw_wide = wide;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Powers the gyro down and lets the accelerometer wait for motion
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_motion_doze(void)
+{
+    app_motion_i2c_wait();
+
+    i2c_bmi055_init (0x69, 2, 0);
+    i2c_bmi055_write_byte(BMI055_PMU_LOW_POWER, BMI055_GYR_FAST_POWERUP);
+    i2c_bmi055_write_byte(BMI055_PMU_LPW, BMI055_SUSPEND);
+
+    i2c_bmi055_init (0x19, 2, 0);
+    i2c_bmi055_write_byte(BMI055_INT_6, MOTION_SLOPE_THRESHOLD);
+    i2c_bmi055_write_byte(BMI055_INT_5, 1);                     // 2 samples above the threshold
+    i2c_bmi055_write_byte(BMI055_INT_MAP_0, BMI055_INT_SLOPE);  // on INT1, active high (INT_OUT_CTRL at reset)
+    i2c_bmi055_write_byte(BMI055_INT_RST_LATCH, BMI055_INT_RESET | BMI055_INT_LATCHED);
+    i2c_bmi055_write_byte(BMI055_INT_EN_0, BMI055_INT_EN_SLOPE_XYZ);
+    i2c_bmi055_suspend_device(0x19, BMI055_LOW_POWER_25MS);
+
+    motion_level = MOTION_PWR_DOZE;
+    motion_standby_due = false;
+    app_timer_set(APP_MOT_TIMER, TASK_APP, MOTION_STANDBY_DELAY);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Suspends the gyro and slows the accelerometer down
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_motion_standby(void)
+{
+    app_motion_i2c_wait();
+
+    i2c_bmi055_suspend_device(0x69, BMI055_SUSPEND);
+    i2c_bmi055_suspend_device(0x19, BMI055_LOW_POWER_100MS);
+    motion_level = MOTION_PWR_STANDBY;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Puts both sensors back in normal mode. The next report is flagged with a gap.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_motion_resume(void)
+{
+    ke_timer_clear(APP_MOT_TIMER, TASK_APP);
+    app_motion_i2c_wait();
+
+    i2c_bmi055_init (0x19, 2, 0);
+    i2c_bmi055_write_byte(BMI055_INT_EN_0, 0);
+    i2c_bmi055_write_byte(BMI055_INT_RST_LATCH, BMI055_INT_RESET | BMI055_INT_LATCHED);
+    i2c_bmi055_suspend_device(0x19, BMI055_NORMAL);
+    app_motion_clear_fifo();
+
+    i2c_bmi055_suspend_device(0x69, BMI055_NORMAL);
+    app_motion_clear_fifo();
+
+    motion_level = MOTION_PWR_ACTIVE;
+    motion_still_cnt = 0;
+    motion_gap = true;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Checks the any-motion interrupt while the gyro is powered down. Called at each
+ *        connection event instead of the burst read. The interrupt is latched, so it is
+ *        read from the INT1 pin if it is wired (HAS_MOTION_INT_PIN), else over I2C.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_motion_poll_activity(void)
+{
+    bool activity;
+
+#if (HAS_MOTION_INT_PIN)
+    activity = GPIO_GetPinStatus(MOTION_INT_PORT, MOTION_INT_PIN);
+#else
+    app_motion_i2c_wait();
+    i2c_bmi055_init (0x19, 2, 0);
+    activity = (i2c_bmi055_read_byte(BMI055_INT_STATUS_0) & BMI055_INT_SLOPE) != 0;
+#endif
+    if (activity) {
+        app_motion_resume();
+    } else if (motion_standby_due && (motion_level == MOTION_PWR_DOZE)) {
+        app_motion_standby();
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Selects the power level and the gyro bandwidth from the gyro samples of the
+ *        last burst.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_motion_power_update(void)
+{
+    int16_t peak = 0;
+    uint8_t i, j;
+
+    for (i = 0; i < motion_nb_rot; i++) {
+        const uint8_t *rot_frame = &motion_rot[i * BMI055_FIFO_FRAME_SIZE];
+        bool still = true;
+
+        for (j = 0; j < 3; j++) {
+            const int16_t rot = app_motion_frame_axis(rot_frame, j);
+
+            if (abs(rot) > peak) {
+                peak = abs(rot);
+            }
+            if ((abs(rot) > MOTION_STILL_ROT) || (abs(rot - motion_prev_rot[j]) > MOTION_STILL_DELTA)) {
+                still = false;
+            }
+            motion_prev_rot[j] = rot;
+        }
+
+        if (!still) {
+            motion_still_cnt = 0;
+        } else if (motion_still_cnt < MOTION_DOZE_SAMPLES) {
+            motion_still_cnt++;
+        }
+    }
+
+    if (motion_still_cnt >= MOTION_DOZE_SAMPLES) {
+        app_motion_doze();
+    } else if (!motion_bw_wide && (peak > MOTION_FAST_ROT)) {
+        app_motion_gyro_bw(true);
+    } else if (motion_bw_wide && motion_nb_rot && (peak < MOTION_SLOW_ROT)) {
+        app_motion_gyro_bw(false);
+    }
+}
+#endif // HAS_MOTION_POWER
+
+#if (HAS_BMI055_FIFO)
+/**
+ ****************************************************************************************
+ * @brief Sends the samples of the last burst and the pointer movement
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_motion_send_samples(void)
+{
+    app_motion_send_motion_burst();
+#if (HAS_MOTION_POINTER)
+    app_motion_send_pointer();
+#endif
+#if (HAS_MOTION_POWER)
+    app_motion_power_update();
+#endif
+}
+#endif
 
 /**
  ****************************************************************************************
@@ -113,9 +880,16 @@ static bool app_motion_test_bist(void)
 static void app_motion_gyro_config(void)
 {
     i2c_bmi055_init (0x69,2, 0);
+#if (HAS_BMI055_FIFO)
+    i2c_bmi055_write_byte(BMI055_PMU_RANGE,2  ); //range is set to +/-500, 12-bit resolution 0.24 deg/s
+    i2c_bmi055_write_byte(BMI055_PMU_BW,   BMI055_GYR_BW_100HZ_32HZ); //ODR 100Hz (MOTION_ODR_HZ)
+    i2c_bmi055_write_byte(BMI055_ACCD_HBW, 0  ); //range 
+    app_motion_clear_fifo();
+#else
     i2c_bmi055_write_byte(BMI055_PMU_RANGE,0  ); //range is set to +/-2000
     i2c_bmi055_write_byte(BMI055_PMU_BW,   0x2); //bandwidth 116Hz
     i2c_bmi055_write_byte(BMI055_ACCD_HBW, 0  ); //range 
+#endif
 }
 
 /**
@@ -129,8 +903,14 @@ static void app_motion_accel_config(void)
 {
     i2c_bmi055_init (0x19,2, 0);
     i2c_bmi055_write_byte(BMI055_PMU_RANGE,8  ); //range is set to +/-8g
+#if (HAS_BMI055_FIFO)
+    i2c_bmi055_write_byte(BMI055_PMU_BW,   0xB); //bandwidth 62.5Hz, ODR 125Hz (> MOTION_ODR_HZ)
+    i2c_bmi055_write_byte(BMI055_ACCD_HBW, 0  ); //filtered data in the FIFO
+    app_motion_clear_fifo();
+#else
     i2c_bmi055_write_byte(BMI055_PMU_BW,   0xF); //bandwidth BW 0x8 = 7.81 Hz -  0xF = 1000 HZ
     i2c_bmi055_write_byte(BMI055_ACCD_HBW, 0  ); //range 
+#endif
 }
 
 /**
@@ -142,6 +922,10 @@ static void app_motion_accel_config(void)
  */
 static void app_motion_sleep_bmi(void)
 {
+    app_motion_i2c_wait();
+#if (HAS_I2C_ASYNC)
+    motion_burst_ready=false;
+#endif
     cnt=0;
     device_ready=false;
     i2c_bmi055_suspend_device (0x69, BMI055_DEEP_SUSPEND);
@@ -175,6 +959,24 @@ static void app_motion_config_bmi(void)
     app_motion_gyro_config();
     app_motion_accel_config();
     cnt=0;
+#if (HAS_BMI055_FIFO)
+    motion_gap=false;
+    motion_temp_cnt=0;
+    memset(last_acc_motion, 0, sizeof(last_acc_motion));
+#endif
+#if (HAS_MOTION_POINTER)
+    app_motion_fusion_reset();
+    motion_buttons=0;
+#endif
+#if (HAS_MOTION_DELTA)
+    app_motion_codec_reset();
+#endif
+#if (HAS_MOTION_POWER)
+    motion_level=MOTION_PWR_ACTIVE;
+    motion_still_cnt=0;
+    motion_bw_wide=true;
+    memset(motion_prev_rot, 0, sizeof(motion_prev_rot));
+#endif
     device_ready=true;
 }
 
@@ -187,13 +989,31 @@ static void app_motion_config_bmi(void)
  */
 static void app_motion_send_motion_not(void)
 {
+#if (HAS_BMI055_FIFO)
+    if (device_ready) {
+#if (HAS_MOTION_POWER)
+        if (motion_level != MOTION_PWR_ACTIVE) {
+            app_motion_poll_activity();
+#if (HAS_MOTION_POINTER)
+            app_motion_send_pointer();      // the click
+#endif
+            return;
+        }
+#endif
+        app_motion_read_burst();
+#if !(HAS_I2C_ASYNC)
+        app_motion_send_samples();
+#endif
+    }
+#else
     struct s_app_motion_data data;
     memset (&data,0,sizeof (struct s_app_motion_data));
 
     app_motion_read_data (&data);
     if (device_ready) {
-        app_stream_send_motionreport(&data);
+        app_stream_send_motionreport(&data, APP_STREAM_PACKET_SIZE);
     }
+#endif
 }
 
 extern char motion_cpt_event;        
@@ -215,12 +1035,18 @@ void app_motion_state_machine ( int pressed )
             app_timer_set(APP_MOT_TIMER,TASK_APP,4);
             break;
         case 2:
-            app_motion_issue_bist();
-            state_bmi_pressed=3;
+            if (motion_bist_passed) {
+                app_motion_config_bmi();
+                state_bmi_pressed=5;
+            } else {
+                app_motion_issue_bist();
+                state_bmi_pressed=3;
+            }
             app_timer_set(APP_MOT_TIMER,TASK_APP,1);
             break;
         case 4:
             if (app_motion_test_bist()) {
+                motion_bist_passed=true;
                 app_motion_config_bmi();
                 state_bmi_pressed=5;
                 app_timer_set(APP_MOT_TIMER,TASK_APP,1);
@@ -236,8 +1062,21 @@ void app_motion_state_machine ( int pressed )
                 if (app_kbd_check_conn_status() && !conn_upd_pending) {
                     app_motion_send_motion_not();
                 }
+#if (USE_CONNECTION_FSM)
+                if (con_fsm_params.has_conn_params_manager) {
+                    app_conn_params_activity(CONN_LOAD_MOTION);
+                }
+#endif
                 motion_cpt_event=0;
             }
+#if (HAS_I2C_ASYNC)
+            if (motion_burst_ready) {
+                motion_burst_ready=false;
+                if (device_ready && app_kbd_check_conn_status()) {
+                    app_motion_send_samples();
+                }
+            }
+#endif
             break;
         case 1:
         case 3:
@@ -278,6 +1117,11 @@ int app_motion_timer_handler(ke_msg_id_t const msgid,
     if (state_bmi_pressed < 6) {
         state_bmi_pressed++;
     }
+#if (HAS_MOTION_POWER)
+    else if (motion_level == MOTION_PWR_DOZE) {
+        motion_standby_due=true;
+    }
+#endif
 	return (KE_MSG_CONSUMED);
 }
 
@@ -34,6 +34,68 @@ typedef  struct s_app_motion_data
     int16_t click_events;
 } t_app_motion_data;
 
+#if (HAS_BMI055_FIFO)
+/*
+ * Burst motion report
+ *
+ * The gyro FIFO sets the sample clock (MOTION_ODR_HZ). Each sample carries the 6 axes
+ * as 12-bit two's complement values, packed in pairs (acc X,Y - acc Z,rot X - rot Y,Z):
+ *   byte 0: bits 7:0 of the first value
+ *   byte 1: bits 11:8 of the first value | bits 3:0 of the second value << 4
+ *   byte 2: bits 11:4 of the second value
+ * The accelerometer values are the 12 data bits of the sensor, the gyro values are
+ * the upper 12 bits of the 16-bit data (MOTION_GYRO_RANGE). Each gyro sample is paired
+ * with the accelerometer sample taken closest in time.
+ */
+#define MOTION_ODR_HZ               (100)
+#define MOTION_ACC_ODR_HZ           (125)   // accelerometer FIFO, above MOTION_ODR_HZ
+#define MOTION_BURST_SAMPLES        (2)
+#define MOTION_SAMPLE_SIZE          (9)
+
+// info field
+#define MOTION_INFO_SAMPLES         (0x03)  // number of samples in the report
+#define MOTION_INFO_CLICK           (0x04)  // left click is pressed
+#define MOTION_INFO_GAP             (0x08)  // samples were lost before the first sample
+#define MOTION_INFO_TEMP_HIGH       (0x10)  // MOTION_INFO_TEMP holds bits 5:3 of the temperature, else bits 2:0
+#define MOTION_INFO_TEMP            (0xE0)  // 3 bits of the temperature, alternating between reports
+
+// Temperature of the accelerometer in the burst reports: 6-bit two's complement, 1K/LSB, 0 is 23 degC
+#define MOTION_TEMP_MIN             (-32)
+#define MOTION_TEMP_MAX             (31)
+
+// Connection events between two reads of the temperature
+#define MOTION_TEMP_INTERVAL        (50)
+
+typedef  struct s_app_motion_burst
+{
+    uint8_t timestamp;                      // sample counter of the first sample (1/MOTION_ODR_HZ)
+    uint8_t info;
+    uint8_t samples[MOTION_BURST_SAMPLES][MOTION_SAMPLE_SIZE];
+} t_app_motion_burst;
+#endif
+
+#if (HAS_MOTION_POWER)
+/*
+ * Power levels
+ *
+ * The remote is still when no gyro axis exceeds MOTION_STILL_ROT (above the largest gyro
+ * bias) and no axis changes by more than MOTION_STILL_DELTA between two samples, for
+ * MOTION_DOZE_SAMPLES samples. The gyro then goes to fast power-up mode and the
+ * accelerometer to low power mode with the any-motion interrupt. The interrupt status is
+ * polled at each connection event. After MOTION_STANDBY_DELAY the gyro is suspended and
+ * the accelerometer samples less often.
+ */
+#define MOTION_STILL_ROT            (48)    // LSB, ~12 deg/s
+#define MOTION_STILL_DELTA          (8)     // LSB
+#define MOTION_DOZE_SAMPLES         (50)    // 0.5s
+#define MOTION_STANDBY_DELAY        (500)   // 5s, in 10ms
+#define MOTION_SLOPE_THRESHOLD      (4)     // any-motion threshold, 15.6mg LSB at +/-8g
+
+// Gyro rate (LSB) above which the 32Hz bandwidth is used, and below which the 12Hz one
+#define MOTION_FAST_ROT             (400)
+#define MOTION_SLOW_ROT             (200)
+#endif
+
 
 /*
  * GLOBAL VARIABLE DECLARATION
@@ -32,7 +32,15 @@
 #include "app_task.h"                // application task definitions
 #include "l2cc_task.h"
 #include "l2cm.h"
+#include "co_utils.h"
 #include "app_stream.h"
+#include "app_event.h"
+#include "app_energy.h"
+#include "app_kbd.h"
+
+#ifdef WLAN_COEX_ENABLED
+#include "wlan_coex.h"
+#endif
 
 
 /*
@@ -228,6 +236,64 @@ void app_stream_send_keyreport(struct hogpd_report_info *kreq)
     ke_msg_send(pkt);
 }
 
+#if (HAS_ENERGY_LEDGER)
+uint8_t app_stream_energy_left __attribute__((section("retention_mem_area0"), zero_init));     // buckets still to send
+
+/**
+ ****************************************************************************************
+ * @brief Send the energy ledger, one notification per bucket, on the HID vendor
+ *        specific report.
+ *
+ * Byte 2 is the bucket, byte 3 the number of buckets, then the time in ms, the charge
+ * in nAh, the current in nA and the count, 4 bytes each (little endian).
+ *
+ * @return      void.
+ ****************************************************************************************
+ */
+void app_stream_send_energy(void)
+{
+    app_stream_energy_left = ENERGY_NB;
+    app_stream_send_energy_more();
+}
+
+void app_stream_send_energy_more(void)
+{
+    struct app_energy_entry entry;
+    int bucket;
+
+    if (!app_kbd_check_conn_status()) {
+        app_stream_energy_left = 0;     // the read ends with the connection
+        return;
+    }
+
+    // Since pkt reqs can be silently discarded if no Tx bufs are available, check first!
+    // Keep one free, as the stream does; the rest is sent after the next connection event.
+    while (app_stream_energy_left && (l2cm_get_nb_buffer_available() > 1)) {
+        struct l2cc_pdu_send_req *pkt = KE_MSG_ALLOC_DYN(L2CC_PDU_SEND_REQ,
+                                                         KE_BUILD_ID(TASK_L2CC, app_env.conidx),
+                                                         TASK_APP, l2cc_pdu_send_req,
+                                                         APP_STREAM_PACKET_SIZE);
+        bucket = ENERGY_NB - app_stream_energy_left--;
+        app_energy_get(bucket, &entry);
+
+        pkt->pdu.chan_id   = L2C_CID_ATTRIBUTE;
+        // Set packet opcode.
+        pkt->pdu.data.code = L2C_CODE_ATT_HDL_VAL_NTF;
+        pkt->pdu.data.hdl_val_ntf.handle = hogpd_report_handle(STREAM_HOGPD_ENABLE_REPORT_NR);
+        pkt->pdu.data.hdl_val_ntf.value_len = APP_STREAM_PACKET_SIZE;
+        memset (pkt->pdu.data.hdl_val_ntf.value,0,APP_STREAM_PACKET_SIZE);
+        pkt->pdu.data.hdl_val_ntf.value[1] = APP_ENERGY_MSG_TYPE;  // TYPE of message == Energy
+        pkt->pdu.data.hdl_val_ntf.value[2] = bucket;
+        pkt->pdu.data.hdl_val_ntf.value[3] = ENERGY_NB;
+        co_write32p(&(pkt->pdu.data.hdl_val_ntf.value[4]), entry.time_ms);
+        co_write32p(&(pkt->pdu.data.hdl_val_ntf.value[8]), entry.charge_nah);
+        co_write32p(&(pkt->pdu.data.hdl_val_ntf.value[12]), entry.current_na);
+        co_write32p(&(pkt->pdu.data.hdl_val_ntf.value[16]), entry.count);
+        ke_msg_send(pkt);
+    }
+}
+#endif
+
 #define MAX_TX_BUFS (18)
 
 #define MAX_BUFS_PCON_INT (7)
@@ -236,7 +302,7 @@ void app_stream_send_keyreport(struct hogpd_report_info *kreq)
 
 #if (HAS_BMI055)
 #define STREAM_HOGPD_MOTION_REPORT_NR 78
-void app_stream_send_motionreport(void * motiondata)
+bool app_stream_send_motionreport(void * motiondata, uint8_t len)
 {
     int available, already_in;
     available=l2cm_get_nb_buffer_available();
@@ -245,17 +311,19 @@ void app_stream_send_motionreport(void * motiondata)
         struct l2cc_pdu_send_req *pkt = KE_MSG_ALLOC_DYN(L2CC_PDU_SEND_REQ,
                                                          KE_BUILD_ID(TASK_L2CC, app_env.conidx),
                                                          TASK_APP, l2cc_pdu_send_req,
-                                                         APP_STREAM_PACKET_SIZE);
+                                                         len);
     pkt->pdu.chan_id   = L2C_CID_ATTRIBUTE;
     // Set packet opcode.
     pkt->pdu.data.code = L2C_CODE_ATT_HDL_VAL_NTF;
     pkt->pdu.data.hdl_val_ntf.handle = STREAM_HOGPD_MOTION_REPORT_NR;
-    pkt->pdu.data.hdl_val_ntf.value_len = APP_STREAM_PACKET_SIZE;
+    pkt->pdu.data.hdl_val_ntf.value_len = len;
     /* copy the content to value */
-    memcpy (pkt->pdu.data.hdl_val_ntf.value,motiondata,APP_STREAM_PACKET_SIZE);
+    memcpy (pkt->pdu.data.hdl_val_ntf.value,motiondata,len);
 
     ke_msg_send(pkt);
+        return true;
     }
+    return false;
 }
 #endif // HAS_BMI055
 
@@ -358,12 +426,30 @@ uint8* datapt (int16 handle)
  */
 t_app_stream_fifo app_stream_fifo;
 
+/**
+ ****************************************************************************************
+ * @brief Raises the WLAN coexistence urgency when the FIFO passes its high-water mark
+ *        and lowers it when the FIFO has drained to its low-water mark.
+ ****************************************************************************************
+ */
+static inline void app_stream_coex_update(void)
+{
+#ifdef WLAN_COEX_ENABLED
+    if (app_stream_env.fifo_size >= APP_STREAM_COEX_HIGH_WATER) {
+        wlan_coex_urgency_set(WLAN_COEX_URG_STREAM, true);
+    } else if (app_stream_env.fifo_size <= APP_STREAM_COEX_LOW_WATER) {
+        wlan_coex_urgency_set(WLAN_COEX_URG_STREAM, false);
+    }
+#endif
+}
+
 void app_stream_fifo_init (void)
 {
     memset (app_stream_fifo.pkt_fifo, 0, sizeof(t_app_stream_pkt)*MAX_FIFO_LEN);
     app_stream_fifo.fifo_read = 0;
     app_stream_fifo.fifo_write = 0;
     app_stream_env.fifo_size = 0;   
+    app_stream_coex_update();
     app_stream_fifo.hnd = min_vendor_repnr;
     
 #ifndef MULTIPLE_ARRAYS
@@ -437,12 +523,15 @@ void app_stream_fifo_commit_repnr_pkt(uint8 repnr)
     ** obtain the correct Handle number.
     */        
     app_stream_env.fifo_size++;
+    app_stream_coex_update();
 
     app_stream_fifo.pkt_fifo[app_stream_fifo.fifo_write].used_hndl = repnr;
     app_stream_fifo.fifo_write++;  
     if (app_stream_fifo.fifo_write >= MAX_FIFO_LEN) {
         app_stream_fifo.fifo_write = 0;
     }    
+
+    app_event_set(APP_EVENT_BLE_WAKEUP);    // send it at the next connection event
 }
 
 void app_stream_fifo_commit_pkt(void)
@@ -632,6 +721,7 @@ static void send_pkt_to_l2cc(int16 packetIdx)
     // Set used_hndl to 0, to denote that packet is available
     app_stream_fifo.pkt_fifo[packetIdx].used_hndl = 0;  
         app_stream_env.fifo_size--;
+        app_stream_coex_update();
 }
 #endif // MEMORY_OPTIMIZATION1
 
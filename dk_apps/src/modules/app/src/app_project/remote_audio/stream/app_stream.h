@@ -50,6 +50,11 @@
  */
  
 #define APP_STREAM_PACKET_SIZE 20
+
+/// Levels of the stream FIFO, in packets, at which the WLAN coexistence urgency is raised
+/// (60ms of 64kbps voice) and lowered again
+#define APP_STREAM_COEX_HIGH_WATER  24
+#define APP_STREAM_COEX_LOW_WATER   6
  
 typedef  struct s_app_stream_env
 {  
@@ -175,12 +180,13 @@ void app_stream_send_enable_not(short value);
  * @brief Send directly a notfication to L2CC for HID vendore specific report.
  *
  * @param[in]   motiondata: the motion data to send.
+ * @param[in]   len: the length of the motion data (up to APP_STREAM_PACKET_SIZE).
  *
- * @return      void.
+ * @return      true, if the notification was sent. false, if no Tx buffer was available.
  ****************************************************************************************
  */
 #if (HAS_BMI055)
-void app_stream_send_motionreport(void * motiondata);
+bool app_stream_send_motionreport(void * motiondata, uint8_t len);
 #endif
                         
 /**
@@ -280,6 +286,28 @@ int stream_queue_more_data(void);
  */
 void app_stream_send_keyreport(struct hogpd_report_info *kreq);
 
+#if (HAS_ENERGY_LEDGER)
+/**
+ ****************************************************************************************
+ * @brief Send the energy ledger, one notification per bucket, on the HID vendor
+ *        specific report.
+ *
+ * @return      void.
+ ****************************************************************************************
+ */
+void app_stream_send_energy(void);
+
+/**
+ ****************************************************************************************
+ * @brief Send the buckets of the energy ledger that did not fit in the free Tx buffers.
+ *        Called after each connection event.
+ *
+ * @return      void.
+ ****************************************************************************************
+ */
+void app_stream_send_energy_more(void);
+#endif
+
 #endif //BLE_APP_STREAM
 
 /// @} APP
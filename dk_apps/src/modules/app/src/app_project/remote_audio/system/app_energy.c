@@ -0,0 +1,236 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_energy.c
+ *
+ * @brief Energy ledger: time and charge per power state and per subsystem that kept the
+ *        system awake.
+ *
+ * A sample costs two reads of the BLE timer and a few additions, once per pass of the
+ * main loop; a sleep and a wakeup cost a few instructions each. The ledger takes about
+ * 100 bytes of retention RAM.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include "app_energy.h"
+
+#if (HAS_ENERGY_LEDGER)
+
+#include <string.h>
+#include "rwip.h"
+#include "lld_evt.h"
+#include "reg_blecore.h"
+
+/// Longest time between two samples, in slots (1h). A longer one is dropped: the BLE
+/// timer has been off or has wrapped.
+#define ENERGY_MAX_GAP                  (3600UL * 1600)
+
+/// Interrupts of each wake reason, as bits of NVIC->ISPR
+#define ENERGY_IRQ(irq)                 (1UL << (irq))
+#define ENERGY_IRQ_KBD                  (ENERGY_IRQ(WKUP_QUADEC_IRQn) | ENERGY_IRQ(KEYBRD_IRQn))
+#define ENERGY_IRQ_UART                 (ENERGY_IRQ(UART_IRQn) | ENERGY_IRQ(UART2_IRQn))
+#define ENERGY_IRQ_I2C                  (ENERGY_IRQ(I2C_IRQn))
+#define ENERGY_IRQ_AUDIO                (ENERGY_IRQ(SWTIM_IRQn) | ENERGY_IRQ(SPI_IRQn) | ENERGY_IRQ(GPIO3_IRQn))
+
+/// Typical currents, in nA: the sleep modes of the datasheet, and the averages over an
+/// active period of the reference design (CPU at 16MHz, plus the radio for the BLE, the
+/// SPI and the encoder for the audio).
+const uint32_t app_energy_current[ENERGY_NB] =
+{
+    [ENERGY_DEEP_SLEEP] =       600,
+    [ENERGY_EXT_SLEEP]  =      1400,
+    [ENERGY_BLE]        =   3500000,
+    [ENERGY_KBD]        =   1800000,
+    [ENERGY_UART]       =   2000000,
+    [ENERGY_I2C]        =   2000000,
+    [ENERGY_AUDIO]      =   4500000,
+};
+
+struct app_energy_env_tag
+{
+    uint64_t us[ENERGY_NB];                         // time per bucket
+    uint32_t count[ENERGY_NB];
+    uint32_t last_slots;                            // BLE time of the last sample
+    uint32_t last_fine;                             // usec in the slot
+    uint32_t skip_us;                               // sleep charged since the last sample
+    uint32_t awake_us;                              // CPU awake while the BLE sleeps
+    uint8_t reasons;                                // wake reasons since the last sample, one bit per bucket
+    uint8_t sleep;                                  // deepest bucket + 1 slept in during the BLE sleep, 0 if none
+    bool started;                                   // last_slots is valid
+};
+
+static struct app_energy_env_tag app_energy_env __attribute__((section("retention_mem_area0"), zero_init));
+
+/**
+ ****************************************************************************************
+ * @brief Checks if the BLE timer can be read
+ *
+ * @return true, if the BLE core is powered and not sleeping or waking up
+ ****************************************************************************************
+ */
+static inline bool energy_ble_is_running(void)
+{
+    return (GetBits16(CLK_RADIO_REG, BLE_ENABLE) == 1) &&
+           (GetBits32(BLE_DEEPSLCNTL_REG, DEEP_SLEEP_STAT) == 0) &&
+           !(rwip_prevent_sleep_get() & RW_WAKE_UP_ONGOING);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Gets the bucket of the awake time of a sample
+ *
+ * @param[in] reasons       The wake reasons, one bit per bucket
+ *
+ * @return The highest ranked reason, ENERGY_BLE if none
+ ****************************************************************************************
+ */
+static int energy_reason(uint8_t reasons)
+{
+    int bucket;
+
+    for (bucket = ENERGY_NB - 1; bucket > ENERGY_BLE; bucket--) {
+        if (reasons & (1 << bucket)) {
+            break;
+        }
+    }
+    return bucket;
+}
+
+void app_energy_sample(void)
+{
+    uint32_t slots, fine;
+
+    if (!energy_ble_is_running()) {
+        return;
+    }
+
+    // The fine counter is sampled together with the base time. It counts down from 624.
+    slots = lld_evt_time_get();
+    fine = 624 - (ble_finetimecnt_get() & BLE_FINECNT_MASK);
+
+    if (app_energy_env.started) {
+        const uint32_t gap = (slots - app_energy_env.last_slots) & BLE_BASETIMECNT_MASK;
+
+        if (gap < ENERGY_MAX_GAP) {
+            const uint32_t elapsed = (gap * 625) + fine;
+            const uint32_t charged = app_energy_env.last_fine + app_energy_env.skip_us;
+
+            if (elapsed > charged) {
+                app_energy_env.us[energy_reason(app_energy_env.reasons)] += elapsed - charged;
+            }
+        }
+    }
+
+    app_energy_env.last_slots = slots;
+    app_energy_env.last_fine = fine;
+    app_energy_env.skip_us = 0;
+    app_energy_env.reasons = 0;
+    app_energy_env.started = true;
+}
+
+void app_energy_busy(int bucket)
+{
+    app_energy_env.reasons |= (1 << bucket);
+}
+
+void app_energy_sleep(sleep_mode_t sleep_mode)
+{
+    int bucket;
+
+    if (sleep_mode == mode_deep_sleep) {
+        bucket = ENERGY_DEEP_SLEEP;
+    } else if (sleep_mode == mode_ext_sleep) {
+        bucket = ENERGY_EXT_SLEEP;
+    } else {
+        return;
+    }
+
+    app_energy_env.count[bucket]++;
+    if (!app_energy_env.sleep || (app_energy_env.sleep > (bucket + 1))) {
+        app_energy_env.sleep = bucket + 1;
+    }
+}
+
+void app_energy_wakeup(void)
+{
+    const uint32_t pending = NVIC->ISPR[0];
+    uint8_t reasons = 0;
+    int bucket;
+
+    if ((pending & ENERGY_IRQ_KBD) || (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)) {
+        reasons |= (1 << ENERGY_KBD);
+    }
+    if (pending & ENERGY_IRQ_UART) {
+        reasons |= (1 << ENERGY_UART);
+    }
+    if (pending & ENERGY_IRQ_I2C) {
+        reasons |= (1 << ENERGY_I2C);
+    }
+    if (pending & ENERGY_IRQ_AUDIO) {
+        reasons |= (1 << ENERGY_AUDIO);
+    }
+    if (!reasons) {
+        reasons = (1 << ENERGY_BLE);
+    }
+
+    for (bucket = ENERGY_BLE; bucket < ENERGY_NB; bucket++) {
+        if (reasons & (1 << bucket)) {
+            app_energy_env.count[bucket]++;
+        }
+    }
+    app_energy_env.reasons |= reasons;
+}
+
+void app_energy_ble_slept(uint32_t dur_us)
+{
+    if (app_energy_env.sleep) {
+        const uint32_t ahead = lld_sleep_lpcycles_2_us_sel_func(GetBits32(BLE_ENBPRESET_REG, TWIRQ_SET));
+        const uint32_t awake = ahead + app_energy_env.awake_us;
+
+        if (dur_us > awake) {
+            app_energy_env.us[app_energy_env.sleep - 1] += dur_us - awake;
+            app_energy_env.skip_us += dur_us - awake;
+        }
+    }
+    app_energy_env.sleep = 0;
+    app_energy_env.awake_us = 0;
+}
+
+void app_energy_awake(uint32_t us)
+{
+    if (!energy_ble_is_running()) {
+        app_energy_env.awake_us += us;
+    }
+}
+
+void app_energy_get(int bucket, struct app_energy_entry *entry)
+{
+    uint64_t ms;
+
+    GLOBAL_INT_STOP();
+    ms = app_energy_env.us[bucket] / 1000;
+    entry->count = app_energy_env.count[bucket];
+    GLOBAL_INT_START();
+
+    // nA * ms = 1/3600000 nAh
+    entry->time_ms = (uint32_t)ms;
+    entry->charge_nah = (uint32_t)((ms * app_energy_current[bucket]) / 3600000);
+    entry->current_na = app_energy_current[bucket];
+}
+
+void app_energy_reset(void)
+{
+    GLOBAL_INT_STOP();
+    memset(&app_energy_env, 0, sizeof(app_energy_env));
+    GLOBAL_INT_START();
+}
+
+#endif // HAS_ENERGY_LEDGER
@@ -0,0 +1,195 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_energy.h
+ *
+ * @brief Energy ledger: time and charge per power state and per subsystem that kept the
+ *        system awake.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_ENERGY_H_
+#define APP_ENERGY_H_
+
+/*
+ ****************************************************************************************
+ * USAGE
+ * The ledger splits the time into buckets: the two sleep modes and one bucket per wake
+ * reason for the time the system is awake (running or waiting in WFI with the clocks on).
+ *
+ * Time base: the BLE timer (slots of 625us and the fine counter), which the BLE core
+ * advances on each wakeup by the sleep duration it measured with the low power clock.
+ * app_energy_sample() reads it from the main loop whenever the BLE core runs. The time
+ * between two samples is split into:
+ * - the CPU sleep, if the CPU entered extended or deep sleep (APP_ENERGY_SLEEP()): the
+ *   BLE sleep (APP_ENERGY_BLE_SLEPT(), from the sleep compensation) minus the time the
+ *   CPU was awake before the BLE, i.e. the TWIRQ_SET cycles of the wakeup and the
+ *   SysTick periods of the key scanning (APP_ENERGY_AWAKE()). It goes to the deepest
+ *   mode entered.
+ * - the awake time, the rest. It goes to the highest ranked wake reason seen since the
+ *   last sample (enum app_energy_bucket), or else to the BLE. The reasons are the
+ *   interrupts pending at each wakeup from a sleep (APP_ENERGY_WAKEUP()) and the
+ *   subsystems found busy by the main loop (app_energy_busy()), which also covers the
+ *   idle WFIs of the main loop while the audio streams.
+ * Work done while the BLE sleeps, other than the key scanning, is counted as sleep.
+ *
+ * The charge of a bucket is its time multiplied by its current in app_energy_current[].
+ * The currents are typical values and should be replaced by the ones measured on the
+ * product.
+ *
+ * The ledger is kept in the retention RAM and starts over after a reset or on request.
+ * It is read over the vendor Output report: byte 1 set to APP_ENERGY_CMD_READ sends one
+ * notification of the vendor Input report per bucket (app_stream_send_energy()),
+ * APP_ENERGY_CMD_RESET clears the ledger.
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "arch.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Commands in byte 1 of the vendor Output report
+#define APP_ENERGY_CMD_READ             (7)
+#define APP_ENERGY_CMD_RESET            (8)
+
+/// TYPE of message of the ledger notifications
+#define APP_ENERGY_MSG_TYPE             (5)
+
+/// Buckets. The awake buckets are wake reasons, the lowest ranked first.
+enum app_energy_bucket
+{
+    ENERGY_DEEP_SLEEP,
+    ENERGY_EXT_SLEEP,
+    ENERGY_BLE,                         ///< BLE events, and the time no other reason claims
+    ENERGY_KBD,                         ///< key scanning, wakeup controller (keys, wheel)
+    ENERGY_UART,
+    ENERGY_I2C,
+    ENERGY_AUDIO,                       ///< audio sample timer and codec SPI
+    ENERGY_NB
+};
+
+/// A bucket of the ledger
+struct app_energy_entry
+{
+    uint32_t time_ms;                   ///< time spent
+    uint32_t charge_nah;                ///< charge drawn, in nAh
+    uint32_t current_na;                ///< current of the bucket, in nA
+    uint32_t count;                     ///< sleeps, or wakeups for the reason
+};
+
+/// Current of each bucket, in nA
+extern const uint32_t app_energy_current[ENERGY_NB];
+
+/*
+ * HOOKS
+ ****************************************************************************************
+ */
+
+#if (HAS_ENERGY_LEDGER)
+#define APP_ENERGY_SLEEP(mode)          app_energy_sleep(mode)
+#define APP_ENERGY_WAKEUP()             app_energy_wakeup()
+#define APP_ENERGY_BLE_SLEPT(us)        app_energy_ble_slept(us)
+#define APP_ENERGY_AWAKE(us)            app_energy_awake(us)
+#else
+#define APP_ENERGY_SLEEP(mode)
+#define APP_ENERGY_WAKEUP()
+#define APP_ENERGY_BLE_SLEPT(us)
+#define APP_ENERGY_AWAKE(us)
+#endif
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Charges the time since the last sample, if the BLE timer can be read. Called
+ *        from the main loop before the sleep decision, with the interrupts disabled.
+ ****************************************************************************************
+ */
+void app_energy_sample(void);
+
+/**
+ ****************************************************************************************
+ * @brief Marks a subsystem as busy since the last sample, so the awake time of the
+ *        sample goes to it if no higher ranked one was busy too.
+ *
+ * @param[in] bucket        enum app_energy_bucket, ENERGY_BLE or above
+ ****************************************************************************************
+ */
+void app_energy_busy(int bucket);
+
+/**
+ ****************************************************************************************
+ * @brief Called just before the CPU sleeps.
+ *
+ * @param[in] sleep_mode    The sleep mode, only extended and deep sleep are counted
+ ****************************************************************************************
+ */
+void app_energy_sleep(sleep_mode_t sleep_mode);
+
+/**
+ ****************************************************************************************
+ * @brief Called just after a WFI, before the interrupts are enabled. Records the
+ *        interrupts that woke the CPU up as wake reasons.
+ ****************************************************************************************
+ */
+void app_energy_wakeup(void);
+
+/**
+ ****************************************************************************************
+ * @brief Called when the BLE core wakes up, from the sleep compensation.
+ *
+ * @param[in] dur_us        The duration of the BLE sleep, measured with the low power
+ *                          clock
+ ****************************************************************************************
+ */
+void app_energy_ble_slept(uint32_t dur_us);
+
+/**
+ ****************************************************************************************
+ * @brief Counts time the CPU was awake while the BLE core slept. Called from interrupt
+ *        context; ignored while the BLE core runs (the BLE timer counts it).
+ *
+ * @param[in] us            The time
+ ****************************************************************************************
+ */
+void app_energy_awake(uint32_t us);
+
+/**
+ ****************************************************************************************
+ * @brief Reads a bucket.
+ *
+ * @param[in]  bucket       enum app_energy_bucket
+ * @param[out] entry        The time, charge and count of the bucket
+ ****************************************************************************************
+ */
+void app_energy_get(int bucket, struct app_energy_entry *entry);
+
+/**
+ ****************************************************************************************
+ * @brief Clears the ledger.
+ ****************************************************************************************
+ */
+void app_energy_reset(void);
+
+#endif // APP_ENERGY_H_
@@ -0,0 +1,24 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_event.c
+ *
+ * @brief Application events of the main loop.
+ *
+ * Copyright (C) 2014. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#include "app_event.h"
+
+volatile uint32_t app_event_field __attribute__((section("retention_mem_area0"), zero_init));
+
+#if (LOG_APP_EVENT_STATS)
+struct app_event_stats_tag app_event_stats;
+#endif
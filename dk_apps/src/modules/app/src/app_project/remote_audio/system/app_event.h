@@ -0,0 +1,168 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_event.h
+ *
+ * @brief Application events of the main loop.
+ *
+ * Interrupt handlers and application code set an event when a handler of the main loop
+ * has work to do. The asynchronous hooks (app_sleep.h) run only the handlers of the
+ * pending events, so that a pass of the main loop without pending events reaches the
+ * sleep decision directly.
+ *
+ * Copyright (C) 2014. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_EVENT_H_
+#define APP_EVENT_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "arch.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Application events, in the order they are handled
+enum app_event_type
+{
+    APP_EVENT_KBD_SCAN = 0,     ///< wkup_hit or systick_hit: run the key scanning FSM
+    APP_EVENT_DELAYED_START,    ///< delayed start trigger from the wakeup handler
+    APP_EVENT_LINK_QUALITY,     ///< the state of the link quality monitor has changed
+    APP_EVENT_BLE_WAKEUP,       ///< data (keys, wheel, motion, voice) may require waking up the BLE
+    APP_EVENT_TRM,              ///< prepare and send reports when the BLE is running
+    APP_EVENT_AUDIO,            ///< audio samples are ready to be encoded
+    APP_EVENT_STREAM,           ///< end of BLE event or Tx: queue more stream data
+    APP_EVENT_MAX
+};
+
+#define APP_EVENT_BIT(event_type)   (1UL << (event_type))
+
+#if (LOG_APP_EVENT_STATS)
+/// Main loop statistics, read with the debugger
+struct app_event_stats_tag
+{
+    uint32_t loops;                             ///< passes of the main loop that reached the sleep decision
+    uint32_t idle_loops;                        ///< of them, passes without a pending event
+    uint32_t dispatched[APP_EVENT_MAX];         ///< handler calls per event
+    uint32_t forced_wakeups;                    ///< BLE woken up before its next connection event for pending data
+    uint32_t idle_wfi;                          ///< CPU halted until the next interrupt with the BLE core up
+};
+
+extern struct app_event_stats_tag app_event_stats;
+
+#define APP_EVENT_STATS_DISPATCH(event_type)    (app_event_stats.dispatched[event_type]++)
+#define APP_EVENT_STATS_FORCED_WAKEUP()         (app_event_stats.forced_wakeups++)
+#define APP_EVENT_STATS_IDLE_WFI()              (app_event_stats.idle_wfi++)
+#define APP_EVENT_STATS_LOOP()                                              \
+    {                                                                       \
+        app_event_stats.loops++;                                            \
+        if (app_event_field == 0) {                                         \
+            app_event_stats.idle_loops++;                                   \
+        }                                                                   \
+    }
+#else
+#define APP_EVENT_STATS_DISPATCH(event_type)
+#define APP_EVENT_STATS_FORCED_WAKEUP()
+#define APP_EVENT_STATS_IDLE_WFI()
+#define APP_EVENT_STATS_LOOP()
+#endif
+
+/*
+ * GLOBAL VARIABLE DECLARATION
+ ****************************************************************************************
+ */
+
+extern volatile uint32_t app_event_field;
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Sets an event. May be called from interrupt context.
+ *
+ * @param[in] event_type    Event to be set.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+__INLINE void app_event_set(uint8_t event_type)
+{
+    GLOBAL_INT_DISABLE();
+    app_event_field |= APP_EVENT_BIT(event_type);
+    GLOBAL_INT_RESTORE();
+}
+
+/**
+ ****************************************************************************************
+ * @brief Clears an event. May be called from interrupt context.
+ *
+ * @param[in] event_type    Event to be cleared.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+__INLINE void app_event_clear(uint8_t event_type)
+{
+    GLOBAL_INT_DISABLE();
+    app_event_field &= ~APP_EVENT_BIT(event_type);
+    GLOBAL_INT_RESTORE();
+}
+
+/**
+ ****************************************************************************************
+ * @brief Gets the status of an event and clears it. A handler that finds more work
+ *        than it can do in one call sets its event again.
+ *
+ * @param[in] event_type    Event to get.
+ *
+ * @return true, if the event was set
+ ****************************************************************************************
+ */
+__INLINE bool app_event_take(uint8_t event_type)
+{
+    bool ret;
+
+    GLOBAL_INT_DISABLE();
+    ret = (app_event_field & APP_EVENT_BIT(event_type)) != 0;
+    app_event_field &= ~APP_EVENT_BIT(event_type);
+    GLOBAL_INT_RESTORE();
+
+    if (ret) {
+        APP_EVENT_STATS_DISPATCH(event_type);
+    }
+    return ret;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Gets the status of an event
+ *
+ * @param[in] event_type    Event to get.
+ *
+ * @return true, if the event is set
+ ****************************************************************************************
+ */
+__INLINE bool app_event_get(uint8_t event_type)
+{
+    return (app_event_field & APP_EVENT_BIT(event_type)) != 0;
+}
+
+#endif // APP_EVENT_H_
@@ -23,6 +23,7 @@
 
 #include "app_kbd_scan_fsm.h"
 #include "app_kbd.h"
+#include "app_kbd_proj.h"
 
 #if (USE_CONNECTION_FSM)
 #include "app_con_fsm.h"
@@ -37,6 +38,26 @@
 extern bool user_motion_keys_pressed;
 extern char state_bmi_pressed, state_bmi_released;
 #endif
+
+#if (HAS_QUADEC_WHEEL)
+#include "app_wheel.h"
+#endif
+
+#if (HAS_I2C_ASYNC)
+#include "i2c_async.h"
+#endif
+
+#if (HAS_SPI_FLASH_ASYNC)
+#include "app_flash_async.h"
+#endif
+
+#ifdef WLAN_COEX_ENABLED
+#include "wlan_coex.h"
+#endif
+
+#include "app_kbd_trace.h"
+#include "app_event.h"
+#include "app_energy.h"
 /*
  ******************************** Locals ***********************************
  */
@@ -70,12 +91,17 @@ static void delayed_start_proc(void)
             
             ble_is_woken_up = true;
         }
+
+        if ( (trigger_kbd_delayed_start_st == PRESSED_TRIGGER) || (trigger_kbd_delayed_start_st == RELEASED_TRIGGER) ) {
+            app_event_set(APP_EVENT_DELAYED_START);     // retry when the BLE has handled the previous trigger
+        }
     }
 }
 
 #if (HAS_AUDIO)
+#include "app_audio439.h"
+
 extern char stop_when_buffer_empty;
-void app_audio439_stop (void);
 #endif
 
 /*
@@ -97,6 +123,12 @@ static inline bool app_asynch_trm(void)
 	bool ret = false;
 
 	do {
+        // Runs after a BLE event, after kernel messages or timers have been handled and
+        // when keys have been buffered.
+        if (!app_event_take(APP_EVENT_TRM)) {
+            break;
+        }
+
         // Synchronize with the BLE here! The time window of requesting a packet trm at the upcoming
         // anchor point is from the CSCNT event until the FINEGTIM event. If you pass the FINEGTIM
         // event then the packet will be sent at the next anchor point!
@@ -147,6 +179,14 @@ static inline bool app_asynch_trm(void)
         }
 #endif       
 
+#if (HAS_QUADEC_WHEEL)
+        app_wheel_send_report();
+#endif
+
+#if (HAS_ENERGY_LEDGER)
+        app_stream_send_energy_more();
+#endif
+
         if ( !ke_event_get(KE_EVENT_KE_MESSAGE) ) {
             // Since pkt reqs can be silently discarded if no Tx bufs are available, check first!
             if (kbd_trm_list && app_kbd_check_conn_status() && l2cm_get_nb_buffer_available()) {
@@ -156,6 +196,7 @@ static inline bool app_asynch_trm(void)
                     // prepared because of unread data in the keycode_buffer now that the free list is not NULL.
                     app_kbd_prepare_keyreports();
                     
+                    app_event_set(APP_EVENT_TRM);   // more reports may be waiting
                     ret = true;
                     break;
                 }
@@ -166,6 +207,28 @@ static inline bool app_asynch_trm(void)
 	return ret;
 }
 
+/**
+ ****************************************************************************************
+ * @brief Checks if the application has data for the host that the BLE has not taken yet:
+ *        key reports, stream packets (voice, motion) or wheel reports.
+ *
+ * While nothing is pending, the BLE sleeps through the connection events skipped by the
+ * slave latency. Else it is woken up, so the data goes out at the next connection event
+ * instead of the next one the slave has to listen to.
+ *
+ * @return  true, if data is pending
+ ****************************************************************************************
+ */
+static inline bool app_tx_pending(void)
+{
+    return app_kbd_buffer_has_data() || (kbd_trm_list != NULL) ||
+           (app_stream_env.fifo_size > 0) ||
+#if (HAS_QUADEC_WHEEL)
+           app_wheel_wakeup_pending() ||
+#endif
+           false;
+}
+
 /**
  ****************************************************************************************
  * @brief HOOK #2 - See documentation (UM-B-006 : User Manual - Sleep mode configuration)
@@ -181,7 +244,21 @@ static inline bool app_asynch_proc(void)
 	bool ret = false;
 
 	do {
-		fsm_scan_update();
+        if (app_event_take(APP_EVENT_KBD_SCAN)) {
+            fsm_scan_update();
+        }
+
+        if (app_event_take(APP_EVENT_LINK_QUALITY)) {
+            app_link_quality_func();
+        }
+
+        if (!app_event_take(APP_EVENT_BLE_WAKEUP)) {
+            break;
+        }
+
+#ifdef WLAN_COEX_ENABLED
+        wlan_coex_urgency_set(WLAN_COEX_URG_KEY, app_kbd_buffer_has_data() || (kbd_trm_list != NULL));
+#endif
 
 #if (HAS_BMI055)
         if (((user_motion_keys_pressed == true) && 
@@ -195,20 +272,43 @@ static inline bool app_asynch_proc(void)
             ret = app_ble_force_wakeup();
         }
 #endif
-        if  ( app_kbd_buffer_has_data() && 
+#if (HAS_QUADEC_WHEEL)
+        if (app_wheel_wakeup_pending() &&
+            (GetBits16(CLK_RADIO_REG, BLE_ENABLE) == 0)) {
+            // If BLE is sleeping, wake it up to start the wheel idle timer!
+            ret = app_ble_force_wakeup();
+        }
+#endif
+        if  ( app_tx_pending() && 
             (app_con_fsm_get_state() == CONNECTED_ST) &&
             (GetBits16(CLK_RADIO_REG, BLE_ENABLE) == 0)) {
-            // If BLE is sleeping, wake it up!
+            // If BLE is sleeping, wake it up for the next connection event!
             ret = app_ble_force_wakeup();
+            APP_EVENT_STATS_FORCED_WAKEUP();
         }
-        
-        if (HAS_DELAYED_WAKEUP) {
-            delayed_start_proc();
+
+        // Check again in the next pass while data is waiting for the BLE
+        if (app_tx_pending() ||
+#if (HAS_BMI055)
+            user_motion_keys_pressed || (state_bmi_released == 0) ||
+#endif
+            false) {
+            app_event_set(APP_EVENT_BLE_WAKEUP);
         }
-        
-        
  	} while(0);
 
+#if (HAS_SPI_FLASH_ASYNC)
+    if (app_flash_async_poll()) {
+        ret = true;                             // a page is being programmed, check it in the next pass
+    }
+#endif
+
+    if (HAS_DELAYED_WAKEUP) {
+        if (app_event_take(APP_EVENT_DELAYED_START)) {
+            delayed_start_proc();
+        }
+    }
+
 	return ret;
 }
 
@@ -223,12 +323,39 @@ static inline bool app_asynch_proc(void)
  */
 static inline void app_asynch_sleep_proc(void)
 {
-    if (wkup_hit) { // make sure we do not miss any wake up interrupts!
+    APP_EVENT_STATS_LOOP();
+
+    if (app_event_take(APP_EVENT_KBD_SCAN)) { // make sure we do not miss any wake up interrupts!
         fsm_scan_update();
     }
 
+#if (HAS_KBD_LATENCY_TRACE)
+    if (current_scan_state == KEY_SCAN_IDLE) {
+        app_kbd_trace_export();     // the UART output would disturb the timing of the scanning
+    }
+#endif
+
+#if (HAS_ENERGY_LEDGER)
+    if ((current_scan_state == KEY_STATUS_UPD) || (current_scan_state == KEY_SCANNING)) {
+        app_energy_busy(ENERGY_KBD);
+    }
+#if (HAS_I2C_ASYNC)
+    if (i2c_async_is_busy()) {
+        app_energy_busy(ENERGY_I2C);
+    }
+#endif
+#if (HAS_AUDIO)
+    if (app_audio439_timer_started) {
+        app_energy_busy(ENERGY_AUDIO);      // the CPU idles between the samples, without waking up from a sleep
+    }
+#endif
+    app_energy_sample();
+#endif
+
     if (HAS_DELAYED_WAKEUP) {
-        delayed_start_proc();
+        if (app_event_take(APP_EVENT_DELAYED_START)) {
+            delayed_start_proc();
+        }
     }
     
     if (HAS_KEYBOARD_MEASURE_EXT_SLP) {
@@ -261,6 +388,27 @@ static inline void app_asynch_sleep_proc(void)
     } 
 }
 
+/**
+ ****************************************************************************************
+ * @brief Checks if the CPU can be halted until the next interrupt while the BLE core
+ *        stays up (HAS_BLE_SLEEP is 0). Called with the interrupts disabled, after
+ *        app_asynch_sleep_proc(), so an event set by an ISR since its handler ran is
+ *        not missed.
+ *
+ * @return true, if no kernel event and no application event is pending
+ ****************************************************************************************
+ */
+static inline bool app_asynch_idle_check(void)
+{
+    // APP_EVENT_BLE_WAKEUP stays set while data waits for a sleeping BLE core. It does
+    // not sleep in this mode, so the event needs no pass of the main loop.
+    if (!ke_sleep_check() || (app_event_field & ~APP_EVENT_BIT(APP_EVENT_BLE_WAKEUP))) {
+        return false;
+    }
+    APP_EVENT_STATS_IDLE_WFI();
+    return true;
+}
+
 
 /**
  ****************************************************************************************
@@ -276,6 +424,21 @@ static inline void app_sleep_prepare_proc(sleep_mode_t *sleep_mode)
     if ( (current_scan_state == KEY_STATUS_UPD) || (current_scan_state == KEY_SCANNING) )  {
         *sleep_mode = mode_idle;                // block power-off
     }
+#if (HAS_QUADEC_WHEEL)
+    if (app_wheel_is_active()) {
+        *sleep_mode = mode_idle;                // keep the Quadrature Decoder powered
+    }
+#endif
+#if (HAS_I2C_ASYNC)
+    if (i2c_async_is_busy()) {
+        *sleep_mode = mode_idle;                // keep the I2C controller powered
+    }
+#endif
+#if (HAS_SPI_FLASH_ASYNC)
+    if (app_flash_async_is_busy() && (*sleep_mode == mode_deep_sleep)) {
+        *sleep_mode = mode_ext_sleep;           // the queue is in SysRAM
+    }
+#endif
 }
 
 
@@ -290,6 +453,13 @@ static inline void app_sleep_prepare_proc(sleep_mode_t *sleep_mode)
  */
 static inline void app_sleep_entry_proc(sleep_mode_t *sleep_mode)
 {
+    APP_ENERGY_SLEEP(*sleep_mode);
+
+#if (HAS_I2C_ASYNC)
+    if (i2c_async_is_busy()) {
+        return;                                 // the I2C bit rate depends on the peripheral clock
+    }
+#endif
     if ( *sleep_mode == mode_idle && !HAS_PRINTF)  {
         /*
         * Use a lower clock to preserve power (i.e. 2MHz)
@@ -310,6 +480,8 @@ static inline void app_sleep_entry_proc(sleep_mode_t *sleep_mode)
  */
 static inline void app_sleep_exit_proc(sleep_mode_t sleep_mode)
 {
+    APP_ENERGY_WAKEUP();                        // the interrupts are still disabled, the wakeup ones are pending
+
     /*
      * Restore clock
      */
@@ -38,6 +38,14 @@
 #include "app_flash.h"
 #endif
 
+#if (HAS_QUADEC_WHEEL)
+#include "app_wheel.h"
+#endif
+
+#if (HAS_SPI_FLASH_ASYNC)
+#include "app_flash_async.h"
+#endif
+
 /*
  * FUNCTION DEFINITIONS
  ****************************************************************************************
@@ -74,7 +82,13 @@ void GPIO_reservations(void)
      */    
     declare_keyboard_gpios();
     declare_audio439_gpios();
+#if (HAS_QUADEC_WHEEL)
+    declare_wheel_gpios();
+#endif
     //DECLARE_I2C_GPIOS;
+#if (HAS_MOTION_INT_PIN)
+    RESERVE_GPIO( MOTION_INT, MOTION_INT_PORT, MOTION_INT_PIN, PID_GPIO);
+#endif
     DECLARE_SPI_GPIOS;
     
 #endif // FPGA_USED
@@ -101,6 +115,14 @@ void set_pad_functions(void)
 #endif // PROGRAM_ENABLE_UART
 
     //INIT_I2C_GPIOS;
+#if (HAS_MOTION_INT_PIN)
+    GPIO_ConfigurePin( MOTION_INT_PORT, MOTION_INT_PIN, INPUT_PULLDOWN, PID_GPIO, false );
+#endif
+#if (HAS_SPI_FLASH_ASYNC)
+    if (app_flash_async_is_busy()) {
+        park_spi_flash_gpios();                 // an erase may be in progress
+    } else
+#endif
     deactivate_spi_flash_gpios();
     
 #if (HAS_AUDIO)
@@ -128,6 +150,10 @@ void set_pad_functions(void)
     if (current_scan_state == KEY_SCAN_IDLE) {
 		app_kbd_reinit_matrix(); 
     }
+
+#if (HAS_QUADEC_WHEEL)
+    app_wheel_init_gpios();
+#endif
 #else   //FPGA_USED
 
     RESERVE_GPIO( UART1_TX, GPIO_PORT_0,  GPIO_PIN_0, PID_UART1_TX);
@@ -50,6 +50,10 @@
 /****************************************************************************************/ 
 #define WKUP_ENABLED
 
+#if (HAS_QUADEC_WHEEL)
+#define QUADEC_ENABLED
+#endif
+
 /*
  * FUNCTION DECLARATIONS
  ****************************************************************************************
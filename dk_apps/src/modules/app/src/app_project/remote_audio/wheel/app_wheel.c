@@ -0,0 +1,257 @@
+ /**
+ ****************************************************************************************
+ *
+ * @file app_wheel.c
+ *
+ * @brief Scroll wheel (Quadrature Decoder) application.
+ *
+ * The Quadrature Decoder is in the peripheral power domain, which is off during
+ * Extended and Deep sleep. While the wheel is idle its pins are handed to the Wakeup
+ * Controller (together with the key matrix inputs). The wakeup powers up the decoder,
+ * which then counts in hardware while the system is kept out of sleep. The counter is
+ * read once per connection event and the movement since the previous event is sent
+ * in a single Mouse report. The decoder is powered down WHEEL_IDLE_TIMEOUT after the
+ * last movement.
+ *
+ * The detent that causes the wakeup is not counted.
+ *
+ * Copyright (C) 2014. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#if (HAS_QUADEC_WHEEL)
+
+#include "app_api.h"
+#include "app_event.h"
+#include "app_wheel.h"
+#include "app_kbd.h"
+#include "app_kbd_scan_fsm.h"
+#include "app_con_fsm.h"
+#include "hogpd_task.h"
+#include "l2cm.h"
+#include "wkupct_quadec.h"
+
+extern bool conn_upd_pending;
+
+static bool wheel_active                __attribute__((section("retention_mem_area0"), zero_init));
+static volatile bool wheel_wkup_hit     __attribute__((section("retention_mem_area0"), zero_init));
+static bool wheel_moved                 __attribute__((section("retention_mem_area0"), zero_init));
+static int16_t wheel_last_cnt           __attribute__((section("retention_mem_area0"), zero_init));
+static int16_t wheel_delta              __attribute__((section("retention_mem_area0"), zero_init));
+
+/**
+ ****************************************************************************************
+ * @brief Adds a wheel pin to the Wakeup Controller
+ *
+ * @param port  The GPIO port
+ * @param pin   The GPIO pin
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_wheel_arm_pin(GPIO_PORT port, GPIO_PIN pin)
+{
+    const uint32_t sel_reg = WKUP_SELECT_P0_REG + (2 * port);
+    const uint32_t pol_reg = WKUP_POL_P0_REG + (2 * port);
+
+    if (GPIO_GetPinStatus(port, pin)) {
+        SetWord16(pol_reg, GetWord16(pol_reg) | (1 << pin));    // high: generate INT when input goes low
+    } else {
+        SetWord16(pol_reg, GetWord16(pol_reg) & ~(1 << pin));   // low: generate INT when input goes high
+    }
+    SetWord16(sel_reg, GetWord16(sel_reg) | (1 << pin));
+}
+
+/**
+ ****************************************************************************************
+ * @brief Adds the movement counted by the Quadrature Decoder since the last call
+ *        to wheel_delta
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_wheel_poll(void)
+{
+    int16_t cnt = quad_decoder_get_x_counter();
+    int16_t diff = cnt - wheel_last_cnt;
+
+    if (diff) {
+        wheel_last_cnt = cnt;
+        wheel_delta += diff;
+        wheel_moved = true;
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Powers down the Quadrature Decoder and gives the wheel pins back to the
+ *        Wakeup Controller
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_wheel_power_down(void)
+{
+    // quad_decoder_release() would also disable the WKUP_QUADEC_IRQn, which is still
+    // used by the keyboard. Only switch off the decoder.
+    SetWord16(QDEC_CTRL2_REG, QUAD_DEC_CHXA_NONE_AND_CHXB_NONE | QUAD_DEC_CHYA_NONE_AND_CHYB_NONE | QUAD_DEC_CHZA_NONE_AND_CHZB_NONE);
+    SetBits16(CLK_PER_REG, QUAD_ENABLE, 0);
+
+    GLOBAL_INT_DISABLE();
+    wheel_active = false;
+    wheel_delta = 0;
+
+    // If the keyboard is scanning, the pins are added when the Wakeup Controller
+    // is re-programmed at the end of the scan. The delayed start monitor uses its
+    // own setup of the Wakeup Controller.
+    if ( (current_scan_state == KEY_SCAN_IDLE) && !(HAS_DELAYED_WAKEUP && (app_con_fsm_get_state() == IDLE_ST)) ) {
+        app_wheel_arm_wakeup();
+    }
+    GLOBAL_INT_RESTORE();
+}
+
+/**
+ ****************************************************************************************
+ * @brief Powers up the Quadrature Decoder on the wheel pins and takes its counter as
+ *        the base of the movement
+ *
+ * @return void
+ ****************************************************************************************
+ */
+static void app_wheel_decoder_init(void)
+{
+    QUAD_DEC_INIT_PARAMS_t params;
+
+    app_wheel_init_gpios();
+
+    params.chx_port_sel = WHEEL_QUADEC_CHX;
+    params.chy_port_sel = QUAD_DEC_CHYA_NONE_AND_CHYB_NONE;
+    params.chz_port_sel = QUAD_DEC_CHZA_NONE_AND_CHZB_NONE;
+    params.qdec_clockdiv = WHEEL_QUADEC_CLOCKDIV;
+    params.qdec_events_count_to_trigger_interrupt = 0;  // the counter is polled, no IRQ is used
+    quad_decoder_init(&params);
+
+    wheel_last_cnt = quad_decoder_get_x_counter();
+}
+
+
+void app_wheel_init(void)
+{
+    wheel_active = false;
+    wheel_wkup_hit = false;
+    wheel_moved = false;
+    wheel_delta = 0;
+
+    app_wheel_init_gpios();
+}
+
+
+void app_wheel_init_gpios(void)
+{
+    GPIO_ConfigurePin((GPIO_PORT)WHEEL_A_PORT, (GPIO_PIN)WHEEL_A_PIN, INPUT_PULLUP, PID_GPIO, false);
+    GPIO_ConfigurePin((GPIO_PORT)WHEEL_B_PORT, (GPIO_PIN)WHEEL_B_PIN, INPUT_PULLUP, PID_GPIO, false);
+}
+
+
+void app_wheel_wakeup(void)
+{
+    if (!wheel_active) {
+        app_wheel_decoder_init();
+        wheel_active = true;
+        wheel_wkup_hit = true;
+        app_event_set(APP_EVENT_TRM);
+        app_event_set(APP_EVENT_BLE_WAKEUP);
+    }
+}
+
+
+void app_wheel_arm_wakeup(void)
+{
+    if (!wheel_active) {
+        app_wheel_arm_pin((GPIO_PORT)WHEEL_A_PORT, (GPIO_PIN)WHEEL_A_PIN);
+        app_wheel_arm_pin((GPIO_PORT)WHEEL_B_PORT, (GPIO_PIN)WHEEL_B_PIN);
+    }
+}
+
+
+bool app_wheel_wakeup_pending(void)
+{
+    return wheel_wkup_hit;
+}
+
+
+void app_wheel_send_report(void)
+{
+    if (!wheel_active) {
+        return;
+    }
+
+    if (wheel_wkup_hit) {
+        wheel_wkup_hit = false;
+        wheel_moved = false;
+        app_timer_set(APP_WHEEL_TIMER, TASK_APP, WHEEL_IDLE_TIMEOUT);
+    }
+
+    app_wheel_poll();
+
+    if (wheel_cpt_event == 0) {
+        return;
+    }
+    wheel_cpt_event = 0;
+
+    if (wheel_delta == 0) {
+        return;
+    }
+
+    if (!app_kbd_check_conn_status()) {
+        wheel_delta = 0;    // do not report old movement after (re)connection
+        return;
+    }
+
+    // Since pkt reqs can be silently discarded if no Tx bufs are available, check first!
+    // Otherwise the movement is kept and sent at the next connection event.
+    if (!conn_upd_pending && l2cm_get_nb_buffer_available()) {
+        int16_t wheel = wheel_delta;
+
+        if (wheel > 127) {
+            wheel = 127;
+        } else if (wheel < -127) {
+            wheel = -127;
+        }
+        app_mouse_send_report(0, 0, 0, (int8_t)wheel);
+        wheel_delta -= wheel;
+    }
+}
+
+
+bool app_wheel_is_active(void)
+{
+    return wheel_active;
+}
+
+
+int app_wheel_timer_handler(ke_msg_id_t const msgid,
+                            void const *param,
+                            ke_task_id_t const dest_id,
+                            ke_task_id_t const src_id)
+{
+    if (wheel_active) {
+        app_wheel_poll();
+
+        if (wheel_moved) {
+            wheel_moved = false;
+            app_timer_set(APP_WHEEL_TIMER, TASK_APP, WHEEL_IDLE_TIMEOUT);
+        } else {
+            app_wheel_power_down();
+        }
+    }
+    return (KE_MSG_CONSUMED);
+}
+
+#endif // HAS_QUADEC_WHEEL
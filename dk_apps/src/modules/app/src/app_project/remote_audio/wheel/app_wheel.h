@@ -0,0 +1,153 @@
+ /**
+ ****************************************************************************************
+ *
+ * @file app_wheel.h
+ *
+ * @brief Scroll wheel (Quadrature Decoder) application.
+ *
+ * Copyright (C) 2014. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_WHEEL_H_
+#define APP_WHEEL_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ke_msg.h"
+#include "gpio.h"
+#include "app_mouse.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+// Time (in 10ms) the Quadrature Decoder stays powered after the last wheel movement
+#define WHEEL_IDLE_TIMEOUT          (50)
+
+// Quadrature Decoder sampling clock divider
+#define WHEEL_QUADEC_CLOCKDIV       (0)
+
+/*
+ * GLOBAL VARIABLE DECLARATION
+ ****************************************************************************************
+ */
+
+extern unsigned volatile char wheel_cpt_event;    // set by the BLE event end ISR
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Initializes the wheel. The Quadrature Decoder is off until the wheel wakes
+ *        up the system.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+void app_wheel_init(void);
+
+/**
+ ****************************************************************************************
+ * @brief Configures the wheel pins (input, pull-up). Must be called after the
+ *        peripheral power domain is powered up.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+void app_wheel_init_gpios(void);
+
+/**
+ * \brief Reserve GPIO pins for wheel usage
+ */
+__INLINE void declare_wheel_gpios(void)
+{
+    RESERVE_GPIO( WHEEL_A,        WHEEL_A_PORT,       WHEEL_A_PIN,        PID_GPIO);
+    RESERVE_GPIO( WHEEL_B,        WHEEL_B_PORT,       WHEEL_B_PIN,        PID_GPIO);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Called from the Wakeup Controller handler. Powers up the Quadrature Decoder.
+ *        Runs in interrupt context.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+void app_wheel_wakeup(void);
+
+/**
+ ****************************************************************************************
+ * @brief Adds the wheel pins to the Wakeup Controller, if the wheel is idle.
+ *        The polarity of each pin is set to the opposite of its current level so
+ *        that any movement, from any detent position, triggers the wakeup.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+void app_wheel_arm_wakeup(void);
+
+/**
+ ****************************************************************************************
+ * @brief Checks if the wheel has woken up the system and the idle timer is not
+ *        running yet. The timer is started from app_wheel_send_report() once the
+ *        BLE is awake.
+ *
+ * @return true, if the BLE must be woken up
+ ****************************************************************************************
+ */
+bool app_wheel_wakeup_pending(void);
+
+/**
+ ****************************************************************************************
+ * @brief Accumulates the wheel movement and, once per connection event, sends it
+ *        in one Mouse report. Called when the BLE is awake.
+ *
+ * @return void
+ ****************************************************************************************
+ */
+void app_wheel_send_report(void);
+
+/**
+ ****************************************************************************************
+ * @brief Checks if the Quadrature Decoder is powered and counting
+ *
+ * @return true, if the system must not enter Extended or Deep sleep
+ ****************************************************************************************
+ */
+bool app_wheel_is_active(void);
+
+/**
+ ****************************************************************************************
+ * @brief Handler of the APP_WHEEL_TIMER. Powers down the Quadrature Decoder if the
+ *        wheel has not moved since the previous expiration.
+ *
+ * @param msgid     Id of the message received.
+ * @param param     Pointer to the parameters of the message.
+ * @param dest_id   ID of the receiving task instance (TASK_APP).
+ * @param src_id    ID of the sending task instance.
+ *
+ * @return If the message was consumed or not.
+ ****************************************************************************************
+ */
+int app_wheel_timer_handler(ke_msg_id_t const msgid,
+                            void const *param,
+                            ke_task_id_t const dest_id,
+                            ke_task_id_t const src_id);
+
+#endif // APP_WHEEL_H_
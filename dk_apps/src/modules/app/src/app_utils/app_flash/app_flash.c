@@ -31,19 +31,42 @@
 #include "spi_flash.h"
 #include "app_utils.h"
 
+#if (HAS_SPI_FLASH_ASYNC)
+#include "app_flash_async.h"
+#endif
+
 #ifdef HAS_SPI_FLASH_STORAGE
 
 bool power_up_delay;
 
 /**
  ****************************************************************************************
- * @brief Initializes the flash pins and the SPI interface
+ * @brief Sets the flash pins and the SPI interface up, for a flash that is powered.
+ *        The state of the flash driver, and its read cache, are kept.
  *
  * @return      void
  ****************************************************************************************
  */
 SPI_Pad_t spi_FLASH_CS_Pad;
-void app_spi_flash_peripheral_init(void)
+void app_spi_flash_peripheral_resume(void)
+{
+    activate_spi_flash_gpios();
+        
+	spi_FLASH_CS_Pad.pin =  FLASH_SPI_CS_PIN;
+    spi_FLASH_CS_Pad.port = FLASH_SPI_CS_PORT;
+    // Enable SPI
+    spi_init(&spi_FLASH_CS_Pad, SPI_MODE_8BIT, SPI_ROLE_MASTER, SPI_CLK_IDLE_POL_LOW,
+             SPI_PHA_MODE_0, SPI_MINT_DISABLE, SPI_XTAL_DIV_14);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Powers the flash up and initializes the flash pins and the SPI interface
+ *
+ * @return      void
+ ****************************************************************************************
+ */
+void app_spi_flash_power_up(void)
 {
 #ifdef HAS_FLASH_SPI_POWER_DOWN
     // power_up_delay is used to delay the first write operation
@@ -53,14 +76,8 @@ void app_spi_flash_peripheral_init(void)
 
     //Initialize the SPI interface and power up the SPI flash if needed
     //in case it is shared with another device on different pins.
-    activate_spi_flash_gpios();
-        
-	spi_FLASH_CS_Pad.pin =  FLASH_SPI_CS_PIN;
-    spi_FLASH_CS_Pad.port = FLASH_SPI_CS_PORT;
-    // Enable SPI & SPI FLASH
     spi_flash_init(SPI_FLASH_SIZE, SPI_FLASH_PAGE);
-    spi_init(&spi_FLASH_CS_Pad, SPI_MODE_8BIT, SPI_ROLE_MASTER, SPI_CLK_IDLE_POL_LOW,
-             SPI_PHA_MODE_0, SPI_MINT_DISABLE, SPI_XTAL_DIV_14);
+    app_spi_flash_peripheral_resume();
 
     //The Flash is kept in power_down so we need to power it up
     spi_flash_release_from_power_down();
@@ -68,13 +85,35 @@ void app_spi_flash_peripheral_init(void)
 
 /**
  ****************************************************************************************
- * @brief Releases the flash pins and the SPI interface
+ * @brief Initializes the flash pins and the SPI interface. The background operations
+ *        are completed first.
+ *
+ * @return      void
+ ****************************************************************************************
+ */
+void app_spi_flash_peripheral_init(void)
+{
+#if (HAS_SPI_FLASH_ASYNC)
+    app_flash_async_flush();
+#endif
+    app_spi_flash_power_up();
+}
+
+/**
+ ****************************************************************************************
+ * @brief Releases the flash pins and the SPI interface. Does nothing while background
+ *        operations are queued, the last one releases them.
  *
  * @return      void
  ****************************************************************************************
  */
 void app_spi_flash_peripheral_release(void)
 {
+#if (HAS_SPI_FLASH_ASYNC)
+    if (app_flash_async_is_busy()) {
+        return;
+    }
+#endif
     spi_flash_power_down();
     
     deactivate_spi_flash_gpios();
@@ -85,6 +124,25 @@ void app_spi_flash_peripheral_release(void)
 #endif
 }
 
+/**
+ ****************************************************************************************
+ * @brief Waits until the flash is ready for write operations, the first time it is
+ *        written after app_spi_flash_peripheral_init()
+ *
+ * @return      void
+ ****************************************************************************************
+ */
+void app_spi_flash_wait_power_up(void)
+{
+#ifdef HAS_FLASH_SPI_POWER_DOWN
+    if (power_up_delay) {
+// The flash was off so wait until is ready for write operations        
+        power_up_delay=false;
+        app_delay(15000);
+    }
+#endif
+}
+
 /**
  ****************************************************************************************
  * @brief Simplified write data to a single page in flash. Used to write bonding data
@@ -99,13 +157,7 @@ void app_spi_flash_peripheral_release(void)
 size_t app_spi_flash_write_random_page_data(const void *data, uint32_t address,
                                             size_t size)
 {
-#ifdef HAS_FLASH_SPI_POWER_DOWN
-    if (power_up_delay) {
-// The flash was off so wait until is ready for write operations        
-        power_up_delay=false;
-        app_delay(15000);
-    }
-#endif
+    app_spi_flash_wait_power_up();
 
     uint8_t cpdata[SPI_FLASH_PAGE];
     int start_address = address & ~(SPI_FLASH_PAGE-1);
@@ -27,9 +27,13 @@
 #define APP_FLASH_MSG_SIZE  SPI_FLASH_SECTOR - APP_DBG_REGS_SIZE
 #define APP_FLASH_REGS_BASE APP_FLASH_BASE + APP_FLASH_MSG_SIZE
 
+/// The flash has been powered up, the first write must wait (app_spi_flash_wait_power_up())
+extern bool power_up_delay;
+
 /**
  ****************************************************************************************
- * @brief Initializes the flash pins and the SPI interface.
+ * @brief Initializes the flash pins and the SPI interface. The background operations
+ *        (app_flash_async.h) are completed first.
  *
  * @param[in]   void.
  *
@@ -37,10 +41,34 @@
  ****************************************************************************************
  */
 void app_spi_flash_peripheral_init(void);
+
+/**
+ ****************************************************************************************
+ * @brief Powers the flash up and initializes the flash pins and the SPI interface.
+ *
+ * @param[in]   void.
+ *
+ * @return      void.
+ ****************************************************************************************
+ */
+void app_spi_flash_power_up(void);
+
+/**
+ ****************************************************************************************
+ * @brief Sets the flash pins and the SPI interface up again, for a flash that is
+ *        powered (e.g. after sleep).
+ *
+ * @param[in]   void.
+ *
+ * @return      void.
+ ****************************************************************************************
+ */
+void app_spi_flash_peripheral_resume(void);
     
 /**
  ****************************************************************************************
- * @brief Releases the flash pins and the SPI interface.
+ * @brief Releases the flash pins and the SPI interface. Does nothing while background
+ *        operations are queued.
  *
  * @param[in]   void.
  *
@@ -50,6 +78,16 @@ void app_spi_flash_peripheral_init(void);
 
 void app_spi_flash_peripheral_release(void);
 
+/**
+ ****************************************************************************************
+ * @brief Waits until the flash is ready for write operations, the first time it is
+ *        written after app_spi_flash_peripheral_init().
+ * @param[in]   void.
+ * @return      void.
+ ****************************************************************************************
+ */
+void app_spi_flash_wait_power_up(void);
+
 /**
  ****************************************************************************************
  * @brief Simplified write data to a single page in flash. Used to write bonding data.
@@ -172,6 +210,16 @@ __INLINE void deactivate_spi_flash_gpios(void)
     GPIO_SetPinFunction( FLASH_SPI_DI_PORT,  FLASH_SPI_DI_PIN,  INPUT_PULLDOWN, PID_GPIO);
 }
 
+// Keeps the flash powered and deselected, with the SPI functions released
+__INLINE void park_spi_flash_gpios(void)
+{
+    flash_spi_power_up();
+    GPIO_ConfigurePin( FLASH_SPI_CS_PORT,  FLASH_SPI_CS_PIN,  OUTPUT, PID_GPIO, true  );
+    GPIO_ConfigurePin( FLASH_SPI_CLK_PORT, FLASH_SPI_CLK_PIN, OUTPUT, PID_GPIO, false );
+    GPIO_ConfigurePin( FLASH_SPI_DO_PORT,  FLASH_SPI_DO_PIN,  OUTPUT, PID_GPIO, false );
+    GPIO_SetPinFunction( FLASH_SPI_DI_PORT,  FLASH_SPI_DI_PIN,  INPUT_PULLDOWN, PID_GPIO);
+}
+
 __INLINE void activate_spi_flash_gpios(void)
 {
     flash_spi_power_up();
@@ -0,0 +1,332 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_flash_async.c
+ *
+ * @brief Background erases and programs of the SPI flash.
+ *
+ * The operations are executed one after the other. The command of an operation is sent
+ * without waiting for the flash, and the status register is read later, until the
+ * flash is no longer busy. An operation that programs more than a page sends one page
+ * at a time.
+ *
+ * While the flash erases, its pins are parked (CS high, the SPI functions released)
+ * and the system may sleep. The SPI is set up again at every poll. The SPI controller
+ * is shared with the audio codec, so the flash is not polled while the audio runs.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include "rwble_config.h"
+
+#if (HAS_SPI_FLASH_ASYNC)
+
+#include "app_api.h"
+#include "app_flash.h"
+#include "app_flash_async.h"
+
+#if (HAS_AUDIO)
+#include "app_audio439.h"
+#endif
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+// Status polling period during an erase, in 10ms units
+#define FLASH_ASYNC_ERASE_POLL          (2)
+// An erase fails after this many polls (3s, more than a 64KB block erase)
+#define FLASH_ASYNC_ERASE_MAX_POLLS     (150)
+// A page program fails after this many polls from the main loop
+#define FLASH_ASYNC_PROGRAM_MAX_POLLS   (MAX_READY_WAIT_COUNT)
+// A flush drops the command in progress after this many spi_flash_wait_till_ready() timeouts
+#define FLASH_ASYNC_FLUSH_MAX_POLLS     (2)
+// Wait after powering up the flash (app_spi_flash_wait_power_up()), in 10ms units
+#define FLASH_ASYNC_POWER_UP_DELAY      (2)
+
+#if (HAS_AUDIO)
+#define FLASH_ASYNC_SPI_IN_USE()        (app_audio439_timer_started)
+#else
+#define FLASH_ASYNC_SPI_IN_USE()        (false)
+#endif
+
+static struct app_flash_async_op *flash_async_head;    // in progress
+static struct app_flash_async_op *flash_async_tail;
+static uint32_t flash_async_polls;                     // status reads of the command in progress, 0 if none
+static bool flash_async_loop_poll;                     // the main loop polls the flash
+static bool flash_async_powered;                       // the service has powered the flash up
+static int8_t flash_async_error;                       // of the last operation that failed, ERR_OK if none
+
+/*
+ * LOCAL FUNCTIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Removes the operation at the head of the queue and sends its completion
+ *        message. Powers the flash down if the queue is empty.
+ *
+ * @param[in] status    ERR_OK or the error
+ ****************************************************************************************
+ */
+static void flash_async_complete(int8_t status)
+{
+    struct app_flash_async_op *op = flash_async_head;
+
+    flash_async_head = op->next;
+    flash_async_polls = 0;
+    op->status = status;
+    if (status != ERR_OK) {
+        flash_async_error = status;
+    }
+
+    if (flash_async_head == NULL) {
+        flash_async_tail = NULL;
+        flash_async_powered = false;
+        app_spi_flash_peripheral_release();
+    }
+
+    if (op->dest_id != TASK_NONE) {
+        struct app_flash_async_cmp_ind *ind = KE_MSG_ALLOC(APP_FLASH_ASYNC_CMP_IND, op->dest_id, TASK_APP,
+                                                           app_flash_async_cmp_ind);
+        ind->op = op;
+        ind->status = status;
+        ke_msg_send(ind);
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Sends the erase command, or the program command of the next page.
+ *
+ * @param[in] op    The operation
+ *
+ * @return ERR_OK or the error
+ ****************************************************************************************
+ */
+static int8_t flash_async_issue(struct app_flash_async_op *op)
+{
+    const uint32_t address = op->address + op->done;
+    uint32_t len;
+
+    if (op->type == APP_FLASH_ASYNC_ERASE) {
+        return spi_flash_block_erase_start(op->address, (SPI_erase_module_t)op->erase);
+    }
+
+    // up to the end of the page
+    len = SPI_FLASH_PAGE - (address % SPI_FLASH_PAGE);
+    if (len > op->size - op->done) {
+        len = op->size - op->done;
+    }
+    if (spi_flash_page_program_start((uint8_t *)&op->data[op->done], address, len) != ERR_OK) {
+        return ERR_TIMEOUT;
+    }
+    op->done += len;
+    return ERR_OK;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Runs the queue until the flash is busy or the queue is empty. The SPI must be
+ *        set up.
+ *
+ * @param[in] flush     true, if the caller waits for the flash (app_flash_async_flush())
+ *
+ * @return true, if the flash must be polled again from the APP_FLASH_ASYNC_TIMER
+ ****************************************************************************************
+ */
+static bool flash_async_run(bool flush)
+{
+    struct app_flash_async_op *op;
+    int8_t status;
+
+    flash_async_loop_poll = false;
+
+#ifdef HAS_FLASH_SPI_POWER_DOWN
+    if (power_up_delay && !flush) {
+        // the flash has just been powered up
+        power_up_delay = false;
+        app_timer_set(APP_FLASH_ASYNC_TIMER, TASK_APP, FLASH_ASYNC_POWER_UP_DELAY);
+        return true;
+    }
+#endif
+
+    while ((op = flash_async_head) != NULL) {
+        if (flash_async_polls) {
+            // a command is in progress
+            if (spi_flash_read_status_reg() & STATUS_BUSY) {
+                if (flush) {
+                    // app_flash_async_flush() waits again, up to a limit
+                    if (flash_async_polls++ < FLASH_ASYNC_FLUSH_MAX_POLLS) {
+                        return false;
+                    }
+                } else if (op->type == APP_FLASH_ASYNC_ERASE) {
+                    if (flash_async_polls++ < FLASH_ASYNC_ERASE_MAX_POLLS) {
+                        app_timer_set(APP_FLASH_ASYNC_TIMER, TASK_APP, FLASH_ASYNC_ERASE_POLL);
+                        return true;
+                    }
+                } else if (flash_async_polls++ < FLASH_ASYNC_PROGRAM_MAX_POLLS) {
+                    flash_async_loop_poll = true;
+                    return false;
+                }
+                flash_async_complete(ERR_TIMEOUT);
+                continue;
+            }
+
+            flash_async_polls = 0;
+            if (op->type == APP_FLASH_ASYNC_ERASE) {
+                flash_async_complete(ERR_OK);
+                continue;
+            }
+        }
+
+        if ((op->type == APP_FLASH_ASYNC_PROGRAM) && (op->done >= op->size)) {
+            flash_async_complete(ERR_OK);
+            continue;
+        }
+
+        status = flash_async_issue(op);
+        if (status != ERR_OK) {
+            flash_async_complete(status);
+            continue;
+        }
+        flash_async_polls = 1;
+    }
+    return false;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Powers the flash up, the first time, or sets the SPI up again.
+ ****************************************************************************************
+ */
+static void flash_async_setup(void)
+{
+    if (flash_async_powered) {
+        app_spi_flash_peripheral_resume();
+    } else {
+        app_spi_flash_power_up();
+        flash_async_powered = true;
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Sets the SPI up and runs the queue. Parks the flash pins if the next poll is
+ *        from the APP_FLASH_ASYNC_TIMER.
+ ****************************************************************************************
+ */
+static void flash_async_resume(void)
+{
+    if (FLASH_ASYNC_SPI_IN_USE()) {
+        app_timer_set(APP_FLASH_ASYNC_TIMER, TASK_APP, FLASH_ASYNC_ERASE_POLL);
+        return;
+    }
+
+    flash_async_setup();
+    if (flash_async_run(false)) {
+        park_spi_flash_gpios();
+    }
+}
+
+/*
+ * EXPORTED FUNCTIONS
+ ****************************************************************************************
+ */
+
+void app_flash_async_submit(struct app_flash_async_op *op)
+{
+    op->next = NULL;
+    op->done = 0;
+    op->status = APP_FLASH_ASYNC_PENDING;
+
+    if (flash_async_head == NULL) {
+        flash_async_head = op;
+        flash_async_tail = op;
+        flash_async_resume();
+    } else {
+        flash_async_tail->next = op;
+        flash_async_tail = op;
+    }
+}
+
+
+bool app_flash_async_is_busy(void)
+{
+    return flash_async_head != NULL;
+}
+
+
+int8_t app_flash_async_flush(void)
+{
+    flash_async_error = ERR_OK;
+    if (flash_async_head == NULL) {
+        return ERR_OK;
+    }
+
+    flash_async_setup();
+    app_spi_flash_wait_power_up();
+
+    // the polls of the command in progress count in spi_flash_wait_till_ready() calls from now on
+    if (flash_async_polls) {
+        flash_async_polls = 1;
+    }
+    while (flash_async_head) {
+        spi_flash_wait_till_ready();
+        flash_async_run(true);
+    }
+    flash_async_loop_poll = false;
+
+    return flash_async_error;
+}
+
+
+bool app_flash_async_poll(void)
+{
+    if (flash_async_loop_poll) {
+        if (FLASH_ASYNC_SPI_IN_USE()) {
+            flash_async_loop_poll = false;
+            flash_async_resume();
+        } else if (flash_async_run(false)) {
+            park_spi_flash_gpios();
+        }
+    }
+    return flash_async_loop_poll;
+}
+
+
+int app_flash_async_timer_handler(ke_msg_id_t const msgid,
+                                  void const *param,
+                                  ke_task_id_t const dest_id,
+                                  ke_task_id_t const src_id)
+{
+    if (flash_async_head) {
+        flash_async_resume();
+    }
+    return (KE_MSG_CONSUMED);
+}
+
+#endif // HAS_SPI_FLASH_ASYNC
+
+/// @} APP
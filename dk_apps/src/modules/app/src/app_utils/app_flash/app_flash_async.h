@@ -0,0 +1,146 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_flash_async.h
+ *
+ * @brief Background erases and programs of the SPI flash header file.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_FLASH_ASYNC_H_
+#define APP_FLASH_ASYNC_H_
+
+/*
+ ****************************************************************************************
+ * USAGE
+ * An operation is queued with app_flash_async_submit() and runs while the application
+ * does other work. The service powers the flash up when the first operation is queued
+ * and down when the queue is empty.
+ *
+ * During an erase the status of the flash is read every FLASH_ASYNC_ERASE_POLL from the
+ * APP_FLASH_ASYNC_TIMER, so the system can enter Extended sleep. During a program it is
+ * read from the main loop (app_flash_async_poll()), since a page takes about 1ms.
+ *
+ * The blocking users of the flash call app_spi_flash_peripheral_init() first, which
+ * completes the queued operations (app_flash_async_flush()).
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ke_msg.h"
+#include "spi_flash.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Status of an operation that has not completed
+#define APP_FLASH_ASYNC_PENDING         (1)
+
+/// Operation types
+enum app_flash_async_type
+{
+    APP_FLASH_ASYNC_ERASE,          ///< erase the block or sector of address (erase)
+    APP_FLASH_ASYNC_PROGRAM,        ///< program size bytes of data at address, any length
+};
+
+/// An operation. The structure is owned by the caller and must stay valid until it completes.
+struct app_flash_async_op
+{
+    struct app_flash_async_op *next;    ///< used by the service
+    const uint8_t *data;                ///< APP_FLASH_ASYNC_PROGRAM: must stay valid as well
+    uint32_t address;
+    uint32_t size;                      ///< APP_FLASH_ASYNC_PROGRAM
+    uint32_t done;                      ///< used by the service: bytes sent to the flash
+    ke_task_id_t dest_id;               ///< receives APP_FLASH_ASYNC_CMP_IND, TASK_NONE for none
+    uint8_t type;                       ///< app_flash_async_type
+    uint8_t erase;                      ///< APP_FLASH_ASYNC_ERASE: SPI_erase_module_t
+    volatile int8_t status;             ///< APP_FLASH_ASYNC_PENDING, ERR_OK or a spi_flash.h error
+};
+
+/// Parameters of the APP_FLASH_ASYNC_CMP_IND message
+struct app_flash_async_cmp_ind
+{
+    struct app_flash_async_op *op;      ///< the completed operation
+    int8_t status;                      ///< ERR_OK or a spi_flash.h error
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Queues an operation. It starts at once if the queue is empty.
+ *
+ * @param[in] op    The operation
+ *
+ * @return void
+ ****************************************************************************************
+ */
+void app_flash_async_submit(struct app_flash_async_op *op);
+
+/**
+ ****************************************************************************************
+ * @brief Checks if operations are queued or in progress. The flash must then stay
+ *        powered and its CS pin high.
+ *
+ * @return true, if the service is busy
+ ****************************************************************************************
+ */
+bool app_flash_async_is_busy(void);
+
+/**
+ ****************************************************************************************
+ * @brief Completes the queued operations, waiting for the flash. An operation is dropped
+ *        with ERR_TIMEOUT if the flash stays busy.
+ *
+ * @return ERR_OK, or the error of the last operation that failed
+ ****************************************************************************************
+ */
+int8_t app_flash_async_flush(void);
+
+/**
+ ****************************************************************************************
+ * @brief Checks the flash from the main loop while a page is being programmed, and
+ *        moves on to the next page or operation.
+ *
+ * @return true, if the main loop must call it again without sleeping
+ ****************************************************************************************
+ */
+bool app_flash_async_poll(void);
+
+/**
+ ****************************************************************************************
+ * @brief Handler of the APP_FLASH_ASYNC_TIMER. Checks the flash during an erase.
+ *
+ * @param msgid     Id of the message received.
+ * @param param     Pointer to the parameters of the message.
+ * @param dest_id   ID of the receiving task instance (TASK_APP).
+ * @param src_id    ID of the sending task instance.
+ *
+ * @return If the message was consumed or not.
+ ****************************************************************************************
+ */
+int app_flash_async_timer_handler(ke_msg_id_t const msgid,
+                                  void const *param,
+                                  ke_task_id_t const dest_id,
+                                  ke_task_id_t const src_id);
+
+#endif // APP_FLASH_ASYNC_H_
@@ -0,0 +1,626 @@
+/**
+****************************************************************************************
+*
+* @file app_bond_log.c
+*
+* @brief Log-structured storage of the bonding data in the SPI flash.
+*
+* A write of the NV storage appends a record to the active sector instead of erasing a
+* whole sector to change a single byte. A sector is erased only when the active one is
+* full, once every (SPI_FLASH_SECTOR / record size) writes, and the erases are spread
+* over BOND_LOG_SECTORS sectors.
+*
+* Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+* program includes Confidential, Proprietary Information and is a Trade Secret of
+* Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+* unless authorized in writing. All Rights Reserved.
+*
+* <bluetooth.support@diasemi.com> and contributors.
+*
+****************************************************************************************
+*/
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include "rwble_config.h"
+
+#if (HAS_SPI_FLASH_BOND_LOG)
+
+#include <string.h>
+#include "app_task.h"
+#include "app_flash.h"
+#include "spi_flash.h"
+#include "app_multi_bond.h"
+#include "app_bond_log.h"
+
+#if (HAS_SPI_FLASH_ASYNC)
+#include "app_flash_async.h"
+#endif
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+enum bond_log_key {
+    BOND_LOG_KEY_HEADER,                            // guard and magic numbers
+    BOND_LOG_KEY_STATUS,                            // multi_bond_status
+    BOND_LOG_KEY_USAGE,                             // bond_usage
+    BOND_LOG_KEY_BOND,                              // bonding info entries
+    BOND_LOG_KEYS = BOND_LOG_KEY_BOND + MAX_BOND_PEER,
+    BOND_LOG_KEY_NONE = 0xFF,                       // unused space of the layout
+};
+
+struct bond_log_sector_hdr_tag
+{
+    uint32_t seq;
+    uint32_t magic;
+};
+
+struct bond_log_rec_hdr_tag
+{
+    uint8_t key;
+    uint8_t len;
+    uint16_t crc;
+};
+
+// The bonding info entry is the largest record
+#define BOND_LOG_REC_MAX                (sizeof(struct bond_log_rec_hdr_tag) + sizeof(struct bonding_info_))
+
+#define BOND_LOG_SECTOR_ADDR(s)         (BOND_LOG_BASE_ADDR + (s) * SPI_FLASH_SECTOR)
+
+struct bond_log_env_tag
+{
+    uint32_t seq;                                   // sequence number of the active sector
+    uint16_t rec_pos[BOND_LOG_KEYS];                // last record of each key in the active sector, 0 if none
+    uint16_t wr_pos;                                // start of the free space of the active sector
+    uint8_t sector;                                 // active sector
+    bool mounted;
+    bool compact;                                   // the free space may be dirty, the next write compacts
+};
+
+/*
+ * Retained variables
+ ****************************************************************************************
+ */
+
+static struct bond_log_env_tag bond_log_env __attribute__((section("retention_mem_area0"), zero_init));
+
+#if (HAS_SPI_FLASH_ASYNC)
+// Background erase of the sector after the active one
+static struct app_flash_async_op bond_log_erase_op;
+static uint32_t bond_log_erase_seq;                 // sequence number of the active sector at the erase
+#endif
+
+/*
+ * LOCAL FUNCTIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief       Gets the place of a record key in the NV storage layout.
+ *
+ * @param[in]   key     The key
+ * @param[out]  len     Length of the record data
+ *
+ * @return      Offset from NV_STORAGE_BASE_ADDR
+ ****************************************************************************************
+ */
+static uint32_t bond_log_key_offset(uint8_t key, uint8_t *len)
+{
+    const uint32_t status = NV_STORAGE_STATUS_ADDR - NV_STORAGE_BASE_ADDR;
+    const uint32_t usage = NV_STORAGE_USAGE_ADDR - NV_STORAGE_BASE_ADDR;
+    const uint32_t bond = NV_STORAGE_BOND_DATA_ADDR - NV_STORAGE_BASE_ADDR;
+
+    switch (key) {
+    case BOND_LOG_KEY_HEADER:
+        *len = status;
+        return 0;
+    case BOND_LOG_KEY_STATUS:
+        *len = sizeof(uint8_t);
+        return status;
+    case BOND_LOG_KEY_USAGE:
+        *len = sizeof(struct usage_array_);
+        return usage;
+    default:
+        *len = sizeof(struct bonding_info_);
+        return bond + (key - BOND_LOG_KEY_BOND) * sizeof(struct bonding_info_);
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Finds the record key that holds an offset of the NV storage layout.
+ *
+ * @param[in]   offset  Offset from NV_STORAGE_BASE_ADDR
+ * @param[out]  size    Bytes from offset to the end of the key (or of the unused space)
+ *
+ * @return      The key, BOND_LOG_KEY_NONE if the offset is not used
+ ****************************************************************************************
+ */
+static uint8_t bond_log_find_key(uint32_t offset, uint32_t *size)
+{
+    uint8_t key, len;
+    uint32_t start;
+
+    for (key = 0; key < BOND_LOG_KEYS; key++) {
+        start = bond_log_key_offset(key, &len);
+        if (offset < start) {
+            *size = start - offset;
+            return BOND_LOG_KEY_NONE;
+        }
+        if (offset < start + len) {
+            *size = start + len - offset;
+            return key;
+        }
+    }
+    *size = SPI_FLASH_SECTOR;
+    return BOND_LOG_KEY_NONE;
+}
+
+/**
+ ****************************************************************************************
+ * @brief       CRC-16-CCITT
+ ****************************************************************************************
+ */
+static uint16_t bond_log_crc(uint16_t crc, const uint8_t *data, uint32_t size)
+{
+    int i;
+
+    while (size--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint16_t bond_log_rec_crc(const struct bond_log_rec_hdr_tag *hdr, const uint8_t *data)
+{
+    return bond_log_crc(bond_log_crc(0xFFFF, &hdr->key, 2), data, hdr->len);
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Reads the value of a key from the active sector.
+ *
+ * @param[in]   key     The key
+ * @param[out]  data    The value, zeros if the key has no record
+ ****************************************************************************************
+ */
+static void bond_log_read_key(uint8_t key, uint8_t *data)
+{
+    uint8_t len;
+    const uint16_t pos = bond_log_env.rec_pos[key];
+
+    bond_log_key_offset(key, &len);
+    if (pos) {
+        spi_flash_read_data(data, BOND_LOG_SECTOR_ADDR(bond_log_env.sector) + pos +
+                            sizeof(struct bond_log_rec_hdr_tag), len);
+    } else {
+        memset(data, 0, len);
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Programs erased flash.
+ *
+ * @return      true, if all the data has been programmed
+ ****************************************************************************************
+ */
+static bool bond_log_program(uint32_t address, const void *data, uint32_t size)
+{
+    return spi_flash_write_data((uint8_t *)data, address, size) == (int32_t)size;
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Programs a record. The header and the data are sent in one go, so a
+ *              record cut by a power loss fails its CRC.
+ *
+ * @return      true, if the record has been programmed
+ ****************************************************************************************
+ */
+static bool bond_log_program_rec(uint32_t address, uint8_t key, const uint8_t *data)
+{
+    uint8_t rec[BOND_LOG_REC_MAX];
+    struct bond_log_rec_hdr_tag hdr;
+
+    hdr.key = key;
+    bond_log_key_offset(key, &hdr.len);
+    hdr.crc = bond_log_rec_crc(&hdr, data);
+
+    memcpy(rec, &hdr, sizeof(hdr));
+    memcpy(&rec[sizeof(hdr)], data, hdr.len);
+
+    return bond_log_program(address, rec, sizeof(hdr) + hdr.len);
+}
+
+#if (HAS_SPI_FLASH_ASYNC)
+/**
+ ****************************************************************************************
+ * @brief       Checks if the background erase of a sector has been queued while the
+ *              active sector was active, and has not failed.
+ *
+ * @param[in]   base    Address of the sector
+ *
+ * @return      true, if it is queued, in progress or done
+ ****************************************************************************************
+ */
+static bool bond_log_erase_queued(uint32_t base)
+{
+    return (bond_log_erase_op.address == base) && (bond_log_erase_seq == bond_log_env.seq) &&
+           ((bond_log_erase_op.status == ERR_OK) || (bond_log_erase_op.status == APP_FLASH_ASYNC_PENDING));
+}
+#endif
+
+/**
+ ****************************************************************************************
+ * @brief       Moves the live records to the next sector and makes it the active one.
+ *              The old sector stays valid until the new one is complete.
+ *
+ * @param[in]   key     Key with a new value, BOND_LOG_KEY_NONE if none
+ * @param[in]   data    The new value
+ *
+ * @return      true, if the log has been compacted
+ ****************************************************************************************
+ */
+static bool bond_log_compact(uint8_t key, const uint8_t *data)
+{
+    const uint8_t sector = (bond_log_env.sector + 1) % BOND_LOG_SECTORS;
+    const uint32_t base = BOND_LOG_SECTOR_ADDR(sector);
+    struct bond_log_sector_hdr_tag hdr;
+    uint16_t rec_pos[BOND_LOG_KEYS];
+    uint8_t value[sizeof(struct bonding_info_)];
+    uint16_t pos = sizeof(hdr);
+    uint8_t k, len;
+    bool erased = false;
+
+    hdr.seq = bond_log_env.seq + 1;
+    hdr.magic = BOND_LOG_MAGIC_NUMBER;
+
+#if (HAS_SPI_FLASH_ASYNC)
+    // app_spi_flash_peripheral_init() has completed the background erase, if any
+    erased = bond_log_erase_queued(base) && (bond_log_erase_op.status == ERR_OK);
+#endif
+    if (!erased && (spi_flash_block_erase(base, SECTOR_ERASE) != ERR_OK)) {
+        return false;
+    }
+    if (!bond_log_program(base, &hdr.seq, sizeof(hdr.seq))) {
+        return false;
+    }
+
+    for (k = 0; k < BOND_LOG_KEYS; k++) {
+        const uint8_t *src = value;
+
+        if (k == key) {
+            src = data;
+        } else if (bond_log_env.rec_pos[k]) {
+            bond_log_read_key(k, value);
+        } else {
+            rec_pos[k] = 0;
+            continue;
+        }
+
+        if (!bond_log_program_rec(base + pos, k, src)) {
+            return false;
+        }
+        bond_log_key_offset(k, &len);
+        rec_pos[k] = pos;
+        pos += sizeof(struct bond_log_rec_hdr_tag) + len;
+    }
+
+    // commit
+    if (!bond_log_program(base + sizeof(hdr.seq), &hdr.magic, sizeof(hdr.magic))) {
+        return false;
+    }
+
+    bond_log_env.sector = sector;
+    bond_log_env.seq = hdr.seq;
+    bond_log_env.wr_pos = pos;
+    bond_log_env.compact = false;
+    memcpy(bond_log_env.rec_pos, rec_pos, sizeof(rec_pos));
+
+    return true;
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Appends a record to the active sector, or compacts the log if there is
+ *              not enough free space.
+ *
+ * @return      true, if the record has been written
+ ****************************************************************************************
+ */
+static bool bond_log_append(uint8_t key, const uint8_t *data)
+{
+    uint8_t len;
+
+    bond_log_key_offset(key, &len);
+    app_spi_flash_wait_power_up();
+
+    if (bond_log_env.compact ||
+        (bond_log_env.wr_pos + sizeof(struct bond_log_rec_hdr_tag) + len > SPI_FLASH_SECTOR)) {
+        return bond_log_compact(key, data);
+    }
+
+    if (!bond_log_program_rec(BOND_LOG_SECTOR_ADDR(bond_log_env.sector) + bond_log_env.wr_pos, key, data)) {
+        bond_log_env.compact = true;
+        return false;
+    }
+    bond_log_env.rec_pos[key] = bond_log_env.wr_pos;
+    bond_log_env.wr_pos += sizeof(struct bond_log_rec_hdr_tag) + len;
+
+    return true;
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Builds the record index of the active sector. The scan stops at the
+ *              first erased header or at the first bad record (cut by a power loss).
+ *              In the latter case the next write compacts the log.
+ ****************************************************************************************
+ */
+static void bond_log_scan(void)
+{
+    const uint32_t base = BOND_LOG_SECTOR_ADDR(bond_log_env.sector);
+    struct bond_log_rec_hdr_tag hdr;
+    uint8_t data[sizeof(struct bonding_info_)];
+    uint16_t pos = sizeof(struct bond_log_sector_hdr_tag);
+    uint8_t len = 0;
+
+    memset(bond_log_env.rec_pos, 0, sizeof(bond_log_env.rec_pos));
+    bond_log_env.compact = false;
+
+    while (pos + sizeof(hdr) <= SPI_FLASH_SECTOR) {
+        spi_flash_read_data((uint8_t *)&hdr, base + pos, sizeof(hdr));
+
+        if ((hdr.key == 0xFF) && (hdr.len == 0xFF) && (hdr.crc == 0xFFFF)) {
+            break;
+        }
+
+        if (hdr.key < BOND_LOG_KEYS) {
+            bond_log_key_offset(hdr.key, &len);
+        }
+        if ((hdr.key >= BOND_LOG_KEYS) || (hdr.len != len) || (pos + sizeof(hdr) + len > SPI_FLASH_SECTOR)) {
+            bond_log_env.compact = true;
+            break;
+        }
+
+        spi_flash_read_data(data, base + pos + sizeof(hdr), len);
+        if (bond_log_rec_crc(&hdr, data) != hdr.crc) {
+            bond_log_env.compact = true;
+            break;
+        }
+
+        bond_log_env.rec_pos[hdr.key] = pos;
+        pos += sizeof(hdr) + len;
+    }
+    bond_log_env.wr_pos = pos;
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Clears the magic number of the sector the log replaces, so that it is
+ *              not imported again if the log is lost. The bits are programmed to 0, no
+ *              erase is needed.
+ ****************************************************************************************
+ */
+static void bond_log_retire_legacy(void)
+{
+    uint32_t magic;
+
+    spi_flash_read_data((uint8_t *)&magic, NV_STORAGE_MAGIC_ADDR, sizeof(magic));
+    if (magic == NV_STORAGE_MAGIC_NUMBER) {
+        magic = 0;
+        bond_log_program(NV_STORAGE_MAGIC_ADDR, &magic, sizeof(magic));
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Moves the log to a new, empty sector.
+ *
+ * @return      true, if the flash could be written
+ ****************************************************************************************
+ */
+static bool bond_log_format(void)
+{
+    app_spi_flash_wait_power_up();
+
+    memset(bond_log_env.rec_pos, 0, sizeof(bond_log_env.rec_pos));
+    if (!bond_log_compact(BOND_LOG_KEY_NONE, NULL)) {
+        // mount again at the next access
+        bond_log_env.mounted = false;
+        return false;
+    }
+    bond_log_env.mounted = true;
+
+    return true;
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Copies the sector the log replaces, if it holds valid data, then retires
+ *              it.
+ ****************************************************************************************
+ */
+static void bond_log_import(void)
+{
+    uint8_t data[sizeof(struct bonding_info_)];
+    uint32_t magic;
+    uint32_t offset;
+    uint8_t key, len, i;
+
+    spi_flash_read_data((uint8_t *)&magic, NV_STORAGE_MAGIC_ADDR, sizeof(magic));
+    if (magic != NV_STORAGE_MAGIC_NUMBER) {
+        return;
+    }
+
+    for (key = 0; key < BOND_LOG_KEYS; key++) {
+        offset = bond_log_key_offset(key, &len);
+        spi_flash_read_data(data, NV_STORAGE_BASE_ADDR + offset, len);
+
+        for (i = 0; (i < len) && (data[i] == 0); i++);
+        if ((i < len) && !bond_log_append(key, data)) {
+            return;                                 // imported again at the next mount
+        }
+    }
+
+    bond_log_retire_legacy();
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Finds the active sector and builds its record index.
+ ****************************************************************************************
+ */
+static void bond_log_mount(void)
+{
+    struct bond_log_sector_hdr_tag hdr;
+    bool found = false;
+    uint8_t s;
+
+    for (s = 0; s < BOND_LOG_SECTORS; s++) {
+        spi_flash_read_data((uint8_t *)&hdr, BOND_LOG_SECTOR_ADDR(s), sizeof(hdr));
+
+        if ((hdr.magic == BOND_LOG_MAGIC_NUMBER) && (hdr.seq != 0xFFFFFFFF) &&
+            (!found || (hdr.seq > bond_log_env.seq))) {
+            bond_log_env.sector = s;
+            bond_log_env.seq = hdr.seq;
+            found = true;
+        }
+    }
+
+    bond_log_env.mounted = true;
+
+    if (found) {
+        bond_log_scan();
+    } else {
+        bond_log_env.sector = BOND_LOG_SECTORS - 1;
+        bond_log_env.seq = 0;
+        if (bond_log_format()) {
+            bond_log_import();
+        }
+    }
+}
+
+/*
+ * EXPORTED FUNCTIONS
+ ****************************************************************************************
+ */
+
+uint32_t app_bond_log_read(uint8_t *data, uint32_t address, uint32_t size)
+{
+    uint8_t value[sizeof(struct bonding_info_)];
+    uint32_t offset = address - NV_STORAGE_BASE_ADDR;
+    uint32_t left = size;
+    uint32_t n;
+    uint8_t key, len;
+
+    if (!bond_log_env.mounted) {
+        bond_log_mount();
+    }
+
+    while (left) {
+        key = bond_log_find_key(offset, &n);
+        if (n > left) {
+            n = left;
+        }
+
+        if (key == BOND_LOG_KEY_NONE) {
+            memset(data, 0, n);
+        } else {
+            bond_log_read_key(key, value);
+            memcpy(data, &value[offset - bond_log_key_offset(key, &len)], n);
+        }
+        offset += n;
+        data += n;
+        left -= n;
+    }
+
+    return size;
+}
+
+
+uint32_t app_bond_log_write(const uint8_t *data, uint32_t address, uint32_t size)
+{
+    uint8_t value[sizeof(struct bonding_info_)];
+    uint32_t offset = address - NV_STORAGE_BASE_ADDR;
+    uint32_t done = 0;
+    uint32_t n, pos;
+    uint8_t key, len;
+
+    if (!bond_log_env.mounted) {
+        bond_log_mount();
+    }
+
+    while (done < size) {
+        key = bond_log_find_key(offset, &n);
+        if (n > size - done) {
+            n = size - done;
+        }
+
+        if (key != BOND_LOG_KEY_NONE) {
+            bond_log_read_key(key, value);
+            pos = offset - bond_log_key_offset(key, &len);
+
+            if (memcmp(&value[pos], data, n)) {
+                memcpy(&value[pos], data, n);
+                if (!bond_log_append(key, value)) {
+                    break;
+                }
+            }
+        }
+        offset += n;
+        data += n;
+        done += n;
+    }
+
+    return done;
+}
+
+
+bool app_bond_log_format(void)
+{
+    if (!bond_log_format()) {
+        return false;
+    }
+    bond_log_retire_legacy();
+
+    return true;
+}
+
+
+void app_bond_log_release(void)
+{
+#if (HAS_SPI_FLASH_ASYNC)
+    const uint32_t base = BOND_LOG_SECTOR_ADDR((bond_log_env.sector + 1) % BOND_LOG_SECTORS);
+
+    if (bond_log_env.mounted && (bond_log_env.wr_pos > SPI_FLASH_SECTOR / 2) && !bond_log_erase_queued(base)) {
+        bond_log_erase_op.type = APP_FLASH_ASYNC_ERASE;
+        bond_log_erase_op.erase = SECTOR_ERASE;
+        bond_log_erase_op.address = base;
+        bond_log_erase_op.dest_id = TASK_NONE;
+        bond_log_erase_seq = bond_log_env.seq;
+        app_flash_async_submit(&bond_log_erase_op);
+    }
+#endif
+}
+
+#endif // HAS_SPI_FLASH_BOND_LOG
+
+/// @} APP
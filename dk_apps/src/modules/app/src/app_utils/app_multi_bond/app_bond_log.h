@@ -0,0 +1,112 @@
+/**
+****************************************************************************************
+*
+* @file app_bond_log.h
+*
+* @brief Log-structured storage of the bonding data in the SPI flash header file.
+*
+* Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+* program includes Confidential, Proprietary Information and is a Trade Secret of
+* Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+* unless authorized in writing. All Rights Reserved.
+*
+* <bluetooth.support@diasemi.com> and contributors.
+*
+****************************************************************************************
+*/
+
+#ifndef APP_BOND_LOG_H_
+#define APP_BOND_LOG_H_
+
+/*
+ ****************************************************************************************
+ * USAGE
+ * The module keeps the NV storage layout of app_multi_bond.h (magic number, status,
+ * usage counters and bonding info entries) as records appended to BOND_LOG_SECTORS
+ * sectors of the SPI flash, starting at BOND_LOG_BASE_ADDR. Only one sector is active.
+ * When it is full, its live records are copied to the next sector, which is erased
+ * first, so the erases rotate over all the sectors.
+ *
+ * Sector: | seq (4) | magic (4) | record | record | ... | free (0xFF) |
+ *   The magic number is programmed after the live records have been copied. The valid
+ *   sector with the highest sequence number is the active one.
+ *
+ * Record: | key (1) | len (1) | CRC-16 (2) | data (len) |
+ *   The CRC covers the key, the length and the data. The last record of a key is its
+ *   value. A key without a record reads as zeros.
+ *
+ * The callers must power the flash up (app_spi_flash_peripheral_init()) first. The log
+ * is mounted at the first access after a power-up. If no valid sector exists, the
+ * sector at NV_STORAGE_BASE_ADDR, which the log replaces, is imported. Its magic number
+ * is then cleared, as it is when the log is formatted, so that bonds that have been
+ * changed or cleared since do not come back.
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define BOND_LOG_MAGIC_NUMBER           (0xB0D5106A)
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief       Reads from the NV storage.
+ *
+ * @param[out]  data        The data
+ * @param[in]   address     Address in the NV storage layout (NV_STORAGE_xxx_ADDR)
+ * @param[in]   size        The amount of data to read
+ *
+ * @return      Amount of data read
+ ****************************************************************************************
+ */
+uint32_t app_bond_log_read(uint8_t *data, uint32_t address, uint32_t size);
+
+/**
+ ****************************************************************************************
+ * @brief       Writes to the NV storage. A record is appended for each record key the
+ *              write changes. Unchanged data is not written.
+ *
+ * @param[in]   data        The data
+ * @param[in]   address     Address in the NV storage layout (NV_STORAGE_xxx_ADDR)
+ * @param[in]   size        The amount of data to write
+ *
+ * @return      Amount of data written
+ ****************************************************************************************
+ */
+uint32_t app_bond_log_write(const uint8_t *data, uint32_t address, uint32_t size);
+
+/**
+ ****************************************************************************************
+ * @brief       Clears the NV storage. It then reads as zeros. Only one sector is
+ *              erased. The sector the log replaces is retired.
+ *
+ * @return      true, if the flash could be written
+ ****************************************************************************************
+ */
+bool app_bond_log_format(void);
+
+/**
+ ****************************************************************************************
+ * @brief       Called before the flash is released. Once the active sector is half full,
+ *              queues the erase of the next one in the background (HAS_SPI_FLASH_ASYNC),
+ *              so that the compaction does not wait for it.
+ ****************************************************************************************
+ */
+void app_bond_log_release(void);
+
+#endif // APP_BOND_LOG_H_
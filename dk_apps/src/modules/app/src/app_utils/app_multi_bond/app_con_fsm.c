@@ -35,6 +35,9 @@
 
 #include "app_con_fsm.h"
 #include "app_con_fsm_debug.h"
+#include "app_conn_params.h"
+#include "app_reconnect.h"
+#include "app_rpa_cache.h"
 #include "app_utils.h"
 #include "gpio.h"
 
@@ -55,7 +58,6 @@ bool user_disconnection_req                  __attribute__((section("retention_m
 bool sync_passcode_entered_evt               __attribute__((section("retention_mem_area0"), zero_init)); // flag to indicate to the high-level FSM that the Passcode has been entered by the user, synchronously to the BLE
 bool reset_bonding_request                   __attribute__((section("retention_mem_area0"), zero_init));
 
-extern struct bonding_info_ bond_array[MAX_BOND_PEER];
 extern enum multi_bond_host_rejection multi_bond_enabled;
 
 __INLINE void app_con_fsm_call_callback(enum con_fsm_state_update_callback_type type);
@@ -218,14 +220,39 @@ static void start_adv_directed(void)
 
 /**
  ****************************************************************************************
- * @brief Sends connection update request
+ * @brief Starts directed advertising to a bonded host, if there is one: the best
+ *        candidate of the reconnection policy or the host in bond_info
  *
  * @param   None    
  *
+ * @return  true, if directed advertising was started
+ ****************************************************************************************
+ */
+static bool start_adv_reconnection(void)
+{
+    if (con_fsm_params.has_reconnect_policy && app_reconnect_start()) {
+        start_adv_directed();
+        return true;
+    }
+    
+    if (is_bonded && (bond_info.env.auth & GAP_AUTH_BOND)) {
+        start_adv_directed();
+        return true;
+    }
+    return false;
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Sends connection update request
+ *
+ * @param[in] set   The connection parameters to request
+ *
  * @return  void
  ****************************************************************************************
  */
-static void send_connection_upd_req(void)
+static void send_connection_upd_req(const struct conn_params_set *set)
 {    
     ke_state_t app_state = ke_state_get(TASK_APP);
     
@@ -236,15 +263,15 @@ static void send_connection_upd_req(void)
 		// Fill in the parameter structure
         req->operation = GAPC_UPDATE_PARAMS;
 #ifndef __DA14581__
-		req->params.intv_min = con_fsm_params.preferred_conn_interval_min; // N * 1.25ms
-		req->params.intv_max = con_fsm_params.preferred_conn_interval_max; // N * 1.25ms
-		req->params.latency  = con_fsm_params.preferred_conn_latency;      // Conn Events skipped
-		req->params.time_out = con_fsm_params.preferred_conn_timeout;      // N * 10ms
+		req->params.intv_min = set->intv_min;   // N * 1.25ms
+		req->params.intv_max = set->intv_max;   // N * 1.25ms
+		req->params.latency  = set->latency;    // Conn Events skipped
+		req->params.time_out = set->time_out;   // N * 10ms
 #else
-		req->intv_min   = con_fsm_params.preferred_conn_interval_min;     // N * 1.25ms
-		req->intv_max   = con_fsm_params.preferred_conn_interval_max;     // N * 1.25ms
-		req->latency    = con_fsm_params.preferred_conn_latency;          // Conn Events skipped
-		req->time_out   = con_fsm_params.preferred_conn_timeout;          // N * 10ms
+		req->intv_min   = set->intv_min;        // N * 1.25ms
+		req->intv_max   = set->intv_max;        // N * 1.25ms
+		req->latency    = set->latency;         // Conn Events skipped
+		req->time_out   = set->time_out;        // N * 10ms
 #endif        
 		dbg_puts(DBG_FSM_LVL, "Send GAP_PARAM_UPDATE_REQ\r\n");
 		ke_msg_send(req);
@@ -404,8 +431,7 @@ void app_con_fsm_state_update(enum main_fsm_events evt)
         switch(evt) {
         case NO_EVENT:
             if (con_fsm_params.is_normally_connectable) {
-                if (is_bonded && (bond_info.env.auth & GAP_AUTH_BOND)) {
-                    start_adv_directed();
+                if (start_adv_reconnection()) {
                     current_fsm_state = DIRECTED_ADV_ST;
                 } else {
                     current_adv_state = SLOW_ADV;
@@ -427,9 +453,8 @@ void app_con_fsm_state_update(enum main_fsm_events evt)
             }
             break;
         case KEY_PRESS_EVT:
-            if (is_bonded && (bond_info.env.auth & GAP_AUTH_BOND)) {
+            if (start_adv_reconnection()) {
                 current_fsm_state = DIRECTED_ADV_ST;
-                start_adv_directed();
             } else {
                 adv_timer_remaining = con_fsm_params.unbonded_discoverable_timeout / 10;
                 current_adv_state = UNBONDED_ADV;
@@ -509,6 +534,10 @@ void app_con_fsm_state_update(enum main_fsm_events evt)
                 // Timer for sending the CONN_PARAM_UPDATE is set by the caller
                 dbg_puts(DBG_FSM_LVL, "  (+) update params timer\r\n");
                 conn_upd_pending = true;
+                
+                if (con_fsm_params.has_conn_params_manager) {
+                    app_conn_params_reset();
+                }
             }
             
 #ifdef EXTENDED_TIMERS_ON
@@ -522,6 +551,10 @@ void app_con_fsm_state_update(enum main_fsm_events evt)
                 add_host_in_white_list(app_env.peer_addr_type, &app_env.peer_addr, app_alt_peer_get_active_index());
             }
             
+            if (con_fsm_params.has_reconnect_policy) {
+                app_reconnect_used(app_alt_peer_get_active_index());
+            }
+            
             // has the host public /* or static random address */?
             if (   (ADDR_PUBLIC == app_env.peer_addr_type)
                 /*|| ( (app_env.peer_addr_type == ADDR_RAND) && ((app_env.peer_addr.addr[5] & SMPM_ADDR_TYPE_STATIC) == SMPM_ADDR_TYPE_STATIC) )*/ ) {
@@ -561,6 +594,10 @@ void app_con_fsm_state_update(enum main_fsm_events evt)
                 // Timer for sending the CONN_PARAM_UPDATE is set by the caller
                 dbg_puts(DBG_FSM_LVL, "  (+) update params timer\r\n");
                 conn_upd_pending = true;
+                
+                if (con_fsm_params.has_conn_params_manager) {
+                    app_conn_params_reset();
+                }
             }
             
             if (con_fsm_params.has_inactivity_timeout) {
@@ -575,6 +612,10 @@ void app_con_fsm_state_update(enum main_fsm_events evt)
                 add_host_in_white_list(app_env.peer_addr_type, &app_env.peer_addr, app_alt_peer_get_active_index());
             }
             
+            if (con_fsm_params.has_reconnect_policy) {
+                app_reconnect_used(app_alt_peer_get_active_index());
+            }
+            
             // has the host public /* or static random address */?
             if (   (ADDR_PUBLIC == app_env.peer_addr_type) 
                 /*|| ( (app_env.peer_addr_type == ADDR_RAND) && ((app_env.peer_addr.addr[5] & SMPM_ADDR_TYPE_STATIC) == SMPM_ADDR_TYPE_STATIC) )*/ ) {
@@ -656,6 +697,10 @@ void app_con_fsm_state_update(enum main_fsm_events evt)
             }
             break;
         case KEY_PRESS_EVT:
+            if (con_fsm_params.has_conn_params_manager) {
+                app_conn_params_activity(CONN_LOAD_TYPING);
+            }
+            
             if (con_fsm_params.has_inactivity_timeout) {
                 if (spota_on == false) {
                     dbg_puts(DBG_FSM_LVL, "  (!) inactivity timer\r\n");
@@ -703,9 +748,8 @@ void app_con_fsm_state_update(enum main_fsm_events evt)
                 dbg_puts(DBG_CONN_LVL, "(-) params update timer\r\n");
             }
                         
-            if (is_bonded && (bond_info.env.auth & GAP_AUTH_BOND)) {
+            if (start_adv_reconnection()) {
                 current_fsm_state = DIRECTED_ADV_ST;
-                start_adv_directed();
             } else {
                 adv_timer_remaining = con_fsm_params.bonded_discoverable_timeout / 10;
                 current_adv_state = BONDED_ADV;
@@ -716,7 +760,14 @@ void app_con_fsm_state_update(enum main_fsm_events evt)
             
         case TIMER_EXPIRED_EVT:
             if (con_fsm_params.use_pref_conn_params) {
-                send_connection_upd_req();
+                struct conn_params_set set;
+                
+                if (!con_fsm_params.has_conn_params_manager) {
+                    app_conn_params_preferred(&set);
+                    send_connection_upd_req(&set);
+                } else if (app_conn_params_next(&set)) {
+                    send_connection_upd_req(&set);
+                }
                 conn_upd_pending = false;
             } else {
                 ASSERT_WARNING(0);
@@ -782,6 +833,11 @@ void app_con_fsm_state_update(enum main_fsm_events evt)
     case DIRECTED_ADV_ST:
         switch(evt) {
         case TIMER_EXPIRED_EVT:
+            if (con_fsm_params.has_reconnect_policy && app_reconnect_next()) {
+                // next candidate
+                start_adv_directed();
+                break;
+            }
             adv_timer_remaining = con_fsm_params.bonded_discoverable_timeout / 10;
             current_adv_state = BONDED_ADV;
             current_fsm_state = ADVERTISE_ST;
@@ -789,6 +845,9 @@ void app_con_fsm_state_update(enum main_fsm_events evt)
             break;
             
         case CONN_REQ_EVT:
+            if (con_fsm_params.has_reconnect_policy) {
+                app_reconnect_connected();
+            }
             // prepare advertising settings in case connection setup fails
             adv_timer_remaining = con_fsm_params.bonded_discoverable_timeout / 10;
             current_adv_state = BONDED_ADV;
@@ -908,6 +967,10 @@ void app_con_fsm_update_params_rejected_func(uint8_t status)
         // Go to Connected State
         ke_state_set(TASK_APP, APP_CONNECTED);
         app_con_fsm_state_update(CONN_CMP_EVT);
+        
+        if (con_fsm_params.has_conn_params_manager) {
+            app_conn_params_rejected();     // retry with a fallback set later
+        }
     } 
 }
 
@@ -927,6 +990,44 @@ void app_con_fsm_update_params_rejected_func(uint8_t status)
 void app_con_fsm_update_params_complete_func(void)
 {
     app_con_fsm_state_update(CONN_CMP_EVT);
+    
+    if (con_fsm_params.has_conn_params_manager) {
+        app_conn_params_accepted();
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief   Continues the connection with a Host whose resolvable random address does not
+ *          resolve to a bonded Host (a new Host).
+ *
+ * @return  void
+ ****************************************************************************************
+ */
+static void unresolved_host(void)
+{
+    if (con_fsm_params.has_virtual_white_list) {
+        if ((virtual_wlist_policy != ADV_ALLOW_SCAN_ANY_CON_ANY)) {
+            app_disconnect();
+        }
+        else if (con_fsm_params.has_security_request_send) {
+            app_security_start();
+        }
+    }
+    else if (con_fsm_params.has_security_request_send) {
+        app_security_start();
+    }
+}
+
+void app_con_fsm_resolved_host(int entry)
+{
+    multi_bond_resolved_peer_pos = entry + 1;
+
+    if (con_fsm_params.has_virtual_white_list) {
+        if (!lookup_rand_in_virtual_white_list(entry)) {
+            app_disconnect();
+        }
+    }
 }
 
 /**
@@ -1000,29 +1101,38 @@ bool app_con_fsm_connection_func(struct gapc_connection_req_ind const *param)
             
             if (con_fsm_params.has_security_request_send) {
                 if ( (app_env.peer_addr_type == ADDR_RAND) && ((app_env.peer_addr.addr[BD_ADDR_LEN - 1] & 0xC0) == SMPM_ADDR_TYPE_PRIV_RESOLV) ) {
-                    //Resolve address
-                    struct gapm_resolv_addr_cmd *cmd = (struct gapm_resolv_addr_cmd *)KE_MSG_ALLOC_DYN(GAPM_RESOLV_ADDR_CMD, 
-                                    TASK_GAPM, TASK_APP, gapm_resolv_addr_cmd, 
-                                    MAX_BOND_PEER * sizeof(struct gap_sec_key) );
-                    
-                    cmd->operation = GAPM_RESOLV_ADDR; // GAPM requested operation
-                    cmd->nb_key = MAX_BOND_PEER; // Number of provided IRK 
-                    cmd->addr = app_env.peer_addr; // Resolvable random address to solve
-                    if (con_fsm_params.has_nv_rom) {
-                        if (MBOND_LOAD_INFO_AT_INIT == false) {
-                            memcpy(cmd->irk, irk_array.irk, MAX_BOND_PEER * sizeof(struct gap_sec_key)); // Array of IRK used for address resolution (MSB -> LSB)
-                        }
+                    // Only the valid IRKs are tried
+                    const uint8_t nb_key = con_fsm_params.has_nv_rom ? bond_index.nb_irk : 1;
+
+                    int entry = MAX_BOND_PEER;
+
+                    if (con_fsm_params.has_nv_rom && con_fsm_params.has_rpa_cache) {
+                        entry = app_rpa_cache_lookup(&app_env.peer_addr);
+                    }
+
+                    if (entry != MAX_BOND_PEER) {
+                        app_con_fsm_resolved_host(entry);
+                    } else if (nb_key == 0) {
+                        unresolved_host();
+                    } else {
+                        //Resolve address
+                        struct gapm_resolv_addr_cmd *cmd = (struct gapm_resolv_addr_cmd *)KE_MSG_ALLOC_DYN(GAPM_RESOLV_ADDR_CMD, 
+                                        TASK_GAPM, TASK_APP, gapm_resolv_addr_cmd, 
+                                        nb_key * sizeof(struct gap_sec_key) );
                         
-                        if (MBOND_LOAD_INFO_AT_INIT) {
-                            for (int i = 0; i < MAX_BOND_PEER; i++) {
-                                cmd->irk[i] = bond_array[i].irk;
-                            }
+                        cmd->operation = GAPM_RESOLV_ADDR; // GAPM requested operation
+                        cmd->nb_key = nb_key; // Number of provided IRK 
+                        cmd->addr = app_env.peer_addr; // Resolvable random address to solve
+                        if (con_fsm_params.has_nv_rom && con_fsm_params.has_rpa_cache) {
+                            app_rpa_cache_irks(cmd->irk); // The IRKs of the most recently resolved Hosts first
+                        } else if (con_fsm_params.has_nv_rom) {
+                            memcpy(cmd->irk, bond_index.irk, nb_key * sizeof(struct gap_sec_key)); // Array of IRK used for address resolution (MSB -> LSB)
+                        } else {
+                            cmd->irk[0] = bond_info.irk; // Only one member in the "array", the "previous" host, if any.
                         }
-                    } else {
-                        cmd->irk[0] = bond_info.irk; // Only one member in the "array", the "previous" host, if any.
-                    }
 
-                    ke_msg_send(cmd);
+                        ke_msg_send(cmd);
+                    }
                 } else {
                     app_security_start();
                 }
@@ -1654,17 +1764,7 @@ void app_con_fsm_handle_cmp_evt(struct gapm_cmp_evt const *param)
             else
             {
                 // Host address has not been resolved - New Host
-                if (con_fsm_params.has_virtual_white_list) {
-                    if ((virtual_wlist_policy != ADV_ALLOW_SCAN_ANY_CON_ANY)) {
-                        app_disconnect();
-                    }
-                    else if (con_fsm_params.has_security_request_send) {
-                        app_security_start();
-                    }
-                }
-                else if (con_fsm_params.has_security_request_send) {
-                    app_security_start();
-                }
+                unresolved_host();
             }
         }
         break;
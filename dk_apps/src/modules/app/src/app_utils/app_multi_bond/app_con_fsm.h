@@ -370,6 +370,17 @@ enum main_fsm_states app_con_fsm_get_state(void);
  ****************************************************************************************
  */
 void app_con_fsm_handle_cmp_evt(struct gapm_cmp_evt const *param);
+
+/**
+ ****************************************************************************************
+ * @brief Continues the connection with a Host whose resolvable random address resolves
+ *        to a bonded Host.
+ *
+ * @param[in] entry     The entry of the Host in the NV memory
+ ****************************************************************************************
+ */
+void app_con_fsm_resolved_host(int entry);
+
 /**
  ****************************************************************************************
  * @brief   Resets the inactivity timeout
@@ -32,12 +32,12 @@
 
 #include "app_con_fsm_task.h"
 #include "app_con_fsm_debug.h"
+#include "app_rpa_cache.h"
 
 #include "app_utils.h"
 
 extern enum adv_states current_adv_state;
 extern int adv_timer_remaining;
-extern struct bonding_info_ bond_array[MAX_BOND_PEER];
 
 /**
  ****************************************************************************************
@@ -88,34 +88,22 @@ int app_con_fsm_gapm_addr_solved_ind_handler(ke_msg_id_t const msgid,
     int i;
     struct gapm_addr_solved_ind *ind = (struct gapm_addr_solved_ind *)param;
     
-    // The Host has been found! We don't care about the key and the BD address. 
+    // The Host has been found! The BD address is kept in the RPA cache, if used.
     // The entry will be located again when EDIV & RAND are provided.
     
     // Since we have the IRK, we can find the real address
-    if (MBOND_LOAD_INFO_AT_INIT) {
-        for (i = 0; i < MAX_BOND_PEER; i++) {
-            if (!memcmp(&bond_array[i].irk.key[0], &ind->irk.key[0], KEY_LEN)) {
-                multi_bond_resolved_peer_pos = i+1;
-                break;
+    for (i = 0; i < bond_index.nb_irk; i++) {
+        if (!memcmp(&bond_index.irk[i].key[0], &ind->irk.key[0], KEY_LEN)) {
+            if (con_fsm_params.has_rpa_cache) {
+                app_rpa_cache_add(&ind->addr, bond_index.irk_entry[i]);
             }
-        }
-    } else {
-        for (i = 0; i < MAX_BOND_PEER; i++) {
-            if (!memcmp(&irk_array.irk[i].key[0], &ind->irk.key[0], KEY_LEN)) {
-                break;
-            }
-        }
-        
-        if (i != MAX_BOND_PEER) { // found
-            multi_bond_resolved_peer_pos = i+1;
+            app_con_fsm_resolved_host(bond_index.irk_entry[i]);
+            return (KE_MSG_CONSUMED);
         }
     }
     
-    if (con_fsm_params.has_virtual_white_list) {
-        if (!lookup_rand_in_virtual_white_list(multi_bond_resolved_peer_pos-1)) {
-            app_disconnect();
-        }
-    }
+    // an IRK that is no longer in the bond index: multi_bond_resolved_peer_pos is left 0
+    app_con_fsm_resolved_host(-1);
     
     return (KE_MSG_CONSUMED);
 }
@@ -0,0 +1,371 @@
+/**
+****************************************************************************************
+*
+* @file app_conn_params.c
+*
+* @brief Connection parameters manager: picks the connection interval and slave latency
+*        by the activity of the device.
+*
+* The slave may transmit at any connection event, so the interval bounds the delay of
+* the reports. The slave latency bounds the events it has to listen to when it has
+* nothing to send. So the sets keep the interval short and vary the latency: high when
+* idle (the device wakes up every 750ms), lower while typing (240ms, so that the host
+* gets its answers in time), and low or none while motion and voice reports are sent at
+* almost every event.
+*
+* Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+* program includes Confidential, Proprietary Information and is a Trade Secret of
+* Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+* unless authorized in writing. All Rights Reserved.
+*
+* <bluetooth.support@diasemi.com> and contributors.
+*
+****************************************************************************************
+*/
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include "rwble_config.h"
+
+#if (USE_CONNECTION_FSM)
+
+#include <string.h>
+#include "app_api.h"
+#include "app_con_fsm.h"
+#include "app_conn_params.h"
+#include "reg_blecore.h"
+
+extern uint32_t ke_time(void);
+extern bool conn_upd_pending;
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+struct conn_params_env_tag
+{
+    uint16_t last[CONN_LOAD_NB];                    // ke_time() of the last activity
+    uint16_t not_before;                            // ke_time() before which nothing is requested, if gap
+    struct conn_params_set applied;                 // all 0 while the host's parameters are in use
+    struct conn_params_set req;                     // in flight
+    uint8_t next_set[CONN_LOAD_NB];                 // CONN_PARAMS_SETS if all were rejected
+    uint8_t req_load;
+    uint8_t count[CONN_LOAD_NB];                    // activities in a row, up to the burst
+    uint8_t held;                                   // loads that run, one bit each
+    uint8_t rejections;                             // in a row
+    bool gap;                                       // not_before is in force
+};
+
+struct conn_params_env_tag conn_params_env          __attribute__((section("retention_mem_area0"), zero_init));
+
+/// Sets of each load, the preferred first. The first set of CONN_LOAD_TYPING is replaced by
+/// the preferred_conn_* parameters. The last set of each load fits the guidelines of the
+/// most restrictive hosts: a range of 15ms at least, from 11.25ms up, and a latency of 30
+/// at most.
+static const struct conn_params_set conn_params_sets[CONN_LOAD_NB][CONN_PARAMS_SETS] =
+{
+    // CONN_LOAD_IDLE: 750ms, 750ms, up to 930ms between the events the device listens to
+    {{ 6,  6, 99, 300}, {12, 12, 49, 400}, {12, 24, 30, 600}},
+    // CONN_LOAD_TYPING: 240ms, up to 375ms, up to 480ms
+    {{ 6,  6, 31, 200}, { 8, 12, 24, 300}, {12, 24, 15, 300}},
+    // CONN_LOAD_MOTION: 37.5ms, up to 75ms, up to 79ms
+    {{ 6,  6,  4, 200}, { 8, 12,  4, 200}, { 9, 21,  2, 200}},
+    // CONN_LOAD_VOICE: every event
+    {{ 6,  6,  0, 200}, { 8, 12,  0, 200}, { 9, 21,  0, 200}},
+};
+
+static const uint16_t conn_params_hold_time[CONN_LOAD_NB] =
+{
+    0,
+    CONN_PARAMS_TYPING_HOLD,
+    CONN_PARAMS_MOTION_HOLD,
+    CONN_PARAMS_VOICE_HOLD,
+};
+
+static const uint8_t conn_params_burst[CONN_LOAD_NB] =
+{
+    1,
+    CONN_PARAMS_TYPING_BURST,
+    1,
+    1,
+};
+
+/*
+ * LOCAL FUNCTIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief       Gets the kernel time.
+ *
+ * @return      The time in 10ms units, modulo 2^16
+ ****************************************************************************************
+ */
+static uint16_t conn_params_now(void)
+{
+    return (uint16_t)(ke_time() & BLE_GROSSTARGET_MASK);
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Gets the time until a request may be sent.
+ *
+ * @return      The time in 10ms units, 0 if a request may be sent now
+ ****************************************************************************************
+ */
+static uint16_t conn_params_wait(void)
+{
+    int16_t wait;
+
+    if (!conn_params_env.gap) {
+        return 0;
+    }
+
+    // the timer is set for the end of the gap, so it is not read after the time wraps
+    wait = (int16_t)(conn_params_env.not_before - conn_params_now());
+    if (wait <= 0) {
+        conn_params_env.gap = false;
+        return 0;
+    }
+    return wait;
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Gets a set of a load.
+ *
+ * @param[in]   load    The load
+ * @param[in]   idx     The set, 0 for the preferred
+ * @param[out]  set     The parameters
+ ****************************************************************************************
+ */
+static void conn_params_get(int load, int idx, struct conn_params_set *set)
+{
+    if ((load == CONN_LOAD_TYPING) && (idx == 0)) {
+        app_conn_params_preferred(set);
+    } else {
+        *set = conn_params_sets[load][idx];
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Selects the most demanding load that runs or had a burst of activity within
+ *              its hold time.
+ *
+ * @param[out]  expiry  Time until the hold time of the load expires in 10ms units, 0 if
+ *                      it runs or if it is CONN_LOAD_IDLE
+ *
+ * @return      The load
+ ****************************************************************************************
+ */
+static int conn_params_target(uint16_t *expiry)
+{
+    int load;
+    uint16_t elapsed;
+
+    *expiry = 0;
+    for (load = CONN_LOAD_NB - 1; load > CONN_LOAD_IDLE; load--) {
+        if (conn_params_env.held & (1 << load)) {
+            return load;
+        }
+        if (conn_params_env.count[load] >= conn_params_burst[load]) {
+            elapsed = conn_params_now() - conn_params_env.last[load];
+            if (elapsed < conn_params_hold_time[load]) {
+                *expiry = conn_params_hold_time[load] - elapsed;
+                return load;
+            }
+            conn_params_env.count[load] = 0;
+        }
+    }
+    return CONN_LOAD_IDLE;
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Checks if a load needs a request.
+ *
+ * @param[in]   load    The load
+ * @param[out]  set     The set to request
+ *
+ * @return      true, if the set differs from the parameters in use and was not rejected
+ ****************************************************************************************
+ */
+static bool conn_params_wanted(int load, struct conn_params_set *set)
+{
+    if (conn_params_env.next_set[load] >= CONN_PARAMS_SETS) {
+        return false;
+    }
+    conn_params_get(load, conn_params_env.next_set[load], set);
+
+    return memcmp(set, &conn_params_env.applied, sizeof(struct conn_params_set)) != 0;
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Sets APP_CON_FSM_TIMER for the next event: the request of a set, the end
+ *              of the hold time of the load or the end of the gap after a request.
+ *
+ * @param[in]   delay   Wait before a request, in 10ms units
+ ****************************************************************************************
+ */
+static void conn_params_set_timer(uint16_t delay)
+{
+    struct conn_params_set set;
+    uint16_t expiry, wait;
+    int load;
+
+    load = conn_params_target(&expiry);
+    wait = conn_params_wait();
+
+    if (conn_params_wanted(load, &set)) {
+        if (delay < wait) {
+            delay = wait;
+        }
+    } else if (expiry && (!wait || (expiry < wait))) {
+        delay = expiry;
+    } else if (wait) {
+        delay = wait;
+    } else {
+        return;
+    }
+    app_timer_set(APP_CON_FSM_TIMER, TASK_APP, delay);
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Calls conn_params_set_timer() when the device is connected, the first
+ *              request has been sent and no request is in flight.
+ *
+ * @param[in]   delay   Wait before a request, in 10ms units
+ ****************************************************************************************
+ */
+static void conn_params_schedule(uint16_t delay)
+{
+    if (con_fsm_params.has_conn_params_manager && (app_con_fsm_get_state() == CONNECTED_ST)
+        && !conn_upd_pending && (ke_state_get(TASK_APP) == APP_CONNECTED)) {
+        conn_params_set_timer(delay);
+    }
+}
+
+/*
+ * EXPORTED FUNCTIONS
+ ****************************************************************************************
+ */
+
+void app_conn_params_preferred(struct conn_params_set *set)
+{
+    set->intv_min = con_fsm_params.preferred_conn_interval_min;
+    set->intv_max = con_fsm_params.preferred_conn_interval_max;
+    set->latency = con_fsm_params.preferred_conn_latency;
+    set->time_out = con_fsm_params.preferred_conn_timeout;
+}
+
+
+void app_conn_params_reset(void)
+{
+    const uint8_t held = conn_params_env.held;      // voice may be on during a re-pairing
+
+    memset(&conn_params_env, 0, sizeof(conn_params_env));
+    conn_params_env.held = held;
+}
+
+
+void app_conn_params_activity(enum conn_params_load load)
+{
+    const uint16_t now = conn_params_now();
+
+    if ((uint16_t)(now - conn_params_env.last[load]) >= conn_params_hold_time[load]) {
+        conn_params_env.count[load] = 0;
+    }
+    conn_params_env.last[load] = now;
+
+    if (conn_params_env.count[load] < conn_params_burst[load]) {
+        if (++conn_params_env.count[load] == conn_params_burst[load]) {
+            conn_params_schedule(CONN_PARAMS_UPGRADE_DELAY);        // selected from now on
+        }
+    }
+}
+
+
+void app_conn_params_hold(enum conn_params_load load, bool on)
+{
+    const uint8_t bit = 1 << load;
+
+    if (on == !!(conn_params_env.held & bit)) {
+        return;
+    }
+
+    if (on) {
+        conn_params_env.held |= bit;
+    } else {
+        conn_params_env.held &= ~bit;
+        conn_params_env.last[load] = conn_params_now();
+        conn_params_env.count[load] = conn_params_burst[load];
+    }
+    conn_params_schedule(CONN_PARAMS_UPGRADE_DELAY);
+}
+
+
+bool app_conn_params_next(struct conn_params_set *set)
+{
+    uint16_t expiry;
+    int load;
+
+    if (ke_state_get(TASK_APP) == APP_PARAM_UPD) {
+        return false;       // scheduled again at completion
+    }
+
+    load = conn_params_target(&expiry);
+    if (conn_params_wanted(load, set) && (conn_params_wait() == 0)) {
+        conn_params_env.req = *set;
+        conn_params_env.req_load = load;
+        return true;
+    }
+
+    conn_params_set_timer(0);
+    return false;
+}
+
+
+void app_conn_params_accepted(void)
+{
+    conn_params_env.applied = conn_params_env.req;
+    conn_params_env.rejections = 0;
+    conn_params_env.not_before = conn_params_now() + CONN_PARAMS_MIN_GAP;
+    conn_params_env.gap = true;
+    conn_params_schedule(0);
+}
+
+
+void app_conn_params_rejected(void)
+{
+    int shift = conn_params_env.rejections;
+
+    if (shift > CONN_PARAMS_BACKOFF_SHIFT_MAX) {
+        shift = CONN_PARAMS_BACKOFF_SHIFT_MAX;
+    } else {
+        conn_params_env.rejections++;
+    }
+
+    conn_params_env.next_set[conn_params_env.req_load]++;
+    conn_params_env.not_before = conn_params_now() + (CONN_PARAMS_REJECT_BACKOFF << shift);
+    conn_params_env.gap = true;
+    conn_params_schedule(0);
+}
+
+#endif // USE_CONNECTION_FSM
+
+/// @} APP
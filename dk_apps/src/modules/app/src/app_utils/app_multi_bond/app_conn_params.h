@@ -0,0 +1,177 @@
+/**
+****************************************************************************************
+*
+* @file app_conn_params.h
+*
+* @brief Connection parameters manager: picks the connection interval and slave latency
+*        by the activity of the device header file.
+*
+* Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+* program includes Confidential, Proprietary Information and is a Trade Secret of
+* Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+* unless authorized in writing. All Rights Reserved.
+*
+* <bluetooth.support@diasemi.com> and contributors.
+*
+****************************************************************************************
+*/
+
+#ifndef APP_CONN_PARAMS_H_
+#define APP_CONN_PARAMS_H_
+
+/*
+ ****************************************************************************************
+ * USAGE
+ * Used by the connection FSM when con_fsm_params.use_pref_conn_params and
+ * con_fsm_params.has_conn_params_manager are set.
+ *
+ * The application reports its activity: app_conn_params_activity() for the loads made of
+ * events (a key press or release, a motion report) and app_conn_params_hold() for the loads
+ * that run until stopped (voice). A load made of events is selected once they come in a
+ * burst (CONN_PARAMS_TYPING_BURST key events, each within CONN_PARAMS_TYPING_HOLD of the
+ * previous one, so a single key press does not change the parameters) and stays selected
+ * for its hold time after the last one. The most demanding load that is selected or held
+ * selects the set of connection parameters requested from the host:
+ *
+ * - A more demanding load is requested CONN_PARAMS_UPGRADE_DELAY after it starts, so that
+ *   the loads starting together (the voice key press and the voice stream) are requested
+ *   once.
+ * - A less demanding load is requested when the hold time of the current one expires. Short
+ *   pauses (between two key presses, two voice searches) do not cause requests.
+ * - Two requests are CONN_PARAMS_MIN_GAP apart at least.
+ *
+ * Each load has CONN_PARAMS_SETS sets, the preferred first. When the host rejects a set,
+ * the next set of the load is requested after CONN_PARAMS_REJECT_BACKOFF (the
+ * TGAP(conn_param_timeout) of the specification), doubled for each rejection in a row, up
+ * to 4 times as long. The rejected sets are not requested again during the connection. If
+ * all the sets of a load are rejected, the parameters in use are kept while it is selected.
+ *
+ * The first request is sent con_fsm_params.time_to_request_param_upd after the connection,
+ * as before, with the set of the load at that time. The manager uses APP_CON_FSM_TIMER,
+ * which is free in CONNECTED_ST.
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Sets of connection parameters per load: the preferred and the fallbacks
+#define CONN_PARAMS_SETS                (3)
+
+/// Wait before requesting a more demanding load, in 10ms units
+#define CONN_PARAMS_UPGRADE_DELAY       (5)
+/// Minimum time between two requests, in 10ms units
+#define CONN_PARAMS_MIN_GAP             (100)
+/// Wait after a rejection, in 10ms units
+#define CONN_PARAMS_REJECT_BACKOFF      (3000)
+/// The wait after a rejection is doubled up to (1 << CONN_PARAMS_BACKOFF_SHIFT_MAX) times
+#define CONN_PARAMS_BACKOFF_SHIFT_MAX   (2)
+
+/// Hold times after the last activity, in 10ms units
+#define CONN_PARAMS_TYPING_HOLD         (500)
+#define CONN_PARAMS_MOTION_HOLD         (200)
+#define CONN_PARAMS_VOICE_HOLD          (100)
+
+/// Key presses and releases that make a typing burst
+#define CONN_PARAMS_TYPING_BURST        (8)
+
+/// Loads, the least demanding first
+enum conn_params_load
+{
+    CONN_LOAD_IDLE,
+    CONN_LOAD_TYPING,
+    CONN_LOAD_MOTION,
+    CONN_LOAD_VOICE,
+    CONN_LOAD_NB
+};
+
+/// A set of connection parameters
+struct conn_params_set
+{
+    uint16_t intv_min;                  ///< N * 1.25ms
+    uint16_t intv_max;                  ///< N * 1.25ms
+    uint16_t latency;                   ///< Connection Events skipped
+    uint16_t time_out;                  ///< N * 10ms
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief       Gets the preferred connection parameters of the application configuration
+ *              (con_fsm_params.preferred_conn_*).
+ *
+ * @param[out]  set     The parameters
+ ****************************************************************************************
+ */
+void app_conn_params_preferred(struct conn_params_set *set);
+
+/**
+ ****************************************************************************************
+ * @brief       Starts over, when a connection is completed. The host's parameters are in
+ *              use and all the sets may be requested.
+ ****************************************************************************************
+ */
+void app_conn_params_reset(void);
+
+/**
+ ****************************************************************************************
+ * @brief       Reports activity of a load. It is selected after a burst and stays
+ *              selected for its hold time.
+ *
+ * @param[in]   load    The load
+ ****************************************************************************************
+ */
+void app_conn_params_activity(enum conn_params_load load);
+
+/**
+ ****************************************************************************************
+ * @brief       Starts or stops a load. It stays selected while it runs and for its hold
+ *              time after it stops.
+ *
+ * @param[in]   load    The load
+ * @param[in]   on      true, when it starts
+ ****************************************************************************************
+ */
+void app_conn_params_hold(enum conn_params_load load, bool on);
+
+/**
+ ****************************************************************************************
+ * @brief       Called when APP_CON_FSM_TIMER expires in CONNECTED_ST. Gets the set to
+ *              request, or sets the timer for the next change of load.
+ *
+ * @param[out]  set     The set to request
+ *
+ * @return      true, if the set must be requested
+ ****************************************************************************************
+ */
+bool app_conn_params_next(struct conn_params_set *set);
+
+/**
+ ****************************************************************************************
+ * @brief       Called when the host has accepted the requested set.
+ ****************************************************************************************
+ */
+void app_conn_params_accepted(void);
+
+/**
+ ****************************************************************************************
+ * @brief       Called when the host has rejected the requested set.
+ ****************************************************************************************
+ */
+void app_conn_params_rejected(void);
+
+#endif // APP_CONN_PARAMS_H_
@@ -40,11 +40,17 @@
 #include "spi_flash.h"
 #endif
 
+#if (HAS_SPI_FLASH_BOND_LOG)
+#include "app_bond_log.h"
+#endif
+
 #ifdef HAS_I2C_EEPROM_STORAGE
 #include "i2c_eeprom.h"
 #endif
 
 #include "app_multi_bond.h"
+#include "app_reconnect.h"
+#include "app_rpa_cache.h"
 
 /*
  * ROM functions
@@ -70,7 +76,7 @@ uint8_t multi_bond_resolved_peer_pos                __attribute__((section("rete
 
 struct usage_array_ bond_usage                      __attribute__((section("retention_mem_area0"), zero_init));
 
-struct irk_array_ irk_array                         __attribute__((section("retention_mem_area0"), zero_init)); // stored in RetRAM for power saving reasons
+struct bond_index_ bond_index                       __attribute__((section("retention_mem_area0"), zero_init)); // stored in RetRAM for power saving reasons
 struct bonding_info_ bond_array[MAX_BOND_PEER]      __attribute__((section("retention_mem_area0"), zero_init)); // stored in RetRAM for power saving reasons                                                   
 uint8_t force_next_store_entry                      __attribute__((section("retention_mem_area0"), zero_init));                                                   
 uint8_t fallback_peer_entry                         __attribute__((section("retention_mem_area0"), zero_init));
@@ -82,6 +88,24 @@ uint8_t fallback_peer_entry                         __attribute__((section("rete
 
 int attribute_handle;
 
+#if defined(HAS_I2C_EEPROM_STORAGE) && (HAS_I2C_ASYNC)
+/*
+ * The writes to the EEPROM are posted: they are queued as i2c_eeprom jobs, which run
+ * from the I2C interrupt, and the bonding does not wait for the page write cycles.
+ * Up to NV_PROM_WRITE_SMALL bytes are copied. A longer write is sent from the buffer of
+ * the caller, which must stay valid: bond_info, bond_usage and the constants of
+ * clear_eeprom(). Such a buffer is read when its page is sent, so a change made in the
+ * meantime is written, and written again by the write that follows the change.
+ * The reads are queued after the pending writes.
+ */
+#define NV_PROM_WRITE_JOBS          (4)
+#define NV_PROM_WRITE_SMALL         (sizeof(int))
+
+static struct i2c_eeprom_job nv_prom_jobs[NV_PROM_WRITE_JOBS];
+static uint8_t nv_prom_small[NV_PROM_WRITE_JOBS][NV_PROM_WRITE_SMALL];
+static uint8_t nv_prom_next_job;
+#endif
+
 static void clear_eeprom(void);
 static bool alt_pair_read_bond_data_from_nv(struct bonding_info_ *info, uint8_t entry);
 static void nv_prom_init(void);
@@ -90,6 +114,150 @@ static uint32_t nv_prom_read_data(uint8_t *rd_data_ptr, uint32_t address, uint32
 static void nv_prom_write_byte(uint32_t address, uint8_t wr_data);
 static uint32_t nv_prom_write_data(uint8_t *wr_data_ptr, uint32_t address, uint32_t size);
 
+/**
+ ****************************************************************************************
+ * @brief       Hashes a key of the bond index to a bucket.
+ *
+ * @param[in]   data    The key
+ * @param[in]   len     Length of the key
+ * @param[in]   seed    EDIV or address type
+ *
+ * @return      The bucket
+ ****************************************************************************************
+ */
+static uint8_t bond_index_hash(const uint8_t *data, int len, uint16_t seed)
+{
+    uint16_t h = seed;
+
+    while (len--) {
+        h = (h * 31) + *data++;
+    }
+    return (h ^ (h >> 8)) & (BOND_INDEX_BUCKETS - 1);
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Rebuilds the hash tables of the bond index from its entries.
+ *
+ * @return      void
+ ****************************************************************************************
+ */
+static void bond_index_rehash(void)
+{
+    uint8_t i, b;
+
+    memset(bond_index.ltk_bucket, 0, sizeof(bond_index.ltk_bucket));
+    memset(bond_index.addr_bucket, 0, sizeof(bond_index.addr_bucket));
+
+    for (i = 0; i < MAX_BOND_PEER; i++) {
+        if (!(bond_index.valid & (1 << i))) {
+            continue;
+        }
+
+        // linear probing. There are more buckets than entries.
+        b = bond_index_hash(bond_index.rand_nb[i].nb, RAND_NB_LEN, bond_index.ediv[i]);
+        while (bond_index.ltk_bucket[b]) {
+            b = (b + 1) & (BOND_INDEX_BUCKETS - 1);
+        }
+        bond_index.ltk_bucket[b] = i + 1;
+
+        b = bond_index_hash(bond_index.peer_addr[i].addr, BD_ADDR_LEN, bond_index.peer_addr_type[i]);
+        while (bond_index.addr_bucket[b]) {
+            b = (b + 1) & (BOND_INDEX_BUCKETS - 1);
+        }
+        bond_index.addr_bucket[b] = i + 1;
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Updates an entry of the bond index.
+ *
+ * @param[in]   entry   The index to the NV memory bonding entry
+ * @param[in]   info    The bonding info of the entry, NULL if the entry has been deleted
+ *
+ * @return      void
+ ****************************************************************************************
+ */
+static void bond_index_set(int entry, const struct bonding_info_ *info)
+{
+    uint8_t i;
+
+    if (con_fsm_params.has_rpa_cache) {
+        app_rpa_cache_forget(entry);
+    }
+
+    // remove the IRK of the entry, the last IRK takes its place
+    for (i = 0; i < bond_index.nb_irk; i++) {
+        if (bond_index.irk_entry[i] == entry) {
+            bond_index.nb_irk--;
+            bond_index.irk[i] = bond_index.irk[bond_index.nb_irk];
+            bond_index.irk_entry[i] = bond_index.irk_entry[bond_index.nb_irk];
+            break;
+        }
+    }
+
+    if (info && ((info->env.nvds_tag >> 4) == 0x5) && (info->env.auth & GAP_AUTH_BOND)) {
+        bond_index.ediv[entry] = info->env.ediv;
+        bond_index.rand_nb[entry] = info->env.rand_nb;
+        bond_index.peer_addr[entry] = info->env.peer_addr;
+        bond_index.peer_addr_type[entry] = info->env.peer_addr_type;
+        bond_index.valid |= (1 << entry);
+
+        if (info->ext_info & IRK_FLAG) {
+            bond_index.irk[bond_index.nb_irk] = info->irk;
+            bond_index.irk_entry[bond_index.nb_irk] = entry;
+            bond_index.nb_irk++;
+        }
+    } else {
+        bond_index.valid &= ~(1 << entry);
+    }
+
+    bond_index_rehash();
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Finds the bonded entry of an EDIV/RAND pair.
+ *
+ * @return      The index to the NV memory bonding entry, MAX_BOND_PEER if not found
+ ****************************************************************************************
+ */
+static int bond_index_find_ltk(struct rand_nb const *rand_nb, uint16_t ediv)
+{
+    uint8_t b = bond_index_hash(rand_nb->nb, RAND_NB_LEN, ediv);
+    uint8_t n;
+
+    while ((n = bond_index.ltk_bucket[b]) != 0) {
+        if ((bond_index.ediv[n - 1] == ediv) && !memcmp(&bond_index.rand_nb[n - 1], rand_nb, RAND_NB_LEN)) {
+            return n - 1;
+        }
+        b = (b + 1) & (BOND_INDEX_BUCKETS - 1);
+    }
+    return MAX_BOND_PEER;
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Finds the bonded entry of a peer address.
+ *
+ * @return      The index to the NV memory bonding entry, MAX_BOND_PEER if not found
+ ****************************************************************************************
+ */
+static int bond_index_find_addr(uint8_t addr_type, struct bd_addr const *addr)
+{
+    uint8_t b = bond_index_hash(addr->addr, BD_ADDR_LEN, addr_type);
+    uint8_t n;
+
+    while ((n = bond_index.addr_bucket[b]) != 0) {
+        if ((bond_index.peer_addr_type[n - 1] == addr_type) && !memcmp(&bond_index.peer_addr[n - 1], addr, BD_ADDR_LEN)) {
+            return n - 1;
+        }
+        b = (b + 1) & (BOND_INDEX_BUCKETS - 1);
+    }
+    return MAX_BOND_PEER;
+}
+
 /**
  ****************************************************************************************
  * @brief       Refresh usage counters.
@@ -202,40 +370,15 @@ static int get_entry_to_delete(void)
         return ret;
     }
  
-    if (MBOND_LOAD_INFO_AT_INIT) {
-        if (app_env.peer_addr_type == ADDR_PUBLIC) {
-            // Look if there's an older entry for this host (use Public address)
-            for (i = 0; i < MAX_BOND_PEER; i++) {
-                if ((bond_array[i].env.peer_addr_type == ADDR_PUBLIC) && !memcmp(&bond_array[i].env.peer_addr, &app_env.peer_addr, BD_ADDR_LEN)) {
-                    return i;
-                }
-            }
-        } else {
-            if (multi_bond_resolved_peer_pos != 0) { //resolved addresses
-                return (multi_bond_resolved_peer_pos - 1);
-            }
-        }
-    }
-    else { //resolved addresses 
-        if (app_env.peer_addr_type == ADDR_PUBLIC) {
-            // Look if there's an older entry for this host (use Public address)            
-            struct bonding_info_ info;
-            for (i = 0; i < MAX_BOND_PEER; i++) {
-                alt_pair_read_bond_data_from_nv(&info, i);
-                if ( (info.env.peer_addr_type == ADDR_PUBLIC) 
-                   && (!memcmp(&info.env.peer_addr, &app_env.peer_addr, BD_ADDR_LEN)) ) { // no need to check if the entry is valid
-                    break;            
-                }
-            }
-                        
-            if (i != MAX_BOND_PEER) {
-                return i;
-            }
+    if (app_env.peer_addr_type == ADDR_PUBLIC) {
+        // Look if there's an older entry for this host (use Public address)
+        i = bond_index_find_addr(ADDR_PUBLIC, &app_env.peer_addr);
+        if (i != MAX_BOND_PEER) {
+            return i;
         }
-        else { 
-            if (multi_bond_resolved_peer_pos != 0) {
-                return (multi_bond_resolved_peer_pos - 1);
-            }
+    } else {
+        if (multi_bond_resolved_peer_pos != 0) { //resolved addresses
+            return (multi_bond_resolved_peer_pos - 1);
         }
     }
 
@@ -338,6 +481,11 @@ void app_alt_pair_init(void)
         bool flush = false;
         fallback_peer_entry=MAX_BOND_PEER;
 
+        memset(&bond_index, 0, sizeof(struct bond_index_));
+        if (con_fsm_params.has_rpa_cache) {
+            app_rpa_cache_forget(MAX_BOND_PEER);
+        }
+
         /*** Sanity tests ***/
         
         // MAGIC number first
@@ -381,9 +529,7 @@ void app_alt_pair_init(void)
                         if (con_fsm_params.has_white_list || con_fsm_params.has_virtual_white_list) {
                             add_host_in_white_list(info.env.peer_addr_type, &info.env.peer_addr, i);
                         }
-                        if (info.ext_info & IRK_FLAG) {
-                            irk_array.irk[i] = info.irk;
-                        }
+                        bond_index_set(i, &info);
                     }                
                 }
             }
@@ -396,6 +542,7 @@ void app_alt_pair_init(void)
                         if (con_fsm_params.has_white_list || con_fsm_params.has_virtual_white_list) {
                             add_host_in_white_list(info.env.peer_addr_type, &info.env.peer_addr, i);
                         }
+                        bond_index_set(i, &info);
                     }                
                 }
             }
@@ -781,15 +928,15 @@ static void write_bonding_info(int8_t entry)
     int addr = NV_STORAGE_BOND_DATA_ADDR;
     
     addr += entry * sizeof(struct bonding_info_); // offset
-    nv_prom_write_byte((addr + offsetof(struct bonding_info_, env.nvds_tag)), 0); //invalidate
+    if (!HAS_SPI_FLASH_BOND_LOG) {
+        // the log writes the entry as a single record, which is valid only when complete
+        nv_prom_write_byte((addr + offsetof(struct bonding_info_, env.nvds_tag)), 0); //invalidate
+    }
     nv_prom_write_data((uint8_t *)&bond_info, addr, sizeof(struct bonding_info_));
     update_usage_count(entry);
     
-    // Update the IRK array
-    if (MBOND_LOAD_INFO_AT_INIT == false) {
-//        memcpy(&irk_array.irk[multi_bond_active_peer_pos].key[0], &bond_info.irk.key[0], KEY_LEN);
-        irk_array.irk[multi_bond_active_peer_pos] = bond_info.irk;
-    }
+    // Update the index
+    bond_index_set(entry, &bond_info);
 
     // or, update the buffer in RetRAM
     if (MBOND_LOAD_INFO_AT_INIT) {
@@ -848,6 +995,9 @@ void app_alt_pair_store_bond_data(void)
                 
                 entry = get_entry_to_delete();
                 update_active_peer_pos(entry);
+                if (con_fsm_params.has_reconnect_policy) {
+                    app_reconnect_forget(entry);    // a new host
+                }
             
                 prepare_bonding_info(&bond_info);
                 bond_info.env.nvds_tag = 0x50 + entry; // validity flag
@@ -1040,57 +1190,41 @@ void app_alt_pair_update_bond_data(int mask, int pos, int value)
 int app_alt_pair_load_bond_data(struct rand_nb *rand_nb, uint16_t ediv)
 {
     if (con_fsm_params.has_nv_rom) {
-        uint32_t i;
+        const int i = bond_index_find_ltk(rand_nb, ediv);
+        struct bonding_info_ info;
         int retval = 0;
 
+        if (i == MAX_BOND_PEER) {
+            return 0;
+        }
+
+        nv_prom_init();
+
         if (MBOND_LOAD_INFO_AT_INIT) {
             //Read buffer in RetRAM
-            nv_prom_init();
-        
-            for (i = 0; i < MAX_BOND_PEER; i++) {   
-                if ( ( (bond_array[i].env.nvds_tag >> 4) == 0x5) && (bond_array[i].env.ediv == ediv) && (!memcmp(rand_nb, &bond_array[i].env.rand_nb, RAND_NB_LEN))
-                            && (bond_array[i].env.auth & GAP_AUTH_BOND)) {
-                    if ( (bond_info.env.ediv == ediv) && (!memcmp(rand_nb, &bond_info.env.rand_nb, RAND_NB_LEN))
-                          && (bond_info.env.auth & GAP_AUTH_BOND) ) {
-                        retval = 2;
-                    } else {
-                        retval = 1;
-                    }
-                    bond_info = bond_array[i];  // use memcpy instead???
-                    update_active_peer_pos(i);
-                    update_usage_count(i);
-                    updatedb_from_bonding_info(&bond_info);
-                    break; 
-                }
-            }
+            info = bond_array[i];
+        } else if (!alt_pair_read_bond_data_from_nv(&info, i)) {
+            // Read NV memory. The index is built from it, so this should not fail.
+            ASSERT_WARNING(0);
             nv_prom_release();
-
-            return retval;
+            return 0;
         }
-        else
-        {   
-            // Read NV memory
-            struct bonding_info_ info;
 
-            nv_prom_init();
-            for (i = 0; i < MAX_BOND_PEER; i++) {
-                if ( alt_pair_read_bond_data_from_nv(&info, i) && (info.env.ediv == ediv) && (!memcmp(rand_nb, &info.env.rand_nb, RAND_NB_LEN))
-                     && (info.env.auth & GAP_AUTH_BOND)) {
-                    if ( (bond_info.env.ediv == ediv) && (!memcmp(rand_nb, &bond_info.env.rand_nb, RAND_NB_LEN))
-                          && (bond_info.env.auth & GAP_AUTH_BOND) ) {
-                        retval = 2;
-                    } else {
-                        retval = 1;
-                    }
-                    bond_info = info;
-                    update_active_peer_pos(i);
-                    update_usage_count(i);
-                    break; 
-                }
-            }
-            nv_prom_release();
-            return retval;
+        if ( (bond_info.env.ediv == ediv) && (!memcmp(rand_nb, &bond_info.env.rand_nb, RAND_NB_LEN))
+              && (bond_info.env.auth & GAP_AUTH_BOND) ) {
+            retval = 2;
+        } else {
+            retval = 1;
         }
+        bond_info = info;
+        update_active_peer_pos(i);
+        update_usage_count(i);
+        if (MBOND_LOAD_INFO_AT_INIT) {
+            updatedb_from_bonding_info(&bond_info);
+        }
+        nv_prom_release();
+
+        return retval;
     }
     else {
         return 0;
@@ -1402,7 +1536,11 @@ void app_alt_pair_delete_entry(int8_t entry)
     ASSERT_WARNING( ((entry >= 0) && (entry < MAX_BOND_PEER)) );
     
     if (con_fsm_params.has_nv_rom) {
-        int addr;
+        int addr = NV_STORAGE_BOND_DATA_ADDR + entry * sizeof(struct bonding_info_);
+        
+        if (con_fsm_params.has_reconnect_policy) {
+            app_reconnect_forget(entry);
+        }
         
         // Update usage counters
         if (con_fsm_params.has_usage_counters) {
@@ -1444,10 +1582,8 @@ void app_alt_pair_delete_entry(int8_t entry)
 
         nv_prom_release();
 
-        // Update the IRK array
-        if (MBOND_LOAD_INFO_AT_INIT == false) {
-            memset(&irk_array.irk[entry].key[0], 0, KEY_LEN);
-        }
+        // Update the index
+        bond_index_set(entry, NULL);
         
         // or, update the buffer in RetRAM
         if (MBOND_LOAD_INFO_AT_INIT) {
@@ -1478,16 +1614,23 @@ static void clear_eeprom(void)
     int i;
     int magic;
     
-    uint8_t zero_data[32] = {0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,
+    static const uint8_t zero_data[32] = {0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,
                              0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,
                              0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,
                              0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0};
-    uint32_t addr = NV_STORAGE_BASE_ADDR;
                                     
-    for (i = 0; i < (NV_STORAGE_BOND_SIZE / 32); i++) {
-        nv_prom_write_data( zero_data, addr, 32);
+#if (HAS_SPI_FLASH_BOND_LOG)
+    // if the log cannot start over in a new sector, zeros are appended to the active one
+    if (!app_bond_log_format())
+#endif
+    {
+        uint32_t addr = NV_STORAGE_BASE_ADDR;
+
+        for (i = 0; i < (NV_STORAGE_BOND_SIZE / 32); i++) {
+            nv_prom_write_data((uint8_t *)zero_data, addr, 32);
 
-        addr += 32;
+            addr += 32;
+        }
     }
     multi_bond_status = 0;
 
@@ -1524,8 +1667,9 @@ static void clear_eeprom(void)
     if (con_fsm_params.has_usage_counters) {
         memset(&bond_usage, 0, sizeof(struct usage_array_));
     }
-    if (MBOND_LOAD_INFO_AT_INIT == false) {
-        memset(&irk_array, 0, sizeof(struct irk_array_));
+    memset(&bond_index, 0, sizeof(struct bond_index_));
+    if (con_fsm_params.has_rpa_cache) {
+        app_rpa_cache_forget(MAX_BOND_PEER);
     }
 
     if (MBOND_LOAD_INFO_AT_INIT) {
@@ -1558,6 +1702,9 @@ void app_alt_pair_clear_all_bond_data(void)
     multi_bond_active_peer_pos=MAX_BOND_PEER;
     fallback_peer_entry=MAX_BOND_PEER;
     clear_white_list();
+    if (con_fsm_params.has_reconnect_policy) {
+        app_reconnect_forget(MAX_BOND_PEER);
+    }
 
     app_con_fsm_request_disconnect(MULTI_BOND_REJECT_NONE);  // do not reject known hosts
 
@@ -1629,6 +1776,9 @@ static void nv_prom_init(void)
 static void nv_prom_release(void)
 {
     if (con_fsm_params.has_nv_rom) {
+    #if (HAS_SPI_FLASH_BOND_LOG)
+        app_bond_log_release();
+    #endif
     #ifdef HAS_SPI_FLASH_STORAGE
         app_spi_flash_peripheral_release();
     #endif
@@ -1639,10 +1789,51 @@ static void nv_prom_release(void)
     }
 }
 
+#if defined(HAS_I2C_EEPROM_STORAGE) && (HAS_I2C_ASYNC)
+/**
+ ****************************************************************************************
+ * @brief Queues a write to the EEPROM. Waits only if NV_PROM_WRITE_JOBS writes are
+ *        already queued.
+ *
+ * @param[in]   data: pointer to the data, copied up to NV_PROM_WRITE_SMALL bytes
+ * @param[in]   address: the address in the EEPROM
+ * @param[in]   size: the amount of data to write
+ *
+ * @return      Amount of data queued
+ ****************************************************************************************
+ */
+static uint32_t nv_prom_post_write(uint8_t *data, uint32_t address, uint32_t size)
+{
+    struct i2c_eeprom_job *job = &nv_prom_jobs[nv_prom_next_job];
+    uint8_t *small = nv_prom_small[nv_prom_next_job];
+
+    // the jobs are used in turn: this one is the oldest
+    if (job->data) {
+        i2c_eeprom_wait(job);
+    }
+    nv_prom_next_job = (nv_prom_next_job + 1) % NV_PROM_WRITE_JOBS;
+
+    if (size <= NV_PROM_WRITE_SMALL) {
+        memcpy(small, data, size);
+        data = small;
+    }
+    memset(job, 0, sizeof(struct i2c_eeprom_job));
+    job->data = data;
+    job->address = address;
+    job->size = size;
+    job->write = true;
+    i2c_eeprom_submit(job);
+
+    return job->size;
+}
+#endif
+
 static uint32_t nv_prom_read_data(uint8_t *rd_data_ptr, uint32_t address, uint32_t size) 
 {
     if (con_fsm_params.has_nv_rom) {
-        #ifdef HAS_SPI_FLASH_STORAGE
+        #if (HAS_SPI_FLASH_BOND_LOG)
+           return app_bond_log_read(rd_data_ptr, address, size);
+        #elif defined(HAS_SPI_FLASH_STORAGE)
            return spi_flash_read_data(rd_data_ptr, address, size);
         #endif
 
@@ -1669,12 +1860,16 @@ static uint32_t nv_prom_read_data(uint8_t *rd_data_ptr, uint32_t address, uint32
 static void nv_prom_write_byte(uint32_t address, uint8_t data)
 {
     if (con_fsm_params.has_nv_rom) {
-    #ifdef HAS_SPI_FLASH_STORAGE
+    #if (HAS_SPI_FLASH_BOND_LOG)
+       app_bond_log_write(&data, address, sizeof(uint8_t));
+    #elif defined(HAS_SPI_FLASH_STORAGE)
        app_spi_flash_write_random_page_data(&data, address, sizeof(uint8_t));
     #endif
         
-    #ifdef HAS_I2C_EEPROM_STORAGE
-       i2c_eeprom_write_byte(address, wr_data);
+    #if defined(HAS_I2C_EEPROM_STORAGE) && (HAS_I2C_ASYNC)
+       nv_prom_post_write(&data, address, sizeof(uint8_t));
+    #elif defined(HAS_I2C_EEPROM_STORAGE)
+       i2c_eeprom_write_byte(address, data);
     #endif
     }
 }
@@ -1694,11 +1889,15 @@ static uint32_t nv_prom_write_data(uint8_t *wr_data_ptr, uint32_t address, uint3
 {
     if (con_fsm_params.has_nv_rom) {
 
-    #ifdef HAS_SPI_FLASH_STORAGE
+    #if (HAS_SPI_FLASH_BOND_LOG)
+       return app_bond_log_write(wr_data_ptr, address, size);
+    #elif defined(HAS_SPI_FLASH_STORAGE)
        return app_spi_flash_write_random_page_data(wr_data_ptr, address, size);
     #endif
         
-    #ifdef HAS_I2C_EEPROM_STORAGE
+    #if defined(HAS_I2C_EEPROM_STORAGE) && (HAS_I2C_ASYNC)
+       return nv_prom_post_write(wr_data_ptr, address, size);
+    #elif defined(HAS_I2C_EEPROM_STORAGE)
        return i2c_eeprom_write_data(wr_data_ptr, address, size);
     #endif
     }
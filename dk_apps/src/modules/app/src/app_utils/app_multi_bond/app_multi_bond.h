@@ -209,8 +209,35 @@ struct usage_array_
     uint8_t pos[MAX_BOND_PEER];
 };
 
-struct irk_array_
+// Buckets of the hash tables of the bond index: a power of 2, at least twice MAX_BOND_PEER,
+// so that a probe always ends on an empty bucket
+#if (MAX_BOND_PEER <= 4)
+#define BOND_INDEX_BUCKETS      (8)
+#else
+#define BOND_INDEX_BUCKETS      (16)
+#endif
+
+// The entries are bits of bond_index.valid (and of multi_bond_status)
+#if (MAX_BOND_PEER > 8)
+#error "The bond index supports up to 8 bonds (MAX_BOND_PEER)"
+#endif
+
+/*
+ * Index of the bonded entries, built by app_alt_pair_init(). It finds the entry of an EDIV/RAND
+ * pair or of a peer address without walking the entries (or reading the NV memory) and keeps
+ * the valid IRKs contiguous for the resolution of random addresses.
+ */
+struct bond_index_
 {
+    uint16_t ediv[MAX_BOND_PEER];
+    struct rand_nb rand_nb[MAX_BOND_PEER];
+    struct bd_addr peer_addr[MAX_BOND_PEER];
+    uint8_t peer_addr_type[MAX_BOND_PEER];
+    uint8_t valid;                                  // bit n: entry n is bonded and indexed
+    uint8_t ltk_bucket[BOND_INDEX_BUCKETS];         // EDIV/RAND hash table: entry + 1, 0 if empty
+    uint8_t addr_bucket[BOND_INDEX_BUCKETS];        // peer address hash table: entry + 1, 0 if empty
+    uint8_t nb_irk;
+    uint8_t irk_entry[MAX_BOND_PEER];               // entry of each IRK
     struct gap_sec_key irk[MAX_BOND_PEER];
 };
 
@@ -230,7 +257,7 @@ extern uint8_t multi_bond_resolved_peer_pos;
 
 extern struct usage_array_ bond_usage;
 
-extern struct irk_array_ irk_array;
+extern struct bond_index_ bond_index;
 
 extern const struct notification_info_ notification_info[ENUM_NTF_INFO_POS_END];
 /*
@@ -0,0 +1,282 @@
+/**
+****************************************************************************************
+*
+* @file app_reconnect.c
+*
+* @brief Reconnection policy: directed advertising to the bonded hosts most likely to
+*        reconnect.
+*
+* A host is scored with the share of its directed advertising bursts that ended in a
+* connection (1 success in 2 bursts is assumed for a new host) minus
+* RECONNECT_RECENCY_WEIGHT for every host connected after it. So the last host comes
+* first, unless it has stopped answering and another host does.
+*
+* Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+* program includes Confidential, Proprietary Information and is a Trade Secret of
+* Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+* unless authorized in writing. All Rights Reserved.
+*
+* <bluetooth.support@diasemi.com> and contributors.
+*
+****************************************************************************************
+*/
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include "rwble_config.h"
+
+#if (USE_CONNECTION_FSM)
+
+#include <string.h>
+#include "app_api.h"
+#include "app_con_fsm.h"
+#include "app_multi_bond.h"
+#include "app_reconnect.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+struct reconnect_env_tag
+{
+    uint8_t mru[MAX_BOND_PEER];                     // entry + 1, the most recently connected first; 0 if empty
+    uint8_t attempts[MAX_BOND_PEER];                // directed advertising bursts
+    uint8_t successes[MAX_BOND_PEER];               // bursts that ended in a connection
+    uint8_t cand[RECONNECT_CANDIDATES];             // the candidates, the best first
+    uint8_t nb_cand;
+    uint8_t cur;                                    // candidate of the burst in progress
+    uint8_t round;
+};
+
+struct reconnect_env_tag reconnect_env              __attribute__((section("retention_mem_area0"), zero_init));
+
+/*
+ * LOCAL FUNCTIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief       Gets the position of an entry in the MRU list.
+ *
+ * @param[in]   entry   The entry
+ *
+ * @return      0 for the most recently connected host, MAX_BOND_PEER if not in the list
+ ****************************************************************************************
+ */
+static int reconnect_mru_pos(int entry)
+{
+    int i;
+
+    for (i = 0; i < MAX_BOND_PEER; i++) {
+        if (reconnect_env.mru[i] == (entry + 1)) {
+            break;
+        }
+    }
+    return i;
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Removes an entry from the MRU list.
+ *
+ * @param[in]   entry   The entry
+ ****************************************************************************************
+ */
+static void reconnect_mru_remove(int entry)
+{
+    int i;
+
+    for (i = reconnect_mru_pos(entry); i < (MAX_BOND_PEER - 1); i++) {
+        reconnect_env.mru[i] = reconnect_env.mru[i + 1];
+    }
+    if (i == (MAX_BOND_PEER - 1)) {
+        reconnect_env.mru[i] = 0;
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Scores a host.
+ *
+ * @param[in]   entry   Its entry
+ *
+ * @return      The score, the higher the better
+ ****************************************************************************************
+ */
+static int reconnect_score(int entry)
+{
+    int rate = (RECONNECT_RATE_SCALE * (reconnect_env.successes[entry] + 1)) / (reconnect_env.attempts[entry] + 2);
+
+    return rate - (RECONNECT_RECENCY_WEIGHT * reconnect_mru_pos(entry));
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Counts a directed advertising burst to the current candidate.
+ *
+ * @param[in]   success     true, if the host connected
+ ****************************************************************************************
+ */
+static void reconnect_account(bool success)
+{
+    const int entry = reconnect_env.cand[reconnect_env.cur];
+
+    if (reconnect_env.attempts[entry] >= RECONNECT_MAX_ATTEMPTS) {
+        reconnect_env.attempts[entry] /= 2;
+        reconnect_env.successes[entry] /= 2;
+    }
+    reconnect_env.attempts[entry]++;
+    if (success) {
+        reconnect_env.successes[entry]++;
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Loads the bonding info of the current candidate into bond_info. Drops the
+ *              candidates that cannot be read.
+ *
+ * @return      true, if a candidate was loaded
+ ****************************************************************************************
+ */
+static bool reconnect_load(void)
+{
+    int i;
+
+    while (reconnect_env.cur < reconnect_env.nb_cand) {
+        const int entry = reconnect_env.cand[reconnect_env.cur];
+
+        if ((entry == app_alt_peer_get_active_index()) || app_alt_pair_load_entry(entry)) {
+            return true;
+        }
+
+        reconnect_env.nb_cand--;
+        for (i = reconnect_env.cur; i < reconnect_env.nb_cand; i++) {
+            reconnect_env.cand[i] = reconnect_env.cand[i + 1];
+        }
+    }
+    return false;
+}
+
+/*
+ * EXPORTED FUNCTIONS
+ ****************************************************************************************
+ */
+
+bool app_reconnect_start(void)
+{
+    int i, j, entry, score;
+    int scores[RECONNECT_CANDIDATES];
+
+    reconnect_env.nb_cand = 0;
+    reconnect_env.cur = 0;
+    reconnect_env.round = 0;
+
+    if (!con_fsm_params.has_nv_rom) {
+        return false;
+    }
+
+    // after a reset, the last used host (app_alt_pair_load_last_used()) comes first
+    entry = app_alt_peer_get_active_index();
+    if ((reconnect_env.mru[0] == 0) && (entry != MAX_BOND_PEER)) {
+        reconnect_env.mru[0] = entry + 1;
+    }
+
+    // keep the best RECONNECT_CANDIDATES hosts, sorted
+    for (entry = 0; entry < MAX_BOND_PEER; entry++) {
+        if (!(bond_index.valid & (1 << entry)) || (bond_index.peer_addr_type[entry] != ADDR_PUBLIC)) {
+            continue;       // directed advertising needs the address of the host
+        }
+
+        score = reconnect_score(entry);
+        for (i = reconnect_env.nb_cand; (i > 0) && (scores[i - 1] < score); i--)
+            ;
+        if (i == RECONNECT_CANDIDATES) {
+            continue;
+        }
+
+        if (reconnect_env.nb_cand < RECONNECT_CANDIDATES) {
+            reconnect_env.nb_cand++;
+        }
+        for (j = reconnect_env.nb_cand - 1; j > i; j--) {
+            reconnect_env.cand[j] = reconnect_env.cand[j - 1];
+            scores[j] = scores[j - 1];
+        }
+        reconnect_env.cand[i] = entry;
+        scores[i] = score;
+    }
+
+    return reconnect_load();
+}
+
+
+bool app_reconnect_next(void)
+{
+    if (reconnect_env.cur >= reconnect_env.nb_cand) {
+        return false;
+    }
+
+    reconnect_account(false);
+
+    if (++reconnect_env.cur == reconnect_env.nb_cand) {
+        if (++reconnect_env.round == RECONNECT_ROUNDS) {
+            return false;
+        }
+        reconnect_env.cur = 0;
+    }
+    return reconnect_load();
+}
+
+
+void app_reconnect_connected(void)
+{
+    if (reconnect_env.cur < reconnect_env.nb_cand) {
+        reconnect_account(true);
+        reconnect_env.nb_cand = 0;
+    }
+}
+
+
+void app_reconnect_used(int entry)
+{
+    int i;
+
+    if ((entry < 0) || (entry >= MAX_BOND_PEER)) {
+        return;
+    }
+
+    reconnect_mru_remove(entry);
+    for (i = MAX_BOND_PEER - 1; i > 0; i--) {
+        reconnect_env.mru[i] = reconnect_env.mru[i - 1];
+    }
+    reconnect_env.mru[0] = entry + 1;
+}
+
+
+void app_reconnect_forget(int entry)
+{
+    if (entry == MAX_BOND_PEER) {
+        memset(&reconnect_env, 0, sizeof(reconnect_env));
+        return;
+    }
+
+    reconnect_mru_remove(entry);
+    reconnect_env.attempts[entry] = 0;
+    reconnect_env.successes[entry] = 0;
+}
+
+#endif // USE_CONNECTION_FSM
+
+/// @} APP
@@ -0,0 +1,119 @@
+/**
+****************************************************************************************
+*
+* @file app_reconnect.h
+*
+* @brief Reconnection policy: directed advertising to the bonded hosts most likely to
+*        reconnect header file.
+*
+* Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+* program includes Confidential, Proprietary Information and is a Trade Secret of
+* Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+* unless authorized in writing. All Rights Reserved.
+*
+* <bluetooth.support@diasemi.com> and contributors.
+*
+****************************************************************************************
+*/
+
+#ifndef APP_RECONNECT_H_
+#define APP_RECONNECT_H_
+
+/*
+ ****************************************************************************************
+ * USAGE
+ * Used by the connection FSM when con_fsm_params.has_reconnect_policy is set.
+ *
+ * When the device starts directed advertising (disconnection, or key press in IDLE_ST),
+ * app_reconnect_start() ranks the bonded hosts with a public address by how recently they
+ * were connected and by the share of the directed advertising bursts to them that ended
+ * in a connection. The RECONNECT_CANDIDATES best ones get a high duty directed burst
+ * (1.28s) each, in turn, for RECONNECT_ROUNDS rounds. The FSM falls back to undirected
+ * advertising (with the virtual white list) after the last burst.
+ *
+ * The statistics are kept in the retention RAM and start over after a reset.
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Hosts that get a directed advertising burst
+#ifndef RECONNECT_CANDIDATES
+#define RECONNECT_CANDIDATES            (3)
+#endif
+
+/// Bursts to each candidate before falling back to undirected advertising
+#ifndef RECONNECT_ROUNDS
+#define RECONNECT_ROUNDS                (2)
+#endif
+
+/// Score of a host that always reconnects. The share of successful bursts is scaled to it.
+#define RECONNECT_RATE_SCALE            (64)
+/// Score lost for each host connected more recently
+#define RECONNECT_RECENCY_WEIGHT        (16)
+/// The counts of bursts and successes of a host are halved when it reaches this many bursts
+#define RECONNECT_MAX_ATTEMPTS          (16)
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief       Ranks the bonded hosts and loads the bonding info of the best one into
+ *              bond_info, for start_adv_directed().
+ *
+ * @return      true, if there is a candidate
+ ****************************************************************************************
+ */
+bool app_reconnect_start(void);
+
+/**
+ ****************************************************************************************
+ * @brief       Called when a directed advertising burst times out. Counts it as failed
+ *              and loads the bonding info of the next candidate.
+ *
+ * @return      true, if the next burst must start, false to fall back to undirected
+ *              advertising
+ ****************************************************************************************
+ */
+bool app_reconnect_next(void);
+
+/**
+ ****************************************************************************************
+ * @brief       Called when the host of the current directed advertising burst connects.
+ ****************************************************************************************
+ */
+void app_reconnect_connected(void);
+
+/**
+ ****************************************************************************************
+ * @brief       Marks a bonded host as the most recently connected.
+ *
+ * @param[in]   entry   Its entry in the NV memory
+ ****************************************************************************************
+ */
+void app_reconnect_used(int entry);
+
+/**
+ ****************************************************************************************
+ * @brief       Clears the statistics of an entry, when it is deleted or given to a new host.
+ *
+ * @param[in]   entry   The entry in the NV memory, MAX_BOND_PEER for all of them
+ ****************************************************************************************
+ */
+void app_reconnect_forget(int entry);
+
+#endif // APP_RECONNECT_H_
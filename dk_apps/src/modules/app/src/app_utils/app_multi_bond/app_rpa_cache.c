@@ -0,0 +1,207 @@
+/**
+****************************************************************************************
+*
+* @file app_rpa_cache.c
+*
+* @brief Resolvable private address cache: the addresses of the bonded hosts resolved
+*        recently and the order in which their IRKs are tried.
+*
+* A hit costs a compare of 6 bytes per cached address instead of one AES operation per
+* IRK tried, each one a command to the link layer and back. A miss costs as many AES
+* operations as hosts resolved since the last connection of the host, plus one.
+*
+* Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+* program includes Confidential, Proprietary Information and is a Trade Secret of
+* Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+* unless authorized in writing. All Rights Reserved.
+*
+* <bluetooth.support@diasemi.com> and contributors.
+*
+****************************************************************************************
+*/
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include "rwble_config.h"
+
+#if (USE_CONNECTION_FSM)
+
+#include <string.h>
+#include "app_api.h"
+#include "app_con_fsm.h"
+#include "app_multi_bond.h"
+#include "app_rpa_cache.h"
+#include "lld_evt.h"
+#include "reg_blecore.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+struct rpa_cache_slot
+{
+    struct bd_addr addr;
+    uint8_t entry;                                  // entry + 1, 0 if empty
+    uint32_t time;                                  // base time of the resolution
+};
+
+struct rpa_cache_env_tag
+{
+    struct rpa_cache_slot slot[RPA_CACHE_SIZE];
+    uint8_t mru[MAX_BOND_PEER];                     // entry + 1, the most recently resolved first; 0 if empty
+};
+
+struct rpa_cache_env_tag rpa_cache_env              __attribute__((section("retention_mem_area0"), zero_init));
+
+/*
+ * LOCAL FUNCTIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief       Gets the time elapsed since a slot was filled.
+ *
+ * @return      The time in slots. A base time that went back (after a reset of the BLE
+ *              core) gives a value above RPA_CACHE_TIMEOUT.
+ ****************************************************************************************
+ */
+static uint32_t rpa_cache_age(struct rpa_cache_slot const *slot)
+{
+    return (lld_evt_time_get() - slot->time) & BLE_BASETIMECNT_MASK;
+}
+
+/**
+ ****************************************************************************************
+ * @brief       Removes an entry from the MRU list.
+ *
+ * @param[in]   entry   The entry
+ ****************************************************************************************
+ */
+static void rpa_cache_mru_remove(int entry)
+{
+    int i, j;
+
+    for (i = 0, j = 0; i < MAX_BOND_PEER; i++) {
+        if (rpa_cache_env.mru[i] != (entry + 1)) {
+            rpa_cache_env.mru[j++] = rpa_cache_env.mru[i];
+        }
+    }
+    for (; j < MAX_BOND_PEER; j++) {
+        rpa_cache_env.mru[j] = 0;
+    }
+}
+
+/*
+ * EXPORTED FUNCTIONS
+ ****************************************************************************************
+ */
+
+int app_rpa_cache_lookup(struct bd_addr const *addr)
+{
+    int i;
+
+    for (i = 0; i < RPA_CACHE_SIZE; i++) {
+        struct rpa_cache_slot *slot = &rpa_cache_env.slot[i];
+
+        if (slot->entry && !memcmp(&slot->addr, addr, sizeof(struct bd_addr))) {
+            if (rpa_cache_age(slot) < RPA_CACHE_TIMEOUT) {
+                return slot->entry - 1;
+            }
+            slot->entry = 0;
+            break;
+        }
+    }
+    return MAX_BOND_PEER;
+}
+
+
+void app_rpa_cache_irks(struct gap_sec_key *irk)
+{
+    int i, j, n = 0;
+    uint8_t done = 0;                               // IRKs copied, one bit each
+
+    for (i = 0; (i < MAX_BOND_PEER) && rpa_cache_env.mru[i]; i++) {
+        for (j = 0; j < bond_index.nb_irk; j++) {
+            if (bond_index.irk_entry[j] == (rpa_cache_env.mru[i] - 1)) {
+                irk[n++] = bond_index.irk[j];
+                done |= (1 << j);
+                break;
+            }
+        }
+    }
+
+    for (j = 0; j < bond_index.nb_irk; j++) {
+        if (!(done & (1 << j))) {
+            irk[n++] = bond_index.irk[j];
+        }
+    }
+}
+
+
+void app_rpa_cache_add(struct bd_addr const *addr, int entry)
+{
+    int i, slot = 0;
+
+    if ((entry < 0) || (entry >= MAX_BOND_PEER)) {
+        return;
+    }
+
+    // the slot of the address, or else an empty slot, or else the oldest one
+    for (i = 0; i < RPA_CACHE_SIZE; i++) {
+        if (!rpa_cache_env.slot[i].entry) {
+            slot = i;
+            continue;
+        }
+        if (!memcmp(&rpa_cache_env.slot[i].addr, addr, sizeof(struct bd_addr))) {
+            slot = i;
+            break;
+        }
+        if (rpa_cache_env.slot[slot].entry && (rpa_cache_age(&rpa_cache_env.slot[i]) > rpa_cache_age(&rpa_cache_env.slot[slot]))) {
+            slot = i;
+        }
+    }
+
+    rpa_cache_env.slot[slot].addr = *addr;
+    rpa_cache_env.slot[slot].entry = entry + 1;
+    rpa_cache_env.slot[slot].time = lld_evt_time_get();
+
+    rpa_cache_mru_remove(entry);
+    for (i = MAX_BOND_PEER - 1; i > 0; i--) {
+        rpa_cache_env.mru[i] = rpa_cache_env.mru[i - 1];
+    }
+    rpa_cache_env.mru[0] = entry + 1;
+}
+
+
+void app_rpa_cache_forget(int entry)
+{
+    int i;
+
+    if (entry == MAX_BOND_PEER) {
+        memset(&rpa_cache_env, 0, sizeof(rpa_cache_env));
+        return;
+    }
+
+    for (i = 0; i < RPA_CACHE_SIZE; i++) {
+        if (rpa_cache_env.slot[i].entry == (entry + 1)) {
+            rpa_cache_env.slot[i].entry = 0;
+        }
+    }
+    rpa_cache_mru_remove(entry);
+}
+
+#endif // USE_CONNECTION_FSM
+
+/// @} APP
@@ -0,0 +1,124 @@
+/**
+****************************************************************************************
+*
+* @file app_rpa_cache.h
+*
+* @brief Resolvable private address cache: the addresses of the bonded hosts resolved
+*        recently and the order in which their IRKs are tried header file.
+*
+* Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+* program includes Confidential, Proprietary Information and is a Trade Secret of
+* Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+* unless authorized in writing. All Rights Reserved.
+*
+* <bluetooth.support@diasemi.com> and contributors.
+*
+****************************************************************************************
+*/
+
+#ifndef APP_RPA_CACHE_H_
+#define APP_RPA_CACHE_H_
+
+/*
+ ****************************************************************************************
+ * USAGE
+ * Used by the connection FSM when con_fsm_params.has_rpa_cache and
+ * con_fsm_params.has_nv_rom are set.
+ *
+ * Without the cache, each connection from a resolvable private address sends all the
+ * stored IRKs to the GAPM (GAPM_RESOLV_ADDR_CMD), which tries them in turn with an AES
+ * operation each until one matches. With it:
+ * - app_rpa_cache_lookup() is called first. A host keeps its address for
+ *   TGAP(private_addr_int), so a host that reconnects within that time is found without
+ *   any AES operation.
+ * - Otherwise app_rpa_cache_irks() gives the IRKs of the most recently resolved hosts
+ *   first, so the host that connected last costs one AES operation, the one before it
+ *   two, etc.
+ * - app_rpa_cache_add() records each resolved address and moves its host to the front.
+ *
+ * An address is kept for RPA_CACHE_TIMEOUT after it was resolved, the default
+ * TGAP(private_addr_int): the host has moved to a new one by then. Since an address
+ * resolves with one IRK only, an older address would still be right, but no longer
+ * used. The addresses and the order of an entry are dropped when the entry is written
+ * or deleted (app_rpa_cache_forget()), so they never point to another host.
+ *
+ * The cache is kept in the retention RAM and starts over after a reset.
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "co_bt.h"
+#include "gap.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Addresses kept. One per bonded host is enough, since a host uses one address at a time.
+#ifndef RPA_CACHE_SIZE
+#define RPA_CACHE_SIZE                  (MAX_BOND_PEER)
+#endif
+
+/// The IRKs are bits of a uint8_t in app_rpa_cache_irks()
+#if (MAX_BOND_PEER > 8)
+#error "The RPA cache supports up to 8 bonds (MAX_BOND_PEER)"
+#endif
+
+/// Lifetime of a resolved address in slots (625us): 15min, the default TGAP(private_addr_int)
+#define RPA_CACHE_TIMEOUT               (15UL * 60 * 1600)
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief       Looks up a resolvable private address.
+ *
+ * @param[in]   addr    The address
+ *
+ * @return      The entry of the host in the NV memory, MAX_BOND_PEER if the address has
+ *              not been resolved within RPA_CACHE_TIMEOUT
+ ****************************************************************************************
+ */
+int app_rpa_cache_lookup(struct bd_addr const *addr);
+
+/**
+ ****************************************************************************************
+ * @brief       Gets the IRKs of the bond index (bond_index.irk), the IRKs of the most
+ *              recently resolved hosts first.
+ *
+ * @param[out]  irk     The IRKs, bond_index.nb_irk of them
+ ****************************************************************************************
+ */
+void app_rpa_cache_irks(struct gap_sec_key *irk);
+
+/**
+ ****************************************************************************************
+ * @brief       Records a resolved address, in place of the oldest one, and marks its
+ *              host as the most recently resolved.
+ *
+ * @param[in]   addr    The address
+ * @param[in]   entry   The entry of the host in the NV memory
+ ****************************************************************************************
+ */
+void app_rpa_cache_add(struct bd_addr const *addr, int entry);
+
+/**
+ ****************************************************************************************
+ * @brief       Drops the addresses of an entry, when it is written or deleted.
+ *
+ * @param[in]   entry   The entry in the NV memory, MAX_BOND_PEER for all of them
+ ****************************************************************************************
+ */
+void app_rpa_cache_forget(int entry);
+
+#endif // APP_RPA_CACHE_H_
@@ -33,6 +33,7 @@
 #include "ke_mem.h"
 #include "sw_aes.h"
 #include "aes_api.h"
+#include "aes_queue.h"
 
 
 /*
@@ -69,6 +70,8 @@ void aes_init(bool reset, void (*aes_done_cb)(uint8_t status))
 {
     aes_cb = aes_done_cb;
     
+    aes_queue_reset();
+
     if(!reset)
     {
         // Reset the aes environment
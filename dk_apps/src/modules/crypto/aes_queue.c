@@ -0,0 +1,251 @@
+/**
+ ****************************************************************************************
+ *
+ * @file aes_queue.c
+ *
+ * @brief Queue of encryption jobs for the hardware AES block.
+ *
+ * The AES task runs a burst of the job at the head of the queue for each AES_QUEUE_RUN
+ * message. The key is loaded once per burst and each block is started as soon as the
+ * previous one has been read back, so the main loop is not entered between the blocks
+ * of a burst (an encryption takes a few us). The queue sends AES_QUEUE_RUN to itself
+ * while jobs remain, or sets it as a timer while the stack uses the AES block.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @addtogroup aes
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include "aes_queue.h"
+
+#if (USE_AES)
+
+#include "rwip.h"
+#include "ke_timer.h"
+#include "aes_task.h"
+#include "aes_locl.h"
+#include "smpm.h"
+#include "gapm_task.h"
+
+static struct aes_job *aes_queue_head;     // in progress
+static struct aes_job *aes_queue_tail;
+static bool aes_queue_scheduled;           // AES_QUEUE_RUN is queued or its timer is set
+
+/*
+ * LOCAL FUNCTIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Sends AES_QUEUE_RUN to the AES task, at once or after AES_QUEUE_RETRY_DELAY.
+ *
+ * @param[in] retry     true, to wait for the AES block
+ ****************************************************************************************
+ */
+static void aes_queue_schedule(bool retry)
+{
+    if (aes_queue_scheduled) {
+        return;
+    }
+    aes_queue_scheduled = true;
+
+    if (retry) {
+        ke_timer_set(AES_QUEUE_RUN, TASK_AES, AES_QUEUE_RETRY_DELAY);
+    } else {
+        ke_msg_send_basic(AES_QUEUE_RUN, TASK_AES, TASK_AES);
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Checks if the AES block is free: the Security Manager does not use it
+ *        (GAPM_USE_ENC_BLOCK), no aes_operation() is in progress and no encryption
+ *        is running.
+ *
+ * @return true, if the queue may use the AES block
+ ****************************************************************************************
+ */
+static bool aes_queue_hw_free(void)
+{
+    if (smpm_env.operation && ((struct smp_cmd *)(smpm_env.operation))->operation == GAPM_USE_ENC_BLOCK) {
+        return false;
+    }
+    // an asynchronous aes_operation() keeps its command until its last block
+    if (aes_env.operation != NULL) {
+        return false;
+    }
+    return GetWord32(BLE_AESCNTL_REG) == 0;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Loads a key in the AES block.
+ *
+ * @param[in] key   16 bytes, most significant first
+ ****************************************************************************************
+ */
+static void aes_queue_hw_key(const uint8_t *key)
+{
+    SetWord32(BLE_AESKEY31_0_REG, GETU32(key + 12));
+    SetWord32(BLE_AESKEY63_32_REG, GETU32(key + 8));
+    SetWord32(BLE_AESKEY95_64_REG, GETU32(key + 4));
+    SetWord32(BLE_AESKEY127_96_REG, GETU32(key));
+}
+
+/**
+ ****************************************************************************************
+ * @brief Encrypts a block with the AES block, through the exchange memory buffers.
+ *
+ * @param[in]  in   The plain block
+ * @param[out] out  The encrypted block, may be in
+ ****************************************************************************************
+ */
+static void aes_queue_hw_block(const uint8_t *in, uint8_t *out)
+{
+    volatile uint8_t *plain = (volatile uint8_t *)(0x80000 + jump_table_struct[offset_em_enc_plain]);
+    volatile uint8_t *cipher = (volatile uint8_t *)(0x80000 + jump_table_struct[offset_em_enc_cipher]);
+    int j;
+
+    for (j = 0; j < AES_BLOCKSIZE; j++) {
+        plain[j] = in[j];
+    }
+
+    SetWord32(BLE_AESPTR_REG, jump_table_struct[offset_em_enc_plain]);
+    SetWord32(BLE_AESCNTL_REG, 1);
+    while (GetWord32(BLE_AESCNTL_REG) == 1)
+        ;
+
+    for (j = 0; j < AES_BLOCKSIZE; j++) {
+        out[j] = cipher[j];
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Removes the job at the head of the queue and completes it.
+ *
+ * @param[in] status    AES_JOB_OK or the error
+ ****************************************************************************************
+ */
+static void aes_queue_complete(int8_t status)
+{
+    struct aes_job *job = aes_queue_head;
+
+    aes_queue_head = job->next;
+    if (aes_queue_head == NULL) {
+        aes_queue_tail = NULL;
+    }
+    job->status = status;
+
+    if (job->callback) {
+        job->callback(job);
+    } else if (job->dest_id != TASK_NONE) {
+        struct aes_job_cmp_ind *ind = KE_MSG_ALLOC(AES_JOB_CMP_IND, job->dest_id, TASK_AES,
+                                                   aes_job_cmp_ind);
+        ind->job = job;
+        ind->status = status;
+        ke_msg_send(ind);
+    }
+}
+
+/*
+ * EXPORTED FUNCTIONS
+ ****************************************************************************************
+ */
+
+void aes_queue_submit(struct aes_job *job)
+{
+    job->next = NULL;
+    job->done = 0;
+    job->status = AES_JOB_PENDING;
+
+    if (aes_queue_head == NULL) {
+        aes_queue_head = job;
+    } else {
+        aes_queue_tail->next = job;
+    }
+    aes_queue_tail = job;
+
+    aes_queue_schedule(false);
+}
+
+
+bool aes_queue_is_busy(void)
+{
+    return aes_queue_head != NULL;
+}
+
+
+void aes_queue_reset(void)
+{
+    // the kernel has flushed its messages and timers when the task is reset
+    aes_queue_head = NULL;
+    aes_queue_tail = NULL;
+    aes_queue_scheduled = false;
+}
+
+
+int aes_queue_run_handler(ke_msg_id_t const msgid,
+                          void const *param,
+                          ke_task_id_t const dest_id,
+                          ke_task_id_t const src_id)
+{
+    struct aes_job *job = aes_queue_head;
+    int blocks;
+
+    aes_queue_scheduled = false;
+
+    if (job == NULL) {
+        return (KE_MSG_CONSUMED);
+    }
+
+    if ((job->len == 0) || (job->len % AES_BLOCKSIZE)) {
+        aes_queue_complete(AES_JOB_ERR_PARAM);
+    } else if (!aes_queue_hw_free()) {
+        aes_queue_schedule(true);
+        return (KE_MSG_CONSUMED);
+    } else {
+        aes_queue_hw_key(job->key);
+        for (blocks = 0; (blocks < AES_QUEUE_BURST) && (job->done < job->len); blocks++) {
+            aes_queue_hw_block(&job->in[job->done], &job->out[job->done]);
+            job->done += AES_BLOCKSIZE;
+        }
+
+        if (job->done >= job->len) {
+            aes_queue_complete(AES_JOB_OK);
+        } else if (job->next) {
+            // let the other jobs go first
+            aes_queue_head = job->next;
+            job->next = NULL;
+            aes_queue_tail->next = job;
+            aes_queue_tail = job;
+        }
+    }
+
+    if (aes_queue_head) {
+        aes_queue_schedule(false);
+    }
+    return (KE_MSG_CONSUMED);
+}
+
+#endif // (USE_AES)
+
+/// @} aes
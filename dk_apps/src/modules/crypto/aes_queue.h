@@ -0,0 +1,157 @@
+/**
+ ****************************************************************************************
+ *
+ * @file aes_queue.h
+ *
+ * @brief Queue of encryption jobs for the hardware AES block header file.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef AES_QUEUE_H_
+#define AES_QUEUE_H_
+
+/*
+ ****************************************************************************************
+ * USAGE
+ * A job encrypts len bytes (AES-128, ECB, a multiple of AES_BLOCKSIZE) with the AES block
+ * of the BLE core. It is queued with aes_queue_submit() from the kernel context and
+ * completes through its callback, or else through an AES_JOB_CMP_IND message to its
+ * dest_id. Any number of users may queue jobs: they no longer have to check whether
+ * aes_operation() is busy.
+ *
+ * The jobs are run by the AES task (aes_init() must have been called), at most
+ * AES_QUEUE_BURST blocks at a time. The blocks of a burst go through the AES block back
+ * to back, with the key loaded once. A job that is not complete after a burst goes to
+ * the tail of the queue, so a long job does not hold off the short ones. The kernel
+ * schedules the other messages between two bursts.
+ *
+ * While the Security Manager, the link layer or an aes_operation() uses the AES block,
+ * the queue waits AES_QUEUE_RETRY_DELAY before trying again. aes_operation() itself does
+ * not wait for the queue: it still returns -2 only while another aes_operation() is in
+ * progress. A synchronous aes_operation() loads its key for each block, so the jobs
+ * that run from its rwip_schedule() calls do not disturb it.
+ *
+ * The queue is part of the crypto module (USE_AES). No project of this SDK builds the
+ * module yet: a project that uses it adds the files of modules/crypto and defines USE_AES.
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include "aes.h"
+
+#if (USE_AES)
+
+#include <stdint.h>
+#include "ke_msg.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Blocks encrypted by the AES task before the kernel schedules other messages
+#ifndef AES_QUEUE_BURST
+#define AES_QUEUE_BURST                 (4)
+#endif
+
+/// Wait before retrying while the AES block is used by the stack, in 10ms units
+#define AES_QUEUE_RETRY_DELAY           (1)
+
+/// Status of a job
+enum aes_job_status
+{
+    AES_JOB_OK          = 0,
+    AES_JOB_PENDING     = 1,
+    AES_JOB_ERR_PARAM   = -1,       ///< len is 0 or not a multiple of AES_BLOCKSIZE
+};
+
+/// An encryption job. The structure is owned by the caller and must stay valid until it completes.
+struct aes_job
+{
+    struct aes_job *next;               ///< used by the queue
+    const uint8_t *key;                 ///< 16 bytes, must stay valid as well
+    const uint8_t *in;                  ///< must stay valid as well
+    uint8_t *out;                       ///< may be in
+    uint16_t len;                       ///< multiple of AES_BLOCKSIZE
+    uint16_t done;                      ///< used by the queue: bytes encrypted
+    /// Called at completion, from the AES task. It may submit jobs.
+    void (*callback)(struct aes_job *job);
+    ke_task_id_t dest_id;               ///< receives AES_JOB_CMP_IND if there is no callback, TASK_NONE for none
+    volatile int8_t status;             ///< aes_job_status
+};
+
+/// Parameters of the @ref AES_JOB_CMP_IND message
+struct aes_job_cmp_ind
+{
+    /// The completed job
+    struct aes_job *job;
+    /// AES_JOB_OK or the error
+    int8_t status;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Queues a job.
+ *
+ * @param[in] job   The job
+ *
+ * @return void
+ ****************************************************************************************
+ */
+void aes_queue_submit(struct aes_job *job);
+
+/**
+ ****************************************************************************************
+ * @brief Checks if jobs are queued or in progress.
+ *
+ * @return true, if the queue is busy
+ ****************************************************************************************
+ */
+bool aes_queue_is_busy(void);
+
+/**
+ ****************************************************************************************
+ * @brief Drops the queued jobs, without completing them. Called by aes_init().
+ *
+ * @return void
+ ****************************************************************************************
+ */
+void aes_queue_reset(void);
+
+/**
+ ****************************************************************************************
+ * @brief Handler of AES_QUEUE_RUN. Runs a burst of the job at the head of the queue.
+ *
+ * @param[in] msgid     Id of the message received.
+ * @param[in] param     Pointer to the parameters of the message.
+ * @param[in] dest_id   ID of the receiving task instance (TASK_AES).
+ * @param[in] src_id    ID of the sending task instance.
+ *
+ * @return If the message was consumed or not.
+ ****************************************************************************************
+ */
+int aes_queue_run_handler(ke_msg_id_t const msgid,
+                          void const *param,
+                          ke_task_id_t const dest_id,
+                          ke_task_id_t const src_id);
+
+#endif // (USE_AES)
+
+#endif // AES_QUEUE_H_
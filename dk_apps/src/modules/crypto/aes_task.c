@@ -33,6 +33,7 @@
 #include "llm_task.h"
 #include "gapm_util.h"
 #include "gapc.h"
+#include "aes_queue.h"
 #include <string.h>
 
 /*
@@ -209,6 +210,8 @@ const struct ke_msg_handler aes_default_state[] =
     {AES_USE_ENC_BLOCK_CMD,        (ke_msg_func_t)aes_use_enc_block_cmd_handler},
 
     {LLM_LE_ENC_CMP_EVT,            (ke_msg_func_t)llm_le_enc_cmp_evt_handler},
+
+    {AES_QUEUE_RUN,                 (ke_msg_func_t)aes_queue_run_handler},
 };
 
 /// State handlers table
@@ -97,7 +97,12 @@ enum aes_msg_id
     AES_GEN_RAND_NB_IND,
 
     /// Command Complete Event
-    AES_CMP_EVT
+    AES_CMP_EVT,
+
+    /// Job queue: runs a burst of the job at the head of the queue (aes_queue.h)
+    AES_QUEUE_RUN,
+    /// Job queue: a job has completed
+    AES_JOB_CMP_IND,
 };
 
 /*
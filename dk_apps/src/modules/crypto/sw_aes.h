@@ -15,6 +15,23 @@
 #define AES_BLOCKSIZE		   16
 #define AES_IV_SIZE			 16
 
+/*
+ * Speed and footprint of the software encryption, selected at compile time:
+ *   SW_AES_TABLES 0: byte oriented rounds, MixColumns computed with AES_xtime()
+ *   SW_AES_TABLES 1: word oriented rounds with one 1KB T-table and rotations
+ *   SW_AES_TABLES 4: word oriented rounds with four 1KB T-tables, the fastest
+ * With SW_AES_TABLES_IN_RAM the tables are built from the S-box by AES_set_key()
+ * instead of being constant data of the image.
+ * The decryption does not use the tables. CTR and CMAC use only the encryption.
+ */
+#ifndef SW_AES_TABLES
+	#define SW_AES_TABLES			0
+#endif
+
+#ifndef SW_AES_TABLES_IN_RAM
+	#define SW_AES_TABLES_IN_RAM	0
+#endif
+
 #ifndef htonl
 	#define htonl(a)					\
 		((((a) >> 24) & 0x000000ff) |   \
@@ -74,5 +91,22 @@ void AES_decrypt(const AES_CTX *ctx, uint32_t *data);
  */
 void AES_encrypt(const AES_CTX *ctx, uint32_t *data);
 
+/**
+ * Encrypt or decrypt a byte sequence of any length using the AES cipher in CTR
+ * mode (NIST SP 800-38A). The counter block is big endian and is incremented
+ * after each block, so it holds the next counter on return. The rest of the key
+ * stream of a partial block is discarded: only the last call for a message may
+ * have a length that is not a multiple of AES_BLOCKSIZE. in and out may be the
+ * same buffer.
+ */
+void AES_ctr_crypt(const AES_CTX *ctx, uint8_t *counter, const uint8_t *in,
+		uint8_t *out, int length);
+
+/**
+ * Compute the AES-CMAC (NIST SP 800-38B, RFC 4493) of a byte sequence of any
+ * length. The MAC is AES_BLOCKSIZE bytes long.
+ */
+void AES_cmac(const AES_CTX *ctx, const uint8_t *msg, int length, uint8_t *mac);
+
 
 #endif /* !HEADER_AES_H */
@@ -107,6 +107,15 @@
 
 uint32_t wlan_coex_criteria[BLE_CONNECTION_MAX_USER+1] __attribute__((section("retention_mem_area0")));
 
+/// Urgency of the application data, for BLEMPRIO_URGENT
+struct wlan_coex_urgency_tag
+{
+    uint8_t reasons;        // WLAN_COEX_URG_*, set by the application
+    uint8_t key_events;     // connection events ended since a key report was queued
+};
+
+struct wlan_coex_urgency_tag wlan_coex_urgency __attribute__((section("retention_mem_area0"), zero_init));
+
 
 #if DEVELOPMENT_DEBUG
 /**
@@ -185,6 +194,83 @@ void wlan_coex_prio_criteria_del(uint16_t type, uint16_t conhdl, uint16_t missed
 }
 
 
+/*
+ * Name         : wlan_coex_urgency_set - Report the urgency of the application data
+ * Arguments    : reason - WLAN_COEX_URG_STREAM or WLAN_COEX_URG_KEY
+ *                on     - true while the reason holds
+ * Description  : Call the function when the application data becomes urgent or not.
+ *                BLEMPRIO_URGENT raises the BLE priority while the stream FIFO is above
+ *                its high-water mark or a key report has waited WLAN_COEX_KEY_WAIT_EVENTS
+ *                connection events. The key wait is counted until the link layer queue
+ *                of the connection drains.
+ *
+ * Returns      : void
+ *
+ */
+void wlan_coex_urgency_set(uint8_t reason, bool on)
+{
+    GLOBAL_INT_STOP();
+
+    if (on) {
+        wlan_coex_urgency.reasons |= reason;
+    } else {
+        wlan_coex_urgency.reasons &= ~reason;
+    }
+
+    GLOBAL_INT_START();
+}
+
+/*
+ * Name         : wlan_coex_urgency_reset - Clear the urgency of the application data
+ * Arguments    : none
+ * Description  : Call the function when the connection is terminated.
+ *
+ * Returns      : void
+ *
+ */
+void wlan_coex_urgency_reset(void)
+{
+    wlan_coex_urgency.reasons = 0;
+    wlan_coex_urgency.key_events = 0;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Counts the connection events ended while a key report waits.
+ *
+ * @param[in] evt   The event that ends
+ ****************************************************************************************
+ */
+static void wlan_coex_urgency_evt_end(struct lld_evt_tag *evt)
+{
+    if ((evt == NULL) || (evt->conhdl == LLD_ADV_HDL)) {
+        return;
+    }
+
+    if ((wlan_coex_urgency.reasons & WLAN_COEX_URG_KEY) ||
+        (wlan_coex_urgency.key_events && !(co_list_is_empty(&evt->tx_rdy) && co_list_is_empty(&evt->tx_prog)))) {
+        if (wlan_coex_urgency.key_events < WLAN_COEX_KEY_WAIT_EVENTS) {
+            wlan_coex_urgency.key_events++;
+        }
+    } else {
+        wlan_coex_urgency.key_events = 0;
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Checks if the application data is urgent.
+ *
+ * @return true, if the BLE priority must be raised
+ ****************************************************************************************
+ */
+static bool wlan_coex_urgent(void)
+{
+    return (wlan_coex_urgency.reasons & WLAN_COEX_URG_STREAM) ||
+           (wlan_coex_urgency.key_events >= WLAN_COEX_KEY_WAIT_EVENTS);
+}
+
+
 // forward declaration of local functions
 void wlan_coex_eip_1_handler(void);
 #ifdef WLAN_COEX_PORT_2
@@ -402,7 +488,7 @@ int wlan_coex_evt_prio(struct lld_evt_tag *evt)
     else    //per connection criteria
     {
         uint32_t chk = BLEMPRIO_LLCP;
-        while(chk <= BLEMPRIO_MISSED)
+        while(chk <= BLEMPRIO_URGENT)
         {
             if(prio & chk)
             {
@@ -429,6 +515,10 @@ int wlan_coex_evt_prio(struct lld_evt_tag *evt)
                         if(evt->missed_cnt >= prio >> 16)
                             return 1;
                         break;
+                    case BLEMPRIO_URGENT:
+                        if(wlan_coex_urgent())
+                            return 1;
+                        break;
                 }
             }
             chk = chk << 1;
@@ -490,6 +580,8 @@ void wlan_coex_lld_evt_end(void)
     SetWord16(P2_SET_DATA_REG, 1<<8);
 #endif
     
+    wlan_coex_urgency_evt_end((struct lld_evt_tag *)co_list_pick(&lld_evt_env.evt_prog));
+    
     lld_evt_end();     //call rom func
 
     //wlan_coex_evt_prio_set();
@@ -17,6 +17,9 @@
 #ifndef _WLAN_COEX_H_
 #define _WLAN_COEX_H_
 
+#include <stdint.h>
+#include <stdbool.h>
+
 /// Coexistence Definitions
 //active scan
 #define BLEMPRIO_SCAN       0x01
@@ -30,6 +33,25 @@
 #define BLEMPRIO_DATA       0x20
 //missed events
 #define BLEMPRIO_MISSED     0x40
+//urgent application data, see wlan_coex_urgency_set()
+#define BLEMPRIO_URGENT     0x80
+
+/// Urgency reasons reported by the application
+//the stream FIFO is above its high-water mark
+#define WLAN_COEX_URG_STREAM    0x01
+//key reports are waiting to be sent
+#define WLAN_COEX_URG_KEY       0x02
+
+/// Connection events ended with a key report waiting before the key is urgent.
+/// A report queued just before an event waits a full interval at the second one.
+#ifndef WLAN_COEX_KEY_WAIT_EVENTS
+#define WLAN_COEX_KEY_WAIT_EVENTS   2
+#endif
+
+/// Missed events in a row the application passes to BLEMPRIO_MISSED
+#ifndef WLAN_COEX_MISSED_EVENTS
+#define WLAN_COEX_MISSED_EVENTS     2
+#endif
 
 /*
  * FUNCTION DEFINITIONS
@@ -38,6 +60,10 @@
 void wlan_coex_init(void); 
 void wlan_coex_check_signals(void);
 void wlan_coex_enable(void);
+void wlan_coex_prio_criteria_add(uint16_t type, uint16_t conhdl, uint16_t missed);
+void wlan_coex_prio_criteria_del(uint16_t type, uint16_t conhdl, uint16_t missed);
+void wlan_coex_urgency_set(uint8_t reason, bool on);
+void wlan_coex_urgency_reset(void);
 
 #if DEVELOPMENT_DEBUG
 void wlan_coex_reservations(void);
@@ -285,6 +285,20 @@ typedef enum {
 #define RCX_PERIOD_MAX              (100)
 
 
+/*
+ * RCX20 frequency tracker: the RCX is measured when its observed drift needs it, and the
+ * measurements are averaged. See rcx_track_start().
+ ****************************************************************************************
+ */
+#define RCX_CAL_TIME                (20)    // RCX cycles per measurement (~1.8ms)
+#define RCX_TRACK_SHIFT             (1)     // weight of a new measurement: 1 / 2^RCX_TRACK_SHIFT
+#define RCX_TRACK_INTERVAL_MIN      (32)    // slots between measurements after a change (20ms)
+#define RCX_TRACK_INTERVAL_MAX      (6400)  // slots between measurements while stable (4s)
+#define RCX_TRACK_STABLE_PPM        (150)   // deviation under which the interval doubles
+#define RCX_TRACK_STEP_PPM          (400)   // deviation over which the average restarts
+#define RCX_TRACK_TEMP_COUNT        (3)     // change of the RC16M count (~0.6 C) that triggers a measurement
+
+
 /*
  * DEEP SLEEP: Power down configuration
  ****************************************************************************************
@@ -438,6 +452,16 @@ void calibrate_rcx20(uint16_t cal_time);
 
 void read_rcx_freq(uint16_t cal_time);
 
+void rcx_track_start(void);
+
+void rcx_track_wakeup(void);
+
+void rcx_track_poll(void);
+
+void rcx_track_sleep(void);
+
+void rcx_track_kick(void);
+
 uint32_t lld_sleep_lpcycles_2_us_sel_func(uint32_t lpcycles);
 
 uint32_t lld_sleep_us_2_lpcycles_sel_func(uint32_t us);
@@ -374,8 +374,8 @@ int main_func(void)
 
     if ( ((lp_clk_sel == LP_CLK_RCX20) && (CFG_LP_CLK == LP_CLK_FROM_OTP)) || (CFG_LP_CLK == LP_CLK_RCX20) )
     {    
-        calibrate_rcx20(20);
-        read_rcx_freq(20);  
+        calibrate_rcx20(RCX_CAL_TIME);
+        read_rcx_freq(RCX_CAL_TIME);  
     }
     
     /*
@@ -442,6 +442,11 @@ int main_func(void)
 
                 uint8_t ble_evt_end_set = ke_event_get(KE_EVENT_BLE_EVT_END); // BLE event end is set. conditional RF calibration can run.
                 
+#if (BLE_APP_PRESENT)
+                if (ke_event_get_all()) {
+                    app_event_set(APP_EVENT_TRM);   // messages or timers may change the app state
+                }
+#endif
                 rwip_schedule();  
    
                 if (ble_evt_end_set)
@@ -449,7 +454,7 @@ int main_func(void)
                     uint32_t sleep_duration = 0;
                     
                     if ( ((lp_clk_sel == LP_CLK_RCX20) && (CFG_LP_CLK == LP_CLK_FROM_OTP)) || (CFG_LP_CLK == LP_CLK_RCX20) )
-                        read_rcx_freq(20);
+                        rcx_track_poll();
                     
                     if (lld_sleep_check(&sleep_duration, 4)) //6 slots -> 3.750 ms
                         conditionally_run_radio_cals(); // check time and temperature to run radio calibrations. 
@@ -476,13 +481,16 @@ int main_func(void)
 
 #if (BLE_APP_STREAM)
     #if (HAS_AUDIO)
-    app_audio439_encode(8);
+        if (app_event_take(APP_EVENT_AUDIO))
+            app_audio439_encode(8);
     #endif
 #endif
 #if (STREAMDATA_QUEUE || BLE_APP_STREAM)     
     #if (HAS_AUDIO)        
-        if (stream_queue_more_data( ))
+        if (app_event_take(APP_EVENT_STREAM) && stream_queue_more_data( )) {
+            app_event_set(APP_EVENT_STREAM);    // queue the rest in the next pass
             continue;
+        }
     #endif
 #endif
         
@@ -502,7 +510,14 @@ int main_func(void)
         
             // if app has turned sleep off, rwip_sleep() will act accordingly
             // time from rwip_sleep() to WFI() must be kept as short as possible!
+#if (HAS_BLE_SLEEP)
+            sleep_mode = rwip_sleep();
+#elif (BLE_APP_PRESENT)
+            // the BLE core stays up: halt the CPU until the next interrupt if nothing is pending
+            sleep_mode = app_asynch_idle_check() ? mode_idle : mode_active;
+#else
             sleep_mode = mode_active;
+#endif
         
             // BLE is sleeping ==> app defines the mode
             if (sleep_mode == mode_sleeping) {
@@ -515,6 +530,8 @@ int main_func(void)
             
             if (sleep_mode == mode_ext_sleep || sleep_mode == mode_deep_sleep) 
             {
+                rcx_track_sleep();                      // collect the RCX measurement before the XTAL16 stops
+                
                 SetBits16(PMU_CTRL_REG, RADIO_SLEEP, 1); // turn off radio
                 
                 if (jump_table_struct[nb_links_user] > 1)
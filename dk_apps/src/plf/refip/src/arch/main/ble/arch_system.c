@@ -29,6 +29,9 @@
 #include <stdbool.h>   // boolean definition
 #include "rwip.h"     // BLE initialization
 #include "llc.h"
+#include "lld_evt.h"
+#include "reg_blecore.h"
+#include "co_math.h"
 #include "pll_vcocal_lut.h"
 #include "gpio.h"
 #include "rf_580.h"
@@ -81,6 +84,17 @@ uint32_t rcx_period_last __attribute__((section("retention_mem_area0"),zero_init
 uint32_t rcx_period_diff __attribute__((section("retention_mem_area0"),zero_init));
 #endif
 
+struct rcx_track_env_tag
+{
+    uint32_t value;                 // average 16MHz cycles in RCX_CAL_TIME RCX cycles, x256. 0 before the first measurement
+    uint32_t last;                  // base time of the start of the last measurement
+    uint32_t interval;              // slots from the last measurement to the next one
+    uint16_t temp_count;            // RC16M count that triggered the last measurement
+    bool running;                   // a measurement is running
+};
+
+struct rcx_track_env_tag rcx_track_env __attribute__((section("retention_mem_area0"),zero_init));
+
 
 /*
  * EXPORTED FUNCTION DEFINITIONS
@@ -246,7 +260,98 @@ void calibrate_rcx20(uint16_t cal_time)
 
 /**
  ****************************************************************************************
- * @brief Calculates RCX20 frequency. 
+ * @brief Sets the RCX20 frequency used by the sleep timing.
+ *
+ * @param[in]   value. 16MHz cycles in RCX_CAL_TIME RCX20 cycles, x256.
+ *
+ * @return void 
+ ****************************************************************************************
+ */
+static void rcx_track_set(uint32_t value)
+{
+    rcx_freq = (uint32_t)(((uint64_t)16000000 * RCX_CAL_TIME * 256 + (value / 2)) / value);
+    rcx_period = value / (4 * RCX_CAL_TIME);                                // usec x 1024
+    rcx_slot_duration = (float)(10000UL * RCX_CAL_TIME * 256) / (float)value;   // RCX cycles per 625usec
+
+#ifdef RCX_MEASURE
+    if (rcx_period_last)
+    {
+        volatile int diff = rcx_period_last - rcx_period;
+        if (abs(diff) > rcx_period_diff)
+            rcx_period_diff = abs(diff);
+    }
+    rcx_period_last = rcx_period;
+    
+    if (rcx_freq_min == 0)
+    {
+        rcx_freq_min = rcx_freq;
+        rcx_freq_max = rcx_freq;
+    }
+    if (rcx_freq < rcx_freq_min)
+        rcx_freq_min = rcx_freq;
+    else if (rcx_freq > rcx_freq_max)
+        rcx_freq_max = rcx_freq;
+#endif    
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Adds a measurement to the RCX20 frequency average and sets the time of the
+ *        next one.
+ *
+ * A measurement that differs by less than RCX_TRACK_STABLE_PPM from the average doubles
+ * the interval, up to RCX_TRACK_INTERVAL_MAX, else it halves it. One that differs by
+ * RCX_TRACK_STEP_PPM or more replaces the average, since the clock has moved.
+ *
+ * @param[in]   cycles. 16MHz cycles in RCX_CAL_TIME RCX20 cycles.
+ *
+ * @return void 
+ ****************************************************************************************
+ */
+static void rcx_track_update(uint32_t cycles)
+{
+    const uint32_t value = cycles << 8;
+    uint32_t dev, ppm;
+
+    if (rcx_track_env.value == 0)
+    {
+        rcx_track_env.value = value;
+        rcx_track_env.interval = RCX_TRACK_INTERVAL_MIN;
+        rcx_track_set(value);
+        return;
+    }
+
+    // deviation in ppm: dev * 10^6 / average, with dev limited so that dev * 15625 fits
+    dev = (value > rcx_track_env.value) ? (value - rcx_track_env.value) : (rcx_track_env.value - value);
+    ppm = ((dev < 0x40000 ? dev : 0x40000) * 15625) / (rcx_track_env.value >> 6);
+
+    if (ppm >= RCX_TRACK_STEP_PPM)
+    {
+        rcx_track_env.value = value;
+        rcx_track_env.interval = RCX_TRACK_INTERVAL_MIN;
+    }
+    else
+    {
+        if (value > rcx_track_env.value)
+            rcx_track_env.value += (value - rcx_track_env.value) >> RCX_TRACK_SHIFT;
+        else
+            rcx_track_env.value -= (rcx_track_env.value - value) >> RCX_TRACK_SHIFT;
+
+        if (ppm < RCX_TRACK_STABLE_PPM)
+            rcx_track_env.interval = co_min(co_max(2 * rcx_track_env.interval, RCX_TRACK_INTERVAL_MIN), RCX_TRACK_INTERVAL_MAX);
+        else
+            rcx_track_env.interval = co_max(rcx_track_env.interval / 2, RCX_TRACK_INTERVAL_MIN);
+    }
+
+    rcx_track_set(rcx_track_env.value);
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Measures the RCX20 frequency and restarts the average with it. Waits for the
+ *        end of the measurement started by calibrate_rcx20().
  *
  * @param[in]   cal_time. Calibration time in RCX20 cycles. 
  *
@@ -261,34 +366,131 @@ void read_rcx_freq(uint16_t cal_time)
         volatile uint32_t high = GetWord16(CLK_REF_VAL_H_REG);
         volatile uint32_t low = GetWord16(CLK_REF_VAL_L_REG);
         volatile uint32_t value = ( high << 16 ) + low;
-        volatile uint32_t f = (16000000 * cal_time) / value;
 
         cal_enable = 0;
 
-        rcx_freq = f;
-        rcx_period = ((float) 1000000/f) * 1024;
-        rcx_slot_duration = 0.000625 * (float)rcx_freq;
-        
-#ifdef RCX_MEASURE
-        if (rcx_period_last)
-        {
-            volatile int diff = rcx_period_last - rcx_period;
-            if (abs(diff) > rcx_period_diff)
-                rcx_period_diff = abs(diff);
-        }
-        rcx_period_last = rcx_period;
-        
-        if (rcx_freq_min == 0)
-        {
-            rcx_freq_min = rcx_freq;
-            rcx_freq_max = rcx_freq;
-        }
-        if (rcx_freq < rcx_freq_min)
-            rcx_freq_min = rcx_freq;
-        else if (rcx_freq > rcx_freq_max)
-            rcx_freq_max = rcx_freq;
-#endif    
+        rcx_track_env.value = 0;
+        rcx_track_env.running = false;
+        rcx_track_update((value * RCX_CAL_TIME) / cal_time);
+    }
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Starts an RCX20 measurement if one is due. Called at the start of the BLE
+ *        events, while the 16MHz crystal runs. A running measurement is left to end.
+ *
+ * The RCX20 frequency drifts with the temperature and the supply voltage. Instead of a
+ * measurement per BLE event, which the main loop had to wait for, a measurement is
+ * started when RCX_TRACK_INTERVAL_MIN to RCX_TRACK_INTERVAL_MAX slots have elapsed,
+ * depending on the drift seen, or when the temperature or the battery level has changed
+ * (rcx_track_kick()). rcx_track_poll() collects it after the end of the event, or
+ * rcx_track_sleep() before the next sleep. The sleep timing uses the average of the
+ * measurements.
+ *
+ * @return void 
+ ****************************************************************************************
+ */
+void rcx_track_start(void)
+{
+    if (rcx_track_env.running)
+        return;
+
+    if (((lld_evt_time_get() - rcx_track_env.last) & BLE_BASETIMECNT_MASK) < rcx_track_env.interval)
+        return;
+
+    calibrate_rcx20(RCX_CAL_TIME);
+    rcx_track_env.last = lld_evt_time_get();
+    rcx_track_env.running = true;
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Drops the running RCX20 measurement, when the system wakes up. The 16MHz
+ *        crystal was off during the sleep.
+ *
+ * @return void 
+ ****************************************************************************************
+ */
+void rcx_track_wakeup(void)
+{
+    rcx_track_env.running = false;
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Reads the ended RCX20 measurement. Called with the interrupts disabled.
+ *
+ * @return 16MHz cycles in RCX_CAL_TIME RCX20 cycles
+ ****************************************************************************************
+ */
+static uint32_t rcx_track_read(void)
+{
+    rcx_track_env.running = false;
+    cal_enable = 0;
+    
+    return (GetWord16(CLK_REF_VAL_H_REG) << 16) + GetWord16(CLK_REF_VAL_L_REG);
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Collects the RCX20 measurement if it has ended. Called from the main loop after
+ *        the BLE events; does not wait.
+ *
+ * @return void 
+ ****************************************************************************************
+ */
+void rcx_track_poll(void)
+{
+    uint32_t value;
+
+    GLOBAL_INT_STOP();
+    if (!rcx_track_env.running || (GetBits16(CLK_REF_SEL_REG, REF_CAL_START) == 1))
+    {
+        GLOBAL_INT_START();
+        return;
     }
+    value = rcx_track_read();
+    GLOBAL_INT_START();
+
+    rcx_track_update(value);
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Waits for the end of the running RCX20 measurement, if any, and collects it.
+ *        Called with the interrupts disabled before the system sleeps, which would drop
+ *        it. Only a measurement longer than its BLE event has to be waited for.
+ *
+ * @return void 
+ ****************************************************************************************
+ */
+void rcx_track_sleep(void)
+{
+    if (rcx_track_env.running)
+    {
+        while(GetBits16(CLK_REF_SEL_REG, REF_CAL_START) == 1);
+        rcx_track_update(rcx_track_read());
+    }
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Requests an RCX20 measurement at the next BLE event, when the temperature or
+ *        the supply voltage has changed.
+ *
+ * @return void 
+ ****************************************************************************************
+ */
+void rcx_track_kick(void)
+{
+    rcx_track_env.interval = 0;
 }
 
 
@@ -427,6 +629,12 @@ void conditionally_run_radio_cals(void)
         last_temp_time = current_time;
         count = get_rc16m_count();                  // Estimate the RC16M frequency
         
+        if (abs(count - rcx_track_env.temp_count) >= RCX_TRACK_TEMP_COUNT)
+        {
+            rcx_track_env.temp_count = count;
+            rcx_track_kick();                       // the RCX20 frequency follows the temperature
+        }
+        
         if (count > last_temp_count)
             count_diff = count - last_temp_count;
         else
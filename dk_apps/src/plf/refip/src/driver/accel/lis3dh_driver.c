@@ -30,22 +30,60 @@
 #include "lis3dh_driver.h"
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
+
+// SPI command byte
+#define LIS3DH_SPI_READ                 0x80
+#define LIS3DH_SPI_INC                  0x40    // address auto-increment
+
+// Control registers kept in the shadow. The read-only registers in between are not.
+#define LIS3DH_SHADOW_FIRST             LIS3DH_TEMP_CFG_REG
+#define LIS3DH_SHADOW_LAST              LIS3DH_TIME_WINDOW
+#define LIS3DH_SHADOW_SIZE              (LIS3DH_SHADOW_LAST - LIS3DH_SHADOW_FIRST + 1)
+
 /* Private macro -------------------------------------------------------------*/
+#define LIS3DH_SHADOW_BIT(reg)          (1UL << ((reg) - LIS3DH_SHADOW_FIRST))
+
+#define LIS3DH_SHADOW_MASK              (LIS3DH_SHADOW_BIT(LIS3DH_TEMP_CFG_REG) | \
+                                         LIS3DH_SHADOW_BIT(LIS3DH_CTRL_REG1)    | \
+                                         LIS3DH_SHADOW_BIT(LIS3DH_CTRL_REG2)    | \
+                                         LIS3DH_SHADOW_BIT(LIS3DH_CTRL_REG3)    | \
+                                         LIS3DH_SHADOW_BIT(LIS3DH_CTRL_REG4)    | \
+                                         LIS3DH_SHADOW_BIT(LIS3DH_CTRL_REG5)    | \
+                                         LIS3DH_SHADOW_BIT(LIS3DH_CTRL_REG6)    | \
+                                         LIS3DH_SHADOW_BIT(LIS3DH_FIFO_CTRL_REG) | \
+                                         LIS3DH_SHADOW_BIT(LIS3DH_INT1_CFG)     | \
+                                         LIS3DH_SHADOW_BIT(LIS3DH_INT1_THS)     | \
+                                         LIS3DH_SHADOW_BIT(LIS3DH_INT1_DURATION) | \
+                                         LIS3DH_SHADOW_BIT(LIS3DH_CLICK_CFG)    | \
+                                         LIS3DH_SHADOW_BIT(LIS3DH_CLICK_THS)    | \
+                                         LIS3DH_SHADOW_BIT(LIS3DH_TIME_LIMIT)   | \
+                                         LIS3DH_SHADOW_BIT(LIS3DH_TIME_LATENCY) | \
+                                         LIS3DH_SHADOW_BIT(LIS3DH_TIME_WINDOW))
+
+#define LIS3DH_IS_SHADOWED(reg)         (((reg) >= LIS3DH_SHADOW_FIRST) && ((reg) <= LIS3DH_SHADOW_LAST) && \
+                                         (LIS3DH_SHADOW_MASK & LIS3DH_SHADOW_BIT(reg)))
+
 /* Private variables ---------------------------------------------------------*/
+static u8_t LIS3DH_Shadow[LIS3DH_SHADOW_SIZE]   __attribute__((section("retention_mem_area0"),zero_init)); //@RETENTION MEMORY
+static unsigned long LIS3DH_ShadowDirty        __attribute__((section("retention_mem_area0"),zero_init)); //@RETENTION MEMORY
+static u8_t LIS3DH_ShadowValid                  __attribute__((section("retention_mem_area0"),zero_init)); //@RETENTION MEMORY
+static u8_t LIS3DH_ShadowDeferred               __attribute__((section("retention_mem_area0"),zero_init)); //@RETENTION MEMORY
+
 /* Private function prototypes -----------------------------------------------*/
 
+#include <stddef.h>
 #include "global_io.h"
 
 
 /*******************************************************************************
-* Function Name		: LIS3DH_ReadReg
+* Function Name		: LIS3DH_BusReadReg
 * Description		: Generic Reading function. It must be fullfilled with either
 *			: I2C or SPI reading functions					
 * Input			: Register Address
 * Output		: Data REad
 * Return		: None
 *******************************************************************************/
-u8_t LIS3DH_ReadReg(u8_t Reg, u8_t* Data) {
+static u8_t LIS3DH_BusReadReg(u8_t Reg, u8_t* Data) {
   
   //To be completed with either I2c or SPI reading function
   //i.e. *Data = SPI_Mems_Read_Reg( Reg );  
@@ -81,14 +119,14 @@ u8_t LIS3DH_ReadReg(u8_t Reg, u8_t* Data) {
 
 
 /*******************************************************************************
-* Function Name		: LIS3DH_WriteReg
+* Function Name		: LIS3DH_BusWriteReg
 * Description		: Generic Writing function. It must be fullfilled with either
 *			: I2C or SPI writing function
 * Input			: Register Address, Data to be written
 * Output		: None
 * Return		: None
 *******************************************************************************/
-u8_t LIS3DH_WriteReg(u8_t WriteAddr, u8_t Data) {
+static u8_t LIS3DH_BusWriteReg(u8_t WriteAddr, u8_t Data) {
   
   //To be completed with either I2c or SPI writing function
   //i.e. SPI_Mems_Write_Reg(WriteAddr, Data);  
@@ -121,6 +159,105 @@ u8_t LIS3DH_WriteReg(u8_t WriteAddr, u8_t Data) {
   return 1;
 }
 
+/*******************************************************************************
+* Function Name		: LIS3DH_BusTransfer
+* Description		: Multi-byte SPI transfer with CS kept low. The address
+*			: auto-increments after each byte.
+* Input			: Command byte (LIS3DH_SPI_READ | LIS3DH_SPI_INC | Reg),
+*			: data to write (NULL to send 0), length
+* Output		: Data read (NULL if not needed)
+* Return		: None
+*******************************************************************************/
+static void LIS3DH_BusTransfer(u8_t cmd, const u8_t* wr, u8_t* rd, u16_t len) {
+  u16_t i;
+  u8_t val;
+
+  SetBits16(SPI_CTRL_REG,SPI_WORD,0);                   // set to 8bit mode
+  SetBits16(SPI_CTRL_REG,SPI_POL,1);                    // set to spi mode 3
+  SetBits16(SPI_CTRL_REG,SPI_PHA,1);
+  SetBits16(SPI_CTRL_REG,SPI_ON,1);                     // enable SPI block
+  SetBits16(SPI_CTRL_REG,SPI_CLK,3);                    // fastest clock
+
+  SetWord16(P0_RESET_DATA_REG,1<<6);                    // set cs LOW
+
+  for (i = 0; i <= len; i++) {
+    if (i == 0)
+      val = cmd;
+    else
+      val = wr ? wr[i - 1] : 0;
+
+    SetWord16(SPI_RX_TX_REG0, val);                     // write TX_REG0, trigger to start
+    do{
+    }while (GetBits16(SPI_CTRL_REG,SPI_INT_BIT)==0);    // polling to wait for spi have data
+    SetWord16(SPI_CLEAR_INT_REG, 1);                    // clear pending flag
+    val = (u8_t)GetWord16(SPI_RX_TX_REG0);
+
+    if (i && rd)
+      rd[i - 1] = val;
+  }
+
+  SetWord16(P0_SET_DATA_REG,1<<6);                      // set cs HIGH
+
+  SetBits16(SPI_CTRL_REG,SPI_ON,0);                     // disable SPI block
+}
+
+
+/*******************************************************************************
+* Function Name		: LIS3DH_ReadReg
+* Description		: Reads a register. The shadowed control registers are read
+*			: from RAM once LIS3DH_ShadowInit has been called.
+* Input			: Register Address
+* Output		: Data REad
+* Return		: None
+*******************************************************************************/
+u8_t LIS3DH_ReadReg(u8_t Reg, u8_t* Data) {
+
+  if (LIS3DH_ShadowValid && LIS3DH_IS_SHADOWED(Reg)) {
+    *Data = LIS3DH_Shadow[Reg - LIS3DH_SHADOW_FIRST];
+    return 1;
+  }
+
+  return LIS3DH_BusReadReg(Reg, Data);
+}
+
+
+/*******************************************************************************
+* Function Name		: LIS3DH_WriteReg
+* Description		: Writes a register. A shadowed control register is written
+*			: only if its value changes. Between LIS3DH_ConfigBegin and
+*			: LIS3DH_ConfigCommit it is only marked dirty.
+* Input			: Register Address, Data to be written
+* Output		: None
+* Return		: None
+*******************************************************************************/
+u8_t LIS3DH_WriteReg(u8_t WriteAddr, u8_t Data) {
+  u8_t* shadow;
+
+  if (!LIS3DH_ShadowValid || !LIS3DH_IS_SHADOWED(WriteAddr))
+    return LIS3DH_BusWriteReg(WriteAddr, Data);
+
+  shadow = &LIS3DH_Shadow[WriteAddr - LIS3DH_SHADOW_FIRST];
+
+  if ((WriteAddr == LIS3DH_CTRL_REG5) && (Data & (MEMS_SET<<LIS3DH_BOOT))) {
+    // reboot of the memory content: the bit clears itself
+    *shadow = Data & ~(MEMS_SET<<LIS3DH_BOOT);
+    LIS3DH_ShadowDirty &= ~LIS3DH_SHADOW_BIT(WriteAddr);
+    return LIS3DH_BusWriteReg(WriteAddr, Data);
+  }
+
+  if (*shadow == Data)
+    return 1;
+
+  *shadow = Data;
+
+  if (LIS3DH_ShadowDeferred) {
+    LIS3DH_ShadowDirty |= LIS3DH_SHADOW_BIT(WriteAddr);
+    return 1;
+  }
+
+  return LIS3DH_BusWriteReg(WriteAddr, Data);
+}
+
 
 /* Private functions ---------------------------------------------------------*/
 
@@ -1687,6 +1824,184 @@ status_t LIS3DH_SetSPIInterface(LIS3DH_SPIMode_t spi) {
   
   return MEMS_SUCCESS;
 }
+/*******************************************************************************
+* Function Name  : LIS3DH_ShadowInit
+* Description    : Reads the control registers into the RAM shadow. From then on
+*                  the configuration functions read them from RAM and write
+*                  only the registers that change.
+* Input          : None
+* Output         : None
+* Return         : Status [MEMS_ERROR, MEMS_SUCCESS]
+*******************************************************************************/
+status_t LIS3DH_ShadowInit(void) {
+  u8_t first, last;
+
+  LIS3DH_ShadowValid = 0;
+  LIS3DH_ShadowDirty = 0;
+  LIS3DH_ShadowDeferred = 0;
+
+  // one burst per run of consecutive shadowed registers
+  for (first = LIS3DH_SHADOW_FIRST; first <= LIS3DH_SHADOW_LAST; first = last + 1) {
+    last = first;
+    if (!LIS3DH_IS_SHADOWED(first))
+      continue;
+    while ((last < LIS3DH_SHADOW_LAST) && LIS3DH_IS_SHADOWED(last + 1))
+      last++;
+    LIS3DH_BusTransfer(LIS3DH_SPI_READ | LIS3DH_SPI_INC | first, NULL,
+                       &LIS3DH_Shadow[first - LIS3DH_SHADOW_FIRST], last - first + 1);
+  }
+
+  LIS3DH_ShadowValid = 1;
+
+  return MEMS_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name  : LIS3DH_ConfigBegin
+* Description    : Starts a configuration change. The configuration functions
+*                  only update the shadow until LIS3DH_ConfigCommit.
+* Input          : None
+* Output         : None
+* Return         : Status [MEMS_ERROR, MEMS_SUCCESS]
+*******************************************************************************/
+status_t LIS3DH_ConfigBegin(void) {
+
+  if (!LIS3DH_ShadowValid)
+    return MEMS_ERROR;
+
+  LIS3DH_ShadowDeferred = 1;
+
+  return MEMS_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name  : LIS3DH_ConfigCommit
+* Description    : Writes the registers changed since LIS3DH_ConfigBegin. The
+*                  dirty registers of a run of consecutive shadowed registers
+*                  are written in one burst, e.g. CTRL_REG1 to CTRL_REG6.
+* Input          : None
+* Output         : None
+* Return         : Status [MEMS_ERROR, MEMS_SUCCESS]
+*******************************************************************************/
+status_t LIS3DH_ConfigCommit(void) {
+  u8_t first, last;
+
+  if (!LIS3DH_ShadowValid)
+    return MEMS_ERROR;
+
+  for (first = LIS3DH_SHADOW_FIRST; first <= LIS3DH_SHADOW_LAST; first = last + 1) {
+    u8_t run_last = first;
+
+    last = first;
+    if (!(LIS3DH_ShadowDirty & LIS3DH_SHADOW_BIT(first)))
+      continue;
+
+    // end of the run, then back to its last dirty register
+    while ((run_last < LIS3DH_SHADOW_LAST) && LIS3DH_IS_SHADOWED(run_last + 1))
+      run_last++;
+    for (last = run_last; !(LIS3DH_ShadowDirty & LIS3DH_SHADOW_BIT(last)); last--)
+      ;
+
+    LIS3DH_BusTransfer(LIS3DH_SPI_INC | first, &LIS3DH_Shadow[first - LIS3DH_SHADOW_FIRST],
+                       NULL, last - first + 1);
+    last = run_last;
+  }
+
+  LIS3DH_ShadowDirty = 0;
+  LIS3DH_ShadowDeferred = 0;
+
+  return MEMS_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name  : LIS3DH_FifoStreamStart
+* Description    : Enables the FIFO in stream mode with the watermark interrupt
+*                  on INT1, in one configuration change
+* Input          : Watermark = [1,31] samples
+* Output         : None
+* Return         : Status [MEMS_ERROR, MEMS_SUCCESS]
+*******************************************************************************/
+status_t LIS3DH_FifoStreamStart(u8_t wtm) {
+  u8_t value;
+
+  if((wtm == 0) || (wtm > 31))
+    return MEMS_ERROR;
+
+  if( !LIS3DH_ConfigBegin() )
+    return MEMS_ERROR;
+
+  // bypass first: a change of mode restarts the FIFO
+  LIS3DH_ReadReg(LIS3DH_FIFO_CTRL_REG, &value);
+  LIS3DH_WriteReg(LIS3DH_FIFO_CTRL_REG, value & 0x1F);
+  LIS3DH_ConfigCommit();
+
+  LIS3DH_ConfigBegin();
+  LIS3DH_ReadReg(LIS3DH_CTRL_REG5, &value);
+  LIS3DH_WriteReg(LIS3DH_CTRL_REG5, value | (MEMS_SET<<LIS3DH_FIFO_EN));
+  LIS3DH_ReadReg(LIS3DH_CTRL_REG3, &value);
+  LIS3DH_WriteReg(LIS3DH_CTRL_REG3, value | LIS3DH_WTM_ON_INT1_ENABLE);
+  LIS3DH_WriteReg(LIS3DH_FIFO_CTRL_REG, (LIS3DH_FIFO_STREAM_MODE<<LIS3DH_FM) | wtm);
+
+  return LIS3DH_ConfigCommit();
+}
+
+
+/*******************************************************************************
+* Function Name  : LIS3DH_FifoStreamStop
+* Description    : Disables the FIFO and the watermark interrupt
+* Input          : None
+* Output         : None
+* Return         : Status [MEMS_ERROR, MEMS_SUCCESS]
+*******************************************************************************/
+status_t LIS3DH_FifoStreamStop(void) {
+  u8_t value;
+
+  if( !LIS3DH_ConfigBegin() )
+    return MEMS_ERROR;
+
+  LIS3DH_ReadReg(LIS3DH_CTRL_REG3, &value);
+  LIS3DH_WriteReg(LIS3DH_CTRL_REG3, value & ~LIS3DH_WTM_ON_INT1_ENABLE);
+  LIS3DH_ReadReg(LIS3DH_CTRL_REG5, &value);
+  LIS3DH_WriteReg(LIS3DH_CTRL_REG5, value & ~(MEMS_SET<<LIS3DH_FIFO_EN));
+  LIS3DH_ReadReg(LIS3DH_FIFO_CTRL_REG, &value);
+  LIS3DH_WriteReg(LIS3DH_FIFO_CTRL_REG, value & 0x1F);
+
+  return LIS3DH_ConfigCommit();
+}
+
+
+/*******************************************************************************
+* Function Name  : LIS3DH_FifoDrain
+* Description    : Reads the samples waiting in the FIFO: one read of FIFO_SRC
+*                  and one burst from OUT_X_L, which wraps around to OUT_X_L
+*                  after OUT_Z_H while the FIFO is enabled. Call it from the
+*                  watermark interrupt.
+* Input          : buffer to empty by AxesRaw_t Typedef, size of the buffer
+* Output         : FIFO_SRC before the read (LIS3DH_FIFO_SRC_OVRUN: samples
+*                  were lost)
+* Return         : Number of samples read
+*******************************************************************************/
+u8_t LIS3DH_FifoDrain(AxesRaw_t* buff, u8_t max, u8_t* src) {
+  u8_t nb;
+
+  LIS3DH_BusReadReg(LIS3DH_FIFO_SRC_REG, src);
+
+  if (*src & LIS3DH_FIFO_SRC_EMPTY)
+    return 0;
+
+  nb = (*src & LIS3DH_FIFO_SRC_OVRUN) ? 32 : (*src & 0x1F);
+  if (nb > max)
+    nb = max;
+
+  // little endian (BLE = 0) data in the order of AxesRaw_t
+  LIS3DH_BusTransfer(LIS3DH_SPI_READ | LIS3DH_SPI_INC | LIS3DH_OUT_X_L, NULL, (u8_t*)buff,
+                     nb * sizeof(AxesRaw_t));
+
+  return nb;
+}
 /******************* (C) COPYRIGHT 2012 STMicroelectronics *****END OF FILE****/
 
 #endif
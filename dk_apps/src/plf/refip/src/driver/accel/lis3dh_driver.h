@@ -503,6 +503,14 @@ status_t LIS3DH_SetTriggerInt(LIS3DH_TrigInt_t tr);
 status_t LIS3DH_GetFifoSourceReg(u8_t* val);
 status_t LIS3DH_GetFifoSourceBit(u8_t statusBIT, u8_t* val);
 status_t LIS3DH_GetFifoSourceFSS(u8_t* val);
+status_t LIS3DH_FifoStreamStart(u8_t wtm);
+status_t LIS3DH_FifoStreamStop(void);
+u8_t LIS3DH_FifoDrain(AxesRaw_t* buff, u8_t max, u8_t* src);
+
+//Register Shadow Functions
+status_t LIS3DH_ShadowInit(void);
+status_t LIS3DH_ConfigBegin(void);
+status_t LIS3DH_ConfigCommit(void);
 
 //Other Reading Functions
 status_t LIS3DH_GetStatusReg(u8_t* val);
@@ -517,8 +525,8 @@ status_t LIS3DH_GetWHO_AM_I(u8_t* val);
 status_t LIS3DH_Get6DPosition(u8_t* val);
 
 //Generic
-// i.e. u8_t LIS3DH_ReadReg(u8_t Reg, u8_t* Data);
-// i.e. u8_t LIS3DH_WriteReg(u8_t Reg, u8_t Data);
+u8_t LIS3DH_ReadReg(u8_t Reg, u8_t* Data);
+u8_t LIS3DH_WriteReg(u8_t WriteAddr, u8_t Data);
 
 
 #endif /* __LIS3DH_H */
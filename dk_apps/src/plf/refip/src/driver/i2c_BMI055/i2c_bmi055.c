@@ -133,6 +133,36 @@ uint32_t i2c_bmi055_read_data(uint8_t *rd_data_ptr, uint32_t address, uint32_t s
     return bytes_read;
 }
 
+/**
+ ****************************************************************************************
+ * @brief Reads the oldest frames of the FIFO of the selected device in one I2C burst.
+ *
+ * @param[in] rd_data_ptr   Read data pointer (frames * BMI055_FIFO_FRAME_SIZE bytes).
+ * @param[in] frames        Number of frames to read (up to BMI055_FIFO_MAX_BURST).
+ *
+ * @return Number of frames waiting in the FIFO before the read. Bit 7
+ *         (BMI055_FIFO_OVERRUN) is set if frames were lost.
+ ****************************************************************************************
+ */
+uint8_t i2c_bmi055_read_fifo(uint8_t *rd_data_ptr, uint8_t frames)
+{
+    uint8_t status = i2c_bmi055_read_byte(BMI055_FIFO_STATUS);
+    uint8_t available = status & BMI055_FIFO_FRAME_COUNTER;
+
+    if (frames > available) {
+        frames = available;
+    }
+    if (frames > BMI055_FIFO_MAX_BURST) {
+        frames = BMI055_FIFO_MAX_BURST;
+    }
+    
+    if (frames) {
+        // FIFO_DATA does not auto-increment: every byte read pops the next byte of the FIFO
+        bmi055_read_data_single(&rd_data_ptr, BMI055_FIFO_DATA, frames * BMI055_FIFO_FRAME_SIZE);
+    }
+    return status;
+}
+
 /**
  ****************************************************************************************
  * @brief Write single byte to BMI055.
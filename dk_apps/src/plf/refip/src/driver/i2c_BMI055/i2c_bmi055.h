@@ -39,20 +39,21 @@ enum I2C_ADRESS_BYTES_COUNT{
 
 #endif // _I2C_EEPROM_H
 
+// PMU_LPW (0x11). The sleep duration of the low power mode is in bits 4:1.
 enum BMI055_POWER_MODE{
   BMI055_NORMAL=0,
   BMI055_DEEP_SUSPEND=1<<5,
   BMI055_LOW_POWER_0_5MS= 1<<6,
-  BMI055_LOW_POWER_1MS=   1<<6 | 0x6,
-  BMI055_LOW_POWER_2MS=   1<<6 | 0x7,
-  BMI055_LOW_POWER_4MS=   1<<6 | 0x8,
-  BMI055_LOW_POWER_6MS=   1<<6 | 0x9,
-  BMI055_LOW_POWER_10MS=  1<<6 | 0xA,
-  BMI055_LOW_POWER_25S=   1<<6 | 0xB,
-  BMI055_LOW_POWER_50MS=  1<<6 | 0xC,
-  BMI055_LOW_POWER_100MS= 1<<6 | 0xD,
-  BMI055_LOW_POWER_500MS= 1<<6 | 0xE,
-  BMI055_LOW_POWER_1000MS=1<<6 | 0xF,
+  BMI055_LOW_POWER_1MS=   1<<6 | 0x6<<1,
+  BMI055_LOW_POWER_2MS=   1<<6 | 0x7<<1,
+  BMI055_LOW_POWER_4MS=   1<<6 | 0x8<<1,
+  BMI055_LOW_POWER_6MS=   1<<6 | 0x9<<1,
+  BMI055_LOW_POWER_10MS=  1<<6 | 0xA<<1,
+  BMI055_LOW_POWER_25MS=  1<<6 | 0xB<<1,
+  BMI055_LOW_POWER_50MS=  1<<6 | 0xC<<1,
+  BMI055_LOW_POWER_100MS= 1<<6 | 0xD<<1,
+  BMI055_LOW_POWER_500MS= 1<<6 | 0xE<<1,
+  BMI055_LOW_POWER_1000MS=1<<6 | 0xF<<1,
   BMI055_SUSPEND=1<<7
 };
 
@@ -117,6 +118,37 @@ enum BMI055_POWER_MODE{
     #define BMI055_FIFO_CONFIG_1    0x3E
     #define BMI055_FIFO_DATA        0x3F
 
+    // Gyro PMU_BW (0x10): ODR and filter bandwidth
+    #define BMI055_GYR_BW_100HZ_32HZ    0x07
+    #define BMI055_GYR_BW_100HZ_12HZ    0x05
+
+    // Gyro LPM2 (0x12). Fast power-up mode when set with BMI055_SUSPEND.
+    #define BMI055_GYR_FAST_POWERUP     0x80
+
+    // Accelerometer INT_STATUS_0 (0x09), INT_MAP_0 (0x19) and INT_EN_0 (0x16)
+    #define BMI055_INT_SLOPE            0x04
+    #define BMI055_INT_EN_SLOPE_XYZ     0x07
+
+    // Accelerometer INT_RST_LATCH (0x21)
+    #define BMI055_INT_RESET            0x80
+    #define BMI055_INT_LATCHED          0x0F
+
+    // FIFO_STATUS (0x0E)
+    #define BMI055_FIFO_FRAME_COUNTER   0x7F
+    #define BMI055_FIFO_OVERRUN         0x80
+
+    // FIFO_CONFIG_1 (0x3E). Writing the register clears the FIFO.
+    #define BMI055_FIFO_MODE_BYPASS     (0<<6)
+    #define BMI055_FIFO_MODE_FIFO       (1<<6)
+    #define BMI055_FIFO_MODE_STREAM     (2<<6)
+    #define BMI055_FIFO_DATA_XYZ        0
+
+    // A FIFO frame holds the X, Y and Z axes, LSB first
+    #define BMI055_FIFO_FRAME_SIZE      6
+
+    // Frames read in one burst. The bytes of a burst must fit in the 32-byte I2C Rx FIFO.
+    #define BMI055_FIFO_MAX_BURST       5
+
 
 /**
  ****************************************************************************************
@@ -171,6 +203,19 @@ uint32_t i2c_bmi055_read_data(uint8_t *rd_data_ptr, uint32_t address, uint32_t s
  */
 void i2c_bmi055_write_byte(uint32_t address, uint8_t wr_data);
 
+/**
+ ****************************************************************************************
+ * @brief Reads the oldest frames of the FIFO of the selected device in one I2C burst.
+ *
+ * @param[in] rd_data_ptr   Read data pointer (frames * BMI055_FIFO_FRAME_SIZE bytes).
+ * @param[in] frames        Number of frames to read (up to BMI055_FIFO_MAX_BURST).
+ *
+ * @return Number of frames waiting in the FIFO before the read. Bit 7
+ *         (BMI055_FIFO_OVERRUN) is set if frames were lost.
+ ****************************************************************************************
+ */
+uint8_t i2c_bmi055_read_fifo(uint8_t *rd_data_ptr, uint8_t frames);
+
 void i2c_bmi055_suspend_device(int dev_address, enum BMI055_POWER_MODE power_mode);
 void i2c_bmi055_reset_device(int address);
 
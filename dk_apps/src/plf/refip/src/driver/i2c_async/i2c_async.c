@@ -0,0 +1,230 @@
+/**
+ ****************************************************************************************
+ *
+ * @file i2c_async.c
+ *
+ * @brief Queued, interrupt driven I2C master driver.
+ *
+ * The transactions are executed one after the other. Each one reprograms the speed and
+ * the slave address, so devices with different settings can share the queue.
+ *
+ * The controller generates the STOP when its Tx FIFO empties and a RESTART when the
+ * direction changes. The Tx FIFO is refilled from the TX_EMPTY interrupt (below
+ * I2C_ASYNC_TX_TL entries), the Rx FIFO is drained from the RX_FULL interrupt and the
+ * transaction completes on STOP_DET. The read commands in flight never exceed the Rx FIFO
+ * depth, so no byte can be lost. A transaction ends early, with I2C_ASYNC_ERR_UNDERRUN,
+ * only if the interrupt is held off for the time the controller needs to send
+ * I2C_ASYNC_TX_TL bytes (~400us at 400kHz).
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#if (HAS_I2C_ASYNC)
+
+#include "i2c_async.h"
+#include "arch.h"
+
+// Tx FIFO level, at or below which it is refilled
+#define I2C_ASYNC_TX_TL                 (16)
+// Largest Rx FIFO level that raises RX_FULL
+#define I2C_ASYNC_RX_TL                 (16)
+
+#define I2C_CMD_READ                    (0x0100)
+
+static struct i2c_async_trans *i2c_async_head;     // in progress
+static struct i2c_async_trans *i2c_async_tail;
+static uint16_t i2c_async_tx_pos;                  // commands written to the Tx FIFO
+static uint16_t i2c_async_rx_pos;                  // bytes received
+
+/**
+ ****************************************************************************************
+ * @brief Writes the next commands of the current transaction to the Tx FIFO.
+ *        TX_EMPTY stays enabled until all of them have been written, except while
+ *        the reads wait for the Rx FIFO to be drained (RX_FULL refills it then).
+ ****************************************************************************************
+ */
+static void i2c_async_fill(void)
+{
+    struct i2c_async_trans *t = i2c_async_head;
+    const uint16_t hdr_len = t->reg_len + t->wr_len;
+    const uint16_t total = hdr_len + t->rd_len;
+    bool rx_wait = false;
+
+    while ((i2c_async_tx_pos < total) && (GetWord16(I2C_STATUS_REG) & TFNF)) {
+        uint16_t pos = i2c_async_tx_pos;
+
+        if (pos < t->reg_len) {
+            SetWord16(I2C_DATA_CMD_REG, (t->reg >> (8 * (t->reg_len - 1 - pos))) & 0xFF);
+        } else if (pos < hdr_len) {
+            SetWord16(I2C_DATA_CMD_REG, t->wr_data[pos - t->reg_len]);
+        } else if ((pos - hdr_len - i2c_async_rx_pos) < I2C_ASYNC_FIFO_DEPTH) {
+            SetWord16(I2C_DATA_CMD_REG, I2C_CMD_READ);
+        } else {
+            rx_wait = true;     // the Rx FIFO could overflow
+            break;
+        }
+        i2c_async_tx_pos++;
+    }
+
+    if ((i2c_async_tx_pos < total) && !rx_wait) {
+        SetBits16(I2C_INTR_MASK_REG, M_TX_EMPTY, 1);
+    } else {
+        SetBits16(I2C_INTR_MASK_REG, M_TX_EMPTY, 0);
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Reads the received bytes of the current transaction and sets the Rx threshold
+ *        for the rest.
+ ****************************************************************************************
+ */
+static void i2c_async_drain(void)
+{
+    struct i2c_async_trans *t = i2c_async_head;
+    uint16_t left;
+
+    while ((i2c_async_rx_pos < t->rd_len) && GetWord16(I2C_RXFLR_REG)) {
+        t->rd_data[i2c_async_rx_pos++] = GetWord16(I2C_DATA_CMD_REG) & 0xFF;
+    }
+
+    left = t->rd_len - i2c_async_rx_pos;
+    if (left) {
+        SetWord16(I2C_RX_TL_REG, ((left < I2C_ASYNC_RX_TL) ? left : I2C_ASYNC_RX_TL) - 1);
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Programs the controller for the transaction at the head of the queue and
+ *        starts it.
+ ****************************************************************************************
+ */
+static void i2c_async_start(void)
+{
+    struct i2c_async_trans *t = i2c_async_head;
+
+    SetWord16(I2C_ENABLE_REG, 0x0);                                                 // TAR can be written only while disabled
+    SetWord16(I2C_CON_REG, I2C_MASTER_MODE | I2C_SLAVE_DISABLE | I2C_RESTART_EN);
+    SetBits16(I2C_CON_REG, I2C_SPEED, t->speed);
+    SetWord16(I2C_TAR_REG, t->dev_address);
+    SetWord16(I2C_TX_TL_REG, I2C_ASYNC_TX_TL);
+    SetWord16(I2C_INTR_MASK_REG, M_TX_ABRT | M_STOP_DET | (t->rd_len ? M_RX_FULL : 0));
+    SetWord16(I2C_ENABLE_REG, 0x1);
+    GetWord16(I2C_CLR_INTR_REG);
+
+    i2c_async_tx_pos = 0;
+    i2c_async_rx_pos = 0;
+    t->status = I2C_ASYNC_PENDING;
+    if (t->rd_len) {
+        i2c_async_drain();
+    }
+    i2c_async_fill();
+}
+
+/**
+ ****************************************************************************************
+ * @brief Stops the controller and its clock
+ ****************************************************************************************
+ */
+static void i2c_async_stop(void)
+{
+    SetWord16(I2C_INTR_MASK_REG, 0);
+    SetWord16(I2C_ENABLE_REG, 0x0);
+    NVIC_DisableIRQ(I2C_IRQn);
+    NVIC_ClearPendingIRQ(I2C_IRQn);
+    SetBits16(CLK_PER_REG, I2C_ENABLE, 0);
+}
+
+
+void i2c_async_submit(struct i2c_async_trans *trans)
+{
+    trans->next = NULL;
+    trans->status = I2C_ASYNC_PENDING;
+
+    GLOBAL_INT_DISABLE();
+    if (i2c_async_head == NULL) {
+        i2c_async_head = trans;
+        i2c_async_tail = trans;
+        SetBits16(CLK_PER_REG, I2C_ENABLE, 1);
+        i2c_async_start();
+        NVIC_SetPriority(I2C_IRQn, 2);
+        NVIC_EnableIRQ(I2C_IRQn);
+    } else {
+        i2c_async_tail->next = trans;
+        i2c_async_tail = trans;
+    }
+    GLOBAL_INT_RESTORE();
+}
+
+
+bool i2c_async_is_busy(void)
+{
+    return i2c_async_head != NULL;
+}
+
+/**
+ ****************************************************************************************
+ * @brief I2C interrupt handler
+ ****************************************************************************************
+ */
+void I2C_Handler(void)
+{
+    struct i2c_async_trans *t = i2c_async_head;
+    const uint16_t stat = GetWord16(I2C_INTR_STAT_REG);
+
+    if (t == NULL) {
+        i2c_async_stop();
+        return;
+    }
+
+    if (stat & R_TX_ABRT) {
+        // the controller flushes the Tx FIFO and sends the STOP
+        GetWord16(I2C_CLR_TX_ABRT_REG);
+        t->status = I2C_ASYNC_ERR_ABORT;
+        SetBits16(I2C_INTR_MASK_REG, M_TX_EMPTY, 0);
+    }
+
+    if (t->rd_len) {
+        i2c_async_drain();
+    }
+
+    if (stat & R_STOP_DET) {
+        GetWord16(I2C_CLR_STOP_DET_REG);
+
+        if (t->status == I2C_ASYNC_PENDING) {
+            if ((i2c_async_tx_pos < (t->reg_len + t->wr_len + t->rd_len)) || (i2c_async_rx_pos < t->rd_len)) {
+                t->status = I2C_ASYNC_ERR_UNDERRUN;
+            } else {
+                t->status = I2C_ASYNC_OK;
+            }
+        }
+
+        // start the next one before the callback, which may submit more
+        i2c_async_head = t->next;
+        if (i2c_async_head) {
+            i2c_async_start();
+        } else {
+            i2c_async_tail = NULL;
+            i2c_async_stop();
+        }
+
+        if (t->callback) {
+            t->callback(t);
+        }
+        return;
+    }
+
+    if (t->status == I2C_ASYNC_PENDING) {
+        i2c_async_fill();
+    }
+}
+
+#endif // HAS_I2C_ASYNC
@@ -0,0 +1,99 @@
+/**
+ ****************************************************************************************
+ *
+ * @file i2c_async.h
+ *
+ * @brief Queued, interrupt driven I2C master driver header file.
+ *
+ * Copyright (C) 2015. Dialog Semiconductor Ltd, unpublished work. This computer
+ * program includes Confidential, Proprietary Information and is a Trade Secret of
+ * Dialog Semiconductor Ltd.  All use, disclosure, and/or reproduction is prohibited
+ * unless authorized in writing. All Rights Reserved.
+ *
+ * <bluetooth.support@diasemi.com> and contributors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _I2C_ASYNC_H
+#define _I2C_ASYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+// Depth of the Tx and Rx FIFOs of the I2C controller
+#define I2C_ASYNC_FIFO_DEPTH            (32)
+
+// Transaction status
+enum I2C_ASYNC_STATUS {
+    I2C_ASYNC_PENDING,
+    I2C_ASYNC_OK,
+    I2C_ASYNC_ERR_ABORT,        // NACK or arbitration lost (see I2C_TX_ABRT_SOURCE_REG)
+    I2C_ASYNC_ERR_UNDERRUN,     // the Tx FIFO emptied before the end, the transfer was cut
+};
+
+struct i2c_async_trans;
+
+/**
+ ****************************************************************************************
+ * @brief Called, from the I2C interrupt, when a transaction has completed. The
+ *        transaction is no longer used by the driver and may be submitted again.
+ *
+ * @param[in] trans     The transaction. trans->status holds the result.
+ ****************************************************************************************
+ */
+typedef void (*i2c_async_cb_t)(struct i2c_async_trans *trans);
+
+/*
+ * A transaction: [START] address+W, reg, wr_data, [RESTART address+R, rd_data] STOP.
+ * The register address is sent MSB first. The structure is owned by the caller and must
+ * stay valid until the callback.
+ */
+struct i2c_async_trans {
+    struct i2c_async_trans *next;   // used by the driver
+    i2c_async_cb_t callback;        // may be NULL
+    void *user;                     // for the caller
+    const uint8_t *wr_data;
+    uint8_t *rd_data;
+    uint16_t wr_len;
+    uint16_t rd_len;
+    uint32_t reg;
+    uint8_t reg_len;                // 0 to 3 bytes
+    uint8_t dev_address;            // 7-bit slave address
+    uint8_t speed;                  // I2C_STANDARD or I2C_FAST
+    volatile uint8_t status;        // I2C_ASYNC_STATUS
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Queues a transaction. It starts at once if the controller is idle. The I2C
+ *        clock is enabled while transactions are queued.
+ *
+ *        The blocking driver i2c_bmi055 must not be used while i2c_async_is_busy()
+ *        returns true. i2c_eeprom queues its transfers here.
+ *
+ * @param[in] trans     The transaction. Can be called from the callback.
+ ****************************************************************************************
+ */
+void i2c_async_submit(struct i2c_async_trans *trans);
+
+/**
+ ****************************************************************************************
+ * @brief Checks if transactions are queued or in progress.
+ *
+ * @return true, if the driver is busy
+ ****************************************************************************************
+ */
+bool i2c_async_is_busy(void);
+
+#endif // _I2C_ASYNC_H
@@ -16,11 +16,426 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 #include "global_io.h"
 #include "gpio.h"
 #include "periph_setup.h"
 #include "i2c_eeprom.h"
 
+#if (HAS_I2C_ASYNC)
+
+/*
+ * The transfers are jobs (struct i2c_eeprom_job) executed one after the other through
+ * the queue of i2c_async, so they are serialized with the transactions of the other
+ * devices on the bus and the bytes are moved by the I2C interrupt. Each write page, and
+ * the first read of a job, is preceded by dummy accesses until the EEPROM acknowledges.
+ * The steps are chained from the completion callbacks.
+ *
+ * The blocking functions below submit a job and halt the CPU until its end. They remain
+ * for the callers that use the data at once.
+ */
+
+#include "arch.h"
+
+// Longest read of a transaction. A read never crosses a multiple of it.
+#define I2C_EEPROM_READ_MAX     (256)
+
+static uint8_t mem_address_size;    // I2C_ADRESS_BYTES_COUNT
+static uint8_t i2c_dev_address;     // Device addres
+static uint8_t i2c_speed;
+
+static struct i2c_eeprom_job *i2c_eeprom_head;     // in progress
+static struct i2c_eeprom_job *i2c_eeprom_tail;
+
+static void i2c_eeprom_trans_cb(struct i2c_async_trans *trans);
+
+/**
+ ****************************************************************************************
+ * @brief Prepares a transaction to the memory address of the EEPROM.
+ *
+ * @param[out] t        The transaction
+ * @param[in]  address  The memory address
+ ****************************************************************************************
+ */
+static void i2c_eeprom_trans_init(struct i2c_async_trans *t, uint32_t address)
+{
+    memset(t, 0, sizeof(struct i2c_async_trans));
+    t->speed = i2c_speed;
+    t->dev_address = i2c_dev_address;
+
+    switch(mem_address_size)
+    {
+        case I2C_2BYTES_ADDR:
+            t->dev_address |= (address & 0x10000) >> 16;    // A16 of the 1 Mbit parts
+            t->reg = address & 0xFFFF;
+            t->reg_len = 2;
+        break;
+
+        case I2C_3BYTES_ADDR:
+            t->reg = address & 0xFFFFFF;
+            t->reg_len = 3;
+        break;
+
+        default:
+            t->reg = address & 0xFF;
+            t->reg_len = 1;
+        break;
+    }
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Submits a dummy access. It is not acknowledged while the EEPROM writes.
+ *
+ * @param[in] job       The job
+ ****************************************************************************************
+ */
+static void i2c_eeprom_poll(struct i2c_eeprom_job *job)
+{
+    i2c_eeprom_trans_init(&job->trans, 0);
+    job->trans.reg = 0x08;
+    job->trans.reg_len = 1;
+    job->trans.callback = i2c_eeprom_trans_cb;
+    job->trans.user = job;
+    job->polls++;
+    i2c_async_submit(&job->trans);
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Submits the next page write or read of a job.
+ *
+ * @param[in] job       The job
+ ****************************************************************************************
+ */
+static void i2c_eeprom_transfer(struct i2c_eeprom_job *job)
+{
+    const uint32_t address = job->address + job->done;
+    const uint32_t left = job->size - job->done;
+    uint32_t len;
+
+    i2c_eeprom_trans_init(&job->trans, address);
+    if (job->write) {
+        // max possible write size without crossing page boundary
+        len = I2C_EEPROM_PAGE - (address % I2C_EEPROM_PAGE);
+        if (len > left)
+            len = left;
+        job->trans.wr_data = job->data + job->done;
+        job->trans.wr_len = len;
+    } else {
+        len = I2C_EEPROM_READ_MAX - (address % I2C_EEPROM_READ_MAX);
+        if (len > left)
+            len = left;
+        job->trans.rd_data = job->data + job->done;
+        job->trans.rd_len = len;
+    }
+    job->trans.callback = i2c_eeprom_trans_cb;
+    job->trans.user = job;
+    i2c_async_submit(&job->trans);
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Starts the job at the head of the queue
+ ****************************************************************************************
+ */
+static void i2c_eeprom_start(void)
+{
+    struct i2c_eeprom_job *job = i2c_eeprom_head;
+
+    job->done = 0;
+    job->polls = 0;
+    i2c_eeprom_poll(job);
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Ends the job at the head of the queue, starts the next one and calls the
+ *        callback of the job.
+ *
+ * @param[in] status    The result (I2C_ASYNC_STATUS)
+ ****************************************************************************************
+ */
+static void i2c_eeprom_end(uint8_t status)
+{
+    struct i2c_eeprom_job *job;
+
+    GLOBAL_INT_DISABLE();
+    job = i2c_eeprom_head;
+    i2c_eeprom_head = job->next;
+    if (i2c_eeprom_head == NULL) {
+        i2c_eeprom_tail = NULL;
+    }
+    GLOBAL_INT_RESTORE();
+
+    job->status = status;
+    if (i2c_eeprom_head) {
+        i2c_eeprom_start();
+    }
+    if (job->callback) {
+        job->callback(job);
+    }
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Completion of a transaction of the job at the head of the queue, from the
+ *        I2C interrupt. Polls again while the EEPROM is busy, up to
+ *        I2C_EEPROM_READY_POLLS times, then transfers the next page.
+ *
+ * @param[in] trans     The transaction
+ ****************************************************************************************
+ */
+static void i2c_eeprom_trans_cb(struct i2c_async_trans *trans)
+{
+    struct i2c_eeprom_job *job = i2c_eeprom_head;
+
+    if (job->polls) {
+        // a dummy access
+        if (trans->status == I2C_ASYNC_OK) {
+            job->polls = 0;
+            if (job->done == job->size) {
+                i2c_eeprom_end(I2C_ASYNC_OK);      // a job of 0 bytes only waits
+            } else {
+                i2c_eeprom_transfer(job);
+            }
+        } else if ((trans->status == I2C_ASYNC_ERR_ABORT) && (job->polls < I2C_EEPROM_READY_POLLS)) {
+            i2c_eeprom_poll(job);
+        } else {
+            i2c_eeprom_end(trans->status);
+        }
+        return;
+    }
+
+    if (trans->status != I2C_ASYNC_OK) {
+        i2c_eeprom_end(trans->status);
+        return;
+    }
+
+    job->done += trans->wr_len + trans->rd_len;
+    if (job->done == job->size) {
+        i2c_eeprom_end(I2C_ASYNC_OK);
+    } else if (job->write) {
+        i2c_eeprom_poll(job);       // the page is being written
+    } else {
+        i2c_eeprom_transfer(job);
+    }
+}
+
+
+void i2c_eeprom_submit(struct i2c_eeprom_job *job)
+{
+    bool idle;
+
+    if (job->address >= I2C_EEPROM_SIZE) {
+        job->size = 0;
+    } else if (job->size > I2C_EEPROM_SIZE - job->address) {
+        job->size = I2C_EEPROM_SIZE - job->address;
+    }
+    job->next = NULL;
+    job->status = I2C_ASYNC_PENDING;
+
+    GLOBAL_INT_DISABLE();
+    idle = (i2c_eeprom_head == NULL);
+    if (idle) {
+        i2c_eeprom_head = job;
+    } else {
+        i2c_eeprom_tail->next = job;
+    }
+    i2c_eeprom_tail = job;
+    GLOBAL_INT_RESTORE();
+
+    if (idle) {
+        i2c_eeprom_start();
+    }
+}
+
+
+void i2c_eeprom_wait(struct i2c_eeprom_job *job)
+{
+    GLOBAL_INT_STOP();
+    while (job->status == I2C_ASYNC_PENDING) {
+        // an interrupt pending since the test wakes up WFI at once
+        WFI();
+        GLOBAL_INT_START();
+        GLOBAL_INT_STOP();
+    }
+    GLOBAL_INT_START();
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Queues a job and waits for its end.
+ *
+ * @param[in] job       The job
+ *
+ * @return The status of the job (I2C_ASYNC_STATUS)
+ ****************************************************************************************
+ */
+static uint8_t i2c_eeprom_run(struct i2c_eeprom_job *job)
+{
+    i2c_eeprom_submit(job);
+    i2c_eeprom_wait(job);
+
+    return job->status;
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Keeps the EEPROM settings. The controller is set up by i2c_async for each
+ *        transaction. Only the 7-bit addressing is supported.
+ ****************************************************************************************
+ */
+void i2c_eeprom_init(uint16_t dev_address, uint8_t speed, uint8_t address_mode, uint8_t address_size)
+{
+    mem_address_size = address_size;
+    i2c_dev_address = dev_address & 0x7F;
+    i2c_speed = speed;
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Nothing to do: i2c_async stops the controller and its clock when its queue
+ *        empties.
+ ****************************************************************************************
+ */
+void i2c_eeprom_release(void)
+{
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Polls until I2C eeprom is ready, at most I2C_EEPROM_READY_POLLS times
+ *
+ * @return I2C_EEPROM_OK, or I2C_EEPROM_ERR_NOT_READY if the EEPROM never acknowledged
+ ****************************************************************************************
+ */
+int8_t i2c_wait_until_eeprom_ready(void)
+{
+    struct i2c_eeprom_job job;
+
+    memset(&job, 0, sizeof(job));
+    return (i2c_eeprom_run(&job) == I2C_ASYNC_OK) ? I2C_EEPROM_OK : I2C_EEPROM_ERR_NOT_READY;
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Read single byte from I2C EEPROM.
+ *
+ * @param[in] Memory address to read the byte from.
+ *
+ * @return Read byte.
+ ****************************************************************************************
+ */
+uint8_t i2c_eeprom_read_byte(uint32_t address)
+{
+    uint8_t rd_data = 0xFF;
+
+    i2c_eeprom_read_data(&rd_data, address, 1);
+    return rd_data;
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Reads data from I2C EEPROM to memory position of given pointer.
+ *
+ * @param[in] rd_data_ptr     Read data pointer.
+ * @param[in] address         Starting memory address.
+ * @param[in] size            Size of the data to be read.
+ *
+ * @return Bytes that were actually read (due to memory size limitation).
+ ****************************************************************************************
+ */
+uint32_t i2c_eeprom_read_data(uint8_t *rd_data_ptr, uint32_t address, uint32_t size)
+{
+    struct i2c_eeprom_job job;
+
+    memset(&job, 0, sizeof(job));
+    job.data = rd_data_ptr;
+    job.address = address;
+    job.size = size;
+    i2c_eeprom_run(&job);
+
+    return job.done;
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Write single byte to I2C EEPROM.
+ *
+ * @param[in] address     Memory position to write the byte to.
+ * @param[in] wr_data     Byte to be written.
+ ****************************************************************************************
+ */
+void i2c_eeprom_write_byte(uint32_t address, uint8_t wr_data)
+{
+    i2c_eeprom_write_data(&wr_data, address, 1);
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Writes page to I2C EEPROM.
+ *
+ * @param[in] address         Starting address of memory page.
+ * @param[in] wr_data_ptr     Pointer to the first of bytes to be written.
+ * @param[in] size            Size of the data to be written (MUST BE LESS OR EQUAL TO I2C_EEPROM_PAGE).
+ *
+ * @return                    Count of bytes that were actually written
+ ****************************************************************************************
+ */
+uint16_t i2c_eeprom_write_page(uint8_t *wr_data_ptr, uint32_t address, uint16_t size)
+{
+    uint16_t feasible_size;
+
+    // max possible write size without crossing page boundary
+    feasible_size = I2C_EEPROM_PAGE - (address % I2C_EEPROM_PAGE);
+    if (size < feasible_size)
+        feasible_size = size;                   // adjust limit accordingly
+
+    return i2c_eeprom_write_data(wr_data_ptr, address, feasible_size);
+}
+
+
+/**
+ ****************************************************************************************
+ * @brief Writes data to I2C EEPROM.
+ *
+ * @param[in] address         Starting address of the write process.
+ * @param[in] wr_data_ptr     Pointer to the first of bytes to be written.
+ * @param[in] size            Size of the data to be written.
+ *
+ * @return Bytes that were actually written (due to memory size limitation).
+ ****************************************************************************************
+ */
+uint32_t i2c_eeprom_write_data(uint8_t *wr_data_ptr, uint32_t address, uint32_t size)
+{
+    struct i2c_eeprom_job job;
+
+    memset(&job, 0, sizeof(job));
+    job.data = wr_data_ptr;
+    job.address = address;
+    job.size = size;
+    job.write = true;
+    i2c_eeprom_run(&job);
+
+    return job.done;
+}
+
+#else // HAS_I2C_ASYNC
+
 // macros
 #define SEND_I2C_COMMAND(X) SetWord16(I2C_DATA_CMD_REG, (X))
 #define WAIT_WHILE_I2C_FIFO_IS_FULL() while( (GetWord16(I2C_STATUS_REG) & TFNF) == 0 )
@@ -65,20 +480,27 @@ void i2c_eeprom_release(void)
 
 /**
  ****************************************************************************************
- * @brief Polls until I2C eeprom is ready
+ * @brief Polls until I2C eeprom is ready, at most I2C_EEPROM_READY_POLLS times
+ *
+ * @return I2C_EEPROM_OK, or I2C_EEPROM_ERR_NOT_READY if the EEPROM never acknowledged
  ****************************************************************************************
  */
-void i2c_wait_until_eeprom_ready(void)
+int8_t i2c_wait_until_eeprom_ready(void)
 {
     uint16_t abort_SR_Status; // TX Abort Source Register
+    uint16_t polls = 0;
     // Polling until EEPROM ACK to detect busy period
     do {
+        if (polls++ == I2C_EEPROM_READY_POLLS)
+            return I2C_EEPROM_ERR_NOT_READY;                    // a missing or stuck EEPROM
         SEND_I2C_COMMAND(0x08);                                 // Make a dummy access
         WAIT_UNTIL_I2C_FIFO_IS_EMPTY();                         // Wait until Tx FIFO is empty
         WAIT_UNTIL_NO_MASTER_ACTIVITY();                        // Wait until no master activity   
         abort_SR_Status = GetWord16(I2C_TX_ABRT_SOURCE_REG);    // Read the Tx abort source register
         GetWord16(I2C_CLR_TX_ABRT_REG);                         // Clear the Tx abort flag
     } while( (abort_SR_Status & ABRT_7B_ADDR_NOACK) != 0 );     // Repeat if not ACK    
+
+    return I2C_EEPROM_OK;
 }
 
 
@@ -123,7 +545,8 @@ void i2c_send_address(uint32_t address_to_send)
  */
 uint8_t i2c_eeprom_read_byte(uint32_t address)
 {
-    i2c_wait_until_eeprom_ready();
+    if (i2c_wait_until_eeprom_ready() != I2C_EEPROM_OK)
+        return 0xFF;
     i2c_send_address(address);  
     
     WAIT_WHILE_I2C_FIFO_IS_FULL();                  // Wait if Tx FIFO is full
@@ -201,7 +624,8 @@ uint32_t i2c_eeprom_read_data(uint8_t *rd_data_ptr, uint32_t address, uint32_t s
         bytes_read = size;
     }
 
-    i2c_wait_until_eeprom_ready();
+    if (i2c_wait_until_eeprom_ready() != I2C_EEPROM_OK)
+        return 0;
 
     // Read 32 bytes at a time
     while (tmp_size >= 32)
@@ -228,7 +652,8 @@ uint32_t i2c_eeprom_read_data(uint8_t *rd_data_ptr, uint32_t address, uint32_t s
  */
 void i2c_eeprom_write_byte(uint32_t address, uint8_t wr_data)
 {
-    i2c_wait_until_eeprom_ready();
+    if (i2c_wait_until_eeprom_ready() != I2C_EEPROM_OK)
+        return;
     i2c_send_address(address);
         
     WAIT_WHILE_I2C_FIFO_IS_FULL();                  // Wait if I2C Tx FIFO is full
@@ -263,7 +688,8 @@ uint16_t i2c_eeprom_write_page(uint8_t *wr_data_ptr, uint32_t address, uint16_t
         if (size < feasible_size)                                                                    
             feasible_size = size;                   // adjust limit accordingly
         
-        i2c_wait_until_eeprom_ready();
+        if (i2c_wait_until_eeprom_ready() != I2C_EEPROM_OK)
+            return 0;
         
         // Critical section
         GLOBAL_INT_DISABLE();
@@ -320,9 +746,13 @@ uint32_t i2c_eeprom_write_data(uint8_t *wr_data_ptr, uint32_t address, uint32_t
     while (bytes_left_to_send)
     {
 		uint16_t cnt = i2c_eeprom_write_page(wr_data_ptr + bytes_written, address + bytes_written, bytes_left_to_send);
+        if (cnt == 0)
+            break;                                  // the EEPROM is not ready
         bytes_written += cnt;  
         bytes_left_to_send -= cnt;
     }
     
     return bytes_written;
 }
+
+#endif // HAS_I2C_ASYNC
@@ -47,6 +47,15 @@
 #define _I2C_EEPROM_H
 
 #include <stdint.h>
+#include <stdbool.h>
+
+// Dummy accesses before the EEPROM is declared not ready. A poll takes ~25us at
+// 400 kbits/s, so this is about twice the 5ms write cycle of the supported parts.
+#define I2C_EEPROM_READY_POLLS      (400)
+
+// Results of i2c_wait_until_eeprom_ready()
+#define I2C_EEPROM_OK               (0)
+#define I2C_EEPROM_ERR_NOT_READY    (-1)
 
 enum I2C_SPEED_MODES{
   I2C_STANDARD = 1,
@@ -81,10 +90,12 @@ void i2c_eeprom_release(void);
 
 /**
  ****************************************************************************************
- * @brief Polls until I2C eeprom is ready
+ * @brief Polls until I2C eeprom is ready, at most I2C_EEPROM_READY_POLLS times
+ *
+ * @return I2C_EEPROM_OK, or I2C_EEPROM_ERR_NOT_READY if the EEPROM never acknowledged
  ****************************************************************************************
  */
-void i2c_wait_until_eeprom_ready(void);
+int8_t i2c_wait_until_eeprom_ready(void);
 
 /**
  ****************************************************************************************
@@ -146,4 +157,64 @@ uint16_t i2c_eeprom_write_page(uint8_t *wr_data_ptr, uint32_t address, uint16_t
  */
 uint32_t i2c_eeprom_write_data (uint8_t *wr_data_ptr, uint32_t address, uint32_t size);
 
+#if (HAS_I2C_ASYNC)
+
+#include "i2c_async.h"
+
+struct i2c_eeprom_job;
+
+/**
+ ****************************************************************************************
+ * @brief Called, from the I2C interrupt, when a job has ended. The job is no longer
+ *        used by the driver and may be submitted again.
+ *
+ * @param[in] job       The job. job->status holds the result and job->done the bytes
+ *                      that were transferred.
+ ****************************************************************************************
+ */
+typedef void (*i2c_eeprom_cb_t)(struct i2c_eeprom_job *job);
+
+/*
+ * A read or a write of any length. A write is cut at the page boundaries, and each page
+ * waits for the write cycle of the previous one. The structure is owned by the caller
+ * and, with the data, must stay valid until the callback.
+ */
+struct i2c_eeprom_job {
+    struct i2c_eeprom_job *next;    // used by the driver
+    i2c_eeprom_cb_t callback;       // may be NULL
+    void *user;                     // for the caller
+    uint8_t *data;
+    uint32_t address;
+    uint32_t size;
+    bool write;
+    uint32_t done;                  // bytes transferred
+    uint16_t polls;                 // used by the driver
+    volatile uint8_t status;        // I2C_ASYNC_STATUS. ERR_ABORT: the EEPROM was not ready.
+    struct i2c_async_trans trans;   // used by the driver
+};
+
+/**
+ ****************************************************************************************
+ * @brief Queues a job. The jobs are executed one after the other, through the queue of
+ *        i2c_async. The size is clamped to the end of the EEPROM.
+ *
+ * @param[in] job       The job. Can be called from the callback.
+ ****************************************************************************************
+ */
+void i2c_eeprom_submit(struct i2c_eeprom_job *job);
+
+/**
+ ****************************************************************************************
+ * @brief Waits for the end of a submitted job with the CPU halted (WFI). The I2C
+ *        interrupt, which ends the job, wakes it up. Not to be called from an interrupt
+ *        or with the interrupts disabled. SLEEPDEEP is clear outside the sleep code of
+ *        the main loop, so WFI only stops the CPU clock.
+ *
+ * @param[in] job       The job
+ ****************************************************************************************
+ */
+void i2c_eeprom_wait(struct i2c_eeprom_job *job);
+
+#endif // HAS_I2C_ASYNC
+
 #endif // _I2C_EEPROM_H
@@ -16,6 +16,7 @@
  */
 
 
+#include <string.h>
 #include "spi_flash.h"
 
 // local copy of FLASH setup parameters
@@ -24,6 +25,15 @@ const SPI_FLASH_DEVICE_PARAMETERS_BY_JEDEC_ID_t *spi_flash_detected_device;
 uint32_t spi_flash_size;         
 uint32_t spi_flash_page_size;
 
+#if (SPI_FLASH_CACHE_LINES > 0)
+#define SPI_FLASH_CACHE_NO_LINE     (0)
+
+// read cache: flash line number (address / SPI_FLASH_CACHE_LINE_SIZE) + 1 held by each line,
+// so that the cache starts empty
+static uint32_t spi_flash_cache_tag[SPI_FLASH_CACHE_LINES];
+static uint8_t spi_flash_cache_data[SPI_FLASH_CACHE_LINES][SPI_FLASH_CACHE_LINE_SIZE];
+#endif
+
 const SPI_FLASH_DEVICE_PARAMETERS_BY_JEDEC_ID_t SPI_FLASH_KNOWN_DEVICES_PARAMETERS_LIST[] = 
 {
 	{W25X10_JEDEC_ID, W25X10_JEDEC_ID_MATCHING_BITMASK, W25X10_TOTAL_FLASH_SIZE, W25X10_PAGE_SIZE, W25x_MEM_PROT_BITMASK, W25x10_MEM_PROT_NONE},
@@ -44,6 +54,47 @@ void spi_flash_init(uint32_t spi_flash_size_param, uint32_t spi_flash_page_size_
 	spi_flash_page_size = spi_flash_page_size_param;
 }
 
+/**
+ ****************************************************************************************
+ * @brief Drop the lines of the read cache
+ ****************************************************************************************
+ */
+void spi_flash_cache_invalidate(void)
+{
+#if (SPI_FLASH_CACHE_LINES > 0)
+	int i;
+
+	for (i = 0; i < SPI_FLASH_CACHE_LINES; i++)
+		spi_flash_cache_tag[i] = SPI_FLASH_CACHE_NO_LINE;
+#endif
+}
+
+/**
+ ****************************************************************************************
+ * @brief Drop the lines of the read cache that overlap a range of the flash
+ *
+ * @param[in] address:  Starting address of the range
+ * @param[in] size:     Size of the range
+ ****************************************************************************************
+ */
+static void spi_flash_cache_drop(uint32_t address, uint32_t size)
+{
+#if (SPI_FLASH_CACHE_LINES > 0)
+	const uint32_t first = address / SPI_FLASH_CACHE_LINE_SIZE;
+	const uint32_t last = (address + size - 1) / SPI_FLASH_CACHE_LINE_SIZE;
+	int i;
+
+	if (size == 0)
+		return;
+
+	for (i = 0; i < SPI_FLASH_CACHE_LINES; i++)
+	{
+		if ((spi_flash_cache_tag[i] > first) && (spi_flash_cache_tag[i] <= last + 1))
+			spi_flash_cache_tag[i] = SPI_FLASH_CACHE_NO_LINE;
+	}
+#endif
+}
+
 /**
  ****************************************************************************************
  * @brief Detect the SPI flash device, based on the JEDEC manufacturer id and the		
@@ -211,6 +262,49 @@ int32_t spi_flash_write_status_reg(uint8_t dataToWrite)
 	return spi_flash_wait_till_ready();
 }
 
+/**
+ ****************************************************************************************
+ * @brief Read data from a given starting address. The bulk of the data is moved in 32-bit
+ *        SPI words, which needs a quarter of the SPI accesses of byte transfers.
+ *
+ * @param[in] *rd_data_ptr:  Points to the position the read data will be stored
+ * @param[in] address:       Starting address of data to be read
+ * @param[in] size:          Size of the data to be read (must fit in the flash)
+ * 
+ * @return error code or success (ERR_OK)
+ ****************************************************************************************
+ */
+static int8_t spi_flash_read_burst(uint8_t *rd_data_ptr, uint32_t address, uint32_t size)
+{
+	int8_t spi_flash_status;
+	uint32_t word;
+	
+	spi_flash_status = spi_flash_wait_till_ready();
+	if (spi_flash_status != ERR_OK)
+		return spi_flash_status; 						// an error has occured     
+
+	spi_set_bitmode(SPI_MODE_32BIT);    
+	spi_cs_low();            			            	// pull CS low    
+	spi_access( (READ_DATA<<24) | address);             // Command for sequencial reading from memory		
+	while (size >= 4)
+	{
+		word = spi_access(0x0000);                      // 4 bytes, the first one in the MSB
+		*rd_data_ptr++ = (uint8_t)(word >> 24);
+		*rd_data_ptr++ = (uint8_t)(word >> 16);
+		*rd_data_ptr++ = (uint8_t)(word >> 8);
+		*rd_data_ptr++ = (uint8_t)word;
+		size -= 4;
+	}
+	spi_set_bitmode(SPI_MODE_8BIT);   
+	while (size > 0)                                    // the rest, a byte at a time
+	{
+		*rd_data_ptr++ = (uint8_t)spi_access(0x0000);   // bare SPI transaction
+		size--;
+	}
+	spi_cs_high();               			            // push CS high
+	return ERR_OK;
+}
+
 /**
  ****************************************************************************************
  * @brief Read data from a given starting address (up to the end of the flash)
@@ -225,7 +319,7 @@ int32_t spi_flash_write_status_reg(uint8_t dataToWrite)
 int32_t spi_flash_read_data (uint8_t *rd_data_ptr, uint32_t address, uint32_t size)
 {
 	int8_t spi_flash_status;
-	uint32_t bytes_read, i, temp_size;
+	uint32_t bytes_read, temp_size;
 	
 	// check that all bytes to be retrieved are located in valid flash memory address space
 	if (size + address > spi_flash_size)
@@ -238,27 +332,52 @@ int32_t spi_flash_read_data (uint8_t *rd_data_ptr, uint32_t address, uint32_t si
 		temp_size = size;
 		bytes_read = size;
 	}
+
+#if (SPI_FLASH_CACHE_LINES > 0)
+	if (temp_size <= SPI_FLASH_CACHE_LINE_SIZE)
+	{
+		while (temp_size > 0)
+		{
+			const uint32_t line = address / SPI_FLASH_CACHE_LINE_SIZE;
+			const uint32_t offset = address % SPI_FLASH_CACHE_LINE_SIZE;
+			const int idx = line % SPI_FLASH_CACHE_LINES;
+			uint32_t len = SPI_FLASH_CACHE_LINE_SIZE - offset;
+			
+			if (spi_flash_cache_tag[idx] != line + 1)
+			{
+				spi_flash_status = spi_flash_read_burst(spi_flash_cache_data[idx], line * SPI_FLASH_CACHE_LINE_SIZE,
+				                                        SPI_FLASH_CACHE_LINE_SIZE);
+				if (spi_flash_status != ERR_OK)
+				{
+					spi_flash_cache_tag[idx] = SPI_FLASH_CACHE_NO_LINE;
+					return spi_flash_status;            // an error has occured
+				}
+				spi_flash_cache_tag[idx] = line + 1;
+			}
+			
+			if (len > temp_size)
+				len = temp_size;
+			memcpy(rd_data_ptr, &spi_flash_cache_data[idx][offset], len);
+			rd_data_ptr += len;
+			address += len;
+			temp_size -= len;
+		}
+		return bytes_read;
+	}
+#endif
     
-	spi_flash_status = spi_flash_wait_till_ready();
+	spi_flash_status = spi_flash_read_burst(rd_data_ptr, address, temp_size);
 	if (spi_flash_status != ERR_OK)
 		return spi_flash_status; 						// an error has occured     
 
-	spi_set_bitmode(SPI_MODE_32BIT);    
-	spi_cs_low();            			            	// pull CS low    
-	spi_access( (READ_DATA<<24) | address);             // Command for sequencial reading from memory		
-	spi_set_bitmode(SPI_MODE_8BIT);   
-	for(i=0; i<temp_size; i++)
-	{
-		*rd_data_ptr++ = (uint8_t)spi_access(0x0000);   // bare SPI transaction
-	}
-	spi_cs_high();               			            // push CS high
 	return bytes_read;
 }
 
 
 /**
  ****************************************************************************************
- * @brief Program page (up to <SPI Flash page size> bytes) starting at given address
+ * @brief Start programming a page (up to <SPI Flash page size> bytes) at given address.
+ *        It does not wait for the end of the programming.
  *
  * @param[in] *wr_data_ptr:  Pointer to the data to be written
  * @param[in] address:       Starting address of data to be written
@@ -266,7 +385,7 @@ int32_t spi_flash_read_data (uint8_t *rd_data_ptr, uint32_t address, uint32_t si
  * @return error code or success (ERR_OK)
  ****************************************************************************************
  */
-int32_t spi_flash_page_program(uint8_t *wr_data_ptr, uint32_t address, uint16_t size)
+int32_t spi_flash_page_program_start(uint8_t *wr_data_ptr, uint32_t address, uint16_t size)
 {
 	int8_t spi_flash_status;
 	uint16_t temp_size = size;
@@ -282,6 +401,7 @@ int32_t spi_flash_page_program(uint8_t *wr_data_ptr, uint32_t address, uint16_t
 	if (spi_flash_status != ERR_OK)
 		return spi_flash_status; 						// an error has occured       
     
+	spi_flash_cache_drop(address, temp_size);
 	spi_set_bitmode(SPI_MODE_32BIT);
 	spi_cs_low();            			            	// pull CS low
 	spi_access( (PAGE_PROGRAM<<24) | address);        	// Command for page programming
@@ -292,26 +412,75 @@ int32_t spi_flash_page_program(uint8_t *wr_data_ptr, uint32_t address, uint16_t
 		temp_size--;
 	}
 	spi_cs_high();                                      // push CS high  
+ 	return ERR_OK;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Program page (up to <SPI Flash page size> bytes) starting at given address
+ *
+ * @param[in] *wr_data_ptr:  Pointer to the data to be written
+ * @param[in] address:       Starting address of data to be written
+ * @param[in] size:          Size of the data to be written (should not be larger than SPI Flash page size)
+ * @return error code or success (ERR_OK)
+ ****************************************************************************************
+ */
+int32_t spi_flash_page_program(uint8_t *wr_data_ptr, uint32_t address, uint16_t size)
+{
+	int32_t spi_flash_status;
+	
+	spi_flash_status = spi_flash_page_program_start(wr_data_ptr, address, size);
+	if (spi_flash_status != ERR_OK)
+		return spi_flash_status; 						// an error has occured   
+
  	return spi_flash_wait_till_ready();
 }
 
 
 /**
  ****************************************************************************************
- * @brief Issue a command to Erase a given address
+ * @brief Issue a command to Erase a given address. It does not wait for the end of the
+ *        erase.
  *
  * @param[in] address:  Address that belongs to the block64/block32/sector range
  * @param[in] spiEraseModule: BLOCK_ERASE_64, BLOCK_ERASE_32, SECTOR_ERASE
  * @return error code or success (ERR_OK)
  ****************************************************************************************
  */
-int8_t spi_flash_block_erase(uint32_t address, SPI_erase_module_t spiEraseModule)
+int8_t spi_flash_block_erase_start(uint32_t address, SPI_erase_module_t spiEraseModule)
 {
+	uint32_t erase_size;
+	
 	if (spi_flash_set_write_enable() != ERR_OK)         // send [Write Enable] instruction
 		return ERR_TIMEOUT;
 
+	if (spiEraseModule == BLOCK_ERASE_64)
+		erase_size = 0x10000;
+	else if (spiEraseModule == BLOCK_ERASE_32)
+		erase_size = 0x8000;
+	else
+		erase_size = 0x1000;
+	spi_flash_cache_drop(address & ~(erase_size - 1), erase_size);
+
 	spi_set_bitmode(SPI_MODE_32BIT);
 	spi_transaction( (spiEraseModule<<24) | address);   // Command for erasing a sector    
+	return ERR_OK;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Issue a command to Erase a given address
+ *
+ * @param[in] address:  Address that belongs to the block64/block32/sector range
+ * @param[in] spiEraseModule: BLOCK_ERASE_64, BLOCK_ERASE_32, SECTOR_ERASE
+ * @return error code or success (ERR_OK)
+ ****************************************************************************************
+ */
+int8_t spi_flash_block_erase(uint32_t address, SPI_erase_module_t spiEraseModule)
+{
+	if (spi_flash_block_erase_start(address, spiEraseModule) != ERR_OK)
+		return ERR_TIMEOUT;
+
 	return spi_flash_wait_till_ready();                 
  }
 
@@ -329,6 +498,7 @@ int8_t spi_flash_chip_erase(void)
 	if (spi_flash_set_write_enable() != ERR_OK)      // send [Write Enable] instruction
 		return ERR_TIMEOUT;
 	
+	spi_flash_cache_invalidate();
 	spi_set_bitmode(SPI_MODE_8BIT);
 	spi_transaction(CHIP_ERASE);                    // Command for Chip Erase
 	status = spi_flash_wait_till_ready();
@@ -564,6 +734,7 @@ int8_t spi_flash_page_fill(uint8_t value, uint32_t address, uint16_t size)
 	if (spi_flash_status != ERR_OK)  
 		return spi_flash_status; // an error has occured       
 	
+	spi_flash_cache_drop(address, temp_size);
 	spi_set_bitmode(SPI_MODE_32BIT);
 	spi_cs_low();            			            	// pull CS low
 	spi_access( (PAGE_PROGRAM<<24) | address);          // Command for page programming
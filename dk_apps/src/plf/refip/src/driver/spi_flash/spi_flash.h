@@ -136,6 +136,16 @@ typedef enum SPI_ERASE_MODULE
 
 #define SPI_FLASH_AUTO_DETECT_NOT_DETECTED (-1)
 
+/* Read cache. Reads of up to SPI_FLASH_CACHE_LINE_SIZE bytes are served from
+   SPI_FLASH_CACHE_LINES direct-mapped lines. Define SPI_FLASH_CACHE_LINES as 0 to
+   disable the cache. The cache starts empty and is kept across spi_flash_init() and
+   the power downs of the flash. The programs and the erases of this driver drop the
+   lines they overlap. */
+#ifndef SPI_FLASH_CACHE_LINES
+#define SPI_FLASH_CACHE_LINES       (0)
+#endif
+#define SPI_FLASH_CACHE_LINE_SIZE   (32)
+
 /**
  ****************************************************************************************
  * @brief Initialize SPI Flash
@@ -216,6 +226,14 @@ int32_t spi_flash_write_status_reg(uint8_t dataToWrite);
  */
 int32_t spi_flash_read_data (uint8_t *rd_data_ptr, uint32_t address, uint32_t size);
 
+/**
+ ****************************************************************************************
+ * @brief Drop the lines of the read cache. Must be called if the flash is written
+ *        without this driver.
+ ****************************************************************************************
+ */
+void spi_flash_cache_invalidate(void);
+
 /**
  ****************************************************************************************
  * @brief Program page (up to <SPI Flash page size> bytes) starting at given address
@@ -228,6 +246,19 @@ int32_t spi_flash_read_data (uint8_t *rd_data_ptr, uint32_t address, uint32_t si
  */
 int32_t spi_flash_page_program(uint8_t *wr_data_ptr, uint32_t address, uint16_t size);
 
+/**
+ ****************************************************************************************
+ * @brief Start programming a page (up to <SPI Flash page size> bytes) at given address.
+ *        It does not wait for the end of the programming (STATUS_BUSY).
+ *
+ * @param[in] *wr_data_ptr:  Pointer to the data to be written
+ * @param[in] address:       Starting address of data to be written
+ * @param[in] size:          Size of the data to be written (should not be larger than SPI Flash page size)
+ * @return error code or success (ERR_OK)
+ ****************************************************************************************
+ */
+int32_t spi_flash_page_program_start(uint8_t *wr_data_ptr, uint32_t address, uint16_t size);
+
  /**
  ****************************************************************************************
  * @brief Issue a comamnd to Erase a given address
@@ -239,6 +270,18 @@ int32_t spi_flash_page_program(uint8_t *wr_data_ptr, uint32_t address, uint16_t
  */
 int8_t spi_flash_block_erase(uint32_t address, SPI_erase_module_t spiEraseModule);
 
+/**
+ ****************************************************************************************
+ * @brief Issue a command to Erase a given address. It does not wait for the end of the
+ *        erase (STATUS_BUSY).
+ *
+ * @param[in] address:  Address that belongs to the block64/block32/sector range
+ * @param[in] spiEraseModule: BLOCK_ERASE_64, BLOCK_ERASE_32, SECTOR_ERASE
+ * @return error code or success (ERR_OK)
+ ****************************************************************************************
+ */
+int8_t spi_flash_block_erase_start(uint32_t address, SPI_erase_module_t spiEraseModule);
+
 /**
  ****************************************************************************************
  * @brief Erase chip